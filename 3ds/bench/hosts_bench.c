@@ -0,0 +1,156 @@
+/**
+ * 多主机状态更新路径基准测试 (主机端)
+ *
+ * - ingest: 查找槽位 + 解码一帧 (与服务端同格式的 JSON，带 "host":N)
+ * - apply: 一个渲染帧内对全部主机插值 (当前主机完整插值，其余只更新总览页指标)
+ * - 合计: 16 台主机各 10 Hz 推送时，折算到每个 60 fps 渲染帧的开销
+ * - chart: 下屏历史图表 (3 条曲线) 生成一次顶点的耗时，各时间跨度应相同
+ * - relay-id: 带 cgroups 字段的帧 (嵌套对象按键名排序在顶层 "host" 之前) 仍取到正确的中继主机
+ *   编号，不同上游不合并到同一槽位；检查失败时返回非 0
+ *
+ * 开发机比 3DS (268 MHz ARM11) 快一个数量级以上，结果用于比较改动前后的相对变化；
+ * 绝对值乘以约 20 作为 3DS 上的粗略估计
+ */
+
+#include "chart.h"
+#include "hosts.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOSTS MAX_HOSTS
+#define ROUNDS 2000
+#define PUSH_HZ 10
+#define RENDER_FPS 60
+#define FRAME_BYTES 2048
+
+static HostTable g_table;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// 生成一帧 (字段与服务端一致，按键名排序)
+static int make_frame(char* out, int host, int round, int cores) {
+    char hex[MAX_CORES * 2 + 1];
+    for (int i = 0; i < cores; i++) {
+        snprintf(hex + i * 2, 3, "%02x", (host * 7 + round * 3 + i * 11) % 100);
+    }
+    hex[cores * 2] = '\0';
+    uint64_t sample_ms = 1000 + (uint64_t)round * (1000 / PUSH_HZ);
+    return snprintf(out, FRAME_BYTES,
+        "{\"battery_percentage\":null,\"battery_status\":null,\"core_frequency_mhz\":\"%s\","
+        "\"core_usage\":\"%s\",\"cpu_frequency_mhz\":%d,\"cpu_temp\":%.2f,\"cpu_usage\":%.2f,"
+        "\"fan_speeds\":[%d],\"gpu_temp\":%.2f,\"host\":%d,\"memory_total\":16384,\"memory_usage\":%.2f,"
+        "\"memory_used\":%d,\"power_score\":%d,\"processes\":{\"cpu\":[[101,250,512],[202,120,256],"
+        "[303,60,128]],\"rss\":[[101,250,512]]},\"sample_ms\":%llu,\"seq\":%d,\"swap_usage\":3.5,"
+        "\"uptime_secs\":%d}",
+        hex, hex, 2400 + round % 800, 40.0f + (round + host) % 40, (float)((round * 13 + host * 5) % 100),
+        1200 + round % 600, 45.0f + host, host, (float)((round * 7 + host) % 100),
+        8000 + round % 1000, 1500000 + round * 100, (unsigned long long)sample_ms, round, 3600 + round / 10);
+}
+
+static void run(int cores) {
+    char* frames = malloc((size_t)ROUNDS * HOSTS * FRAME_BYTES);
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int h = 0; h < HOSTS; h++) {
+            if (make_frame(frames + ((size_t)r * HOSTS + h) * FRAME_BYTES, h, r, cores) >= FRAME_BYTES) {
+                fprintf(stderr, "frame too large\n");
+                exit(1);
+            }
+        }
+    }
+
+    hosts_init(&g_table);
+    uint64_t now_ms = 1000;
+    uint64_t ingest_ns = 0, apply_ns = 0;
+    int applies = 0;
+    float sink = 0.0f;
+    for (int r = 0; r < ROUNDS; r++) {
+        uint64_t t0 = now_ns();
+        for (int h = 0; h < HOSTS; h++) {
+            const char* json = frames + ((size_t)r * HOSTS + h) * FRAME_BYTES;
+            int idx = hosts_lookup(&g_table, 0x0100007f, 0x8d23, hosts_relay_id(json), now_ms);
+            if (idx >= 0) host_frame(&g_table.hosts[idx], json, now_ms);
+        }
+        ingest_ns += now_ns() - t0;
+
+        // 两次推送之间的渲染帧
+        for (int f = 0; f < RENDER_FPS / PUSH_HZ; f++) {
+            now_ms += 1000 / RENDER_FPS;
+            uint64_t t1 = now_ns();
+            for (int h = 0; h < g_table.count; h++) {
+                sink += host_apply(&g_table.hosts[h], now_ms, h == 0);
+            }
+            apply_ns += now_ns() - t1;
+            applies++;
+        }
+    }
+
+    double per_frame = (double)ingest_ns / ((double)ROUNDS * HOSTS);
+    double per_apply = (double)apply_ns / applies;
+    double per_render = per_frame * HOSTS * PUSH_HZ / RENDER_FPS + per_apply;
+    printf("hosts=%d cores=%-3d  ingest %7.0f ns/frame   apply %7.0f ns/render-frame   "
+           "total %6.1f us/render-frame (%.2f%% of 16.7 ms)\n",
+           g_table.count, cores, per_frame, per_apply, per_render / 1000.0,
+           per_render / 1000.0 / (1000.0 / RENDER_FPS) * 100.0 / 1000.0);
+    if (sink < 0) printf("%f\n", sink);
+    free(frames);
+}
+
+// 用最后一次 run() 留下的第一台主机的历史生成图表顶点
+static void run_chart(void) {
+    static ChartVertex vertices[CHART_MAX_VERTICES];
+    const Host* host = &g_table.hosts[0];
+    const ChartSeries series[] = {
+        {&host->history[HIST_CPU], 0.0f, 100.0f, 0, 1, 0, 1},
+        {&host->history[HIST_CPU_TEMP], 20.0f, 100.0f, 1, 0, 0, 1},
+        {&host->history[HIST_POWER], 0.0f, 50.0f, 0, 0, 1, 1},
+    };
+    for (int level = 0; level < HISTORY_LEVELS; level++) {
+        int count = 0;
+        uint64_t t0 = now_ns();
+        for (int r = 0; r < ROUNDS; r++) {
+            count = chart_fill(vertices, series, 3, level, 14, 26, 185, 64);
+        }
+        printf("chart level=%d  %d vertices  %6.0f ns/fill\n", level, count,
+               (double)(now_ns() - t0) / ROUNDS);
+    }
+}
+
+// 中继帧由服务端按键名排序重建: "cgroups" 排在顶层 "host" 之前
+static bool check_relay_id(void) {
+    static const char* const psi =
+        "{\"cgroups\":{\"psi\":{\"cpu\":[12,0],\"io\":[3,1],\"memory\":[0,0]},\"top\":[],\"tracked\":4},"
+        "\"cpu_usage\":5.00,\"host\":%d,\"sample_ms\":1000,\"seq\":1}";
+    // 旧服务端把主机 PSI 放在 "host" 键下
+    static const char* const legacy =
+        "{\"cgroups\":{\"host\":{\"cpu\":[12,0],\"io\":[3,1],\"memory\":[0,0]},\"top\":[],\"tracked\":4},"
+        "\"cpu_usage\":5.00,\"host\":%d,\"sample_ms\":1000,\"seq\":1}";
+    char json[FRAME_BYTES];
+    bool ok = true;
+    hosts_init(&g_table);
+    for (int h = 1; h <= 3; h++) {
+        snprintf(json, sizeof(json), h == 3 ? legacy : psi, h);
+        ok &= hosts_relay_id(json) == h;
+        ok &= hosts_lookup(&g_table, 0x0100007f, 0x8d23, hosts_relay_id(json), 1000) == h - 1;
+    }
+    ok &= g_table.count == 3;
+    // 直连帧 (没有顶层 "host")
+    ok &= hosts_relay_id("{\"cgroups\":{\"host\":{\"cpu\":[12,0]},\"top\":[]},\"cpu_usage\":5.00}") == -1;
+    ok &= hosts_relay_id("{\"cgroups\":{\"psi\":{\"cpu\":[12,0]},\"top\":[]},\"host\":0}") == 0;
+    printf("relay-id: %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    bool ok = check_relay_id();
+    run(16);
+    run(64);
+    run(MAX_CORES);
+    run_chart();
+    return ok ? 0 : 1;
+}
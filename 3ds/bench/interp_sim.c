@@ -0,0 +1,187 @@
+/**
+ * 客户端插值仿真 (主机端)
+ *
+ * 服务端按固定周期采样一条单调上升的曲线，帧经过有随机延迟的链路到达，客户端以 60 fps
+ * 按播放时钟 (interp.c) 求值，检查:
+ * - 播放时间与显示值都不回退 (抖动链路、推送周期 100/250/500 ms)
+ * - 播放时间比最新样本晚约一个推送周期，显示值与真实曲线的误差有界
+ * - 样本迟到时外推不超过 INTERP_MAX_EXTRAP 个间隔，之后保持；播放时间早于样本时不向前外推
+ * - 推送周期估计限制在 INTERP_MIN_PERIOD_MS..INTERP_MAX_PERIOD_MS，服务端重启后重新估计
+ *
+ * 任一检查失败时返回非 0
+ */
+
+#include "hosts.h"
+#include "interp.h"
+#include <math.h>
+#include <stdio.h>
+
+#define FRAMES 2000
+#define RENDER_MS 16
+// 本地时钟 = 服务端时钟 + 该偏移
+#define CLOCK_OFFSET_MS 3000
+// 曲线斜率 (每毫秒)
+#define SLOPE 0.01f
+
+static uint32_t g_rng = 12345;
+
+static uint32_t rnd(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+static bool report(const char* name, bool ok) {
+    printf("%-28s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 真实曲线
+static float curve(uint64_t sample_ms) {
+    return sample_ms * SLOPE;
+}
+
+// 固定周期采样，每帧延迟 0..jitter_ms 到达 (抖动小于周期，不乱序)
+static bool playback(int period_ms, int jitter_ms) {
+    InterpClock clk;
+    InterpChannel ch;
+    interp_clock_reset(&clk);
+    interp_reset(&ch);
+
+    uint64_t rx[FRAMES];
+    for (int k = 0; k < FRAMES; k++) {
+        rx[k] = 1000 + (uint64_t)k * period_ms + CLOCK_OFFSET_MS + (jitter_ms ? rnd() % jitter_ms : 0);
+    }
+
+    int next = 0, backward = 0, renders = 0;
+    uint64_t last_t = 0;
+    float last_v = -1.0f, max_err = 0.0f, max_back_ms = 0.0f;
+    double lag_sum = 0.0;
+    for (uint64_t now = rx[0]; now < rx[FRAMES - 1]; now += RENDER_MS) {
+        while (next < FRAMES && rx[next] <= now) {
+            uint64_t sample_ms = 1000 + (uint64_t)next * period_ms;
+            interp_clock_update(&clk, sample_ms, rx[next]);
+            interp_push(&ch, sample_ms, curve(sample_ms));
+            next++;
+        }
+        uint64_t t = interp_clock_time(&clk, now);
+        float v = interp_sample(&ch, t, INTERP_MAX_EXTRAP);
+        if (t < last_t || v < last_v) {
+            backward++;
+            if (last_t - t > max_back_ms) max_back_ms = last_t - t;
+        }
+        // 前 10 帧周期估计尚未收敛
+        if (next > 10) {
+            float err = fabsf(v - curve(t));
+            if (err > max_err) max_err = err;
+            // 播放延迟: 服务端当前时间与播放时间之差
+            lag_sum += (double)((int64_t)(now - CLOCK_OFFSET_MS) - (int64_t)t);
+            renders++;
+        }
+        last_t = t;
+        last_v = v;
+    }
+
+    // 曲线是直线，插值与外推都落在曲线上: 误差只来自外推上限后的保持
+    // 播放延迟约为一个周期加上平均链路延迟
+    float lag = renders ? (float)(lag_sum / renders) : 0.0f;
+    bool ok = backward == 0 && max_err <= 0.01f &&
+              fabsf(lag - period_ms - jitter_ms / 2.0f) <= jitter_ms / 2.0f + RENDER_MS;
+    char name[64];
+    snprintf(name, sizeof(name), "playback/%dms jitter %dms", period_ms, jitter_ms);
+    printf("%-28s lag %6.1f ms, max error %6.3f, backward %d (max %.0f ms)\n", name, lag, max_err, backward,
+           max_back_ms);
+    return report(name, ok);
+}
+
+// 外推: 超过最新样本最多 INTERP_MAX_EXTRAP 个间隔，之后保持；早于最早样本时保持 v0
+static bool extrapolation(void) {
+    InterpChannel ch;
+    interp_reset(&ch);
+    bool ok = interp_sample(&ch, 100, INTERP_MAX_EXTRAP) == 0.0f;
+    interp_push(&ch, 1000, 10.0f);
+    // 只有一个样本: 保持
+    ok &= interp_sample(&ch, 5000, INTERP_MAX_EXTRAP) == 10.0f;
+    interp_push(&ch, 1100, 20.0f);
+    ok &= interp_sample(&ch, 900, INTERP_MAX_EXTRAP) == 10.0f;
+    ok &= interp_sample(&ch, 1050, INTERP_MAX_EXTRAP) == 15.0f;
+    ok &= interp_sample(&ch, 1100, INTERP_MAX_EXTRAP) == 20.0f;
+    ok &= interp_sample(&ch, 1150, INTERP_MAX_EXTRAP) == 25.0f;
+    float limit = 20.0f + 10.0f * INTERP_MAX_EXTRAP;
+    ok &= interp_sample(&ch, 1100 + 100 * (1 + (int)INTERP_MAX_EXTRAP) + 10, INTERP_MAX_EXTRAP) <= limit;
+    ok &= interp_sample(&ch, 1000000, INTERP_MAX_EXTRAP) == limit;
+    ok &= interp_sample(&ch, 5000, 0.0f) == 20.0f;
+    // 下降的曲线同样对称限制
+    interp_push(&ch, 1200, 0.0f);
+    ok &= interp_sample(&ch, 1000000, INTERP_MAX_EXTRAP) == -20.0f * INTERP_MAX_EXTRAP;
+    return report("extrapolation/clamp", ok);
+}
+
+// 迟到与提前: 同一采样时刻的重复样本只更新值；采样时间回退 (服务端重启) 丢弃旧样本
+static bool late_early(void) {
+    InterpChannel ch;
+    interp_reset(&ch);
+    interp_push(&ch, 1000, 10.0f);
+    interp_push(&ch, 1100, 20.0f);
+    interp_push(&ch, 1100, 30.0f);
+    bool ok = ch.t0 == 1000 && ch.v0 == 10.0f && interp_sample(&ch, 1100, INTERP_MAX_EXTRAP) == 30.0f;
+    interp_push(&ch, 50, 5.0f);
+    ok &= interp_sample(&ch, 1100, INTERP_MAX_EXTRAP) == 5.0f;
+
+    // 样本迟到 3 个周期: 播放时间越过最新样本后外推到上限并保持，不回退
+    InterpClock clk;
+    interp_clock_reset(&clk);
+    interp_reset(&ch);
+    uint64_t now = 0;
+    for (int k = 0; k < 10; k++) {
+        uint64_t sample_ms = 1000 + k * 100;
+        now = sample_ms + CLOCK_OFFSET_MS;
+        interp_clock_update(&clk, sample_ms, now);
+        interp_push(&ch, sample_ms, curve(sample_ms));
+    }
+    float last = 0.0f, limit = curve(1900) + 100 * SLOPE * INTERP_MAX_EXTRAP;
+    for (uint64_t t = now; t < now + 300; t += RENDER_MS) {
+        float v = interp_sample(&ch, interp_clock_time(&clk, t), INTERP_MAX_EXTRAP);
+        ok &= v >= last && v <= limit + 1e-4f;
+        last = v;
+    }
+    ok &= fabsf(last - limit) <= 1e-4f;
+    // 迟到的帧到达后从保持值继续
+    interp_clock_update(&clk, 2000, now + 300);
+    interp_push(&ch, 2000, curve(2000));
+    ok &= interp_sample(&ch, interp_clock_time(&clk, now + 300), INTERP_MAX_EXTRAP) >= last - 1e-4f;
+    return report("samples/late-early", ok);
+}
+
+// 推送周期估计的上下限与服务端重启
+static bool period_estimate(void) {
+    InterpClock clk;
+    interp_clock_reset(&clk);
+    bool ok = interp_clock_time(&clk, 1234) == 0;
+    interp_clock_update(&clk, 1000, 5000);
+    ok &= clk.period_ms == 0.0f && interp_clock_time(&clk, 5000) == 1000;
+    interp_clock_update(&clk, 1010, 5010);
+    ok &= clk.period_ms == INTERP_MIN_PERIOD_MS;
+    uint64_t now = 5010;
+    for (uint64_t s = 1010 + 5000; s < 300000; s += 5000) {
+        now += 5000;
+        interp_clock_update(&clk, s, now);
+    }
+    ok &= clk.period_ms <= INTERP_MAX_PERIOD_MS && clk.period_ms > INTERP_MAX_PERIOD_MS - 1.0f;
+    ok &= interp_clock_time(&clk, now) + (uint64_t)clk.period_ms == clk.sample_ms;
+    // 服务端重启: 采样时间回退，周期重新估计，播放时间跟随新时钟 (不受不回退的限制)
+    interp_clock_update(&clk, 200, now + 100);
+    ok &= clk.period_ms == 0.0f && interp_clock_time(&clk, now + 100) == 200;
+    return report("clock/period", ok);
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= playback(100, 0);
+    ok &= playback(100, 40);
+    ok &= playback(250, 80);
+    ok &= playback(500, 150);
+    ok &= extrapolation();
+    ok &= late_early();
+    ok &= period_estimate();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/**
+ * 链路质量统计仿真 (主机端)
+ *
+ * 服务端 10 Hz 推送、客户端每秒一次 PING，经过有丢包、重复、乱序和随机延迟的模拟链路后
+ * 交给 linkstats.c，检查:
+ * - 丢包率: 按窗口统计的结果与实际丢弃的帧数一致；重复帧不计入，迟到的帧从丢失改记为乱序
+ * - 服务端重启 (序号回到 0) 不被当成大量丢包
+ * - 时钟偏移: 往返延迟有抖动时，最小往返过滤后的偏移误差不超过单向抖动的一半
+ * - 端到端延迟: 平滑值收敛到实际单程延迟的均值附近
+ *
+ * 任一检查失败时返回非 0
+ */
+
+#include "linkstats.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PUSH_MS 100
+#define FRAMES 20000
+// 本地时钟 = 服务端时钟 + 该偏移
+#define CLOCK_OFFSET_MS 3000
+#define PING_EVERY 10
+
+static uint32_t g_rng = 12345;
+
+static uint32_t rnd(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+static bool chance(float p) {
+    return (rnd() & 0xFFFF) < p * 65536.0f;
+}
+
+static bool report(const char* name, bool ok) {
+    printf("%-26s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 一帧的到达
+typedef struct {
+    uint32_t seq;
+    uint64_t sample_ms;
+    uint64_t at_ms;
+} Arrival;
+
+static Arrival g_arrivals[FRAMES * 2];
+
+static int by_arrival(const void* a, const void* b) {
+    const Arrival* x = a;
+    const Arrival* y = b;
+    if (x->at_ms != y->at_ms) return x->at_ms < y->at_ms ? -1 : 1;
+    return x->seq < y->seq ? -1 : (x->seq > y->seq);
+}
+
+// 丢包/重复/延迟链路: 窗口丢包率的平均值与实际丢包率一致，乱序数与被超越的帧数一致
+static bool loss(const char* name, float loss_p, float dup_p, int jitter_ms) {
+    int n = 0, dropped = 0;
+    for (uint32_t seq = 0; seq < FRAMES; seq++) {
+        uint64_t sample_ms = 1000 + (uint64_t)seq * PUSH_MS;
+        if (chance(loss_p)) {
+            dropped++;
+            continue;
+        }
+        int copies = chance(dup_p) ? 2 : 1;
+        for (int k = 0; k < copies; k++) {
+            uint64_t delay = 20 + (jitter_ms ? rnd() % jitter_ms : 0);
+            g_arrivals[n++] = (Arrival){seq, sample_ms, sample_ms + CLOCK_OFFSET_MS + delay};
+        }
+    }
+    qsort(g_arrivals, n, sizeof(Arrival), by_arrival);
+
+    LinkStats ls;
+    linkstats_reset(&ls, g_arrivals[0].at_ms);
+    static bool seen[FRAMES];
+    memset(seen, 0, sizeof(seen));
+    uint32_t max_seq = 0, overtaken = 0, reorders = 0, windows = 0;
+    double loss_sum = 0.0;
+    uint64_t window_at = ls.window_start_ms;
+    for (int i = 0; i < n; i++) {
+        const Arrival* a = &g_arrivals[i];
+        // 比已收到的最大序号小、且是第一份的帧才是乱序
+        overtaken += i > 0 && a->seq < max_seq && !seen[a->seq];
+        seen[a->seq] = true;
+        linkstats_frame(&ls, a->seq, a->sample_ms, a->at_ms);
+        if (ls.window_start_ms != window_at) {
+            // 窗口滚动: 累计上一个窗口的结果
+            window_at = ls.window_start_ms;
+            loss_sum += ls.loss_pct;
+            reorders += ls.reorder_count;
+            windows++;
+        }
+        if (a->seq > max_seq) max_seq = a->seq;
+    }
+    float measured = windows ? (float)(loss_sum / windows) : 0.0f;
+    float actual = dropped * 100.0f / FRAMES;
+    // 最后一个窗口尚未滚动，乱序数可能少计该窗口
+    bool ok = fabsf(measured - actual) <= 0.5f && reorders <= overtaken && overtaken - reorders <= 10;
+    printf("%-26s loss %5.2f%% (actual %5.2f%%), reordered %u (actual %u), %u windows\n", name, measured, actual,
+           reorders, overtaken, windows);
+    return report(name, ok);
+}
+
+// 服务端重启: 序号回到 0，不计为丢包，统计重新开始
+static bool restart(void) {
+    LinkStats ls;
+    linkstats_reset(&ls, 0);
+    uint64_t now = 0;
+    for (uint32_t seq = 5000; seq < 5100; seq++, now += PUSH_MS) linkstats_frame(&ls, seq, now, now);
+    bool ok = true;
+    for (uint32_t seq = 0; seq < 100; seq++, now += PUSH_MS) {
+        if (seq != 50) ok &= linkstats_frame(&ls, seq, now, now);
+    }
+    ok &= ls.lost == 1 && ls.last_seq == 99;
+    // 小幅回退 (窗口内) 是乱序，不是重启: 从丢失改记为乱序
+    ok &= !linkstats_frame(&ls, 50, now, now) && ls.last_seq == 99 && ls.lost == 0 && ls.reordered == 1;
+    // 重复帧 (最新的和迟到的) 不应用、不计数
+    uint32_t received = ls.received;
+    ok &= !linkstats_frame(&ls, 99, now, now) && !linkstats_frame(&ls, 50, now, now);
+    ok &= ls.received == received && ls.reordered == 1;
+    return report("seq/restart", ok);
+}
+
+// 时钟偏移与延迟: 每个方向 20 ms 固定延迟加 0..jitter_ms 的排队延迟
+static bool clock(int jitter_ms) {
+    LinkStats ls;
+    linkstats_reset(&ls, 0);
+    int max_offset_err = 0, max_naive_err = 0;
+    double delay_sum = 0.0;
+    int frames = 0;
+    for (uint32_t seq = 1; seq < 3000; seq++) {
+        uint64_t server_ms = 1000 + (uint64_t)seq * PUSH_MS;
+        uint64_t local_ms = server_ms + CLOCK_OFFSET_MS;
+        if (seq % PING_EVERY == 0) {
+            uint64_t up = 20 + (jitter_ms ? rnd() % jitter_ms : 0);
+            uint64_t down = 20 + (jitter_ms ? rnd() % jitter_ms : 0);
+            linkstats_pong(&ls, local_ms, server_ms + up, local_ms + up + down);
+            // 不过滤时按最近一次往返估计的偏移
+            int naive = (int)(local_ms + (up + down) / 2) - (int)(server_ms + up) - CLOCK_OFFSET_MS;
+            if (abs(naive) > max_naive_err) max_naive_err = abs(naive);
+            if (seq > 300) {
+                int err = (int)(ls.offset_ms - CLOCK_OFFSET_MS);
+                if (abs(err) > max_offset_err) max_offset_err = abs(err);
+            }
+        }
+        uint64_t delay = 20 + (jitter_ms ? rnd() % jitter_ms : 0);
+        linkstats_frame(&ls, seq, server_ms, local_ms + delay);
+        if (seq > 300) {
+            delay_sum += delay;
+            frames++;
+        }
+    }
+    float mean_delay = (float)(delay_sum / frames);
+    // 偏移误差是所选往返中两个方向排队延迟之差的一半；延迟估计包含同样的偏移误差
+    bool ok = ls.rtt_ms >= 40 && ls.rtt_ms <= 40 + 2 * (uint32_t)jitter_ms && max_offset_err <= jitter_ms / 2 &&
+              fabsf(ls.latency_ms - mean_delay) <= max_offset_err + jitter_ms / 4.0f + 1.0f;
+    char name[64];
+    snprintf(name, sizeof(name), "clock/jitter %dms", jitter_ms);
+    printf("%-26s offset error %d ms (latest-pong %d ms), latency %.1f ms (actual mean %.1f ms)\n", name,
+           max_offset_err, max_naive_err, ls.latency_ms, mean_delay);
+    return report(name, ok);
+}
+
+int main(void) {
+    bool ok = true;
+    ok &= loss("loss/clean", 0.0f, 0.0f, 0);
+    ok &= loss("loss/5%", 0.05f, 0.0f, 0);
+    ok &= loss("loss/5% reorder", 0.05f, 0.0f, 250);
+    ok &= loss("loss/20% dup", 0.20f, 0.05f, 150);
+    ok &= restart();
+    ok &= clock(0);
+    ok &= clock(20);
+    ok &= clock(80);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/**
+ * 自适应帧率仿真 (主机端)
+ *
+ * 按主循环的方式 (main.c) 驱动 hosts.c 与 pacing.c: 每帧按当前档位的帧间隔推进本地时间，
+ * 处理已到达的 10 Hz 数据帧，插值后的最大变化量超过 PACE_MOTION_PX * dt 时记为画面在动。
+ * 依次运行四段各 2 分钟的场景，统计每段实际渲染的上屏帧数，与固定 60 fps 相比少渲染的比例:
+ * - idle:   主机空闲，指标只有很小的噪声
+ * - busy:   CPU 使用率、温度、功率快速变化
+ * - input:  主机空闲，每 5 秒按住按键 1 秒
+ * - stale:  服务端停止推送
+ *
+ * 同时检查档位策略: 画面在动或有输入时不降帧，空闲时降到 30 fps，数据过期后降到 15 fps。
+ * 任一检查失败时返回非 0
+ */
+
+#include "hosts.h"
+#include "pacing.h"
+#include <math.h>
+#include <stdio.h>
+
+// 与 main.c 相同: 插值后的变化量 (像素/60 Hz 帧) 超过该值视为画面在动
+#define PACE_MOTION_PX 0.5f
+#define PUSH_MS 100
+#define PHASE_MS 120000
+#define SRC_IP 0x0100007f
+#define SRC_PORT 0x8d23
+
+typedef enum { PHASE_IDLE, PHASE_BUSY, PHASE_INPUT, PHASE_STALE, PHASES } Phase;
+
+static const char* g_phase_names[PHASES] = {"idle", "busy", "input", "stale"};
+
+static uint32_t g_rng = 12345;
+
+static uint32_t rnd(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+// -1..1 的均匀噪声
+static float noise(void) {
+    return (rnd() & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// 主机状态 (服务端采样值)
+static float g_cpu = 3.0f, g_temp = 45.0f, g_watts = 15.0f;
+
+static void make_frame(char* out, size_t size, int seq, Phase phase) {
+    if (phase == PHASE_BUSY) {
+        // 负载随机游走，温度与功率跟随
+        g_cpu = clampf(g_cpu + noise() * 8.0f, 20.0f, 95.0f);
+        g_temp += (40.0f + g_cpu * 0.4f - g_temp) * 0.1f;
+        g_watts += (10.0f + g_cpu * 0.5f - g_watts) * 0.2f;
+    } else {
+        g_cpu += (3.0f - g_cpu) * 0.2f + noise() * 0.2f;
+        g_temp += (45.0f - g_temp) * 0.05f + noise() * 0.05f;
+        g_watts += (15.0f - g_watts) * 0.2f + noise() * 0.05f;
+    }
+    snprintf(out, size,
+             "{\"seq\":%d,\"sample_ms\":%d,\"cpu_usage\":%.2f,\"cpu_temp\":%.2f,\"memory_usage\":40.00,"
+             "\"memory_total\":16384,\"memory_used\":6553,\"power_score\":%d,\"uptime_secs\":%d}",
+             seq, 1000 + seq * PUSH_MS, g_cpu, g_temp, (int)(g_watts * 100000.0f), 3600 + seq / 10);
+}
+
+int main(void) {
+    static HostTable table;
+    hosts_init(&table);
+    Pacer pacer;
+    double now = 0.0;
+    pacer_init(&pacer, 0);
+
+    int seq = 0;
+    uint64_t next_frame_ms = 0;
+    uint64_t last_frame_ms = 0;
+    bool ok = true;
+    char json[512];
+
+    printf("%-8s %8s %8s %8s %7s %7s %7s\n", "phase", "frames", "at 60fps", "skipped", "60fps", "30fps", "15fps");
+    for (int phase = 0; phase < PHASES; phase++) {
+        uint64_t start = (uint64_t)now;
+        uint64_t end = start + PHASE_MS;
+        int frames = 0;
+        double tier_ms[3] = {0, 0, 0};
+        while (now < end) {
+            uint64_t ms = (uint64_t)now;
+            // 到达的数据帧 (链路延迟 20 ms)
+            while (phase != PHASE_STALE && next_frame_ms + 20 <= ms) {
+                make_frame(json, sizeof(json), seq, (Phase)phase);
+                int h = hosts_lookup(&table, SRC_IP, SRC_PORT, -1, ms);
+                if (host_frame(&table.hosts[h], json, ms)) pacer_data(&pacer, ms);
+                seq++;
+                next_frame_ms += PUSH_MS;
+            }
+            if (phase == PHASE_STALE) next_frame_ms = ms;
+
+            float dt = (ms - last_frame_ms) * 0.06f;
+            if (dt > 8.0f) dt = 8.0f;
+            last_frame_ms = ms;
+            if (phase == PHASE_INPUT && (ms - start) % 5000 < 1000) pacer_motion(&pacer, ms);
+            if (table.count > 0 && host_apply(&table.hosts[0], ms, true) >= PACE_MOTION_PX * dt) {
+                pacer_motion(&pacer, ms);
+            }
+            pacer_update(&pacer, ms);
+            pacer_frame(&pacer, false, ms);
+            frames++;
+
+            // 按住按键期间必须全速
+            if (phase == PHASE_INPUT && (ms - start) % 5000 < 1000) ok &= pacer.state == PACE_ACTIVE;
+            double interval = 1000.0 / pacer_fps(pacer.state);
+            tier_ms[pacer.state] += interval;
+            now += interval;
+        }
+
+        int full = PHASE_MS * 60 / 1000;
+        float share[3];
+        for (int i = 0; i < 3; i++) share[i] = (float)(tier_ms[i] * 100.0 / (now - start));
+        printf("%-8s %8d %8d %7.1f%% %6.1f%% %6.1f%% %6.1f%%\n", g_phase_names[phase], frames, full,
+               (full - frames) * 100.0f / full, share[PACE_ACTIVE], share[PACE_IDLE], share[PACE_STALE]);
+
+        // 档位策略: 快速变化时几乎一直全速；空闲时大部分时间 30 fps；停推后 3 秒内降到 15 fps
+        switch (phase) {
+            case PHASE_BUSY: ok &= share[PACE_ACTIVE] >= 95.0f; break;
+            case PHASE_IDLE: ok &= share[PACE_IDLE] >= 90.0f; break;
+            case PHASE_INPUT: ok &= share[PACE_ACTIVE] >= 20.0f && share[PACE_STALE] == 0.0f; break;
+            case PHASE_STALE:
+                ok &= share[PACE_STALE] >= 100.0f - (PACE_STALE_MS + PACE_ACTIVE_HOLD_MS) * 100.0f / PHASE_MS;
+                break;
+        }
+    }
+    printf("pacing/policy: %s\n", ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
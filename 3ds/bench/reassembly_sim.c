@@ -0,0 +1,286 @@
+/**
+ * 分片帧重组仿真 (主机端)
+ *
+ * 按服务端的规则 (server/src/datagram.rs) 把 10 Hz 的帧打包成 1200 字节的数据报，经过一条
+ * 会丢包、重复、乱序的模拟链路后交给重组器与主机状态解码，检查:
+ * - 交出的每个块与发送的块逐字节相同，没有拼错帧或拼错偏移
+ * - 无损链路上每个块都交出；有损链路上只丢失缺了数据报的块，其余块照常交出
+ * - 重复的数据报不会被应用两次 (链路统计的收帧数不变)
+ * - 外部指标 (gauges) 只在整帧收齐且都不带该字段时清空
+ *
+ * 同时对比整帧才能解码时 (任何一个数据报丢失整帧作废) 的可用帧比例。
+ * 任一检查失败时返回非 0
+ */
+
+#include "hosts.h"
+#include "reassembly.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAMES 2000
+#define PUSH_MS 100
+#define MTU 1200
+#define FRAME_BYTES 4096
+#define MAX_CHUNKS 8
+#define MAX_DGRAMS 32
+#define SRC_IP 0x0100007f
+#define SRC_PORT 0x8d23
+
+typedef struct {
+    uint8_t data[MTU + 1];
+    int len;
+    int frame;
+    uint32_t at_ms;     // 到达时间 (发送时间 + 随机延迟)
+} Dgram;
+
+// 一帧打包出的块
+typedef struct {
+    char json[MAX_CHUNKS][FRAME_BYTES];
+    int parts[MAX_CHUNKS];
+    int count;
+} Chunks;
+
+static char g_frames[FRAMES][FRAME_BYTES];
+static Dgram g_sent[FRAMES * MAX_DGRAMS * 2];
+static HostTable g_table;
+static Reassembler g_reasm;
+static uint32_t g_rng = 12345;
+
+static uint32_t rnd(void) {
+    g_rng = g_rng * 1103515245u + 12345u;
+    return g_rng >> 8;
+}
+
+static bool chance(float p) {
+    return (rnd() & 0xFFFF) < p * 65536.0f;
+}
+
+// 生成一帧: 128 个核心的十六进制数组、带名称的进程榜 (单个字段超过一个数据报)，偶尔带外部指标
+static void make_frame(char* out, int seq) {
+    char hex[MAX_CORES * 2 + 1];
+    for (int i = 0; i < MAX_CORES; i++) snprintf(hex + i * 2, 3, "%02x", (seq * 3 + i * 11) % 100);
+    char names[2048];
+    int n = 0;
+    for (int i = 0; i < 40; i++) {
+        n += snprintf(names + n, sizeof(names) - n, "%s[%d,\"worker-process-%04d\"]", i ? "," : "", 1000 + i, seq % 97 + i);
+    }
+    char gauges[128] = "";
+    if (seq % 50 < 25) snprintf(gauges, sizeof(gauges), ",\"gauges\":[{\"id\":1,\"name\":\"queue\",\"value\":%d}]", seq);
+    snprintf(out, FRAME_BYTES,
+        "{\"seq\":%d,\"sample_ms\":%d,\"cpu_usage\":%.2f,\"cpu_temp\":%.2f,\"memory_usage\":%.2f,"
+        "\"memory_total\":16384,\"memory_used\":%d,\"core_usage\":\"%s\",\"core_frequency_mhz\":\"%s\","
+        "\"processes\":{\"cpu\":[[1000,250,512],[1001,120,256]],\"names\":[%s]}%s,\"uptime_secs\":%d}",
+        seq, 1000 + seq * PUSH_MS, (float)(seq % 100), 40.0f + seq % 30, (float)(seq * 7 % 100),
+        8000 + seq % 1000, hex, hex, names, gauges, 3600 + seq / 10);
+}
+
+// 拆出 JSON 对象的顶层成员 (与服务端相同: 只跟踪字符串与嵌套深度)
+static int split_fields(const char* json, const char** start, int* len, int max) {
+    int count = 0, depth = 0;
+    bool in_string = false, escaped = false;
+    const char* p = json + 1;
+    const char* field = p;
+    for (; *p; p++) {
+        if (in_string) {
+            if (escaped) escaped = false;
+            else if (*p == '\\') escaped = true;
+            else if (*p == '"') in_string = false;
+            continue;
+        }
+        if (*p == '"') in_string = true;
+        else if (*p == '{' || *p == '[') depth++;
+        else if ((*p == '}' || *p == ']') && depth-- == 0) break;
+        else if (*p == ',' && depth == 0 && count < max) {
+            start[count] = field;
+            len[count++] = p - field;
+            field = p + 1;
+        }
+    }
+    if (count < max && p > field) {
+        start[count] = field;
+        len[count++] = p - field;
+    }
+    return count;
+}
+
+static bool is_common(const char* field) {
+    return strncmp(field, "\"seq\":", 6) == 0 || strncmp(field, "\"sample_ms\":", 12) == 0 ||
+           strncmp(field, "\"host\":", 7) == 0;
+}
+
+// 按服务端规则打包成块与数据报，返回数据报数
+static int pack(const char* json, int frame_id, Chunks* f, Dgram* out) {
+    const int payload = MTU - REASM_HEADER_LEN;
+    const char* start[64];
+    int len[64];
+    int fields = split_fields(json, start, len, 64);
+
+    char prefix[128] = "{";
+    for (int i = 0; i < fields; i++) {
+        if (!is_common(start[i])) continue;
+        if (prefix[1]) strcat(prefix, ",");
+        strncat(prefix, start[i], len[i]);
+    }
+    int prefix_len = strlen(prefix);
+    f->count = 0;
+    char* chunk = f->json[0];
+    strcpy(chunk, prefix);
+    for (int i = 0; i < fields; i++) {
+        if (is_common(start[i])) continue;
+        int cur = strlen(chunk);
+        if (cur > prefix_len && cur + 1 + len[i] + 1 > payload) {
+            strcat(chunk, "}");
+            chunk = f->json[++f->count];
+            strcpy(chunk, prefix);
+            cur = prefix_len;
+        }
+        if (cur > 1) strcat(chunk, ",");
+        strncat(chunk, start[i], len[i]);
+    }
+    strcat(chunk, "}");
+    f->count++;
+
+    int count = 0;
+    for (int c = 0; c < f->count; c++) {
+        f->parts[c] = ((int)strlen(f->json[c]) + payload - 1) / payload;
+        count += f->parts[c];
+    }
+    int index = 0;
+    for (int c = 0; c < f->count; c++) {
+        int first = index, clen = strlen(f->json[c]);
+        for (int off = 0; off < clen; off += payload, index++) {
+            Dgram* d = &out[index];
+            int n = clen - off < payload ? clen - off : payload;
+            uint8_t header[REASM_HEADER_LEN] = {REASM_MARKER, REASM_VERSION, frame_id & 0xFF, frame_id >> 8,
+                                                count, index, first, f->parts[c], off & 0xFF, off >> 8};
+            memcpy(d->data, header, REASM_HEADER_LEN);
+            memcpy(d->data + REASM_HEADER_LEN, f->json[c] + off, n);
+            d->len = REASM_HEADER_LEN + n;
+            d->frame = frame_id;
+        }
+    }
+    return count;
+}
+
+static int by_arrival(const void* a, const void* b) {
+    uint32_t x = ((const Dgram*)a)->at_ms, y = ((const Dgram*)b)->at_ms;
+    return x < y ? -1 : x > y;
+}
+
+// 一种链路条件下的仿真: loss/dup 为概率，每个数据报另加 0..jitter_ms 的随机延迟
+// (同一帧的数据报相隔 1 ms 发出，延迟超过推送间隔时跨帧乱序)
+static bool simulate(const char* name, float loss, float dup, int jitter_ms) {
+    static Chunks chunks;
+    static Dgram dgrams[MAX_DGRAMS];
+    int originals = 0, sent = 0, lost = 0;
+    // 完整到达的块数 (它的每个数据报至少到达一份) 与完整到达的帧数
+    int expected = 0, total_chunks = 0, whole_frames = 0;
+    for (int f = 0; f < FRAMES; f++) {
+        int n = pack(g_frames[f], f, &chunks, dgrams);
+        bool survived[MAX_DGRAMS];
+        originals += n;
+        for (int i = 0; i < n; i++) {
+            int copies = chance(loss) ? 0 : (chance(dup) ? 2 : 1);
+            if (!copies) lost++;
+            survived[i] = copies > 0;
+            for (int k = 0; k < copies; k++) {
+                Dgram* d = &g_sent[sent++];
+                *d = dgrams[i];
+                d->at_ms = 1000 + f * PUSH_MS + i + (jitter_ms ? rnd() % jitter_ms : 0);
+            }
+        }
+        bool whole = true;
+        for (int c = 0, index = 0; c < chunks.count; c++) {
+            bool ok = true;
+            for (int i = 0; i < chunks.parts[c]; i++) ok &= survived[index + i];
+            index += chunks.parts[c];
+            expected += ok;
+            whole &= ok;
+            total_chunks++;
+        }
+        whole_frames += whole;
+    }
+    qsort(g_sent, sent, sizeof(Dgram), by_arrival);
+
+    hosts_init(&g_table);
+    reasm_init(&g_reasm);
+    int delivered = 0, corrupt = 0, applied = 0, partial_frames = 0;
+    static bool touched[FRAMES];
+    memset(touched, 0, sizeof(touched));
+    for (int i = 0; i < sent; i++) {
+        Dgram d = g_sent[i];
+        uint64_t now_ms = d.at_ms;
+        ReasmChunk chunk;
+        if (!reasm_push(&g_reasm, SRC_IP, SRC_PORT, d.data, d.len, now_ms, &chunk)) continue;
+        delivered++;
+        // 按块的第一个数据报序号找到发送时的块，逐字节比较
+        pack(g_frames[d.frame], d.frame, &chunks, dgrams);
+        int c = 0;
+        for (int idx = 0; c < chunks.count && idx < chunk.first; c++) idx += chunks.parts[c];
+        if (c >= chunks.count || strcmp(chunk.json, chunks.json[c]) != 0) corrupt++;
+        int h = hosts_lookup(&g_table, SRC_IP, SRC_PORT, hosts_relay_id(chunk.json), now_ms);
+        if (host_part(&g_table.hosts[h], chunk.json, now_ms, chunk.first, chunk.parts, chunk.count)) {
+            applied++;
+            touched[d.frame] = true;
+        }
+    }
+    for (int f = 0; f < FRAMES; f++) partial_frames += touched[f];
+
+    // 重复的块被剔除: 交出的块数可能因重复数据报重组两次，但应用的块不超过完整到达的块数
+    bool ok = corrupt == 0 && applied <= expected;
+    if (loss == 0.0f && jitter_ms == 0) ok &= delivered == total_chunks && applied == total_chunks;
+    printf("%-18s %6d %6.1f%% %7.1f%% %7.1f%% %9.1f%% %10.1f%% %6lu %4d  %s\n", name, sent,
+           lost * 100.0f / originals,
+           expected * 100.0f / total_chunks, applied * 100.0f / total_chunks, whole_frames * 100.0f / FRAMES,
+           partial_frames * 100.0f / FRAMES, (unsigned long)g_reasm.expired, corrupt, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 外部指标只在整帧收齐且都不带该字段时清空
+static bool check_gauges(void) {
+    static const char* with = "{\"seq\":1,\"sample_ms\":100,\"gauges\":[{\"id\":1,\"name\":\"q\",\"value\":5}]}";
+    static const char* a2 = "{\"seq\":2,\"sample_ms\":200,\"cpu_usage\":10}";
+    static const char* b2 = "{\"seq\":2,\"sample_ms\":200,\"memory_usage\":20}";
+    static const char* a3 = "{\"seq\":3,\"sample_ms\":300,\"cpu_usage\":11}";
+    hosts_init(&g_table);
+    Host* h = &g_table.hosts[hosts_lookup(&g_table, SRC_IP, SRC_PORT, -1, 0)];
+    bool ok = host_part(h, with, 100, 0, 1, 2) && h->state.gauge_count == 1;
+    // 帧 2 的第一个块: 另一个块还没到，保留
+    ok &= host_part(h, a2, 200, 0, 1, 2) && h->state.gauge_count == 1;
+    // 重复的块不再应用
+    ok &= !host_part(h, a2, 201, 0, 1, 2);
+    // 帧 2 收齐且都不带外部指标: 清空
+    ok &= host_part(h, b2, 202, 1, 1, 2) && h->state.gauge_count == 0;
+    // 帧 3 丢了一个块: 链路统计只按帧计数
+    ok &= host_part(h, a3, 300, 0, 1, 2) && h->link.received == 3 && h->link.lost == 0;
+    printf("gauges/dedup: %s\n", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(void) {
+    static Chunks chunks;
+    static Dgram dgrams[MAX_DGRAMS];
+    int max_dgrams = 0;
+    for (int f = 0; f < FRAMES; f++) {
+        make_frame(g_frames[f], f);
+        int n = pack(g_frames[f], f, &chunks, dgrams);
+        if (n > max_dgrams) max_dgrams = n;
+    }
+    pack(g_frames[0], 0, &chunks, dgrams);
+    printf("frame %d bytes -> %d datagrams of <= %d bytes, %d chunks; reassembler %zu bytes\n",
+           (int)strlen(g_frames[0]), max_dgrams, MTU, chunks.count, sizeof(Reassembler));
+    printf("%-18s %6s %7s %8s %8s %10s %11s %6s %4s\n", "link", "dgrams", "loss", "chunks", "applied",
+           "whole-frm", "any-field", "expire", "bad");
+
+    bool ok = true;
+    ok &= simulate("clean", 0.0f, 0.0f, 0);
+    ok &= simulate("loss 1%", 0.01f, 0.0f, 0);
+    ok &= simulate("loss 5%", 0.05f, 0.0f, 0);
+    ok &= simulate("loss 5% reorder", 0.05f, 0.0f, 8);
+    ok &= simulate("loss 5% late", 0.05f, 0.0f, 250);
+    ok &= simulate("loss 20% dup", 0.20f, 0.02f, 24);
+    ok &= simulate("dup 10% reorder", 0.0f, 0.10f, 8);
+    ok &= check_gauges();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/**
+ * 历史图表的顶点生成 (见 chart.h)
+ */
+
+#include "chart.h"
+
+static void put(ChartVertex* v, float x, float y, const ChartSeries* s, float a) {
+    v->x = x;
+    v->y = y;
+    v->z = 0.0f;
+    v->r = s->r;
+    v->g = s->g;
+    v->b = s->b;
+    v->a = a;
+}
+
+// 数值 -> 屏幕 y (超出范围时贴边)
+static float to_y(const ChartSeries* s, float v, float y, float h) {
+    float t = (v - s->lo) / (s->hi - s->lo);
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+    return y + h - t * h;
+}
+
+int chart_fill(ChartVertex* out, const ChartSeries* series, int count, int level,
+               float x, float y, float w, float h) {
+    if (count > CHART_MAX_SERIES) count = CHART_MAX_SERIES;
+    ChartVertex* v = out;
+    float step = w / (HISTORY_POINTS - 1);
+    for (int k = 0; k < count; k++) {
+        const ChartSeries* s = &series[k];
+        ChartVertex* start = v;
+        // 第二条曲线起先留出两个退化顶点的位置
+        if (k > 0) v += 2;
+        for (int i = 0; i < HISTORY_POINTS; i++) {
+            float px = x + i * step;
+            float lo, hi;
+            if (!history_point(s->history, level, i, &lo, &hi)) {
+                put(v++, px, y + h, s, 0.0f);
+                put(v++, px, y + h, s, 0.0f);
+                continue;
+            }
+            float top = to_y(s, hi, y, h);
+            float bottom = to_y(s, lo, y, h);
+            if (bottom - top < CHART_MIN_THICKNESS) {
+                float mid = (top + bottom) * 0.5f;
+                top = mid - CHART_MIN_THICKNESS * 0.5f;
+                bottom = mid + CHART_MIN_THICKNESS * 0.5f;
+            }
+            put(v++, px, top, s, s->a);
+            put(v++, px, bottom, s, s->a);
+        }
+        // 退化三角形: 重复上一条曲线的末顶点和这一条的首顶点
+        if (k > 0) {
+            start[0] = start[-1];
+            start[1] = start[2];
+        }
+    }
+    return v - out;
+}
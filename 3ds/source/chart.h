@@ -0,0 +1,40 @@
+/**
+ * 历史图表的顶点生成
+ *
+ * 把若干指标的多分辨率历史 (见 history.h) 写成一条三角形带: 每个桶两个顶点 (最大值、最小值)，
+ * 画出 min/max 包络；各指标之间用两个退化顶点连接，整张图一次 draw call 绘制。
+ * 顶点数只取决于指标数，与时间跨度和样本数无关。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef CHART_H
+#define CHART_H
+
+#include "history.h"
+
+// 与 3D 顶点相同的布局 (位置 xyz + 颜色 rgba)，共用顶点着色器与属性配置
+typedef struct {
+    float x, y, z;
+    float r, g, b, a;
+} ChartVertex;
+
+// 一条曲线: 历史、纵轴范围与颜色
+typedef struct {
+    const History* history;
+    float lo, hi;
+    float r, g, b, a;
+} ChartSeries;
+
+// 最多的曲线数
+#define CHART_MAX_SERIES 4
+// 顶点缓冲区容量 (每条曲线每桶 2 个顶点，曲线之间 2 个退化顶点)
+#define CHART_MAX_VERTICES (CHART_MAX_SERIES * (HISTORY_POINTS * 2 + 2))
+// 包络的最小厚度 (像素)，桶内只有一个值时仍画成一条线
+#define CHART_MIN_THICKNESS 1.5f
+
+// 把 count 条曲线在 level 时间跨度下的历史写入 out (屏幕坐标，y 向下)，返回顶点数。
+// 空桶的两个顶点落在底边且透明
+int chart_fill(ChartVertex* out, const ChartSeries* series, int count, int level,
+               float x, float y, float w, float h);
+
+#endif
@@ -0,0 +1,52 @@
+/**
+ * 服务端发现调度 (见 discovery.h)
+ */
+
+#include "discovery.h"
+
+// xorshift32: 抖动只需要分散多台 3DS 的探测时间，不需要高质量随机数
+static uint32_t next_random(Discovery* d) {
+    uint32_t x = d->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    d->rng = x;
+    return x;
+}
+
+void discovery_init(Discovery* d, uint64_t now_ms, uint32_t seed) {
+    d->rng = seed ? seed : 0x9E3779B9u;
+    d->ttfd_ms = -1;
+    discovery_restart(d, now_ms);
+}
+
+void discovery_restart(Discovery* d, uint64_t now_ms) {
+    d->searching = true;
+    d->next_probe_ms = now_ms;
+    d->backoff_ms = DISCOVERY_BACKOFF_MIN_MS;
+    d->search_start_ms = now_ms;
+}
+
+bool discovery_probe_due(Discovery* d, uint64_t now_ms) {
+    if (now_ms < d->next_probe_ms) return false;
+
+    uint32_t delay;
+    if (d->searching) {
+        // 等量抖动: 取 [backoff/2, backoff)，然后退避翻倍
+        uint32_t half = d->backoff_ms / 2;
+        delay = half + next_random(d) % (half ? half : 1);
+        d->backoff_ms *= 2;
+        if (d->backoff_ms > DISCOVERY_BACKOFF_MAX_MS) d->backoff_ms = DISCOVERY_BACKOFF_MAX_MS;
+    } else {
+        delay = DISCOVERY_IDLE_INTERVAL_MS;
+    }
+    d->next_probe_ms = now_ms + delay;
+    return true;
+}
+
+void discovery_data(Discovery* d, uint64_t now_ms) {
+    if (!d->searching) return;
+    d->searching = false;
+    d->ttfd_ms = (int32_t)(now_ms - d->search_start_ms);
+    d->next_probe_ms = now_ms + DISCOVERY_IDLE_INTERVAL_MS;
+}
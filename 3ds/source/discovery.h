@@ -0,0 +1,47 @@
+/**
+ * 服务端发现调度
+ *
+ * 没有可用服务端时立即开始探测 (广播 DISCOVER，并单播给缓存的上次服务端和已知主机)，
+ * 之后按指数退避加随机抖动重试，退避上限保证服务端恢复后 1 秒内重新连上；
+ * 找到服务端后只低频广播，用于发现之后启动的服务端。
+ * 同时记录从开始搜索到收到第一帧数据的时间 (time-to-first-data)。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef DISCOVERY_H
+#define DISCOVERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 搜索时的探测退避 (毫秒): 首次立即探测，之后 100 → 200 → 400 → 800
+#define DISCOVERY_BACKOFF_MIN_MS 100
+#define DISCOVERY_BACKOFF_MAX_MS 800
+// 已连接时继续广播 DISCOVER 的间隔 (毫秒)
+#define DISCOVERY_IDLE_INTERVAL_MS 10000
+// 超过该时间没有收到服务端的任何消息视为离线 (毫秒)
+#define DISCOVERY_LIVENESS_MS 3000
+
+typedef struct {
+    bool searching;
+    uint64_t next_probe_ms;
+    uint32_t backoff_ms;
+    uint32_t rng;
+
+    // time-to-first-data: 最近一次搜索从开始到收到第一帧的时间，-1 表示尚未完成
+    uint64_t search_start_ms;
+    int32_t ttfd_ms;
+} Discovery;
+
+void discovery_init(Discovery* d, uint64_t now_ms, uint32_t seed);
+
+// 开始 (重新) 搜索: 立即探测，退避从最小值开始
+void discovery_restart(Discovery* d, uint64_t now_ms);
+
+// 是否应当现在发送一轮探测 (返回 true 时已排好下一次)
+bool discovery_probe_due(Discovery* d, uint64_t now_ms);
+
+// 收到数据帧；搜索中的第一帧结束搜索并记录 time-to-first-data
+void discovery_data(Discovery* d, uint64_t now_ms);
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ * 多分辨率指标历史 (见 history.h)
+ */
+
+#include "history.h"
+#include <math.h>
+
+const uint32_t HISTORY_BUCKET_MS[HISTORY_LEVELS] = {
+    10 * 1000 / HISTORY_POINTS,
+    5 * 60 * 1000 / HISTORY_POINTS,
+    60 * 60 * 1000 / HISTORY_POINTS,
+};
+
+static void ring_clear(HistoryRing* r, int i) {
+    r->min[i] = INFINITY;
+    r->max[i] = -INFINITY;
+}
+
+void history_reset(History* h) {
+    h->started = false;
+    for (int l = 0; l < HISTORY_LEVELS; l++) {
+        HistoryRing* r = &h->level[l];
+        for (int i = 0; i < HISTORY_POINTS; i++) ring_clear(r, i);
+        r->bucket = 0;
+        r->head = 0;
+    }
+}
+
+void history_push(History* h, uint64_t t_ms, float value) {
+    for (int l = 0; l < HISTORY_LEVELS; l++) {
+        HistoryRing* r = &h->level[l];
+        uint64_t bucket = t_ms / HISTORY_BUCKET_MS[l];
+        if (!h->started) {
+            r->bucket = bucket;
+        } else if (bucket > r->bucket) {
+            // 推进到新桶，跳过的桶 (没有收到样本) 留空
+            uint64_t steps = bucket - r->bucket;
+            if (steps > HISTORY_POINTS) steps = HISTORY_POINTS;
+            for (uint64_t k = 0; k < steps; k++) {
+                r->head = (r->head + 1) % HISTORY_POINTS;
+                ring_clear(r, r->head);
+            }
+            r->bucket = bucket;
+        }
+        // 时间回退时并入当前桶
+        if (value < r->min[r->head]) r->min[r->head] = value;
+        if (value > r->max[r->head]) r->max[r->head] = value;
+    }
+    h->started = true;
+}
+
+bool history_point(const History* h, int level, int i, float* lo, float* hi) {
+    const HistoryRing* r = &h->level[level];
+    int idx = (r->head + 1 + i) % HISTORY_POINTS;
+    *lo = r->min[idx];
+    *hi = r->max[idx];
+    return *lo <= *hi;
+}
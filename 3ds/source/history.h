@@ -0,0 +1,46 @@
+/**
+ * 多分辨率指标历史
+ *
+ * 每个指标按三种时间跨度 (最近 10 秒 / 5 分钟 / 1 小时) 各保留一个定长环形缓冲区，
+ * 每个桶记录该时间段内样本的最小值和最大值。每收到一个样本推进一次 (与帧率无关)，
+ * 桶按本地接收时间划分，推送频率变化时各桶覆盖的时间不变。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 每种时间跨度的桶数 (即图表的横向点数)
+#define HISTORY_POINTS 100
+
+// 时间跨度
+enum { HISTORY_10S, HISTORY_5MIN, HISTORY_1H, HISTORY_LEVELS };
+
+// 各时间跨度的桶宽 (毫秒)
+extern const uint32_t HISTORY_BUCKET_MS[HISTORY_LEVELS];
+
+typedef struct {
+    // 空桶的 min > max
+    float min[HISTORY_POINTS];
+    float max[HISTORY_POINTS];
+    uint64_t bucket;     // 当前桶的序号 (接收时间 / 桶宽)
+    int head;            // 当前桶在环中的位置
+} HistoryRing;
+
+typedef struct {
+    bool started;
+    HistoryRing level[HISTORY_LEVELS];
+} History;
+
+void history_reset(History* h);
+
+// 记录一个样本 (t_ms 为本地接收时间，应单调不减)
+void history_push(History* h, uint64_t t_ms, float value);
+
+// 第 i 个桶 (0 为最旧，HISTORY_POINTS - 1 为当前桶)；空桶返回 false
+bool history_point(const History* h, int level, int i, float* lo, float* hi);
+
+#endif
@@ -0,0 +1,424 @@
+/**
+ * 多服务端状态 (见 hosts.h)
+ */
+
+#include "hosts.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void app_state_defaults(AppState* s) {
+    memset(s, 0, sizeof(*s));
+    s->cpu_usage = 25.0f;
+    s->memory_usage = 45.0f;
+    s->swap_usage = 10.0f;
+    s->cpu_temp = 42.0f;
+    s->gpu_temp = 48.0f;
+    s->power_watts = 15.0f;
+    s->cpu_freq_mhz = 2400;
+    strcpy(s->hostname, "CONNECTING...");
+    strcpy(s->os_name, "UNKNOWN");
+    strcpy(s->cpu_model, "GENERIC CPU");
+    s->cpu_cores = 8;
+    s->battery_level = -1;
+    strcpy(s->battery_status, "UNKNOWN");
+    s->memory_total_mb = 16384;
+    s->memory_used_mb = 8192;
+    s->fan_rpm = 1200;
+    s->connected = false;
+    s->uptime_seconds = 0;
+    s->current_mode = 3;
+}
+
+void hosts_init(HostTable* t) {
+    t->count = 0;
+}
+
+int hosts_lookup(HostTable* t, uint32_t ip, uint16_t port, int relay_id, uint64_t now_ms) {
+    for (int i = 0; i < t->count; i++) {
+        const Host* h = &t->hosts[i];
+        if (h->ip == ip && h->port == port && h->relay_id == relay_id) return i;
+    }
+    if (t->count >= MAX_HOSTS) return -1;
+
+    Host* h = &t->hosts[t->count];
+    memset(h, 0, sizeof(*h));
+    h->ip = ip;
+    h->port = port;
+    h->relay_id = relay_id;
+    app_state_defaults(&h->state);
+    h->state.connected = true;
+    h->state.hostname[0] = '\0';   // 等待服务端发送主机名
+    h->uptime_at_ms = now_ms;
+    linkstats_reset(&h->link, now_ms);
+    interp_clock_reset(&h->clock);
+    for (int i = 0; i < HIST_COUNT; i++) history_reset(&h->history[i]);
+    return t->count++;
+}
+
+int hosts_relay_id(const char* json) {
+    // 只接受数字值: 嵌套对象里同名的键 (如旧服务端的 "cgroups":{"host":{...}}) 按键名排序可能排在前面
+    for (const char* p = strstr(json, "\"host\":"); p; p = strstr(p + 7, "\"host\":")) {
+        if (p[7] >= '0' && p[7] <= '9') return atoi(p + 7);
+    }
+    return -1;
+}
+
+static void parse_json_string(const char* json, const char* key, char* dest, size_t dest_size) {
+    char search_key[64];
+    snprintf(search_key, sizeof(search_key), "\"%s\":\"", key);
+    const char* p = strstr(json, search_key);
+    if (p) {
+        p += strlen(search_key);
+        size_t i = 0;
+        while (*p && *p != '"' && i < dest_size - 1) {
+            dest[i++] = *p++;
+        }
+        dest[i] = '\0';
+    }
+}
+
+// 解析紧凑十六进制数组 ("key":"1f3c...")，每 2 个字符 1 字节，返回字节数
+static int parse_json_hex(const char* json, const char* key, uint8_t* dest, int max_count) {
+    char search_key[64];
+    snprintf(search_key, sizeof(search_key), "\"%s\":\"", key);
+    const char* p = strstr(json, search_key);
+    if (!p) return -1;
+    p += strlen(search_key);
+
+    int count = 0;
+    while (count < max_count && p[0] && p[0] != '"' && p[1] && p[1] != '"') {
+        int hi = (p[0] <= '9') ? p[0] - '0' : (p[0] | 0x20) - 'a' + 10;
+        int lo = (p[1] <= '9') ? p[1] - '0' : (p[1] | 0x20) - 'a' + 10;
+        dest[count++] = (uint8_t)((hi << 4) | lo);
+        p += 2;
+    }
+    return count;
+}
+
+const char* host_proc_name(const Host* h, int pid) {
+    for (int i = 0; i < PROC_NAME_CACHE; i++) {
+        if (h->proc_names[i].pid == pid && h->proc_names[i].name[0]) return h->proc_names[i].name;
+    }
+    return NULL;
+}
+
+static void proc_name_store(Host* h, int pid, const char* name, int len) {
+    ProcName* slot = NULL;
+    for (int i = 0; i < PROC_NAME_CACHE && !slot; i++) {
+        if (h->proc_names[i].pid == pid) slot = &h->proc_names[i];
+    }
+    if (!slot) {
+        // 环形覆盖最旧的条目
+        slot = &h->proc_names[h->proc_name_next];
+        h->proc_name_next = (h->proc_name_next + 1) % PROC_NAME_CACHE;
+    }
+    if (len > (int)sizeof(slot->name) - 1) len = sizeof(slot->name) - 1;
+    slot->pid = pid;
+    memcpy(slot->name, name, len);
+    h->proc_name_version++;
+    slot->name[len] = '\0';
+}
+
+// 解析进程榜单: "processes":{"cpu":[[pid,cpu10,rss],...],"rss":[...],"names":[[pid,"name"],...]}
+static void parse_processes(Host* h, const char* json) {
+    const char* obj = strstr(json, "\"processes\":{");
+    if (!obj) return;
+    AppState* s = &h->state;
+
+    const char* p = strstr(obj, "\"cpu\":[");
+    if (p) {
+        p += 7;
+        int count = 0;
+        while (count < PROC_TOP && *p == '[') {
+            char* end;
+            s->proc_pid[count] = strtol(p + 1, &end, 10);
+            s->proc_cpu10[count] = strtol(end + 1, &end, 10);
+            s->proc_rss_mb[count] = strtol(end + 1, &end, 10);
+            count++;
+            p = end + 1;           // 跳过 ']'
+            if (*p == ',') p++;
+        }
+        s->proc_count = count;
+    }
+
+    p = strstr(obj, "\"names\":[");
+    if (p) {
+        p += 9;
+        while (*p == '[') {
+            char* end;
+            int pid = strtol(p + 1, &end, 10);
+            if (end[0] != ',' || end[1] != '"') break;
+            const char* name = end + 2;
+            const char* q = strchr(name, '"');
+            if (!q) break;
+            proc_name_store(h, pid, name, q - name);
+            p = q + 2;             // 跳过 '"]'
+            if (*p == ',') p++;
+        }
+    }
+}
+
+// 解析外部指标: "gauges":[{"id":N,"name":"...","value":V},...]
+// 服务端没有存活的外部指标时不携带该字段，此时清空 (clear 为 false 时保留)
+static bool parse_gauges(AppState* s, const char* json, bool clear) {
+    const char* p = strstr(json, "\"gauges\":[");
+    bool present = p != NULL;
+    if (!present && !clear) return false;
+    int count = 0;
+    while (p && count < GAUGE_MAX) {
+        const char* name = strstr(p, "\"name\":\"");
+        if (!name) break;
+        name += 8;
+        const char* q = strchr(name, '"');
+        const char* value = q ? strstr(q, "\"value\":") : NULL;
+        if (!value) break;
+        int len = q - name;
+        if (len > (int)sizeof(s->gauge_name[0]) - 1) len = sizeof(s->gauge_name[0]) - 1;
+        memcpy(s->gauge_name[count], name, len);
+        s->gauge_name[count][len] = '\0';
+        s->gauge_value[count] = strtof(value + 8, NULL);
+        count++;
+        p = strchr(value, '}');
+    }
+    s->gauge_count = count;
+    return present;
+}
+
+static void alert_remove(AppState* s, int i) {
+    s->alert_count--;
+    for (; i < s->alert_count; i++) {
+        memcpy(s->alert_name[i], s->alert_name[i + 1], sizeof(s->alert_name[0]));
+        s->alert_value[i] = s->alert_value[i + 1];
+        s->alert_at_ms[i] = s->alert_at_ms[i + 1];
+    }
+}
+
+// 解析告警事件: "alerts":[{"rule":"...","on":true,"value":V},...]
+// 只有状态变化 (和定期重发) 时才携带该字段；"on":true 添加或刷新，false 移除。
+// 表满时丢弃新告警 (先触发的保留)
+static void parse_alerts(AppState* s, const char* json, uint64_t now_ms) {
+    const char* p = strstr(json, "\"alerts\":[");
+    while (p) {
+        const char* name = strstr(p, "\"rule\":\"");
+        if (!name) break;
+        name += 8;
+        const char* q = strchr(name, '"');
+        const char* on = q ? strstr(q, "\"on\":") : NULL;
+        const char* value = on ? strstr(on, "\"value\":") : NULL;
+        if (!value) break;
+        char rule[sizeof(s->alert_name[0])];
+        int len = q - name;
+        if (len > (int)sizeof(rule) - 1) len = sizeof(rule) - 1;
+        memcpy(rule, name, len);
+        rule[len] = '\0';
+
+        int i = 0;
+        while (i < s->alert_count && strcmp(s->alert_name[i], rule) != 0) i++;
+        if (strncmp(on + 5, "true", 4) == 0) {
+            if (i == s->alert_count && s->alert_count < ALERT_MAX) {
+                memcpy(s->alert_name[i], rule, sizeof(rule));
+                s->alert_count++;
+            }
+            if (i < s->alert_count) {
+                s->alert_value[i] = strtof(value + 8, NULL);
+                s->alert_at_ms[i] = now_ms;
+            }
+        } else if (i < s->alert_count) {
+            alert_remove(s, i);
+        }
+        p = strchr(value, '}');
+    }
+}
+
+// 静态信息 (直连服务端每帧携带，中继单独发送)
+static void parse_static(AppState* s, const char* json) {
+    const char* p;
+    parse_json_string(json, "hostname", s->hostname, sizeof(s->hostname));
+    parse_json_string(json, "os_name", s->os_name, sizeof(s->os_name));
+    parse_json_string(json, "cpu_model", s->cpu_model, sizeof(s->cpu_model));
+    if ((p = strstr(json, "\"cpu_cores\":"))) {
+        s->cpu_cores = atoi(p + 12);
+    }
+}
+
+// 分片帧的块: 同一帧的第一个块计入链路统计，之后的块按数据报位图去重
+static bool part_begin(Host* h, uint32_t seq, int first, int parts) {
+    if (seq != h->part_seq || h->part_received == 0) {
+        h->part_seq = seq;
+        memset(h->part_have, 0, sizeof(h->part_have));
+        h->part_received = 0;
+        h->part_gauges = false;
+    }
+    for (int i = first; i < first + parts; i++) {
+        if (h->part_have[i >> 3] & (1 << (i & 7))) return false;
+    }
+    for (int i = first; i < first + parts; i++) h->part_have[i >> 3] |= 1 << (i & 7);
+    h->part_received += parts;
+    return true;
+}
+
+// parts 为 0 表示完整的帧，否则是分片帧中占 parts 个数据报的块
+static bool decode(Host* h, const char* json, uint64_t now_ms, int first, int parts, int count) {
+    AppState* s = &h->state;
+    const char* p;
+    h->last_rx_ms = now_ms;
+    s->connected = true;
+
+    // 中继的静态信息消息: {"host":N,"static":{...}}
+    if ((p = strstr(json, "\"static\":{"))) {
+        parse_static(s, p);
+        return true;
+    }
+
+    // 插值使用的采样时间: 优先取服务端采样时间，旧版服务端退回到本地接收时间
+    uint64_t frame_ms = now_ms;
+    bool part_tracked = false, same_frame = false;
+    if ((p = strstr(json, "\"seq\":"))) {
+        uint32_t seq = strtoul(p + 6, NULL, 10);
+        uint64_t sample_ms = 0;
+        if ((p = strstr(json, "\"sample_ms\":"))) {
+            sample_ms = strtoull(p + 12, NULL, 10);
+        }
+        // 迟到的旧帧只计入统计，不覆盖已显示的较新数据
+        same_frame = parts && h->part_received > 0 && seq == h->part_seq;
+        if (!same_frame && !linkstats_frame(&h->link, seq, sample_ms, now_ms)) return false;
+        if (parts && !part_begin(h, seq, first, parts)) return false;
+        part_tracked = parts > 0;
+        frame_ms = sample_ms;
+    }
+    // 同一帧的后续块不再推进播放时钟 (接收时间以第一个块为准)
+    if (!same_frame) interp_clock_update(&h->clock, frame_ms, now_ms);
+
+    // 历史按本地接收时间分桶 (服务端重启后采样时间回退也不受影响)
+    bool recorded = false;
+    if ((p = strstr(json, "\"cpu_usage\":"))) {
+        float v = strtof(p + 12, NULL);
+        interp_push(&h->interp[CH_CPU], frame_ms, v);
+        history_push(&h->history[HIST_CPU], now_ms, v);
+        recorded = true;
+    }
+    if ((p = strstr(json, "\"cpu_temp\":"))) {
+        float v = strtof(p + 11, NULL);
+        interp_push(&h->interp[CH_CPU_TEMP], frame_ms, v);
+        // null (没有温度传感器) 不计入历史
+        if (p[11] != 'n') history_push(&h->history[HIST_CPU_TEMP], now_ms, v);
+        recorded = true;
+    }
+    if ((p = strstr(json, "\"gpu_temp\":"))) {
+        interp_push(&h->interp[CH_GPU_TEMP], frame_ms, strtof(p + 11, NULL));
+    }
+    if ((p = strstr(json, "\"memory_usage\":"))) {
+        interp_push(&h->interp[CH_MEM], frame_ms, strtof(p + 15, NULL));
+    }
+    if ((p = strstr(json, "\"memory_total\":"))) {
+        s->memory_total_mb = atoi(p + 15);
+    }
+    if ((p = strstr(json, "\"memory_used\":"))) {
+        s->memory_used_mb = atoi(p + 14);
+    }
+    if ((p = strstr(json, "\"swap_usage\":"))) {
+        interp_push(&h->interp[CH_SWAP], frame_ms, strtof(p + 13, NULL));
+    }
+    if ((p = strstr(json, "\"power_score\":"))) {
+        float v = strtof(p + 14, NULL) / 100000.0f;
+        interp_push(&h->interp[CH_POWER], frame_ms, v);
+        if (p[14] != 'n') history_push(&h->history[HIST_POWER], now_ms, v);
+        recorded = true;
+    }
+    if (recorded) h->history_version++;
+    if ((p = strstr(json, "\"fan_speeds\":["))) {
+        interp_push(&h->interp[CH_FAN], frame_ms, atoi(p + 14));
+    }
+    if ((p = strstr(json, "\"cpu_frequency_mhz\":"))) {
+        s->cpu_freq_mhz = atoi(p + 20);
+    }
+
+    parse_static(s, json);
+    parse_json_string(json, "battery_status", s->battery_status, sizeof(s->battery_status));
+    if ((p = strstr(json, "\"battery_percentage\":"))) {
+        s->battery_level = atoi(p + 21);
+    }
+    if ((p = strstr(json, "\"uptime_secs\":"))) {
+        h->uptime_base = atoi(p + 14);
+        h->uptime_at_ms = now_ms;
+    }
+
+    uint8_t core_usage[MAX_CORES];
+    int cores = parse_json_hex(json, "core_usage", core_usage, MAX_CORES);
+    if (cores >= 0) {
+        if (cores != s->core_count) {
+            // 核心数变化 (服务端重启或换了机器)，旧样本不再对应
+            for (int i = 0; i < MAX_CORES; i++) interp_reset(&h->interp_cores[i]);
+        }
+        for (int i = 0; i < cores; i++) {
+            interp_push(&h->interp_cores[i], frame_ms, core_usage[i]);
+        }
+        s->core_count = cores;
+    }
+
+    parse_processes(h, json);
+    if (parse_gauges(s, json, !parts)) h->part_gauges = true;
+    // 整帧收齐且没有块带外部指标: 与完整帧不带该字段相同，清空
+    if (part_tracked && h->part_received >= count && !h->part_gauges) s->gauge_count = 0;
+    parse_alerts(s, json, now_ms);
+    return true;
+}
+
+bool host_frame(Host* h, const char* json, uint64_t now_ms) {
+    return decode(h, json, now_ms, 0, 0, 0);
+}
+
+bool host_part(Host* h, const char* json, uint64_t now_ms, int first, int parts, int count) {
+    return decode(h, json, now_ms, first, parts, count);
+}
+
+// 写回一个显示值，返回变化量 (按 px_per_unit 换算为屏幕像素)
+// 通道还没有样本时保留当前值
+static float apply_field(float* field, const InterpChannel* c, uint64_t t, float lo, float hi, float px_per_unit) {
+    if (!c->valid) return 0.0f;
+    float v = interp_sample(c, t, INTERP_MAX_EXTRAP);
+    v = v < lo ? lo : (v > hi ? hi : v);
+    float moved = fabsf(v - *field) * px_per_unit;
+    *field = v;
+    return moved;
+}
+
+float host_apply(Host* h, uint64_t now_ms, bool full) {
+    AppState* s = &h->state;
+    // 更新时间 (按本地时钟推算，不受帧率影响)
+    s->uptime_seconds = h->uptime_base + (int)((now_ms - h->uptime_at_ms) / 1000);
+    // 清除过期的告警 (解除事件丢失，或服务端已断开)
+    for (int i = s->alert_count - 1; i >= 0; i--) {
+        if (now_ms - s->alert_at_ms[i] >= ALERT_EXPIRE_MS) alert_remove(s, i);
+    }
+    if (!h->clock.valid) return 0.0f;
+    uint64_t t = interp_clock_time(&h->clock, now_ms);
+
+    // 柱高 140px 对应 100%，功率图 55px 对应 50W，温度按整数显示
+    float motion = 0.0f;
+    motion = fmaxf(motion, apply_field(&s->cpu_usage, &h->interp[CH_CPU], t, 0.0f, 100.0f, 1.4f));
+    motion = fmaxf(motion, apply_field(&s->memory_usage, &h->interp[CH_MEM], t, 0.0f, 100.0f, 1.4f));
+    motion = fmaxf(motion, apply_field(&s->cpu_temp, &h->interp[CH_CPU_TEMP], t, 0.0f, 150.0f, 1.0f));
+    motion = fmaxf(motion, apply_field(&s->power_watts, &h->interp[CH_POWER], t, 0.0f, 1000.0f, 1.1f));
+    if (!full) return motion;
+
+    motion = fmaxf(motion, apply_field(&s->swap_usage, &h->interp[CH_SWAP], t, 0.0f, 100.0f, 1.4f));
+    motion = fmaxf(motion, apply_field(&s->gpu_temp, &h->interp[CH_GPU_TEMP], t, 0.0f, 150.0f, 1.0f));
+
+    float rpm = s->fan_rpm;
+    motion = fmaxf(motion, apply_field(&rpm, &h->interp[CH_FAN], t, 0.0f, 20000.0f, 0.01f));
+    s->fan_rpm = (int)(rpm + 0.5f);
+
+    for (int i = 0; i < s->core_count; i++) {
+        float usage = s->core_usage[i];
+        motion = fmaxf(motion, apply_field(&usage, &h->interp_cores[i], t, 0.0f, 100.0f, 1.0f));
+        s->core_usage[i] = (uint8_t)(usage + 0.5f);
+    }
+    return motion;
+}
+
+bool host_stale(const Host* h, uint64_t now_ms) {
+    return now_ms - h->last_rx_ms >= HOST_STALE_MS;
+}
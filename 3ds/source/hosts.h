@@ -0,0 +1,161 @@
+/**
+ * 多服务端状态
+ *
+ * 每个发现的服务端 (中继模式下每台上游主机) 占一个槽位，各自保存显示状态、插值通道、
+ * 链路统计、进程名缓存和功率历史。收包时按来源地址和中继主机 ID 找到槽位再解码；
+ * 渲染时只对当前显示的主机做完整插值，其余主机只更新总览页用到的几个指标。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef HOSTS_H
+#define HOSTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "history.h"
+#include "interp.h"
+#include "linkstats.h"
+
+// 最多同时跟踪的主机数
+#define MAX_HOSTS 16
+// 超过该时间没有收到数据的主机在总览页显示为离线 (毫秒)
+#define HOST_STALE_MS 3000
+// 样本迟到时最多外推的样本间隔比例，之后保持不变
+#define INTERP_MAX_EXTRAP 0.5f
+
+#define MAX_CORES 128
+// 下屏进程榜单 (server 以 --processes 启动时才有数据)
+#define PROC_TOP 5
+#define PROC_NAME_CACHE 32
+// 下屏外部指标 (server 以 --shm 启动且有生产者发布时才有数据)，显示在进程榜单的空行
+#define GAUGE_MAX 4
+// 同时记录的告警数 (server 的告警引擎只发送状态变化，告警中的规则每 5 秒重发一次)
+#define ALERT_MAX 4
+// 超过该时间没有收到重发的告警视为已解除 (容忍丢失一次重发)
+#define ALERT_EXPIRE_MS 12000
+
+typedef struct {
+    float cpu_usage;
+    float memory_usage;
+    float swap_usage;     // 从 server 获取
+    float cpu_temp;
+    float gpu_temp;       // 从 server 获取
+    float power_watts;
+    int cpu_freq_mhz;     // 新增: CPU 频率
+    int fan_rpm;
+    bool connected;
+    int uptime_seconds;
+    int current_mode;
+
+    // 新增字段
+    char hostname[64];
+    char os_name[64];
+    char cpu_model[64];
+    int cpu_cores;
+    int battery_level;
+    char battery_status[32];
+
+    // 新增: 内存绝对值 (MB)
+    int memory_total_mb;
+    int memory_used_mb;
+
+    // 每核心使用率 (%)，由 server 的紧凑十六进制编码解出
+    uint8_t core_usage[MAX_CORES];
+    int core_count;
+
+    // CPU 占用最高的进程: PID / CPU (0.1%) / RSS (MB)
+    int proc_pid[PROC_TOP];
+    int proc_cpu10[PROC_TOP];
+    int proc_rss_mb[PROC_TOP];
+    int proc_count;
+
+    // 外部生产者经共享内存发布的指标
+    char gauge_name[GAUGE_MAX][20];
+    float gauge_value[GAUGE_MAX];
+    int gauge_count;
+
+    // 告警中的规则: 名称 / 触发时的信号值 / 最近一次收到的本地时间
+    char alert_name[ALERT_MAX][20];
+    float alert_value[ALERT_MAX];
+    uint64_t alert_at_ms[ALERT_MAX];
+    int alert_count;
+} AppState;
+
+// 插值通道: 收包时写入带采样时间的样本，每帧按播放时间求值后写回 AppState
+enum { CH_CPU, CH_MEM, CH_SWAP, CH_CPU_TEMP, CH_GPU_TEMP, CH_POWER, CH_FAN, CH_COUNT };
+
+// 下屏历史图表的指标
+enum { HIST_POWER, HIST_CPU_TEMP, HIST_CPU, HIST_COUNT };
+
+// PID -> 进程名缓存 (server 只在 PID 首次进入榜单时发送名称)
+typedef struct {
+    int pid;
+    char name[20];
+} ProcName;
+
+typedef struct {
+    // 槽位键: 服务端地址 (网络字节序) 与中继主机 ID (直连服务端为 -1)
+    uint32_t ip;
+    uint16_t port;
+    int relay_id;
+
+    AppState state;
+    uint64_t last_rx_ms;
+
+    LinkStats link;
+    InterpChannel interp[CH_COUNT];
+    InterpChannel interp_cores[MAX_CORES];
+    InterpClock clock;
+
+    // 服务端运行时间: 最近一次收到的值及其本地接收时间，两次更新之间按本地时钟推算
+    int uptime_base;
+    uint64_t uptime_at_ms;
+
+    ProcName proc_names[PROC_NAME_CACHE];
+    int proc_name_next;
+    uint32_t proc_name_version;  // 名称缓存每次写入加一 (下屏据此判断是否重绘)
+
+    // 功率/温度/CPU 的多分辨率历史 (收到样本时推进)
+    History history[HIST_COUNT];
+    uint32_t history_version;    // 每次记录样本加一 (下屏据此判断是否重绘)
+
+    // 分片帧: 当前帧的序号、已应用的数据报 (按 index 的位图) 与其中是否带外部指标
+    uint32_t part_seq;
+    uint8_t part_have[32];
+    int part_received;
+    bool part_gauges;
+} Host;
+
+typedef struct {
+    Host hosts[MAX_HOSTS];
+    int count;
+} HostTable;
+
+// 尚未收到任何数据时显示的默认状态
+void app_state_defaults(AppState* s);
+
+void hosts_init(HostTable* t);
+
+// 按键查找槽位，没有则新建；表满时返回 -1
+int hosts_lookup(HostTable* t, uint32_t ip, uint16_t port, int relay_id, uint64_t now_ms);
+
+// 中继消息的主机 ID ("host":N)，直连服务端的消息返回 -1
+int hosts_relay_id(const char* json);
+
+// 解码一条数据消息 (数据帧或中继的静态信息)；迟到的旧帧只计入链路统计，返回 false
+bool host_frame(Host* h, const char* json, uint64_t now_ms);
+
+// 解码分片帧中的一个块 (见 reassembly.h): 同一帧的各个块分别应用，重复的块返回 false。
+// 块只更新自己携带的字段；外部指标 (gauges) 的缺席要等整帧收齐才能确认，此时才清空
+bool host_part(Host* h, const char* json, uint64_t now_ms, int first, int parts, int count);
+
+// 按当前播放时间把插值结果写回 AppState (每帧调用一次)；
+// full 为 false 时只更新总览页用到的指标 (CPU/内存/温度/功率)
+// 返回本帧显示值的最大变化量 (像素)，供帧率调度判断画面是否在动
+float host_apply(Host* h, uint64_t now_ms, bool full);
+
+bool host_stale(const Host* h, uint64_t now_ms);
+
+const char* host_proc_name(const Host* h, int pid);
+
+#endif
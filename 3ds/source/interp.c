@@ -0,0 +1,89 @@
+/**
+ * 客户端插值 (见 interp.h)
+ */
+
+#include "interp.h"
+
+// 推送周期估计的平滑系数
+#define PERIOD_ALPHA 0.25f
+
+void interp_reset(InterpChannel* c) {
+    c->valid = false;
+}
+
+void interp_push(InterpChannel* c, uint64_t t, float v) {
+    if (!c->valid || t < c->t1) {
+        // 首个样本或时钟回退: 两个样本都取当前值
+        c->v0 = c->v1 = v;
+        c->t0 = c->t1 = t;
+        c->valid = true;
+        return;
+    }
+    if (t == c->t1) {
+        // 同一采样时刻的重复样本只更新值
+        c->v1 = v;
+        return;
+    }
+    c->v0 = c->v1;
+    c->t0 = c->t1;
+    c->v1 = v;
+    c->t1 = t;
+}
+
+float interp_sample(const InterpChannel* c, uint64_t t, float max_extrap) {
+    if (!c->valid) return 0.0f;
+    if (c->t1 == c->t0) return c->v1;
+    if (t <= c->t0) return c->v0;
+
+    float alpha = (float)((double)(t - c->t0) / (double)(c->t1 - c->t0));
+    if (alpha > 1.0f + max_extrap) alpha = 1.0f + max_extrap;
+    return c->v0 + (c->v1 - c->v0) * alpha;
+}
+
+void interp_clock_reset(InterpClock* clk) {
+    clk->valid = false;
+    clk->period_ms = 0.0f;
+    clk->played_valid = false;
+}
+
+void interp_clock_update(InterpClock* clk, uint64_t sample_ms, uint64_t now_ms) {
+    if (clk->valid && sample_ms > clk->sample_ms) {
+        float period = (float)(sample_ms - clk->sample_ms);
+        if (period < INTERP_MIN_PERIOD_MS) period = INTERP_MIN_PERIOD_MS;
+        if (period > INTERP_MAX_PERIOD_MS) period = INTERP_MAX_PERIOD_MS;
+        // 第二帧直接取间隔，之后平滑
+        if (clk->period_ms > 0.0f) {
+            clk->period_ms += (period - clk->period_ms) * PERIOD_ALPHA;
+        } else {
+            clk->period_ms = period;
+        }
+    } else if (!clk->valid || sample_ms < clk->sample_ms) {
+        // 首帧或服务端重启: 周期未知，先不加播放延迟；播放时间跟随新时钟
+        clk->period_ms = 0.0f;
+        clk->played_valid = false;
+    }
+    clk->sample_ms = sample_ms;
+    clk->rx_ms = now_ms;
+    clk->valid = true;
+}
+
+uint64_t interp_clock_time(InterpClock* clk, uint64_t now_ms) {
+    if (!clk->valid) return 0;
+    // 目标: 最新样本 + 接收后经过的本地时间 - 一个推送周期的播放延迟
+    uint64_t t = clk->sample_ms + (now_ms - clk->rx_ms);
+    uint64_t delay = (uint64_t)clk->period_ms;
+    uint64_t target = t > delay ? t - delay : 0;
+
+    if (clk->played_valid && target < clk->played_ms) {
+        // 领先于目标 (新样本提前到达、启动时周期估计从 0 变为一个周期): 放慢而不是回退
+        uint64_t elapsed = now_ms > clk->played_at ? now_ms - clk->played_at : 0;
+        uint64_t advance = (uint64_t)(elapsed * INTERP_CATCH_UP_RATE);
+        // 不足 1ms 时不更新 played_at，经过的本地时间留到下次累计
+        if (advance == 0) return clk->played_ms;
+        target = clk->played_ms + advance;
+    }
+    clk->played_valid = true;
+    clk->played_ms = target;
+    clk->played_at = now_ms;
+    return target;
+}
@@ -0,0 +1,58 @@
+/**
+ * 客户端插值
+ *
+ * 每个指标保留最近两个带采样时间的样本，渲染时按播放时间在两者之间线性插值，
+ * 样本迟到时允许有限外推。播放时间比最新样本晚约一个推送周期，
+ * 因此新样本到达时显示值从上一个样本处平滑过渡，而不是跳变。
+ * 服务端推送降到 2-4 Hz 时显示仍然平滑。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef INTERP_H
+#define INTERP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 推送周期估计的上下限 (毫秒)
+#define INTERP_MIN_PERIOD_MS 50
+#define INTERP_MAX_PERIOD_MS 1000
+// 播放时间领先于目标时间时的推进速度 (相对本地时间)
+#define INTERP_CATCH_UP_RATE 0.5f
+
+// 单个指标的最近两个样本
+typedef struct {
+    bool valid;
+    float v0, v1;
+    uint64_t t0, t1;     // 采样时间 (与 InterpClock 同一时钟)
+} InterpChannel;
+
+// 播放时钟: 把本地时间映射到采样时钟上
+typedef struct {
+    bool valid;
+    uint64_t sample_ms;  // 最新样本的采样时间
+    uint64_t rx_ms;      // 最新样本的本地接收时间
+    float period_ms;     // 推送周期估计 (平滑值，0 表示尚未估计)
+    bool played_valid;
+    uint64_t played_ms;  // 上次返回的播放时间
+    uint64_t played_at;  // 上次求播放时间时的本地时间
+} InterpClock;
+
+void interp_reset(InterpChannel* c);
+
+// 加入新样本；采样时间回退 (服务端重启) 时丢弃旧样本
+void interp_push(InterpChannel* c, uint64_t t, float v);
+
+// 在采样时钟 t 处求值；超过最新样本时最多外推 max_extrap 个样本间隔，之后保持
+float interp_sample(const InterpChannel* c, uint64_t t, float max_extrap);
+
+void interp_clock_reset(InterpClock* clk);
+
+// 收到一帧时更新播放时钟
+void interp_clock_update(InterpClock* clk, uint64_t sample_ms, uint64_t now_ms);
+
+// 当前播放时间 (采样时钟)，不回退: 新样本提前到达或周期估计变大使目标时间落后于已播放的时间时，
+// 按 INTERP_CATCH_UP_RATE 的速度推进，直到目标时间追上。服务端重启后从新时钟重新开始
+uint64_t interp_clock_time(InterpClock* clk, uint64_t now_ms);
+
+#endif
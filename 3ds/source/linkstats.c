@@ -0,0 +1,87 @@
+/**
+ * 链路质量统计 (见 linkstats.h)
+ */
+
+#include "linkstats.h"
+#include <string.h>
+
+// 延迟平滑系数
+#define LATENCY_ALPHA 0.125f
+
+void linkstats_reset(LinkStats* ls, uint64_t now_ms) {
+    memset(ls, 0, sizeof(*ls));
+    ls->window_start_ms = now_ms;
+}
+
+// 窗口结束时输出丢包率与乱序数，并开始新窗口
+static void roll_window(LinkStats* ls, uint64_t now_ms) {
+    if (now_ms - ls->window_start_ms < LINK_WINDOW_MS) return;
+
+    uint32_t expected = ls->received + ls->lost;
+    ls->loss_pct = expected > 0 ? ls->lost * 100.0f / expected : 0.0f;
+    ls->reorder_count = ls->reordered;
+    ls->received = 0;
+    ls->lost = 0;
+    ls->reordered = 0;
+    ls->window_start_ms = now_ms;
+}
+
+bool linkstats_frame(LinkStats* ls, uint32_t seq, uint64_t sample_ms, uint64_t now_ms) {
+    roll_window(ls, now_ms);
+
+    if (ls->have_seq && seq + LINK_REORDER_WINDOW < ls->last_seq) {
+        // 序号大幅回退: 服务端重启，时钟起点也随之改变
+        linkstats_reset(ls, now_ms);
+    }
+
+    bool newest = !ls->have_seq || seq > ls->last_seq;
+    if (newest) {
+        if (ls->have_seq) {
+            uint32_t gap = seq - ls->last_seq;
+            ls->lost += gap - 1;
+            ls->seen = gap < 64 ? ls->seen << gap : 0;
+        }
+        ls->seen |= 1;
+        ls->have_seq = true;
+        ls->last_seq = seq;
+        ls->received++;
+    } else if (seq < ls->last_seq) {
+        uint32_t age = ls->last_seq - seq;
+        uint64_t bit = age < 64 ? (uint64_t)1 << age : 0;
+        // 迟到的重复帧 (第一份已经到过): 不是乱序，也不能抵消丢失
+        if (ls->seen & bit) return false;
+        ls->seen |= bit;
+        // 迟到的帧: 之前按空洞计为丢失，现在改记为乱序
+        ls->reordered++;
+        ls->received++;
+        if (ls->lost > 0) ls->lost--;
+    }
+
+    if (newest && ls->have_offset) {
+        int64_t latency = (int64_t)now_ms - ((int64_t)sample_ms + ls->offset_ms);
+        // 非对称路由可能让估计值略小于 0
+        if (latency < 0) latency = 0;
+        if (ls->have_latency) {
+            ls->latency_ms += (latency - ls->latency_ms) * LATENCY_ALPHA;
+        } else {
+            ls->latency_ms = latency;
+            ls->have_latency = true;
+        }
+    }
+    return newest;
+}
+
+void linkstats_pong(LinkStats* ls, uint64_t sent_ms, uint64_t server_ms, uint64_t now_ms) {
+    if (now_ms < sent_ms) return;
+    uint32_t rtt = now_ms - sent_ms;
+    ls->rtt_ms = rtt;
+
+    // 最小往返过滤: 往返越短，单程时间假设为 rtt/2 的误差越小。
+    // 旧的最优值每次放宽 1ms，时钟漂移或路径变化后仍能被新样本替换
+    if (ls->have_offset) ls->best_rtt_ms++;
+    if (!ls->have_offset || rtt <= ls->best_rtt_ms) {
+        ls->offset_ms = (int64_t)(sent_ms + rtt / 2) - (int64_t)server_ms;
+        ls->best_rtt_ms = rtt;
+        ls->have_offset = true;
+    }
+}
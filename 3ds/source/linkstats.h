@@ -0,0 +1,56 @@
+/**
+ * 链路质量统计
+ *
+ * 根据帧序号 (seq) 统计丢包与乱序，根据 PING/PONG 往返估计与服务端的时钟偏移，
+ * 再结合帧内的采样时间 (sample_ms) 计算端到端延迟。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef LINKSTATS_H
+#define LINKSTATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 统计窗口 (毫秒)，每个窗口结束时刷新显示值
+#define LINK_WINDOW_MS 5000
+// 序号回退超过该值视为服务端重启，而不是乱序
+#define LINK_REORDER_WINDOW 64
+
+typedef struct {
+    // 序号跟踪
+    bool have_seq;
+    uint32_t last_seq;       // 已收到的最大序号
+    uint64_t seen;           // 最近 64 个序号的到达位图 (第 i 位: last_seq - i)，用于剔除迟到的重复帧
+
+    // 当前窗口计数
+    uint64_t window_start_ms;
+    uint32_t received;
+    uint32_t lost;           // 序号空洞 (迟到的帧会从中扣除)
+    uint32_t reordered;
+
+    // 上一个窗口的结果 (用于显示)
+    float loss_pct;
+    uint32_t reorder_count;
+
+    // 时钟偏移: 本地时间 = 服务端时间 + offset_ms
+    bool have_offset;
+    int64_t offset_ms;
+    uint32_t best_rtt_ms;    // 当前偏移对应的往返时间 (每次 PONG 缓慢放宽，以跟踪漂移)
+    uint32_t rtt_ms;         // 最近一次往返时间
+
+    // 端到端延迟 (采样 → 本地收到，平滑值)
+    bool have_latency;
+    float latency_ms;
+} LinkStats;
+
+void linkstats_reset(LinkStats* ls, uint64_t now_ms);
+
+// 记录收到的一帧；返回 true 表示这是最新的帧，应当应用到显示状态
+// (迟到的旧帧和重复帧返回 false；重复帧不计入统计)
+bool linkstats_frame(LinkStats* ls, uint32_t seq, uint64_t sample_ms, uint64_t now_ms);
+
+// 记录一次 PONG: sent_ms 为发送 PING 时的本地时间，server_ms 为服务端回复时间
+void linkstats_pong(LinkStats* ls, uint64_t sent_ms, uint64_t server_ms, uint64_t now_ms);
+
+#endif
@@ -17,11 +17,32 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include "linkstats.h"
+#include "interp.h"
+#include "pacing.h"
+#include "hosts.h"
+#include "chart.h"
+#include "discovery.h"
+#include "reassembly.h"
 
 // ========================================
 // Configuration
 // ========================================
 #define UDP_PORT 9001
+// 心跳 (PING) 间隔
+#define HEARTBEAT_INTERVAL_MS 1000
+// 字段订阅 (随每次心跳发送): 只要本客户端解析的字段，不要 kernel_version/resolution/io 和每核心频率
+#define SUBSCRIBE_MSG "SUB cpu,core_usage,memory,thermal,power,battery,processes,gauges,alerts," \
+                      "hostname,os_name,cpu_model,cpu_cores,uptime_secs"
+// 数据报大小上限 (随每次心跳发送): 超过的帧由服务端按字段拆成多个数据报 (见 reassembly.h)，
+// 留出 IP/UDP 头部和无线链路封装的余量，避免 IP 分片 (一个分片丢失整帧都会丢)
+#define MTU_MSG "MTU 1200"
+// 上次连接的服务端 (启动和断线后优先单播探测)
+#define LAST_SERVER_PATH "sdmc:/3ds/holographic-monitor.server"
+// 每帧最多处理的数据包数 (16 台主机 x 10 Hz 在 15 fps 时也不积压)
+#define MAX_PACKETS_PER_FRAME 32
+// 显示值每帧 (按 60 fps 折算) 变化超过该像素数时视为画面在动，保持全速渲染
+#define PACE_MOTION_PX 0.5f
 
 // 3D Shader
 extern u8 vshader_shbin[];
@@ -34,6 +55,25 @@ typedef struct {
 } vertex;
 
 #define VBO_SIZE 2000
+
+// 每核心热力条 (与柱体、风扇同一个 VBO，一次 draw call 绘制)
+#define CORE_STRIP_COLS 16
+#define CORE_STRIP_X 160
+#define CORE_STRIP_Y 50
+#define CORE_STRIP_W 128
+#define CORE_STRIP_H 32
+
+// 总览页: 每台主机 CPU/内存/温度三根柱 (全部主机同一个 VBO，一次 draw call 绘制)
+#define OVERVIEW_COLS 8
+#define OVERVIEW_X 10
+#define OVERVIEW_Y 44
+#define OVERVIEW_W 380
+#define OVERVIEW_H 186
+// 柱区下方的标签高度
+#define OVERVIEW_LABEL_H 22
+// 温度柱满格对应的温度
+#define OVERVIEW_TEMP_MAX 100.0f
+
 static vertex* g_vbo_buffers[2] = {NULL, NULL};
 static int g_cur_buf_idx = 0;
 static int g_vertex_count = 0; // Dynamic vertex count
@@ -45,6 +85,12 @@ static int g_uLoc_modelView;
 static C3D_AttrInfo g_attrInfo;
 static C3D_BufInfo g_bufInfo;
 
+// 下屏历史图表: 一个三角形带 VBO，内容变化时原地重写 (下屏只在内容变化时重绘)
+static ChartVertex* g_chart_vbo = NULL;
+static C3D_BufInfo g_chart_bufInfo;
+// 图表显示的时间跨度 (触摸图表切换)
+static int g_chart_level = HISTORY_10S;
+
 
 // 颜色定义
 #define COL_BG        C2D_Color32(0x10, 0x10, 0x20, 0xFF)
@@ -55,81 +101,44 @@ static C3D_BufInfo g_bufInfo;
 #define COL_ORANGE    C2D_Color32(0xFF, 0x6B, 0x35, 0xFF)
 #define COL_TEXT      C2D_Color32(0xE0, 0xE0, 0xFF, 0xFF)
 #define COL_WHITE     C2D_Color32(0xFF, 0xFF, 0xFF, 0xFF)
+#define COL_MAGENTA   C2D_Color32(0xFF, 0x00, 0xAA, 0xFF)
 
 // ========================================
 // Global State
 // ========================================
-typedef struct {
-    float cpu_usage;    
-    float memory_usage; 
-    float swap_usage;     // 从 server 获取
-    float cpu_temp;
-    float gpu_temp;       // 从 server 获取
-    float power_watts;
-    int cpu_freq_mhz;     // 新增: CPU 频率
-    int fan_rpm;
-    bool connected;
-    int uptime_seconds;
-    int current_mode;
-    
-    // 新增字段
-    char hostname[64];
-    char os_name[64];
-    char cpu_model[64];
-    int cpu_cores;
-    int battery_level;
-    char battery_status[32];
-    
-    // 新增: 内存绝对值 (MB)
-    int memory_total_mb;
-    int memory_used_mb;
-} AppState;
-
-static void parse_json_string(const char* json, const char* key, char* dest, size_t dest_size) {
-    char search_key[64];
-    snprintf(search_key, sizeof(search_key), "\"%s\":\"", key);
-    char* p = strstr(json, search_key);
-    if (p) {
-        p += strlen(search_key);
-        size_t i = 0;
-        while (*p && *p != '"' && i < dest_size - 1) {
-            dest[i++] = *p++;
-        }
-        dest[i] = '\0';
-    }
-}
-
-static AppState g_state = {
-    .cpu_usage = 25.0f,
-    .memory_usage = 45.0f,
-    .swap_usage = 10.0f,
-    .cpu_temp = 42.0f,
-    .gpu_temp = 48.0f,
-    .power_watts = 15.0f,
-    .gpu_temp = 48.0f,
-    .power_watts = 15.0f,
-    .cpu_freq_mhz = 2400,
-    .hostname = "CONNECTING...",
-    .os_name = "UNKNOWN",
-    .cpu_model = "GENERIC CPU",
-    .cpu_cores = 8,
-    .battery_level = -1,
-    .battery_status = "UNKNOWN",
-    .memory_total_mb = 16384,
-    .memory_used_mb = 8192,
-    .fan_rpm = 1200,
-    .connected = false,
-    .uptime_seconds = 0,
-    .current_mode = 3
-};
+// 各主机的显示状态、插值通道与链路统计 (见 hosts.h)
+static HostTable g_hosts;
+// 当前显示的主机 (D-pad 左右切换) 与总览页 (D-pad 上下切换)
+static int g_selected = 0;
+static bool g_overview = false;
+// 尚未收到任何数据时显示的占位状态
+static AppState g_placeholder;
+// 当前显示的状态 (指向所选主机或占位状态)
+static AppState* g_state = &g_placeholder;
 
 // 网络状态
 static int g_socket = -1;
 static bool g_net_init = false;
-static bool g_server_found = false;
-static struct sockaddr_in g_server_addr;
-static struct sockaddr_in g_broadcast_addr;
 static u32* g_soc_buffer = NULL;
+// 已发现的服务端 (心跳目标)；中继服务端一个地址对应多台主机
+typedef struct {
+    struct sockaddr_in addr;
+    u64 last_rx_ms;         // 最近一次收到该服务端任何消息的时间 (存活检测)
+} Server;
+static Server g_servers[MAX_HOSTS];
+static int g_server_count = 0;
+// 发现调度 (退避与 time-to-first-data) 与缓存的上次服务端
+static Discovery g_discovery;
+static struct sockaddr_in g_cached_server;
+static bool g_have_cached_server = false;
+// 从休眠唤醒后立即重新探测 (APT 回调中设置)
+static volatile bool g_wake_pending = false;
+
+// 自适应帧率
+static Pacer g_pacer;
+
+// 分片帧重组
+static Reassembler g_reasm;
 
 // 3D Props
 // 3D Props - unused arrays removed
@@ -142,14 +151,17 @@ static u32* g_soc_buffer = NULL;
 static C3D_RenderTarget* bottomScreen = NULL;
 static C2D_TextBuf textBuf = NULL;
 
-// 功率历史
-#define POWER_HISTORY_SIZE 50
-static float g_power_history[POWER_HISTORY_SIZE] = {0};
-static int g_power_idx = 0;
+// 历史图表区域 (下屏坐标) 与纵轴范围
+#define CHART_LEFT 14
+#define CHART_TOP 26
+#define CHART_WIDTH 185
+#define CHART_HEIGHT 64
+#define CHART_POWER_MAX 50.0f
+#define CHART_TEMP_MIN 20.0f
+#define CHART_TEMP_MAX 100.0f
 
 // 动画
 static float g_fan_angle = 0;
-static int g_frame = 0;
 static C2D_SpriteSheet g_spriteSheet;
 static float g_cat_anim_frame = 0.0f;
 static Result g_romfs_rc = -1;
@@ -181,8 +193,40 @@ static void init_3d(void) {
     BufInfo_Init(&g_bufInfo);
     // Initial bind (will be updated per frame)
     BufInfo_Add(&g_bufInfo, g_vbo_buffers[0], sizeof(vertex), 2, 0x10);
+    
+    // 历史图表 VBO (顶点布局与 3D 几何相同，共用着色器和属性配置)
+    g_chart_vbo = (ChartVertex*)linearAlloc(CHART_MAX_VERTICES * sizeof(ChartVertex));
+    BufInfo_Init(&g_chart_bufInfo);
+    BufInfo_Add(&g_chart_bufInfo, g_chart_vbo, sizeof(ChartVertex), 2, 0x10);
+
 
+}
+
+// 平面四边形 (朝向相机)，颜色直接给浮点分量
+static void fill_quad(vertex* v, float x, float y, float z, float w, float h, float r, float g, float b) {
+    vertex quad[] = {
+        {x, y, z, r, g, b, 1}, {x+w, y, z, r, g, b, 1}, {x+w, y+h, z, r, g, b, 1},
+        {x, y, z, r, g, b, 1}, {x+w, y+h, z, r, g, b, 1}, {x, y+h, z, r, g, b, 1}
+    };
+    memcpy(v, quad, sizeof(quad));
+}
 
+// 使用率热力色: 0% 暗青 -> 50% 黄 -> 100% 红
+static void heat_color(float pct, float* r, float* g, float* b) {
+    float t = pct / 100.0f;
+    if (t < 0) t = 0;
+    if (t > 1) t = 1;
+    if (t < 0.5f) {
+        float k = t * 2.0f;
+        *r = k;
+        *g = 0.35f + k * 0.65f;
+        *b = 0.45f * (1.0f - k);
+    } else {
+        float k = (t - 0.5f) * 2.0f;
+        *r = 1.0f;
+        *g = 1.0f - k * 0.8f;
+        *b = 0.0f;
+    }
 }
 
 static void fill_cube(vertex* v, float x, float y, float z, float w, float h, float d, u32 color) {
@@ -403,27 +447,11 @@ static void fill_windmill_blade_geom(geom_vtx* v_out, int* v_count) {
 // ========================================
 // Network Functions (容错版本)
 // ========================================
-static void init_network(void) {
-    // 分配socket缓冲区
-    g_soc_buffer = (u32*)memalign(0x1000, 0x10000);
-    if (!g_soc_buffer) {
-        return;
-    }
-    
-    // 初始化socket服务
-    Result ret = socInit(g_soc_buffer, 0x10000);
-    if (R_FAILED(ret)) {
-        free(g_soc_buffer);
-        g_soc_buffer = NULL;
-        return;
-    }
-    
-    g_net_init = true;
-    
-    // 创建UDP socket
+// 创建并绑定 UDP socket (休眠唤醒后 socket 失效时重新创建)
+static bool open_socket(void) {
     g_socket = socket(AF_INET, SOCK_DGRAM, 0);
     if (g_socket < 0) {
-        return;
+        return false;
     }
     
     // 设置非阻塞
@@ -444,102 +472,261 @@ static void init_network(void) {
     if (bind(g_socket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         close(g_socket);
         g_socket = -1;
+        return false;
+    }
+    return true;
+}
+
+static void init_network(void) {
+    // 分配socket缓冲区
+    g_soc_buffer = (u32*)memalign(0x1000, 0x10000);
+    if (!g_soc_buffer) {
         return;
     }
     
-    // 设置广播地址
+    // 初始化socket服务
+    Result ret = socInit(g_soc_buffer, 0x10000);
+    if (R_FAILED(ret)) {
+        free(g_soc_buffer);
+        g_soc_buffer = NULL;
+        return;
+    }
+    
+    g_net_init = true;
+    open_socket();
+}
+
+static bool same_addr(const struct sockaddr_in* a, const struct sockaddr_in* b) {
+    return a->sin_addr.s_addr == b->sin_addr.s_addr && a->sin_port == b->sin_port;
+}
+
+// 读取 SD 卡上缓存的上次服务端 ("ip port")
+static void load_cached_server(void) {
+    FILE* f = fopen(LAST_SERVER_PATH, "r");
+    if (!f) return;
+    char ip[32];
+    unsigned port;
+    if (fscanf(f, "%31s %u", ip, &port) == 2 && inet_addr(ip) != INADDR_NONE && port > 0 && port < 65536) {
+        memset(&g_cached_server, 0, sizeof(g_cached_server));
+        g_cached_server.sin_family = AF_INET;
+        g_cached_server.sin_addr.s_addr = inet_addr(ip);
+        g_cached_server.sin_port = htons(port);
+        g_have_cached_server = true;
+    }
+    fclose(f);
+}
+
+// 地址变化时才写 SD 卡 (每次搜索最多一次)
+static void save_cached_server(const struct sockaddr_in* addr) {
+    if (g_have_cached_server && same_addr(&g_cached_server, addr)) return;
+    g_cached_server = *addr;
+    g_have_cached_server = true;
+    FILE* f = fopen(LAST_SERVER_PATH, "w");
+    if (!f) return;
+    fprintf(f, "%s %u\n", inet_ntoa(addr->sin_addr), (unsigned)ntohs(addr->sin_port));
+    fclose(f);
+}
+
+static void on_apt_event(APT_HookType hook, void* param) {
+    if (hook == APTHOOK_ONWAKEUP || hook == APTHOOK_ONRESTORE) g_wake_pending = true;
+}
+
+// 当前选中的主机 (还没有主机时为 NULL)
+static Host* selected_host(void) {
+    return g_hosts.count > 0 ? &g_hosts.hosts[g_selected] : NULL;
+}
+
+static void select_host(int idx) {
+    g_selected = idx;
+    g_state = &g_hosts.hosts[idx].state;
+}
+
+// 记录收到服务端的消息: 新地址加入心跳列表 (之后每秒向它发送 PING)
+static void touch_server(const struct sockaddr_in* addr, u64 now) {
+    for (int i = 0; i < g_server_count; i++) {
+        if (same_addr(&g_servers[i].addr, addr)) {
+            g_servers[i].last_rx_ms = now;
+            return;
+        }
+    }
+    if (g_server_count < MAX_HOSTS) {
+        g_servers[g_server_count].addr = *addr;
+        g_servers[g_server_count].last_rx_ms = now;
+        g_server_count++;
+    }
+}
+
+// 存活检测: 服务端停止发送超过时限即移出心跳列表，其主机显示为断开；
+// 全部移除后回到快速搜索
+static void check_liveness(u64 now) {
+    bool dropped = false;
+    for (int i = 0; i < g_server_count; ) {
+        if (now - g_servers[i].last_rx_ms < DISCOVERY_LIVENESS_MS) {
+            i++;
+            continue;
+        }
+        for (int k = 0; k < g_hosts.count; k++) {
+            Host* h = &g_hosts.hosts[k];
+            if (h->ip == g_servers[i].addr.sin_addr.s_addr && h->port == g_servers[i].addr.sin_port) {
+                h->state.connected = false;
+            }
+        }
+        g_servers[i] = g_servers[--g_server_count];
+        dropped = true;
+    }
+    if (dropped && g_server_count == 0 && !g_discovery.searching) {
+        discovery_restart(&g_discovery, now);
+    }
+}
+
+static int send_msg(const struct sockaddr_in* addr, const char* msg, int len) {
+    return sendto(g_socket, msg, len, 0, (const struct sockaddr*)addr, sizeof(*addr));
+}
+
+// 一轮发现探测: 缓存的上次服务端和已知主机先单播 (服务端重启或本机唤醒后不依赖广播)，
+// 再广播到本机所在 /24 (每次按当前 IP 计算，唤醒后 IP 可能变化)
+static void send_probe(void) {
+    struct sockaddr_in sent[MAX_HOSTS + 1];
+    int sent_count = 0;
+    if (g_have_cached_server) {
+        send_msg(&g_cached_server, "DISCOVER", 8);
+        sent[sent_count++] = g_cached_server;
+    }
+    for (int i = 0; i < g_hosts.count; i++) {
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = g_hosts.hosts[i].ip;
+        addr.sin_port = g_hosts.hosts[i].port;
+        bool dup = false;
+        for (int k = 0; k < sent_count && !dup; k++) dup = same_addr(&sent[k], &addr);
+        if (dup) continue;
+        send_msg(&addr, "DISCOVER", 8);
+        sent[sent_count++] = addr;
+    }
+    
     u32 ip = gethostid();
-    memset(&g_broadcast_addr, 0, sizeof(g_broadcast_addr));
-    g_broadcast_addr.sin_family = AF_INET;
-    g_broadcast_addr.sin_port = htons(UDP_PORT);
-    g_broadcast_addr.sin_addr.s_addr = (ip & 0x00FFFFFF) | 0xFF000000;
+    if (!ip) return;  // 还没有连上无线网络
+    struct sockaddr_in broadcast;
+    memset(&broadcast, 0, sizeof(broadcast));
+    broadcast.sin_family = AF_INET;
+    broadcast.sin_port = htons(UDP_PORT);
+    broadcast.sin_addr.s_addr = (ip & 0x00FFFFFF) | 0xFF000000;
+    if (send_msg(&broadcast, "DISCOVER", 8) < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        // socket 在休眠或断网后失效，下一轮探测时重新创建
+        close(g_socket);
+        g_socket = -1;
+    }
 }
 
-static void network_update(void) {
-    if (g_socket < 0) return;
+// 应用一条数据消息: part 为 NULL 时是完整的帧，否则是分片帧中的一个块
+static void handle_data(const char* json, const struct sockaddr_in* sender, u64 now, const ReasmChunk* part) {
+    touch_server(sender, now);
+    int idx = hosts_lookup(&g_hosts, sender->sin_addr.s_addr, sender->sin_port, hosts_relay_id(json), now);
+    if (idx < 0) return;  // 超过 MAX_HOSTS 的主机忽略
+    if (g_state == &g_placeholder) select_host(idx);
+    Host* h = &g_hosts.hosts[idx];
+    bool applied = part ? host_part(h, json, now, part->first, part->parts, part->count)
+                        : host_frame(h, json, now);
+    if (applied) {
+        pacer_data(&g_pacer, now);
+        // 搜索后的第一帧: 记录 time-to-first-data，并缓存该服务端供下次优先探测
+        if (g_discovery.searching) {
+            discovery_data(&g_discovery, now);
+            save_cached_server(sender);
+        }
+    }
+}
+
+// 处理一个收到的数据包 (buf[n] 为 '\0')
+static void handle_packet(char* buf, int n, const struct sockaddr_in* sender) {
+    u64 now = osGetTime();
+    if (reasm_is_datagram((const u8*)buf, n)) {
+        ReasmChunk chunk;
+        if (reasm_push(&g_reasm, sender->sin_addr.s_addr, sender->sin_port, (u8*)buf, n, now, &chunk)) {
+            handle_data(chunk.json, sender, now, &chunk);
+        }
+    }
+    else if (strncmp(buf, "SERVER", 6) == 0) {
+        // 每个回复的服务端都加入心跳列表，收到第一帧时再分配主机槽位
+        touch_server(sender, now);
+    } 
+    else if (strncmp(buf, "PONG ", 5) == 0) {
+        // PONG <PING 发送时的本地毫秒> <服务端毫秒>
+        char* end;
+        u64 sent_ms = strtoull(buf + 5, &end, 10);
+        u64 server_ms = strtoull(end, NULL, 10);
+        touch_server(sender, now);
+        // 中继转发的帧带的是上游的采样时钟，与中继的时钟偏移无关，只用于直连主机
+        for (int i = 0; i < g_hosts.count; i++) {
+            Host* h = &g_hosts.hosts[i];
+            if (h->relay_id < 0 && h->ip == sender->sin_addr.s_addr && h->port == sender->sin_port) {
+                linkstats_pong(&h->link, sent_ms, server_ms, now);
+            }
+        }
+    }
+    else if (buf[0] == '{') {
+        handle_data(buf, sender, now, NULL);
+    }
+}
+
+static void network_update(u64 now) {
+    if (!g_net_init) return;
     
-    static int send_counter = 0;
-    send_counter++;
+    // 按时间而非帧数发送心跳，降帧时频率不变
+    static u64 last_heartbeat_ms = 0;
     
-    // 每60帧发送一次
-    if (send_counter >= 60) {
-        send_counter = 0;
-        if (g_server_found) {
-            sendto(g_socket, "PING", 4, 0, 
-                   (struct sockaddr*)&g_server_addr, sizeof(g_server_addr));
-        } else {
-            sendto(g_socket, "DISCOVER", 8, 0, 
-                   (struct sockaddr*)&g_broadcast_addr, sizeof(g_broadcast_addr));
-        }
+    // 从休眠唤醒: 立即发送心跳并重新搜索 (休眠较久时服务端已将本机超时移除)
+    if (g_wake_pending) {
+        g_wake_pending = false;
+        last_heartbeat_ms = 0;
+        discovery_restart(&g_discovery, now);
     }
     
-    // 接收数据
-    char buf[4096];
-    struct sockaddr_in sender;
-    socklen_t len = sizeof(sender);
+    check_liveness(now);
     
-    int n = recvfrom(g_socket, buf, sizeof(buf) - 1, 0, 
-                     (struct sockaddr*)&sender, &len);
+    // 搜索中按退避探测，已连接时低频广播以发现新启动的服务端
+    if (discovery_probe_due(&g_discovery, now)) {
+        if (g_socket < 0) open_socket();
+        if (g_socket >= 0) send_probe();
+    }
+    if (g_socket < 0) return;
     
-    if (n > 0) {
-        buf[n] = '\0';
-        
-        if (strncmp(buf, "SERVER", 6) == 0 && !g_server_found) {
-            g_server_found = true;
-            g_server_addr = sender;
-            g_state.connected = true;
-        } 
-        else if (buf[0] == '{') {
-            // 解析JSON数据
-            char* p;
-            if ((p = strstr(buf, "\"cpu_usage\":"))) {
-                g_state.cpu_usage = strtof(p + 12, NULL);
-            }
-            if ((p = strstr(buf, "\"cpu_temp\":"))) {
-                g_state.cpu_temp = strtof(p + 11, NULL);
-            }
-            if ((p = strstr(buf, "\"gpu_temp\":"))) {
-                g_state.gpu_temp = strtof(p + 11, NULL);
-            }
-            if ((p = strstr(buf, "\"memory_usage\":"))) {
-                g_state.memory_usage = strtof(p + 15, NULL);
-            }
-            if ((p = strstr(buf, "\"memory_total\":"))) {
-                g_state.memory_total_mb = atoi(p + 15);
-            }
-            if ((p = strstr(buf, "\"memory_used\":"))) {
-                g_state.memory_used_mb = atoi(p + 14);
-            }
-            if ((p = strstr(buf, "\"swap_usage\":"))) {
-                g_state.swap_usage = strtof(p + 13, NULL);
-            }
-            if ((p = strstr(buf, "\"power_score\":"))) {
-                g_state.power_watts = strtof(p + 14, NULL) / 100000.0f;
-            }
-            if ((p = strstr(buf, "\"fan_speeds\":["))) {
-                g_state.fan_rpm = atoi(p + 14);
-            }
-            if ((p = strstr(buf, "\"cpu_frequency_mhz\":"))) {
-                g_state.cpu_freq_mhz = atoi(p + 20);
-            }
-            
-            // 解析新字段
-            parse_json_string(buf, "hostname", g_state.hostname, sizeof(g_state.hostname));
-            parse_json_string(buf, "os_name", g_state.os_name, sizeof(g_state.os_name));
-            parse_json_string(buf, "cpu_model", g_state.cpu_model, sizeof(g_state.cpu_model));
-            parse_json_string(buf, "battery_status", g_state.battery_status, sizeof(g_state.battery_status));
-            
-            if ((p = strstr(buf, "\"cpu_cores\":"))) {
-                g_state.cpu_cores = atoi(p + 12);
-            }
-            if ((p = strstr(buf, "\"battery_percentage\":"))) {
-                g_state.battery_level = atoi(p + 21);
-            }
-            if ((p = strstr(buf, "\"uptime_secs\":"))) {
-                g_state.uptime_seconds = atoi(p + 14);
-            }
+    if (now - last_heartbeat_ms >= HEARTBEAT_INTERVAL_MS) {
+        last_heartbeat_ms = now;
+        // 携带本地时间，服务端回复 PONG 用于估计时钟偏移
+        char ping[32];
+        int ping_len = snprintf(ping, sizeof(ping), "PING %llu", (unsigned long long)now);
+        for (int i = 0; i < g_server_count; i++) {
+            send_msg(&g_servers[i].addr, ping, ping_len);
+            // 服务端重启后订阅和数据报上限会丢失，每次心跳都重新发送
+            send_msg(&g_servers[i].addr, SUBSCRIBE_MSG, sizeof(SUBSCRIBE_MSG) - 1);
+            send_msg(&g_servers[i].addr, MTU_MSG, sizeof(MTU_MSG) - 1);
         }
     }
+    
+    // 接收数据: 每帧取完所有待处理的包，低帧率时也不会积压
+    char buf[4096];
+    for (int i = 0; i < MAX_PACKETS_PER_FRAME; i++) {
+        struct sockaddr_in sender;
+        socklen_t len = sizeof(sender);
+        int n = recvfrom(g_socket, buf, sizeof(buf) - 1, 0, 
+                         (struct sockaddr*)&sender, &len);
+        if (n <= 0) break;
+        buf[n] = '\0';
+        handle_packet(buf, n, &sender);
+    }
+}
+
+// 按当前播放时间更新所有主机的显示值: 当前主机完整插值，其余主机只更新总览页指标
+// 返回可见内容的最大变化量 (像素)，供帧率调度判断画面是否在动
+static float hosts_apply(u64 now_ms) {
+    float motion = 0.0f;
+    for (int i = 0; i < g_hosts.count; i++) {
+        float moved = host_apply(&g_hosts.hosts[i], now_ms, i == g_selected);
+        if (g_overview || i == g_selected) motion = fmaxf(motion, moved);
+    }
+    return motion;
 }
 
 static void cleanup_network(void) {
@@ -565,11 +752,82 @@ static void cleanup_network(void) {
 // Render Helper
 // ========================================
 
-static void update_3d_geometry(void) {
+static void finish_3d_geometry(int buf_idx, vertex* end) {
+    // Flush cache so GPU sees the new data
+    GSPGPU_FlushDataCache(g_vbo_buffers[buf_idx], VBO_SIZE * sizeof(vertex));
+    
+    // Store vertex count for draw call
+    g_vertex_count = end - g_vbo_buffers[buf_idx];
+    
+    // Swap buffer index for rendering
+    g_cur_buf_idx = buf_idx;
+}
+
+// 总览页第 i 台主机的格子 (屏幕坐标)；主机少时格子放大
+static void overview_cell(int i, float* x, float* y, float* w, float* h) {
+    int cols = g_hosts.count < OVERVIEW_COLS ? g_hosts.count : OVERVIEW_COLS;
+    if (cols < 1) cols = 1;
+    int rows = (g_hosts.count + cols - 1) / cols;
+    if (rows < 1) rows = 1;
+    *w = (float)OVERVIEW_W / cols;
+    *h = (float)OVERVIEW_H / rows;
+    *x = OVERVIEW_X + (i % cols) * *w;
+    *y = OVERVIEW_Y + (i / cols) * *h;
+}
+
+// 总览页: 每台主机 CPU/内存/温度三根柱，全部写入同一个 VBO (16 台主机 1728 个顶点)
+static vertex* fill_overview_geometry(vertex* vtx, u64 now) {
+    float scale = 0.012f;
+    float cx = 200.0f;
+    float cy = 120.0f;
+    float d = 12.0f * scale;
+    u32 offline = C2D_Color32(0x50, 0x50, 0x60, 0xFF);
+    
+    for (int i = 0; i < g_hosts.count; i++) {
+        const Host* host = &g_hosts.hosts[i];
+        float x, y, w, h;
+        overview_cell(i, &x, &y, &w, &h);
+        
+        float top = y + 6;
+        float bottom = y + h - OVERVIEW_LABEL_H;
+        float barW = (w - 10) / 3 - 2;
+        if (barW > 24) barW = 24;
+        float left = x + (w - (barW + 2) * 3) / 2 + 1;
+        
+        float values[3] = {
+            host->state.cpu_usage / 100.0f,
+            host->state.memory_usage / 100.0f,
+            host->state.cpu_temp / OVERVIEW_TEMP_MAX,
+        };
+        u32 colors[3] = {COL_GREEN, COL_CYAN, COL_ORANGE};
+        bool stale = host_stale(host, now);
+        
+        for (int k = 0; k < 3; k++) {
+            float v = values[k];
+            if (v < 0) v = 0;
+            if (v > 1) v = 1;
+            // 至少 1px，空载的主机也能看到柱底
+            float barH = (bottom - top) * v;
+            if (barH < 1) barH = 1;
+            float bx = left + k * (barW + 2);
+            fill_cube(vtx, (bx - cx) * scale, (cy - bottom) * scale, 0, barW * scale, barH * scale, d,
+                      stale ? offline : colors[k]);
+            vtx += 36;
+        }
+    }
+    return vtx;
+}
+
+static void update_3d_geometry(u64 now) {
     // Write to the next buffer (CPU side)
     int next_buf_idx = (g_cur_buf_idx + 1) % 2;
     vertex* vtx = g_vbo_buffers[next_buf_idx];
     
+    if (g_overview) {
+        finish_3d_geometry(next_buf_idx, fill_overview_geometry(vtx, now));
+        return;
+    }
+    
     // Coordinates (Scaled to fit in -2.0 to 2.0 View Space approx)
 
     // Screen 400x240. Center (200, 120). Scale 1/50 = 0.02.
@@ -590,7 +848,7 @@ static void update_3d_geometry(void) {
     // Y is inverted in 3D (up is positive).
     // Screen Y=50 is high up.
     // Bottom of bar is at Y=50+140 = 190.
-    float cpuH = 140 * (g_state.cpu_usage / 100.0f);
+    float cpuH = 140 * (g_state->cpu_usage / 100.0f);
     if (cpuH > 140) cpuH = 140;
     
     float x = (20 - cx) * scale;
@@ -602,19 +860,39 @@ static void update_3d_geometry(void) {
     vtx += 36;
     
     // RAM Bar (X=65)
-    float ramH = 140 * (g_state.memory_usage / 100.0f);
+    float ramH = 140 * (g_state->memory_usage / 100.0f);
     x = (65 - cx) * scale;
     h = ramH * scale;
     fill_cube(vtx, x, y, 0, w, h, d, COL_CYAN);
     vtx += 36;
     
     // SWAP Bar (X=110)
-    float swapH = 140 * (g_state.swap_usage / 100.0f);
+    float swapH = 140 * (g_state->swap_usage / 100.0f);
     x = (110 - cx) * scale;
     h = swapH * scale;
     fill_cube(vtx, x, y, 0, w, h, d, COL_PURPLE);
     vtx += 36;
     
+    // 每核心热力条: 16 列网格，行数随核心数增加，单元格高度相应缩小
+    if (g_state->core_count > 0) {
+        int cols = CORE_STRIP_COLS;
+        int rows = (g_state->core_count + cols - 1) / cols;
+        float cellW = (float)CORE_STRIP_W / cols;
+        float cellH = (float)CORE_STRIP_H / rows;
+        float gap = 1.0f;
+        
+        for (int i = 0; i < g_state->core_count; i++) {
+            float sx = CORE_STRIP_X + (i % cols) * cellW;
+            float sy = CORE_STRIP_Y + (i / cols) * cellH;
+            float r, g, b;
+            heat_color(g_state->core_usage[i], &r, &g, &b);
+            // 屏幕坐标 (左上角) 转换到 3D 空间 (左下角)
+            fill_quad(vtx, (sx - cx) * scale, (cy - (sy + cellH - gap)) * scale, d,
+                      (cellW - gap) * scale, (cellH - gap) * scale, r, g, b);
+            vtx += 6;
+        }
+    }
+    
     // Fan (X=332, Y=190 - Aligned Middle)
     
     // Scale down fan size (0.6 -> 0.3)
@@ -770,15 +1048,7 @@ static void update_3d_geometry(void) {
         p++;
     }
     
-    
-    // Flush cache so GPU sees the new data
-    GSPGPU_FlushDataCache(g_vbo_buffers[next_buf_idx], VBO_SIZE * sizeof(vertex));
-    
-    // Store vertex count for draw call
-    g_vertex_count = vtx - g_vbo_buffers[next_buf_idx];
-    
-    // Swap buffer index for rendering
-    g_cur_buf_idx = next_buf_idx;
+    finish_3d_geometry(next_buf_idx, vtx);
 }
 
 
@@ -818,7 +1088,7 @@ static void render_3d_view(float iod) {
     C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, g_uLoc_modelView, &modelView);
 
     
-    // Draw (3 bars * 36 + Hub * 36 + 3 blades * 36)
+    // Draw (3 bars * 36 + core strip * 6 + Hub + 3 blades, or all overview bars) in one call
     // Use GEQUAL with 0 clear as it was known to be visible
     C3D_DepthTest(true, GPU_GEQUAL, GPU_WRITE_ALL);
     C3D_DrawArrays(GPU_TRIANGLES, 0, g_vertex_count);
@@ -840,10 +1110,85 @@ static void render_3d_view(float iod) {
 
 
 
+// 总览页的面板与文字 (柱体由 fill_overview_geometry 在 3D pass 中绘制)
+static void DrawOverview(float offset, int layer) {
+    C2D_Text text;
+    char buf[64];
+    float d_back = offset * 1.0f;
+    float d_mid  = offset * 0.2f;
+    u64 now = osGetTime();
+    
+    if (layer == 0) {
+        C2D_DrawRectSolid(10 + d_back, 8, 0, 380, 28, COL_PANEL);
+        for (int i = 0; i < g_hosts.count; i++) {
+            float x, y, w, h;
+            overview_cell(i, &x, &y, &w, &h);
+            C2D_DrawRectSolid(x + 2 + d_back, y + 2, 0, w - 4, h - 4, COL_PANEL);
+            u32 border = (i == g_selected) ? COL_CYAN : C2D_Color32(0x30, 0x30, 0x58, 0xFF);
+            C2D_DrawRectSolid(x + 2 + d_back, y + 2, 0, w - 4, 2, border);
+            C2D_DrawRectSolid(x + 2 + d_back, y + h - 4, 0, w - 4, 2, border);
+        }
+        C2D_DrawRectSolid(0 + d_back, 237, 0, 400, 3, COL_CYAN);
+        return;
+    }
+    
+    snprintf(buf, sizeof(buf), "OVERVIEW  %d HOSTS", g_hosts.count);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 18 + d_mid, 12, 0, 0.45f, 0.45f, COL_CYAN);
+    
+    C2D_TextParse(&text, textBuf, "CPU / RAM / TEMP");
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 290 + d_mid, 15, 0, 0.35f, 0.35f, COL_PURPLE);
+    
+    if (g_hosts.count == 0) {
+        C2D_TextParse(&text, textBuf, "SEARCHING...");
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, 160 + d_mid, 120, 0, 0.5f, 0.5f, COL_TEXT);
+        return;
+    }
+    
+    for (int i = 0; i < g_hosts.count; i++) {
+        const Host* host = &g_hosts.hosts[i];
+        float x, y, w, h;
+        overview_cell(i, &x, &y, &w, &h);
+        
+        // 主机名 (去掉 .local，按格子宽度截断)，未收到主机名时显示序号
+        char name[16];
+        int max_chars = (int)((w - 6) / 4.2f);
+        if (max_chars > (int)sizeof(name) - 1) max_chars = sizeof(name) - 1;
+        if (host->state.hostname[0]) {
+            snprintf(name, max_chars + 1, "%s", host->state.hostname);
+            char* dot = strstr(name, ".local");
+            if (dot) *dot = '\0';
+        } else {
+            snprintf(name, sizeof(name), "HOST %d", i + 1);
+        }
+        u32 col = (i == g_selected) ? COL_CYAN : COL_TEXT;
+        C2D_TextParse(&text, textBuf, name);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, x + 4 + d_mid, y + h - OVERVIEW_LABEL_H, 0, 0.3f, 0.3f, col);
+        
+        if (host_stale(host, now)) {
+            snprintf(buf, sizeof(buf), "OFFLINE");
+        } else {
+            snprintf(buf, sizeof(buf), "%.0f%% %.0fC", host->state.cpu_usage, host->state.cpu_temp);
+        }
+        C2D_TextParse(&text, textBuf, buf);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, x + 4 + d_mid, y + h - OVERVIEW_LABEL_H + 9, 0, 0.28f, 0.28f, COL_TEXT);
+    }
+}
+
 static void DrawTopScreen(float offset, int layer) {
     C2D_Text text;
     char buf[64];
     
+    if (g_overview) {
+        DrawOverview(offset, layer);
+        return;
+    }
+    
     // ---------------------------------------------------------
     // DEPTH LAYERS
     // ---------------------------------------------------------
@@ -864,11 +1209,11 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_DrawCircleSolid(px+15, py+17, 0.51, 15, C2D_Color32(0, 20, 30, 200));
         C2D_DrawCircleSolid(px+55, py+17, 0.51, 15, C2D_Color32(0, 20, 30, 200));
         
-        snprintf(buf, sizeof(buf), "%d", g_state.fan_rpm);
+        snprintf(buf, sizeof(buf), "%d", g_state->fan_rpm);
         C2D_TextBufClear(textBuf);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
-        snprintf(buf, sizeof(buf), "%d", g_state.fan_rpm);
+        snprintf(buf, sizeof(buf), "%d", g_state->fan_rpm);
         C2D_TextBufClear(textBuf);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
@@ -894,6 +1239,11 @@ static void DrawTopScreen(float offset, int layer) {
         // SWAP Frame
         C2D_DrawRectSolid(110 + d_back, 50, 0, 35, 140, COL_PANEL);
         
+        // Per-Core Strip Frame
+        if (g_state->core_count > 0) {
+            C2D_DrawRectSolid(CORE_STRIP_X - 3 + d_back, CORE_STRIP_Y - 3, 0, CORE_STRIP_W + 5, CORE_STRIP_H + 5, COL_PANEL);
+        }
+        
         // Temp BG
         C2D_DrawRectSolid(300 + d_mid, 55, 0, 90, 55, COL_PANEL); // CPU Temp
         C2D_DrawRectSolid(300 + d_mid, 55, 0, 90, 2, COL_CYAN);
@@ -942,10 +1292,10 @@ static void DrawTopScreen(float offset, int layer) {
         
         // 标题文字
         char display_host[64];
-        strncpy(display_host, g_state.hostname, sizeof(display_host));
+        strncpy(display_host, g_state->hostname, sizeof(display_host));
         char* dot = strstr(display_host, ".local");
         if (dot) *dot = '\0';
-        snprintf(buf, sizeof(buf), "%s  %s", display_host, g_state.os_name);
+        snprintf(buf, sizeof(buf), "%s  %s", display_host, g_state->os_name);
         
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
@@ -957,9 +1307,9 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_DrawText(&text, C2D_WithColor, 18 + d_mid, 12, 0, scale, scale, COL_CYAN);
         
         // 运行时间
-        int h = g_state.uptime_seconds / 3600;
-        int m = (g_state.uptime_seconds % 3600) / 60;
-        int s = g_state.uptime_seconds % 60;
+        int h = g_state->uptime_seconds / 3600;
+        int m = (g_state->uptime_seconds % 3600) / 60;
+        int s = g_state->uptime_seconds % 60;
         snprintf(buf, sizeof(buf), "UPTIME: %02d:%02d:%02d", h, m, s);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
@@ -975,7 +1325,7 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 25 + d_mid, 195, 0, 0.45f, 0.45f, COL_GREEN);
         
-        snprintf(buf, sizeof(buf), "%.0f%%", g_state.cpu_usage);
+        snprintf(buf, sizeof(buf), "%.0f%%", g_state->cpu_usage);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 22 + d_super, 208, 0, 0.35f, 0.35f, COL_TEXT);
@@ -985,10 +1335,10 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 70 + d_mid, 195, 0, 0.45f, 0.45f, COL_CYAN);
         
-        if (g_state.memory_total_mb > 0) {
-            snprintf(buf, sizeof(buf), "%.0f/%.0fG", g_state.memory_used_mb / 1024.0f, g_state.memory_total_mb / 1024.0f);
+        if (g_state->memory_total_mb > 0) {
+            snprintf(buf, sizeof(buf), "%.0f/%.0fG", g_state->memory_used_mb / 1024.0f, g_state->memory_total_mb / 1024.0f);
         } else {
-            snprintf(buf, sizeof(buf), "%.0f%%", g_state.memory_usage);
+            snprintf(buf, sizeof(buf), "%.0f%%", g_state->memory_usage);
         }
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
@@ -999,12 +1349,20 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 115 + d_mid, 195, 0, 0.45f, 0.45f, COL_PURPLE);
         
-        float swapPct = g_state.swap_usage;
+        float swapPct = g_state->swap_usage;
         snprintf(buf, sizeof(buf), "%.0f%%", swapPct);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 112 + d_super, 208, 0, 0.35f, 0.35f, COL_TEXT);
         
+        // Per-Core Strip Label
+        if (g_state->core_count > 0) {
+            snprintf(buf, sizeof(buf), "CORES x%d", g_state->core_count);
+            C2D_TextParse(&text, textBuf, buf);
+            C2D_TextOptimize(&text);
+            C2D_DrawText(&text, C2D_WithColor, CORE_STRIP_X + d_mid, CORE_STRIP_Y - 12, 0, 0.3f, 0.3f, COL_TEXT);
+        }
+        
         // Fan (Overlay removed - moved to right)
         
         // CPU Temp Text
@@ -1012,7 +1370,7 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 305 + d_mid, 60, 0, 0.35f, 0.35f, COL_CYAN);
         
-        snprintf(buf, sizeof(buf), "%.0f", g_state.cpu_temp);
+        snprintf(buf, sizeof(buf), "%.0f", g_state->cpu_temp);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 315 + d_super, 78, 0, 0.85f, 0.85f, COL_WHITE);
@@ -1026,7 +1384,7 @@ static void DrawTopScreen(float offset, int layer) {
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 305 + d_mid, 123, 0, 0.35f, 0.35f, COL_PURPLE);
         
-        snprintf(buf, sizeof(buf), "%.0f", g_state.gpu_temp);
+        snprintf(buf, sizeof(buf), "%.0f", g_state->gpu_temp);
         C2D_TextParse(&text, textBuf, buf);
         C2D_TextOptimize(&text);
         C2D_DrawText(&text, C2D_WithColor, 315 + d_super, 141, 0, 0.85f, 0.85f, COL_WHITE);
@@ -1057,6 +1415,312 @@ static void DrawTopScreen(float offset, int layer) {
 }
 
 
+// 下屏显示内容 (按显示精度取整)，与上次绘制时不同才重绘下屏
+typedef struct {
+    u32 history_version;
+    int chart_level;
+    int cpu_temp_c;
+    int cpu_usage_pct;
+    int power_dw;               // 0.1 W
+    int freq_100mhz;
+    int battery_level;
+    char battery_status[32];
+    int current_mode;
+    int proc_count;
+    int proc_pid[PROC_TOP];
+    int proc_cpu10[PROC_TOP];
+    int proc_rss_mb[PROC_TOP];
+    u32 proc_names;
+    int gauge_count;
+    char gauge_name[GAUGE_MAX][20];
+    int gauge_value10[GAUGE_MAX]; // 0.1
+    int alert_count;
+    char alert_name[20];        // 只显示第一条告警
+    int alert_value10;          // 0.1
+    bool connected;
+    int loss_dpct;              // 0.1 %
+    u32 reorder;
+    int latency_ms;             // -1 表示尚无估计
+    int selected;
+    int host_count;
+} BottomView;
+
+static bool g_bottom_backlight = true;
+static bool g_bottom_valid = false;
+static BottomView g_bottom_last;
+
+static void bottom_view(BottomView* v) {
+    const Host* host = selected_host();
+    memset(v, 0, sizeof(*v));   // 填充字节也要清零，之后用 memcmp 比较
+    v->chart_level = g_chart_level;
+    v->cpu_temp_c = (int)lrintf(g_state->cpu_temp);
+    v->cpu_usage_pct = (int)lrintf(g_state->cpu_usage);
+    v->power_dw = (int)(g_state->power_watts * 10.0f + 0.5f);
+    v->freq_100mhz = g_state->cpu_freq_mhz / 100;
+    v->battery_level = g_state->battery_level;
+    memcpy(v->battery_status, g_state->battery_status, sizeof(v->battery_status));
+    v->current_mode = g_state->current_mode;
+    v->proc_count = g_state->proc_count;
+    memcpy(v->proc_pid, g_state->proc_pid, sizeof(v->proc_pid));
+    memcpy(v->proc_cpu10, g_state->proc_cpu10, sizeof(v->proc_cpu10));
+    memcpy(v->proc_rss_mb, g_state->proc_rss_mb, sizeof(v->proc_rss_mb));
+    v->gauge_count = g_state->gauge_count;
+    memcpy(v->gauge_name, g_state->gauge_name, sizeof(v->gauge_name));
+    for (int i = 0; i < g_state->gauge_count; i++) {
+        v->gauge_value10[i] = (int)lroundf(g_state->gauge_value[i] * 10.0f);
+    }
+    v->alert_count = g_state->alert_count;
+    if (g_state->alert_count > 0) {
+        memcpy(v->alert_name, g_state->alert_name[0], sizeof(v->alert_name));
+        v->alert_value10 = (int)lroundf(g_state->alert_value[0] * 10.0f);
+    }
+    v->connected = g_state->connected;
+    v->latency_ms = -1;
+    if (host) {
+        v->history_version = host->history_version;
+        v->proc_names = host->proc_name_version;
+        v->loss_dpct = (int)(host->link.loss_pct * 10.0f + 0.5f);
+        v->reorder = host->link.reorder_count;
+        if (host->link.have_latency) v->latency_ms = (int)(host->link.latency_ms + 0.5f);
+    }
+    v->selected = g_selected;
+    v->host_count = g_hosts.count;
+}
+
+// 调试浮层: 帧率档位与实际帧率 (Y 键切换)
+static bool g_debug_overlay = false;
+
+// 第二行: 发现状态与最近一次搜索的 time-to-first-data
+static void DrawPacingOverlay(void) {
+    C2D_Text text;
+    char buf[64];
+    C2D_DrawRectSolid(158, 214, 0, 150, 22, C2D_Color32(0x00, 0x00, 0x00, 0xA0));
+    
+    if (g_discovery.ttfd_ms >= 0) {
+        snprintf(buf, sizeof(buf), "%s  SRV %d  TTFD %ldms", g_discovery.searching ? "SEARCH" : "LINKED",
+                 g_server_count, (long)g_discovery.ttfd_ms);
+    } else {
+        snprintf(buf, sizeof(buf), "%s  SRV %d  TTFD --", g_discovery.searching ? "SEARCH" : "LINKED",
+                 g_server_count);
+    }
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 162, 215, 0, 0.3f, 0.3f, COL_GREEN);
+    
+    snprintf(buf, sizeof(buf), "%s %dFPS  TOP %.0f  BTM %.0f",
+             pacer_name(g_pacer.state), pacer_fps(g_pacer.state), g_pacer.fps, g_pacer.bottom_fps);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 162, 226, 0, 0.3f, 0.3f, COL_GREEN);
+}
+
+// 历史图表: 当前主机的功率/温度/CPU 包络写入图表 VBO，一次 draw call 绘制
+// (先提交已排队的 C2D 图元，画完恢复 C2D 状态)
+static void DrawHistoryChart(const Host* host) {
+    if (!host) return;
+    const ChartSeries series[] = {
+        {&host->history[HIST_CPU], 0.0f, 100.0f, 0.0f, 1.0f, 0.53f, 0.45f},
+        {&host->history[HIST_CPU_TEMP], CHART_TEMP_MIN, CHART_TEMP_MAX, 1.0f, 0.42f, 0.21f, 0.7f},
+        {&host->history[HIST_POWER], 0.0f, CHART_POWER_MAX, 0.0f, 0.96f, 1.0f, 1.0f},
+    };
+    int count = chart_fill(g_chart_vbo, series, sizeof(series) / sizeof(series[0]), g_chart_level,
+                           CHART_LEFT, CHART_TOP, CHART_WIDTH, CHART_HEIGHT);
+    GSPGPU_FlushDataCache(g_chart_vbo, count * sizeof(ChartVertex));
+    
+    C2D_Flush();
+    C3D_BindProgram(&g_shader);
+    C3D_SetAttrInfo(&g_attrInfo);
+    C3D_SetBufInfo(&g_chart_bufInfo);
+    C3D_TexEnv* env = C3D_GetTexEnv(0);
+    C3D_TexEnvSrc(env, C3D_Both, GPU_PRIMARY_COLOR, 0, 0);
+    C3D_TexEnvFunc(env, C3D_Both, GPU_REPLACE);
+    C3D_DepthTest(false, GPU_ALWAYS, GPU_WRITE_COLOR);
+    
+    // 下屏像素坐标 (与 C2D 相同的正交投影)
+    C3D_Mtx projection, modelView;
+    Mtx_OrthoTilt(&projection, 0.0f, 320.0f, 240.0f, 0.0f, 1.0f, -1.0f, true);
+    Mtx_Identity(&modelView);
+    C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, g_uLoc_projection, &projection);
+    C3D_FVUnifMtx4x4(GPU_VERTEX_SHADER, g_uLoc_modelView, &modelView);
+    C3D_DrawArrays(GPU_TRIANGLE_STRIP, 0, count);
+    
+    C3D_TexEnvSrc(env, C3D_Both, GPU_TEXTURE0, GPU_PRIMARY_COLOR, 0);
+    C3D_TexEnvFunc(env, C3D_Both, GPU_MODULATE);
+    C2D_Prepare();
+}
+
+// 下屏: 历史图表、频率/电池面板、模式按钮、进程榜单与状态栏
+static void DrawBottomScreen(void) {
+    static const char* level_names[HISTORY_LEVELS] = {"10S", "5MIN", "1H"};
+    const Host* host = selected_host();
+    
+    C2D_TargetClear(bottomScreen, COL_BG);
+    C2D_SceneBegin(bottomScreen);
+    
+    C2D_Text text;
+    char buf[64];
+    
+    // 历史图表 (功率 / 温度 / CPU，触摸切换时间跨度)
+    C2D_DrawRectSolid(8, 8, 0, 195, 88, COL_PANEL);
+    C2D_DrawRectSolid(8, 8, 0, 195, 2, COL_CYAN);
+    snprintf(buf, sizeof(buf), "HISTORY %s", level_names[g_chart_level]);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 12, 12, 0, 0.32f, 0.32f, COL_TEXT);
+    
+    snprintf(buf, sizeof(buf), "%.1fW", g_state->power_watts);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 96, 12, 0, 0.32f, 0.32f, COL_CYAN);
+    snprintf(buf, sizeof(buf), "%.0fC", g_state->cpu_temp);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 138, 12, 0, 0.32f, 0.32f, COL_ORANGE);
+    snprintf(buf, sizeof(buf), "%.0f%%", g_state->cpu_usage);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 170, 12, 0, 0.32f, 0.32f, COL_GREEN);
+    
+    DrawHistoryChart(host);
+    
+    // 频率
+    C2D_DrawRectSolid(212, 8, 0, 100, 42, COL_PANEL);
+    C2D_TextParse(&text, textBuf, "CORE CLOCK");
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 216, 12, 0, 0.28f, 0.28f, COL_TEXT);
+    snprintf(buf, sizeof(buf), "%.1f GHz", g_state->cpu_freq_mhz / 1000.0f);
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 218, 28, 0, 0.48f, 0.48f, COL_CYAN);
+    
+    C2D_DrawRectSolid(212, 54, 0, 100, 42, COL_PANEL);
+    C2D_TextParse(&text, textBuf, "HOST BATTERY");
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 216, 58, 0, 0.28f, 0.28f, COL_TEXT);
+    
+    u32 batCol = COL_GREEN;
+    if (g_state->battery_level < 20) batCol = C2D_Color32(0xFF, 0x40, 0x40, 0xFF); // Red
+    
+    if (g_state->battery_level >= 0) {
+        snprintf(buf, sizeof(buf), "%d%%", g_state->battery_level);
+        C2D_TextParse(&text, textBuf, buf);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, 218, 74, 0, 0.48f, 0.48f, batCol);
+        
+        // 状态图标/文字
+        const char* status = "";
+        bool is_charging = false;
+        
+        if (strstr(g_state->battery_status, "Charging")) {
+            status = "CHG";
+            is_charging = true;
+        } else if (strstr(g_state->battery_status, "Discharging")) {
+            status = "BAT";
+        } else if (strstr(g_state->battery_status, "Full")) {
+            status = "FULL";
+            is_charging = true; // Full usually implies connected
+        } else if (strstr(g_state->battery_status, "AC Attached")) {
+            status = "AC";
+            is_charging = true; // Connected to power
+        }
+        
+        // 覆盖颜色逻辑：如果充电中/接电源，不显示红色
+        if (is_charging) {
+            batCol = COL_GREEN;
+        }
+        
+        C2D_TextParse(&text, textBuf, status);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, 270, 78, 0, 0.35f, 0.35f, COL_TEXT);
+    } else {
+         C2D_TextParse(&text, textBuf, "N/A");
+         C2D_TextOptimize(&text);
+         C2D_DrawText(&text, C2D_WithColor, 218, 74, 0, 0.48f, 0.48f, COL_TEXT);
+    }
+    
+    // 模式按钮
+    const char* modes[] = {"TURBO", "SILENT", "CUSTOM", "CONFIG"};
+    for (int i = 0; i < 4; i++) {
+        float bx = 10 + i * 77;
+        bool sel = (g_state->current_mode == i);
+        u32 bg = sel ? C2D_Color32(0x00, 0x40, 0x60, 0xFF) : COL_PANEL;
+        u32 border = sel ? COL_CYAN : COL_PURPLE;
+        
+        C2D_DrawRectSolid(bx, 108, 0, 72, 52, bg);
+        C2D_DrawRectSolid(bx, 108, 0, 72, 2, border);
+        C2D_DrawRectSolid(bx, 158, 0, 72, 2, border);
+        C2D_DrawRectSolid(bx, 108, 0, 2, 52, border);
+        C2D_DrawRectSolid(bx + 70, 108, 0, 2, 52, border);
+        
+        C2D_TextParse(&text, textBuf, modes[i]);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, bx + 12, 128, 0, 0.42f, 0.42f, COL_TEXT);
+    }
+    
+    // 进程榜单 (CPU Top-5)
+    for (int i = 0; i < g_state->proc_count; i++) {
+        const char* name = host ? host_proc_name(host, g_state->proc_pid[i]) : NULL;
+        char pid_name[16];
+        if (!name) {
+            snprintf(pid_name, sizeof(pid_name), "PID %d", g_state->proc_pid[i]);
+            name = pid_name;
+        }
+        snprintf(buf, sizeof(buf), "%-18.18s %5.1f%% %6dM", name,
+                 g_state->proc_cpu10[i] / 10.0f, g_state->proc_rss_mb[i]);
+        C2D_TextParse(&text, textBuf, buf);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, 12, 164 + i * 10, 0, 0.3f, 0.3f, i == 0 ? COL_ORANGE : COL_TEXT);
+    }
+    
+    // 外部指标 (共享内存通道) 占用榜单剩余的行
+    for (int i = 0; i < g_state->gauge_count && g_state->proc_count + i < PROC_TOP; i++) {
+        snprintf(buf, sizeof(buf), "%-18.18s %13.1f", g_state->gauge_name[i], g_state->gauge_value[i]);
+        C2D_TextParse(&text, textBuf, buf);
+        C2D_TextOptimize(&text);
+        C2D_DrawText(&text, C2D_WithColor, 12, 164 + (g_state->proc_count + i) * 10, 0, 0.3f, 0.3f, COL_CYAN);
+    }
+    
+    // 状态栏
+    C2D_DrawRectSolid(0, 218, 0, 320, 22, COL_PANEL);
+    u32 dotCol = g_state->connected ? COL_GREEN : COL_ORANGE;
+    C2D_DrawCircleSolid(14, 229, 0, 4, dotCol);
+    
+    // 链路质量: 上个统计窗口的丢包率/乱序帧数，右侧为端到端延迟
+    // 多台主机时前缀为当前主机序号；有告警时改为显示第一条告警 (其余计数)
+    u32 statusCol = COL_TEXT;
+    if (host && g_state->connected && g_state->alert_count > 0) {
+        if (g_state->alert_count > 1) {
+            snprintf(buf, sizeof(buf), "ALERT %s %.1f (+%d)", g_state->alert_name[0],
+                     g_state->alert_value[0], g_state->alert_count - 1);
+        } else {
+            snprintf(buf, sizeof(buf), "ALERT %s %.1f", g_state->alert_name[0], g_state->alert_value[0]);
+        }
+        statusCol = COL_MAGENTA;
+    } else if (host && !g_state->connected) {
+        snprintf(buf, sizeof(buf), "RECONNECTING...");
+    } else if (host && g_hosts.count > 1) {
+        snprintf(buf, sizeof(buf), "HOST %d/%d // LOSS %.1f%% REORD %lu", g_selected + 1, g_hosts.count,
+                 host->link.loss_pct, (unsigned long)host->link.reorder_count);
+    } else if (host) {
+        snprintf(buf, sizeof(buf), "CONNECTED // LOSS %.1f%% REORD %lu",
+                 host->link.loss_pct, (unsigned long)host->link.reorder_count);
+    } else {
+        snprintf(buf, sizeof(buf), "SEARCHING...");
+    }
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 24, 223, 0, 0.35f, 0.35f, statusCol);
+    
+    if (host && host->link.have_latency) {
+        snprintf(buf, sizeof(buf), "%.0fms", host->link.latency_ms);
+    } else {
+        snprintf(buf, sizeof(buf), "--ms");
+    }
+    C2D_TextParse(&text, textBuf, buf);
+    C2D_TextOptimize(&text);
+    C2D_DrawText(&text, C2D_WithColor, 280, 223, 0, 0.35f, 0.35f, COL_PURPLE);
+}
+
 // ========================================
 // Main
 // ========================================
@@ -1077,8 +1741,21 @@ int main(int argc, char* argv[]) {
     // 创建文本缓冲
     textBuf = C2D_TextBufNew(2048);
     
-    // 初始化网络 (在图形之后)
+    app_state_defaults(&g_placeholder);
+    hosts_init(&g_hosts);
+    pacer_init(&g_pacer, osGetTime());
+    
+    // 初始化网络 (在图形之后)，立即发出第一轮探测 (优先单播给上次的服务端)，
+    // 回复在加载资源期间到达
     init_network();
+    load_cached_server();
+    discovery_init(&g_discovery, osGetTime(), (u32)osGetTime() ^ (g_net_init ? (u32)gethostid() : 0));
+    reasm_init(&g_reasm);
+    network_update(osGetTime());
+    
+    // 休眠唤醒时立即重连
+    aptHookCookie apt_cookie;
+    aptHook(&apt_cookie, on_apt_event, NULL);
     
     // Initialize RomFS
     g_romfs_rc = romfsInit();
@@ -1095,33 +1772,75 @@ int main(int argc, char* argv[]) {
     // 初始化 3D 资源
     init_3d();
     
-    int uptime_counter = 0;
-
+    // 下屏背光控制 (不可用时 SELECT 键无效)
+    bool lcd_ok = R_SUCCEEDED(gspLcdInit());
+    
+    u64 last_frame_ms = osGetTime();
+    C3D_FrameRate(pacer_fps(g_pacer.state));
     
     // 主循环
     while (aptMainLoop()) {
         hidScanInput();
+        u64 now = osGetTime();
+        // 距上一帧的时间，以 60 fps 的帧为单位 (动画按真实时间推进，降帧不改变速度)
+        float dt = (now - last_frame_ms) * 0.06f;
+        if (dt > 8.0f) dt = 8.0f;
+        last_frame_ms = now;
+        
         u32 kDown = hidKeysDown();
         if (kDown & KEY_START) break;
+        if (kDown | hidKeysHeld()) pacer_motion(&g_pacer, now);
+        
+        // SELECT: 开关下屏背光 (底座常亮显示时省电)，关闭期间不绘制下屏、不响应触摸
+        if ((kDown & KEY_SELECT) && lcd_ok) {
+            g_bottom_backlight = !g_bottom_backlight;
+            if (g_bottom_backlight) {
+                GSPLCD_PowerOnBacklight(GSPLCD_SCREEN_BOTTOM);
+                g_bottom_valid = false;
+            } else {
+                GSPLCD_PowerOffBacklight(GSPLCD_SCREEN_BOTTOM);
+            }
+        }
+        // Y: 帧率调试浮层
+        if (kDown & KEY_Y) g_debug_overlay = !g_debug_overlay;
+        
+        // D-pad 左右: 切换主机；上: 全部主机总览，下: 返回单机详情
+        if (g_hosts.count > 0) {
+            if (kDown & KEY_DRIGHT) select_host((g_selected + 1) % g_hosts.count);
+            if (kDown & KEY_DLEFT) select_host((g_selected + g_hosts.count - 1) % g_hosts.count);
+        }
+        if (kDown & KEY_DUP) g_overview = true;
+        if (kDown & KEY_DDOWN) g_overview = false;
         
         // 触摸处理
-        if (kDown & KEY_TOUCH) {
+        if ((kDown & KEY_TOUCH) && g_bottom_backlight) {
             touchPosition touch;
             hidTouchRead(&touch);
             
+            // 历史图表: 切换时间跨度 (10 秒 / 5 分钟 / 1 小时)
+            if (touch.px >= 8 && touch.px <= 203 && touch.py >= 8 && touch.py <= 96) {
+                g_chart_level = (g_chart_level + 1) % HISTORY_LEVELS;
+            }
+            
             // 检测按钮
             if (touch.py >= 110 && touch.py <= 160) {
                 for (int i = 0; i < 4; i++) {
                     float bx = 10 + i * 77;
                     if (touch.px >= bx && touch.px <= bx + 72) {
-                        if (g_state.current_mode != i) {
-                            g_state.current_mode = i;
+                        if (g_state->current_mode != i) {
+                            g_state->current_mode = i;
                             
-                            // 发送 FAN 命令到 server
-                            if (g_socket >= 0 && g_server_found) {
+                            // 发送 FAN 命令到当前主机的 server (中继不转发控制命令)
+                            const Host* host = selected_host();
+                            if (g_socket >= 0 && host && host->relay_id < 0) {
                                 const char* modes[] = {"FAN:TURBO", "FAN:SILENT", "FAN:CUSTOM", "FAN:AUTO"};
+                                struct sockaddr_in addr;
+                                memset(&addr, 0, sizeof(addr));
+                                addr.sin_family = AF_INET;
+                                addr.sin_addr.s_addr = host->ip;
+                                addr.sin_port = host->port;
                                 sendto(g_socket, modes[i], strlen(modes[i]), 0,
-                                       (struct sockaddr*)&g_server_addr, sizeof(g_server_addr));
+                                       (struct sockaddr*)&addr, sizeof(addr));
                             }
                         }
                         break;
@@ -1131,30 +1850,24 @@ int main(int argc, char* argv[]) {
         }
         
         // 更新网络
-        network_update();
+        network_update(now);
+        if (hosts_apply(now) >= PACE_MOTION_PX * dt) pacer_motion(&g_pacer, now);
         
-        // 更新时间
-        uptime_counter++;
-        if (uptime_counter >= 60) {
-            uptime_counter = 0;
-            g_state.uptime_seconds++;
+        // 帧率档位: 画面在动时全速，静止 30 fps，数据过期 15 fps
+        if (pacer_update(&g_pacer, now)) {
+            C3D_FrameRate(pacer_fps(g_pacer.state));
         }
         
         // 更新动画
-        g_frame++;
-        float rpm_factor = (g_state.fan_rpm > 0) ? g_state.fan_rpm / 3000.0f : 0.5f;
+        float rpm_factor = (g_state->fan_rpm > 0) ? g_state->fan_rpm / 3000.0f : 0.5f;
         // Slower base, steeper curve for high RPM
-        g_fan_angle -= 0.005f + rpm_factor * 0.08f;
+        g_fan_angle -= (0.005f + rpm_factor * 0.08f) * dt;
         
         // Cat Animation Speed based on CPU Usage
         // Base speed + cpu dependent speed
-        float cpu_factor = g_state.cpu_usage / 100.0f; // 0.0 to 1.0
+        float cpu_factor = g_state->cpu_usage / 100.0f; // 0.0 to 1.0
         float cat_speed = 0.05f + cpu_factor * 0.5f; // Min 0.05, Max 0.55 per frame
-        g_cat_anim_frame += cat_speed;
-        
-        // 更新功率历史
-        g_power_history[g_power_idx] = g_state.power_watts;
-        g_power_idx = (g_power_idx + 1) % POWER_HISTORY_SIZE;
+        g_cat_anim_frame += cat_speed * dt;
         
         // 获取3D滑块值 (0.0 - 1.0)
         float slider = osGet3DSliderState();
@@ -1162,7 +1875,7 @@ int main(int argc, char* argv[]) {
         float iod = slider * 0.06f; // 3D Interocular distance
 
         // 更新 3D 几何
-        update_3d_geometry();
+        update_3d_geometry(now);
 
         // ===== 渲染 =====
         C3D_FrameBegin(C3D_FRAME_SYNCDRAW);
@@ -1191,159 +1904,56 @@ int main(int argc, char* argv[]) {
         
         // 3. FG Layer
         DrawTopScreen(-base_offset, 1);
+        if (g_debug_overlay) DrawPacingOverlay();
         
         // === 右眼 ===
-        // 1. BG Layer
-        // Use C2D_TargetClear for correct color format
-        C2D_TargetClear(topScreenRight, COL_BG);
-        // Clear Depth to 0
-        C3D_RenderTargetClear(topScreenRight, C3D_CLEAR_DEPTH, 0, 0);
-        C2D_SceneBegin(topScreenRight);
-
-
-
-        
-        DrawTopScreen(base_offset, 0);
-        C3D_DepthTest(false, GPU_ALWAYS, 0); // BG: No Depth Write
-        C2D_Flush();
-
-        
-        // 2. 3D Pass
-
-        render_3d_view(iod);
-        
-        // 3. FG Layer
-        DrawTopScreen(base_offset, 1);
-        
-        // === 下屏 (2D) ===
-
-
-        C2D_TargetClear(bottomScreen, COL_BG);
-        C2D_SceneBegin(bottomScreen);
-        
-        C2D_Text text;
-        char buf[64];
-        
-        // 功率图
-        C2D_DrawRectSolid(8, 8, 0, 195, 88, COL_PANEL);
-        C2D_DrawRectSolid(8, 8, 0, 195, 2, COL_CYAN);
-        C2D_TextParse(&text, textBuf, "POWER CONSUMPTION (W)");
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 12, 12, 0, 0.32f, 0.32f, COL_CYAN);
-        
-        snprintf(buf, sizeof(buf), "%.1fW", g_state.power_watts);
-        C2D_TextParse(&text, textBuf, buf);
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 130, 12, 0, 0.32f, 0.32f, COL_GREEN);
-        
-        // 波形
-        float maxP = 50.0f;
-        for (int i = 0; i < POWER_HISTORY_SIZE - 1; i++) {
-            int idx = (g_power_idx + i) % POWER_HISTORY_SIZE;
-            int nxt = (g_power_idx + i + 1) % POWER_HISTORY_SIZE;
-            float x1 = 15 + i * 3.5f;
-            float x2 = 15 + (i + 1) * 3.5f;
-            float v1 = g_power_history[idx];
-            float v2 = g_power_history[nxt];
-            if (v1 < 1) v1 = 10 + 5 * sinf((i + g_frame) * 0.1f);
-            if (v2 < 1) v2 = 10 + 5 * sinf((i + 1 + g_frame) * 0.1f);
-            float y1 = 85 - (v1 / maxP) * 55;
-            float y2 = 85 - (v2 / maxP) * 55;
-            C2D_DrawLine(x1, y1, COL_CYAN, x2, y2, COL_CYAN, 2, 0);
+        // 3D 滑块为 0 时只显示左眼画面，跳过右眼渲染
+        if (slider > 0.0f) {
+            // 1. BG Layer
+            // Use C2D_TargetClear for correct color format
+            C2D_TargetClear(topScreenRight, COL_BG);
+            // Clear Depth to 0
+            C3D_RenderTargetClear(topScreenRight, C3D_CLEAR_DEPTH, 0, 0);
+            C2D_SceneBegin(topScreenRight);
+
+            DrawTopScreen(base_offset, 0);
+            C3D_DepthTest(false, GPU_ALWAYS, 0); // BG: No Depth Write
+            C2D_Flush();
+
+            // 2. 3D Pass
+            render_3d_view(iod);
+
+            // 3. FG Layer
+            DrawTopScreen(base_offset, 1);
+            if (g_debug_overlay) DrawPacingOverlay();
         }
         
-        // 频率
-        C2D_DrawRectSolid(212, 8, 0, 100, 42, COL_PANEL);
-        C2D_TextParse(&text, textBuf, "CORE CLOCK");
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 216, 12, 0, 0.28f, 0.28f, COL_TEXT);
-        snprintf(buf, sizeof(buf), "%.1f GHz", g_state.cpu_freq_mhz / 1000.0f);
-        C2D_TextParse(&text, textBuf, buf);
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 218, 28, 0, 0.48f, 0.48f, COL_CYAN);
-        
-        C2D_DrawRectSolid(212, 54, 0, 100, 42, COL_PANEL);
-        C2D_TextParse(&text, textBuf, "HOST BATTERY");
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 216, 58, 0, 0.28f, 0.28f, COL_TEXT);
-        
-        u32 batCol = COL_GREEN;
-        if (g_state.battery_level < 20) batCol = C2D_Color32(0xFF, 0x40, 0x40, 0xFF); // Red
-        
-        if (g_state.battery_level >= 0) {
-            snprintf(buf, sizeof(buf), "%d%%", g_state.battery_level);
-            C2D_TextParse(&text, textBuf, buf);
-            C2D_TextOptimize(&text);
-            C2D_DrawText(&text, C2D_WithColor, 218, 74, 0, 0.48f, 0.48f, batCol);
-            
-            // 状态图标/文字
-            const char* status = "";
-            bool is_charging = false;
-            
-            if (strstr(g_state.battery_status, "Charging")) {
-                status = "CHG";
-                is_charging = true;
-            } else if (strstr(g_state.battery_status, "Discharging")) {
-                status = "BAT";
-            } else if (strstr(g_state.battery_status, "Full")) {
-                status = "FULL";
-                is_charging = true; // Full usually implies connected
-            } else if (strstr(g_state.battery_status, "AC Attached")) {
-                status = "AC";
-                is_charging = true; // Connected to power
-            }
-            
-            // 覆盖颜色逻辑：如果充电中/接电源，不显示红色
-            if (is_charging) {
-                batCol = COL_GREEN;
+        // === 下屏 (2D) ===
+        // 内容不变时不重绘 (屏幕保持上一帧画面)，背光关闭时不绘制
+        bool bottom_drawn = false;
+        if (g_bottom_backlight) {
+            BottomView view;
+            bottom_view(&view);
+            if (!g_bottom_valid || memcmp(&view, &g_bottom_last, sizeof(view)) != 0) {
+                memcpy(&g_bottom_last, &view, sizeof(view));
+                g_bottom_valid = true;
+                DrawBottomScreen();
+                bottom_drawn = true;
             }
-            
-            C2D_TextParse(&text, textBuf, status);
-            C2D_TextOptimize(&text);
-            C2D_DrawText(&text, C2D_WithColor, 270, 78, 0, 0.35f, 0.35f, COL_TEXT);
-        } else {
-             C2D_TextParse(&text, textBuf, "N/A");
-             C2D_TextOptimize(&text);
-             C2D_DrawText(&text, C2D_WithColor, 218, 74, 0, 0.48f, 0.48f, COL_TEXT);
-        }
-        
-        // 模式按钮
-        const char* modes[] = {"TURBO", "SILENT", "CUSTOM", "CONFIG"};
-        for (int i = 0; i < 4; i++) {
-            float bx = 10 + i * 77;
-            bool sel = (g_state.current_mode == i);
-            u32 bg = sel ? C2D_Color32(0x00, 0x40, 0x60, 0xFF) : COL_PANEL;
-            u32 border = sel ? COL_CYAN : COL_PURPLE;
-            
-            C2D_DrawRectSolid(bx, 108, 0, 72, 52, bg);
-            C2D_DrawRectSolid(bx, 108, 0, 72, 2, border);
-            C2D_DrawRectSolid(bx, 158, 0, 72, 2, border);
-            C2D_DrawRectSolid(bx, 108, 0, 2, 52, border);
-            C2D_DrawRectSolid(bx + 70, 108, 0, 2, 52, border);
-            
-            C2D_TextParse(&text, textBuf, modes[i]);
-            C2D_TextOptimize(&text);
-            C2D_DrawText(&text, C2D_WithColor, bx + 12, 128, 0, 0.42f, 0.42f, COL_TEXT);
         }
-        
-        // 状态栏
-        C2D_DrawRectSolid(0, 218, 0, 320, 22, COL_PANEL);
-        u32 dotCol = g_state.connected ? COL_GREEN : COL_ORANGE;
-        C2D_DrawCircleSolid(14, 229, 0, 4, dotCol);
-        
-        const char* status = g_state.connected ? "CONNECTED // UDP:9001" : "SEARCHING...";
-        C2D_TextParse(&text, textBuf, status);
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 24, 223, 0, 0.35f, 0.35f, COL_TEXT);
-        
-        C2D_TextOptimize(&text);
-        C2D_DrawText(&text, C2D_WithColor, 280, 223, 0, 0.35f, 0.35f, COL_PURPLE);
+        pacer_frame(&g_pacer, bottom_drawn, now);
         
         C3D_FrameEnd(0);
     }
     
     // 清理
     // 清理
+    aptUnhook(&apt_cookie);
+    if (lcd_ok) {
+        // 退出前恢复下屏背光
+        if (!g_bottom_backlight) GSPLCD_PowerOnBacklight(GSPLCD_SCREEN_BOTTOM);
+        gspLcdExit();
+    }
     if (g_spriteSheet) C2D_SpriteSheetFree(g_spriteSheet);
     cleanup_network();
     romfsExit();
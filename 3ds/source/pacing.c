@@ -0,0 +1,67 @@
+/**
+ * 自适应帧率 (见 pacing.h)
+ */
+
+#include "pacing.h"
+#include <string.h>
+
+void pacer_init(Pacer* p, uint64_t now_ms) {
+    memset(p, 0, sizeof(*p));
+    p->state = PACE_ACTIVE;
+    p->last_motion_ms = now_ms;
+    p->window_start_ms = now_ms;
+}
+
+void pacer_motion(Pacer* p, uint64_t now_ms) {
+    p->last_motion_ms = now_ms;
+}
+
+void pacer_data(Pacer* p, uint64_t now_ms) {
+    p->last_data_ms = now_ms;
+}
+
+bool pacer_update(Pacer* p, uint64_t now_ms) {
+    PaceState next;
+    if (now_ms - p->last_motion_ms < PACE_ACTIVE_HOLD_MS) {
+        // 输入优先于数据状态: 断线时操作界面也应流畅
+        next = PACE_ACTIVE;
+    } else if (p->last_data_ms == 0 || now_ms - p->last_data_ms >= PACE_STALE_MS) {
+        next = PACE_STALE;
+    } else {
+        next = PACE_IDLE;
+    }
+
+    bool changed = next != p->state;
+    p->state = next;
+    return changed;
+}
+
+void pacer_frame(Pacer* p, bool bottom_drawn, uint64_t now_ms) {
+    p->frames++;
+    if (bottom_drawn) p->bottom_frames++;
+
+    uint64_t elapsed = now_ms - p->window_start_ms;
+    if (elapsed >= PACE_STATS_WINDOW_MS) {
+        p->fps = p->frames * 1000.0f / elapsed;
+        p->bottom_fps = p->bottom_frames * 1000.0f / elapsed;
+        p->frames = 0;
+        p->bottom_frames = 0;
+        p->window_start_ms = now_ms;
+    }
+}
+
+int pacer_fps(PaceState state) {
+    switch (state) {
+        case PACE_ACTIVE: return 60;
+        case PACE_IDLE: return 30;
+        default: return 15;
+    }
+}
+
+const char* pacer_name(PaceState state) {
+    switch (state) {
+        case PACE_ACTIVE: return "ACTIVE";
+        case PACE_IDLE: return "IDLE";
+        default: return "STALE";
+    }
+}
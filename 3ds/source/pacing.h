@@ -0,0 +1,56 @@
+/**
+ * 自适应帧率
+ *
+ * 显示值变化或有输入时全速渲染，画面静止时降到 30 fps，数据过期 (断线/服务端停推)
+ * 时降到 15 fps。动画按真实时间推进，降帧不改变动画速度。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef PACING_H
+#define PACING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 最后一次变化后保持全速的时间 (毫秒)
+#define PACE_ACTIVE_HOLD_MS 500
+// 超过该时间没有新数据视为过期 (毫秒)
+#define PACE_STALE_MS 3000
+// 帧率统计窗口 (毫秒)
+#define PACE_STATS_WINDOW_MS 1000
+
+typedef enum {
+    PACE_ACTIVE,    // 60 fps
+    PACE_IDLE,      // 30 fps
+    PACE_STALE,     // 15 fps
+} PaceState;
+
+typedef struct {
+    PaceState state;
+    uint64_t last_motion_ms;
+    uint64_t last_data_ms;
+
+    // 调试浮层: 上一个统计窗口的实际帧率
+    uint64_t window_start_ms;
+    uint32_t frames, bottom_frames;
+    float fps, bottom_fps;
+} Pacer;
+
+void pacer_init(Pacer* p, uint64_t now_ms);
+
+// 显示值变化或有用户输入
+void pacer_motion(Pacer* p, uint64_t now_ms);
+
+// 收到一帧新数据
+void pacer_data(Pacer* p, uint64_t now_ms);
+
+// 根据最近的变化与数据时间决定状态；返回 true 表示状态改变 (需要重设帧率)
+bool pacer_update(Pacer* p, uint64_t now_ms);
+
+// 记录一帧渲染 (bottom_drawn: 本帧是否重绘了下屏)
+void pacer_frame(Pacer* p, bool bottom_drawn, uint64_t now_ms);
+
+int pacer_fps(PaceState state);
+const char* pacer_name(PaceState state);
+
+#endif
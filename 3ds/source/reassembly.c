@@ -0,0 +1,120 @@
+/**
+ * 分片帧重组 (见 reassembly.h)
+ */
+
+#include "reassembly.h"
+#include <string.h>
+
+void reasm_init(Reassembler* r) {
+    memset(r, 0, sizeof(*r));
+}
+
+static uint16_t read_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+bool reasm_is_datagram(const uint8_t* buf, int len) {
+    return len >= REASM_HEADER_LEN && buf[0] == REASM_MARKER;
+}
+
+bool reasm_header(const uint8_t* buf, int len, DatagramHeader* h) {
+    if (!reasm_is_datagram(buf, len) || buf[1] != REASM_VERSION) return false;
+    h->frame = read_u16(buf + 2);
+    h->count = buf[4];
+    h->index = buf[5];
+    h->first = buf[6];
+    h->parts = buf[7];
+    h->offset = read_u16(buf + 8);
+    // 位图按 32 位记录，一个块最多 32 个数据报
+    return h->parts >= 1 && h->parts <= 32 && h->index < h->count &&
+           h->first <= h->index && h->index - h->first < h->parts && h->first + h->parts <= h->count;
+}
+
+static bool same_chunk(const ReasmSlot* s, uint32_t ip, uint16_t port, const DatagramHeader* h) {
+    return s->ip == ip && s->port == port && s->key.frame == h->frame && s->key.count == h->count &&
+           s->key.first == h->first && s->key.parts == h->parts;
+}
+
+// 找到块所在的槽位，没有则新开一个: 先用空闲槽位，其次已交出的块，最后挤掉最早开始的块
+static ReasmSlot* find_slot(Reassembler* r, uint32_t ip, uint16_t port, const DatagramHeader* h, uint64_t now_ms) {
+    ReasmSlot* free_slot = NULL;
+    ReasmSlot* oldest = NULL;
+    for (int i = 0; i < REASM_SLOTS; i++) {
+        ReasmSlot* s = &r->slots[i];
+        if (s->used && now_ms - s->started_ms >= REASM_TIMEOUT_MS) {
+            s->used = false;
+            if (!s->done) r->expired++;
+        }
+        if (!s->used) {
+            if (!free_slot) free_slot = s;
+            continue;
+        }
+        if (same_chunk(s, ip, port, h)) return s;
+        if (!oldest || s->done > oldest->done ||
+            (s->done == oldest->done && s->started_ms < oldest->started_ms)) {
+            oldest = s;
+        }
+    }
+    ReasmSlot* s = free_slot;
+    if (!s) {
+        s = oldest;
+        if (!s->done) r->expired++;
+    }
+    s->used = true;
+    s->done = false;
+    s->ip = ip;
+    s->port = port;
+    s->key = *h;
+    s->have = 0;
+    s->length = -1;
+    s->started_ms = now_ms;
+    return s;
+}
+
+bool reasm_push(Reassembler* r, uint32_t ip, uint16_t port, uint8_t* buf, int len, uint64_t now_ms, ReasmChunk* out) {
+    DatagramHeader h;
+    r->datagrams++;
+    if (!reasm_header(buf, len, &h)) {
+        r->invalid++;
+        return false;
+    }
+    uint8_t* payload = buf + REASM_HEADER_LEN;
+    int payload_len = len - REASM_HEADER_LEN;
+    out->count = h.count;
+    out->first = h.first;
+    out->parts = h.parts;
+
+    // 单数据报的块: 负载就是完整的 JSON 对象
+    if (h.parts == 1) {
+        if (h.offset != 0) {
+            r->invalid++;
+            return false;
+        }
+        payload[payload_len] = '\0';
+        out->json = (const char*)payload;
+        r->chunks++;
+        return true;
+    }
+
+    if (h.offset + payload_len > REASM_MAX_BYTES) {
+        r->invalid++;
+        return false;
+    }
+    ReasmSlot* s = find_slot(r, ip, port, &h, now_ms);
+    uint32_t bit = 1u << (h.index - h.first);
+    if (s->have & bit) {
+        r->duplicates++;
+        return false;
+    }
+    s->have |= bit;
+    memcpy(s->data + h.offset, payload, payload_len);
+    if (h.index == h.first + h.parts - 1) s->length = h.offset + payload_len;
+
+    uint32_t all = h.parts == 32 ? 0xFFFFFFFFu : (1u << h.parts) - 1;
+    if (s->have != all || s->length < 0) return false;
+    s->data[s->length] = '\0';
+    s->done = true;
+    out->json = s->data;
+    r->chunks++;
+    return true;
+}
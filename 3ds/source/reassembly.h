@@ -0,0 +1,90 @@
+/**
+ * 分片帧重组
+ *
+ * 客户端发送 MTU <字节数> 后，服务端把超过该大小的消息按顶层字段拆成若干个块，每个块本身是
+ * 完整的 JSON 对象 (都带 seq/sample_ms，中继消息还带 host)，可以单独解码；单个字段仍然放不下时，
+ * 该块再按字节切成连续的几个数据报。每个数据报带 10 字节头部 (小端，见 server/src/datagram.rs):
+ *
+ *    0  u8   0xFD 标记
+ *    1  u8   版本 (1)
+ *    2  u16  frame   帧号 (服务端每打包一条消息加一)
+ *    4  u8   count   本帧数据报数
+ *    5  u8   index   本数据报序号
+ *    6  u8   first   所在块的第一个数据报序号
+ *    7  u8   parts   所在块的数据报数 (1 = 负载本身就是完整的 JSON 对象)
+ *    8  u16  offset  负载在块中的字节偏移
+ *
+ * 单数据报的块直接交给调用方；跨数据报的块在固定数量的槽位中拼接，收齐后交出。
+ * 槽位满时先复用已交出的块，再挤掉最早开始的块，超时未收齐的块丢弃，内存占用固定。
+ * 丢一个数据报只影响它所在的块，同一帧的其他块照常显示。
+ * 不依赖 libctru，可在主机上单独编译测试
+ */
+
+#ifndef REASSEMBLY_H
+#define REASSEMBLY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define REASM_MARKER 0xFD
+#define REASM_VERSION 1
+#define REASM_HEADER_LEN 10
+// 同时拼接的块数 (多台主机经中继转发时各占一个)
+#define REASM_SLOTS 4
+// 单个块的上限 (字节)，超过的块丢弃；服务端按同一上限 (datagram::MAX_CHUNK_BYTES) 不发送更大的块
+#define REASM_MAX_BYTES 8192
+// 块的第一个数据报到达后超过该时间仍未收齐则丢弃 (毫秒)
+#define REASM_TIMEOUT_MS 500
+
+typedef struct {
+    uint16_t frame;
+    uint8_t count;
+    uint8_t index;
+    uint8_t first;
+    uint8_t parts;
+    uint16_t offset;
+} DatagramHeader;
+
+typedef struct {
+    bool used;
+    bool done;               // 已交出 (保留到超时，用来识别迟到的重复数据报)
+    uint32_t ip;
+    uint16_t port;
+    DatagramHeader key;      // frame/count/first/parts 标识一个块
+    uint32_t have;           // 已收到的数据报 (按 index - first 的位图)
+    int length;              // 收到最后一个数据报后得知的块长度，之前为 -1
+    uint64_t started_ms;
+    char data[REASM_MAX_BYTES + 1];
+} ReasmSlot;
+
+// 解出的块: json 在下一次 reasm_push 之前有效
+typedef struct {
+    const char* json;
+    uint8_t count;
+    uint8_t first;
+    uint8_t parts;
+} ReasmChunk;
+
+typedef struct {
+    ReasmSlot slots[REASM_SLOTS];
+    // 统计 (累计)
+    uint32_t datagrams;
+    uint32_t chunks;         // 交出的块
+    uint32_t expired;        // 超时或被挤出而丢弃的未完成块
+    uint32_t duplicates;
+    uint32_t invalid;        // 头部非法或块超过上限
+} Reassembler;
+
+void reasm_init(Reassembler* r);
+
+// 是否为分片帧的数据报
+bool reasm_is_datagram(const uint8_t* buf, int len);
+
+// 解析并校验头部
+bool reasm_header(const uint8_t* buf, int len, DatagramHeader* h);
+
+// 处理一个数据报 (buf[len] 必须可写，用于单数据报块的 '\0' 结尾)；
+// 返回 true 表示解出一个完整的块
+bool reasm_push(Reassembler* r, uint32_t ip, uint16_t port, uint8_t* buf, int len, uint64_t now_ms, ReasmChunk* out);
+
+#endif
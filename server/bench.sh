@@ -0,0 +1,59 @@
+#!/bin/bash
+
+# 3D 全息仪表盘 - 服务端基准测试脚本
+# 基于 criterion 的命名基线:
+#   ./bench.sh save  [基线名]   运行全部基准并保存为基线 (默认 main)
+#   ./bench.sh check [基线名]   与基线比较，任一基准均值变慢超过阈值时返回非零
+# 环境变量:
+#   BENCH_THRESHOLD  回归阈值 (相对变化，默认 0.10 即 10%)
+#   BENCH_FILTER     只运行名称匹配的基准 (criterion 过滤表达式)
+# 基线保存在 target/criterion/<基准>/<基线名>/，全部离线运行 (首次运行前需 cargo fetch)
+
+set -e
+
+# 颜色定义
+GREEN='\033[0;32m'
+BLUE='\033[0;34m'
+RED='\033[0;31m'
+NC='\033[0m' # No Color
+
+MODE="${1:-check}"
+BASELINE="${2:-main}"
+THRESHOLD="${BENCH_THRESHOLD:-0.10}"
+CRITERION_DIR="target/criterion"
+
+case "$MODE" in
+    save)
+        echo -e "${BLUE}📏 运行基准测试并保存基线: ${BASELINE}${NC}"
+        cargo bench --offline -- --save-baseline "$BASELINE" $BENCH_FILTER
+        echo -e "${GREEN}✅ 基线已保存到 ${CRITERION_DIR}/*/${BASELINE}/${NC}"
+        ;;
+    check)
+        echo -e "${BLUE}📏 与基线 ${BASELINE} 比较 (阈值 +$(awk "BEGIN { print $THRESHOLD * 100 }")%)${NC}"
+        # 只检查本次运行写出的比较结果
+        MARKER=$(mktemp)
+        trap 'rm -f "$MARKER"' EXIT
+        cargo bench --offline -- --baseline "$BASELINE" $BENCH_FILTER
+
+        REGRESSED=0
+        while IFS= read -r estimates; do
+            # change/estimates.json 中第一个 point_estimate 为均值的相对变化
+            change=$(grep -o '"point_estimate":[-0-9.eE+]*' "$estimates" | head -1 | cut -d: -f2)
+            name=${estimates#"$CRITERION_DIR/"}
+            name=${name%/change/estimates.json}
+            if awk "BEGIN { exit !($change > $THRESHOLD) }"; then
+                echo -e "${RED}❌ 回归: ${name} $(awk "BEGIN { printf \"%+.1f%%\", $change * 100 }")${NC}"
+                REGRESSED=1
+            fi
+        done < <(find "$CRITERION_DIR" -path '*/change/estimates.json' -newer "$MARKER")
+
+        if [ "$REGRESSED" -ne 0 ]; then
+            exit 1
+        fi
+        echo -e "${GREEN}✅ 没有超过阈值的回归${NC}"
+        ;;
+    *)
+        echo "用法: $0 {save|check} [基线名]"
+        exit 1
+        ;;
+esac
@@ -0,0 +1,181 @@
+//! 告警引擎基准测试
+//!
+//! 规则轮流使用 8 种信号 (当前值、EWMA、滑动最小/最大值、分位数、变化率、降频):
+//! - observe/N: N 条规则 (1 .. 1000)，阈值都在信号取值范围之外 (常态: 没有告警状态变化)。
+//!   每帧耗时只随去重后的信号数变化，与规则数基本无关
+//! - crossing/N: 阈值均匀分布在信号取值范围内，每帧都有规则被信号的变化跨过。
+//!   耗时与产生的告警事件数成正比 (每个事件一次检查和一次推送)
+//! - stats: 各统计量单独加入一个样本的耗时
+//!
+//! 输入是预先生成的 5 分钟 (100ms 间隔) 指标序列，结束时打印各规则数下的告警事件数。
+//! 计时前先断言: 阈值跨过信号取值范围的 above/below 规则，按阈值索引跳过的检查与逐条检查全部规则
+//! ([`AlertEngine::exhaustive`]) 每帧产生完全相同的事件
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use holographic_monitor::{
+    alerts::{AlertEngine, AlertEvent, Metric, RuleSpec, SignalSpec},
+    monitor::{Backend, SystemMetrics},
+    streamstats::{Ewma, QuantileSketch, SlidingExtreme, SlidingRate},
+    synthetic::SyntheticBackend,
+};
+use std::time::Duration;
+
+/// 低于该相对变化的差异视为噪声 (criterion 不报告为回归)
+const NOISE_THRESHOLD: f64 = 0.03;
+/// 推送间隔
+const PERIOD: Duration = Duration::from_millis(100);
+/// 预生成的帧数 (5 分钟)
+const FRAMES: usize = 3000;
+
+/// 信号模板与其取值范围
+fn templates() -> [(SignalSpec, f32, f32); 8] {
+    [
+        (SignalSpec::Value { metric: Metric::CpuUsage }, 0.0, 100.0),
+        (SignalSpec::Ewma { metric: Metric::CpuUsage, half_life_s: 5.0 }, 0.0, 100.0),
+        (SignalSpec::Min { metric: Metric::CpuTemp, window_s: 30.0 }, 40.0, 100.0),
+        (SignalSpec::Max { metric: Metric::CpuTemp, window_s: 10.0 }, 40.0, 100.0),
+        (SignalSpec::Percentile { metric: Metric::CpuUsage, q: 0.9, window_s: 60.0 }, 0.0, 100.0),
+        (SignalSpec::Rate { metric: Metric::MemoryUsed, window_s: 60.0 }, -5.0, 5.0),
+        (SignalSpec::Throttle { temp_c: 85.0, window_s: 10.0 }, 0.0, 50.0),
+        (SignalSpec::Value { metric: Metric::PowerScore }, 0.0, 30.0),
+    ]
+}
+
+/// `count` 条规则，轮流使用各信号模板，阈值在模板范围内均匀分布；
+/// `offset` 把全部阈值平移到范围之外
+fn rules(count: usize, offset: f32) -> Vec<RuleSpec> {
+    let templates = templates();
+    let per_template = count.div_ceil(templates.len()) as f32;
+    (0..count)
+        .map(|i| {
+            let (signal, lo, hi) = templates[i % templates.len()];
+            let slot = (i / templates.len()) as f32;
+            RuleSpec {
+                name: format!("rule_{}", i),
+                signal,
+                above: Some(lo + (hi - lo) * (slot + 0.5) / per_template + offset),
+                below: None,
+                hysteresis: (hi - lo) * 0.02,
+            }
+        })
+        .collect()
+}
+
+/// 5 分钟的指标序列: CPU 使用率快速波动，温度缓慢起伏，高温时降频，内存缓慢增长
+fn frames() -> Vec<SystemMetrics> {
+    let template = SyntheticBackend::new(Duration::ZERO).refresh();
+    (0..FRAMES)
+        .map(|i| {
+            let t = i as f32;
+            let mut m = template.clone();
+            m.seq = i as u64;
+            m.sample_ms = i as u64 * PERIOD.as_millis() as u64;
+            m.cpu_usage = (50.0 + 45.0 * (t * 0.05).sin() + 5.0 * (t * 1.3).sin()).clamp(0.0, 100.0);
+            let temp = 70.0 + 25.0 * (t * 0.01).sin();
+            m.cpu_temp = Some(temp);
+            m.cpu_frequency_mhz = if temp > 88.0 { 2000 } else { 3500 };
+            m.memory_used = 8000 + (t * 0.2 + 300.0 * (t * 0.003).sin()) as u64;
+            m.power_score = Some(15.0 + 12.0 * (t * 0.02).sin());
+            m
+        })
+        .collect()
+}
+
+/// 阈值索引与逐条检查的事件逐帧一致 (一半规则改为 below，覆盖两个方向的触发与解除；
+/// 另加阈值等于某帧信号值的规则，覆盖区间端点)
+fn check_index(frames: &[SystemMetrics]) {
+    for count in [10usize, 1000] {
+        let mut specs = rules(count, 0.0);
+        for spec in specs.iter_mut().skip(1).step_by(2) {
+            spec.below = spec.above.take();
+        }
+        // 阈值恰好等于某一帧的信号值 (落在索引区间的端点上)
+        specs.extend(frames.iter().step_by(97).enumerate().map(|(k, frame)| RuleSpec {
+            name: format!("exact_{}", k),
+            signal: SignalSpec::Value { metric: Metric::CpuUsage },
+            above: Some(frame.cpu_usage),
+            below: None,
+            hysteresis: 0.0,
+        }));
+        let mut indexed = AlertEngine::new(&specs, PERIOD).unwrap();
+        let mut exhaustive = AlertEngine::new(&specs, PERIOD).unwrap().exhaustive();
+        let (mut expected, mut actual) = (Vec::new(), Vec::new());
+        let mut total = 0;
+        for (i, frame) in frames.iter().enumerate() {
+            expected.clear();
+            actual.clear();
+            exhaustive.observe(frame, &mut expected);
+            indexed.observe(frame, &mut actual);
+            assert_eq!(actual, expected, "{} 条规则第 {} 帧: 阈值索引与逐条检查的告警事件不一致", specs.len(), i);
+            total += expected.len();
+        }
+        println!("alerts/index/{}: {} 帧共 {} 个告警事件，与逐条检查一致", specs.len(), frames.len(), total);
+    }
+}
+
+fn bench_observe(c: &mut Criterion) {
+    let frames = frames();
+    check_index(&frames);
+    for (name, offset) in [("observe", 1000.0), ("crossing", 0.0)] {
+        observe_group(c, &frames, name, offset);
+    }
+}
+
+fn observe_group(c: &mut Criterion, frames: &[SystemMetrics], name: &str, offset: f32) {
+    let mut group = c.benchmark_group(format!("alerts/{}", name));
+    let mut summary = Vec::new();
+    for count in [1usize, 10, 100, 1000] {
+        let specs = rules(count, offset);
+        let mut engine = AlertEngine::new(&specs, PERIOD).unwrap();
+        let mut events: Vec<AlertEvent> = Vec::new();
+        let mut next = 0;
+        let mut total_events = 0;
+        group.bench_with_input(BenchmarkId::from_parameter(count), &count, |b, _| {
+            b.iter(|| {
+                events.clear();
+                engine.observe(&frames[next % FRAMES], &mut events);
+                total_events += events.len();
+                next += 1;
+            })
+        });
+        summary.push((count, engine.signal_count(), next, total_events));
+    }
+    group.finish();
+    for (count, signals, ticks, events) in summary {
+        println!("alerts/{}/{}: {} 个信号，{} 帧共 {} 个告警事件", name, count, signals, ticks, events);
+    }
+}
+
+fn bench_stats(c: &mut Criterion) {
+    let window = 600;
+    let mut group = c.benchmark_group("alerts/stats");
+    let mut x = 0.0f32;
+    let mut step = || {
+        x = (x + 7.3) % 100.0;
+        x
+    };
+
+    let mut ewma = Ewma::with_half_life(50.0);
+    group.bench_function("ewma", |b| b.iter(|| ewma.push(step())));
+    let mut extreme = SlidingExtreme::max(window);
+    group.bench_function("sliding_max", |b| b.iter(|| extreme.push(step())));
+    let mut rate = SlidingRate::new(window);
+    let mut t = 0u64;
+    group.bench_function("rate", |b| {
+        b.iter(|| {
+            t += 100;
+            rate.push(t, step())
+        })
+    });
+    let mut sketch = QuantileSketch::new(window);
+    group.bench_function("sketch_push", |b| b.iter(|| sketch.push(step())));
+    group.bench_function("sketch_p95", |b| b.iter(|| sketch.quantile(0.95)));
+    group.finish();
+}
+
+criterion_group! {
+    name = benches;
+    config = Criterion::default().noise_threshold(NOISE_THRESHOLD);
+    targets = bench_observe, bench_stats
+}
+criterion_main!(benches);
@@ -0,0 +1,130 @@
+//! cgroup 与 PSI 采集基准测试
+//!
+//! 在临时生成的 cgroup v2 夹具树上测量单次采样开销: 4 个 slice，每个 slice 下 N/4 个
+//! 服务组，每个组带完整的 `cpu.stat`、`memory.current`、`io.stat` (两块设备) 和三个 PSI 文件，
+//! 以及采集器不读取的其他接口文件 (遍历时需要跳过)。每 10 次采样的目录遍历计入平均开销。
+//! 夹具是普通文件，不含内核生成 cgroup 文件内容的开销；在 Linux 上额外测量真实 `/` 的开销
+//! (混合模式的 unified 层级通常没有启用控制器，只有 `cpu.stat` 与 PSI 文件)。
+//!
+//! 计时前先断言 Top-N 只列出叶子组: slice 与其下的服务组一起增长时，只有服务组出现在报告中
+
+#[cfg(unix)]
+mod common;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+
+#[cfg(unix)]
+use common::write;
+#[cfg(unix)]
+use holographic_monitor::cgroups::{CgroupCollector, CgroupSelection};
+#[cfg(unix)]
+use std::{fs, path::Path};
+
+/// 夹具中的组数
+const GROUP_COUNTS: [usize; 3] = [100, 300, 1000];
+/// 报告的 Top-N
+const TOP_N: usize = 5;
+/// 夹具中的 slice
+const SLICES: [&str; 4] = ["system.slice", "user.slice", "machine.slice", "kubepods.slice"];
+
+/// 写入一个组的接口文件
+#[cfg(unix)]
+fn write_group(dir: &Path, seed: usize) {
+    write(
+        dir.join("cpu.stat"),
+        &format!(
+            "usage_usec {}\nuser_usec {}\nsystem_usec {}\nnr_periods 1024\nnr_throttled 12\nthrottled_usec 83412\n\
+             nr_bursts 0\nburst_usec 0\n",
+            1_283_412_000 + seed * 7919,
+            981_212_000 + seed * 5303,
+            302_200_000 + seed * 2617
+        ),
+    );
+    write(dir.join("memory.current"), &format!("{}\n", 268_435_456 + seed * 4096));
+    write(
+        dir.join("io.stat"),
+        &format!(
+            "259:0 rbytes={} wbytes={} rios=84123 wios=12345 dbytes=0 dios=0\n\
+             8:0 rbytes=1048576 wbytes=4194304 rios=256 wios=1024 dbytes=0 dios=0\n",
+            734_003_200 + seed * 512,
+            1_610_612_736 + seed * 1024
+        ),
+    );
+    for resource in ["cpu", "memory", "io"] {
+        write(
+            dir.join(format!("{}.pressure", resource)),
+            &format!(
+                "some avg10=0.52 avg60=0.31 avg300=0.12 total={}\nfull avg10=0.00 avg60=0.00 avg300=0.00 total={}\n",
+                8_123_456 + seed * 31,
+                1_234_567 + seed * 7
+            ),
+        );
+    }
+    // 采集器不读取的接口文件
+    for file in ["cgroup.procs", "cgroup.type", "cgroup.events", "memory.max", "memory.stat", "cpu.weight", "pids.current"] {
+        write(dir.join(file), "0\n");
+    }
+}
+
+/// 生成约 `groups` 个组的 cgroup v2 树与 /proc/pressure
+#[cfg(unix)]
+fn write_fixture(root: &Path, groups: usize) {
+    let cgroup = root.join("sys/fs/cgroup");
+    write(cgroup.join("cgroup.controllers"), "cpuset cpu io memory hugetlb pids rdma misc\n");
+    for resource in ["cpu", "memory", "io"] {
+        write(
+            root.join("proc/pressure").join(resource),
+            "some avg10=1.25 avg60=0.80 avg300=0.33 total=432182786\nfull avg10=0.00 avg60=0.00 avg300=0.00 total=0\n",
+        );
+    }
+    for (s, slice) in SLICES.iter().enumerate() {
+        write_group(&cgroup.join(slice), s);
+        for i in 0..groups / SLICES.len() {
+            write_group(&cgroup.join(slice).join(format!("unit-{}.service", i)), s * groups + i);
+        }
+    }
+}
+
+/// 父组的计数包含子组: 两者同时增长时 Top-N 只列出子组
+#[cfg(unix)]
+fn check_leaf_ranking() {
+    let root = std::env::temp_dir().join(format!("holo-cgroup-leaf-{}", std::process::id()));
+    write_fixture(&root, SLICES.len() * 2);
+    let mut collector = CgroupCollector::open(&root, CgroupSelection::Depth(2), usize::MAX).unwrap();
+    collector.sample(TOP_N);
+    let slice = root.join("sys/fs/cgroup").join(SLICES[0]);
+    write_group(&slice, 1_000_000);
+    write_group(&slice.join("unit-0.service"), 1_000_000);
+    std::thread::sleep(std::time::Duration::from_millis(10));
+    let names: Vec<String> = collector.sample(TOP_N).top.into_iter().map(|rate| rate.name).collect();
+    let _ = fs::remove_dir_all(&root);
+    assert_eq!(names, [format!("{}/unit-0.service", SLICES[0])], "Top-N 应只含叶子组");
+}
+
+fn bench_sample(c: &mut Criterion) {
+    #[cfg(unix)]
+    check_leaf_ranking();
+    let mut group = c.benchmark_group("cgroup_sample");
+
+    #[cfg(unix)]
+    for count in GROUP_COUNTS {
+        let root = std::env::temp_dir().join(format!("holo-cgroup-fixture-{}-{}", std::process::id(), count));
+        write_fixture(&root, count);
+        let mut collector = CgroupCollector::open(&root, CgroupSelection::Depth(2), usize::MAX).unwrap();
+        assert_eq!(collector.group_count(), count + SLICES.len());
+        group.bench_with_input(BenchmarkId::new("fixture", count), &count, |b, _| {
+            b.iter(|| collector.sample(TOP_N))
+        });
+        let _ = fs::remove_dir_all(&root);
+    }
+
+    #[cfg(target_os = "linux")]
+    if let Ok(mut live) = CgroupCollector::open(Path::new("/"), CgroupSelection::Depth(2), usize::MAX) {
+        group.bench_function(BenchmarkId::new("live", live.group_count()), |b| b.iter(|| live.sample(TOP_N)));
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_sample);
+criterion_main!(benches);
@@ -0,0 +1,155 @@
+//! 主机指标采集基准测试
+//!
+//! 对比 Linux 原生采集器与 sysinfo 路径的单次刷新开销。原生采集器运行在
+//! 临时生成的夹具目录上 (64 核 /proc/stat、hwmon、RAPL)，因此在任何 Unix
+//! 机器上都能运行；在 Linux 上额外测量真实 `/` 的开销。
+//! 吞吐采集同样在夹具 (`FIXTURE_DISKS` 块磁盘及其分区、`FIXTURE_NICS` 块网卡) 上测量
+
+mod common;
+
+use common::write;
+use criterion::{criterion_group, criterion_main, Criterion};
+use std::fs;
+use std::path::Path;
+use sysinfo::{Components, CpuRefreshKind, MemoryRefreshKind, RefreshKind, System};
+
+#[cfg(unix)]
+use holographic_monitor::{
+    monitor::HostSample,
+    procfs::{IoCounterFiles, ProcfsCollector},
+    throughput::IoSampler,
+};
+
+/// 夹具中的核心数
+const FIXTURE_CORES: usize = 64;
+/// 夹具中的磁盘数 (每块带 4 个分区)
+const FIXTURE_DISKS: usize = 16;
+/// 夹具中的网卡数
+const FIXTURE_NICS: usize = 8;
+
+/// 生成模拟 Linux 主机的 /proc 与 /sys 夹具
+fn write_fixture(root: &Path) {
+    let mut stat = String::from("cpu  4705 356 584 3699176 23 23 0 0 0 0\n");
+    for core in 0..FIXTURE_CORES {
+        stat += &format!("cpu{} 1393 280 209 924112 6 6 0 0 0 0\n", core);
+    }
+    stat += "intr 114930548 113199788 3 0 5 263 0 4\nctxt 1990473\nbtime 1062191376\nprocesses 2915\n";
+    write(root.join("proc/stat"), &stat);
+
+    write(
+        root.join("proc/meminfo"),
+        "MemTotal:       16318120 kB\nMemFree:         5412376 kB\nMemAvailable:   11025344 kB\n\
+         Buffers:          412812 kB\nCached:          5298264 kB\nSwapCached:            0 kB\n\
+         Active:          6321844 kB\nInactive:        3519164 kB\nSwapTotal:       2097148 kB\n\
+         SwapFree:        2097148 kB\nDirty:               240 kB\nAnonPages:       4147972 kB\n",
+    );
+
+    let coretemp = root.join("sys/class/hwmon/hwmon0");
+    write(coretemp.join("name"), "coretemp\n");
+    write(coretemp.join("temp1_label"), "Package id 0\n");
+    write(coretemp.join("temp1_input"), "52000\n");
+    for core in 0..FIXTURE_CORES / 2 {
+        write(coretemp.join(format!("temp{}_label", core + 2)), &format!("Core {}\n", core));
+        write(coretemp.join(format!("temp{}_input", core + 2)), "48000\n");
+    }
+    let nvme = root.join("sys/class/hwmon/hwmon1");
+    write(nvme.join("name"), "nvme\n");
+    write(nvme.join("temp1_label"), "Composite\n");
+    write(nvme.join("temp1_input"), "38850\n");
+
+    for core in 0..FIXTURE_CORES {
+        write(
+            root.join(format!("sys/devices/system/cpu/cpu{}/cpufreq/scaling_cur_freq", core)),
+            "2400000\n",
+        );
+    }
+
+    let rapl = root.join("sys/class/powercap/intel-rapl:0");
+    write(rapl.join("name"), "package-0\n");
+    write(rapl.join("energy_uj"), "81324687561\n");
+    write(rapl.join("max_energy_range_uj"), "262143328850\n");
+
+    let mut diskstats = String::new();
+    for disk in 0..FIXTURE_DISKS {
+        let name = format!("nvme{}n1", disk);
+        diskstats += &format!(
+            " 259       {} {} 1160379 4025 94830778 240133 2356890 1294834 160429416 5093414 0 1713900 5427413 0 0 0 0 44118 93865\n",
+            disk * 5,
+            name
+        );
+        for part in 1..=4 {
+            diskstats += &format!(
+                " 259       {} {}p{} 290094 1006 23707694 60033 589222 323708 40107354 1273353 0 428475 1356853 0 0 0 0 0 0\n",
+                disk * 5 + part,
+                name,
+                part
+            );
+        }
+        write(root.join(format!("sys/block/{}/device/model", name)), "FIXTURE SSD\n");
+    }
+    write(root.join("proc/diskstats"), &diskstats);
+
+    let mut net_dev = String::from(
+        "Inter-|   Receive                                                |  Transmit\n          face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n             lo: 16997643    2019    0    0    0     0          0         0 16997643    2019    0    0    0     0       0          0\n",
+    );
+    for nic in 0..FIXTURE_NICS {
+        net_dev += &format!(
+            "  eth{}: 9813467521 7412394    0   12    0     0          0     10231 1287346123 3912734    0    0    0     0       0          0\n",
+            nic
+        );
+        write(root.join(format!("sys/class/net/eth{}/device/vendor", nic)), "0x8086\n");
+    }
+    write(root.join("proc/net/dev"), &net_dev);
+}
+
+fn bench_refresh(c: &mut Criterion) {
+    let mut group = c.benchmark_group("host_refresh");
+
+    #[cfg(unix)]
+    {
+        let root = std::env::temp_dir().join(format!("holo-procfs-fixture-{}", std::process::id()));
+        write_fixture(&root);
+        let mut fixture = ProcfsCollector::open(&root).unwrap();
+        let mut sample = HostSample::default();
+        group.bench_function("procfs_fixture", |b| b.iter(|| fixture.sample_into(&mut sample).unwrap()));
+        let mut io = IoSampler::new(IoCounterFiles::open(&root).unwrap(), 3);
+        group.bench_function("io_fixture", |b| b.iter(|| io.sample().unwrap()));
+        let _ = fs::remove_dir_all(&root);
+    }
+
+    #[cfg(target_os = "linux")]
+    if let Ok(mut live) = ProcfsCollector::open(Path::new("/")) {
+        let mut sample = HostSample::default();
+        group.bench_function("procfs_live", |b| b.iter(|| live.sample_into(&mut sample).unwrap()));
+    }
+
+    // 与 Monitor 的 sysinfo 路径相同的刷新与温度筛选
+    let mut system = System::new_with_specifics(
+        RefreshKind::new()
+            .with_cpu(CpuRefreshKind::new().with_cpu_usage().with_frequency())
+            .with_memory(MemoryRefreshKind::everything()),
+    );
+    let mut components = Components::new_with_refreshed_list();
+    group.bench_function("sysinfo_live", |b| {
+        b.iter(|| {
+            system.refresh_cpu_usage();
+            system.refresh_memory();
+            components.refresh();
+            let _per_core: Vec<f32> = system.cpus().iter().map(|c| c.cpu_usage()).collect();
+            components
+                .list()
+                .iter()
+                .filter(|c| {
+                    let label = c.label().to_lowercase();
+                    label.contains("core") || label.contains("package") || label.contains("cpu")
+                })
+                .map(|c| c.temperature())
+                .fold(0.0f32, f32::max)
+        })
+    });
+
+    group.finish();
+}
+
+criterion_group!(benches, bench_refresh);
+criterion_main!(benches);
@@ -0,0 +1,45 @@
+//! 基准测试共用的辅助函数 (各基准以 `mod common;` 引入，只用到其中一部分)
+
+#![allow(dead_code)]
+
+use std::fs;
+use std::net::{TcpListener, UdpSocket};
+use std::path::PathBuf;
+use std::process::Command;
+
+/// 写入夹具文件 (自动创建上级目录)
+pub fn write(path: PathBuf, contents: &str) {
+    fs::create_dir_all(path.parent().unwrap()).unwrap();
+    fs::write(path, contents).unwrap();
+}
+
+/// 系统分配的空闲端口 (释放后交给服务端绑定)
+pub fn free_port() -> u16 {
+    let tcp = TcpListener::bind("127.0.0.1:0").unwrap();
+    let port = tcp.local_addr().unwrap().port();
+    // 同一端口号的 UDP 也要空闲
+    match UdpSocket::bind(("0.0.0.0", port)) {
+        Ok(_) => port,
+        Err(_) => free_port(),
+    }
+}
+
+/// 每秒时钟滴答数 (/proc/<pid>/stat 中 CPU 时间的单位)
+pub fn clock_ticks() -> f64 {
+    Command::new("getconf")
+        .arg("CLK_TCK")
+        .output()
+        .ok()
+        .and_then(|out| String::from_utf8(out.stdout).ok()?.trim().parse().ok())
+        .unwrap_or(100.0)
+}
+
+/// 进程累计 CPU 时间 (秒，全部线程的用户态 + 内核态)
+pub fn cpu_seconds(pid: u32, ticks_per_sec: f64) -> f64 {
+    let stat = fs::read_to_string(format!("/proc/{}/stat", pid)).unwrap();
+    // 进程名可能含空格，从最后一个 ')' 之后开始数: 第 14、15 个字段是 utime、stime
+    let fields: Vec<&str> = stat[stat.rfind(')').unwrap() + 2..].split_whitespace().collect();
+    let utime: u64 = fields[11].parse().unwrap();
+    let stime: u64 = fields[12].parse().unwrap();
+    (utime + stime) as f64 / ticks_per_sec
+}
@@ -0,0 +1,126 @@
+//! UDP 分片帧打包检查
+//!
+//! 用服务端实际的打包函数 ([`datagram::pack`]) 打包合成后端的整帧和几种构造的大帧，在
+//! [`MIN_MTU`]..[`MAX_MTU`] 的几个上限下按 3DS 客户端的规则 (`3ds/source/reassembly.c`) 重组并断言:
+//! - 每个数据报不超过上限，头部字段自洽
+//! - 每个块不超过客户端的重组上限 (字节数与数据报数)
+//! - 每个块单独解析为带公共字段的 JSON 对象，全部块合并后与原消息相同 (丢弃的字段除外)
+//! - 单个字段超过重组上限时只丢弃该字段所在的块，并如实报告
+//!
+//! 最后输出每帧的打包耗时
+
+use holographic_monitor::datagram::{
+    self, Packed, HEADER_LEN, MARKER, MAX_CHUNK_BYTES, MAX_CHUNK_PARTS, MAX_MTU, MIN_MTU, VERSION,
+};
+use holographic_monitor::monitor::Backend;
+use holographic_monitor::subscription::{self, FieldMask};
+use holographic_monitor::synthetic::SyntheticBackend;
+use serde_json::{Map, Value};
+use std::collections::BTreeMap;
+use std::time::{Duration, Instant};
+
+/// 检查的数据报上限
+const MTUS: [u16; 4] = [MIN_MTU as u16, 600, 1200, MAX_MTU as u16];
+/// 计时的打包次数
+const TIMED_ROUNDS: u32 = 2000;
+
+/// 构造一帧: `names` 个带名称的进程与 `blob` 字节的大字段
+fn frame(names: usize, blob: usize) -> String {
+    let names: Vec<String> = (0..names).map(|i| format!("[{},\"worker-process-{:04}\"]", 1000 + i, i)).collect();
+    format!(
+        "{{\"seq\":42,\"sample_ms\":123456,\"host\":3,\"cpu_usage\":12.5,\"core_usage\":\"{}\",\
+         \"processes\":{{\"cpu\":[[1000,2,3]],\"names\":[{}]}},\"hostname\":\"a,b}}{{\\\"x\",\"blob\":\"{}\",\
+         \"uptime_secs\":3600}}",
+        "ab".repeat(128),
+        names.join(","),
+        "x".repeat(blob)
+    )
+}
+
+/// 按客户端规则重组，返回合并后的字段；断言数据报与块都在客户端的上限之内
+fn reassemble(datagrams: &[Vec<u8>], mtu: u16, packed: Packed) -> Map<String, Value> {
+    assert_eq!(datagrams.len(), packed.datagrams);
+    if datagrams.len() == 1 && datagrams[0][0] == b'{' {
+        return serde_json::from_slice(&datagrams[0]).unwrap();
+    }
+    let mut chunks: BTreeMap<u8, (u8, Vec<u8>)> = BTreeMap::new();
+    for (i, d) in datagrams.iter().enumerate() {
+        assert!(d.len() <= usize::from(mtu), "数据报 {} 字节超过上限 {}", d.len(), mtu);
+        assert_eq!((d[0], d[1]), (MARKER, VERSION));
+        let (count, index, first, parts) = (d[4], d[5], d[6], d[7]);
+        let offset = usize::from(u16::from_le_bytes([d[8], d[9]]));
+        assert_eq!((usize::from(count), usize::from(index)), (datagrams.len(), i));
+        assert!(first <= index && index - first < parts && usize::from(parts) <= MAX_CHUNK_PARTS);
+        let payload = &d[HEADER_LEN..];
+        assert!(offset + payload.len() <= MAX_CHUNK_BYTES, "块超过客户端重组上限");
+        let (_, chunk) = chunks.entry(first).or_insert((parts, Vec::new()));
+        assert_eq!(chunk.len(), offset, "块内数据报不连续");
+        chunk.extend_from_slice(payload);
+    }
+    let mut merged = Map::new();
+    for (parts, chunk) in chunks.values() {
+        let fields: Map<String, Value> = serde_json::from_slice(chunk).unwrap();
+        assert!(fields.contains_key("seq") && fields.contains_key("sample_ms"), "块缺少公共字段");
+        assert!(*parts == 1 || chunk.len() > usize::from(mtu) - HEADER_LEN);
+        merged.extend(fields);
+    }
+    merged
+}
+
+fn check(name: &str, json: &str, dropped: &[&str]) {
+    let original: Map<String, Value> = serde_json::from_str(json).unwrap();
+    for mtu in MTUS {
+        let mut datagrams = Vec::new();
+        let packed = datagram::pack(json, mtu, 7, &mut datagrams).unwrap();
+        let merged = reassemble(&datagrams, mtu, packed);
+        let mut expected = original.clone();
+        // 过大的字段只在需要拆分时才可能被丢弃
+        if json.len() > usize::from(mtu) {
+            for key in dropped {
+                expected.remove(*key);
+            }
+        }
+        assert_eq!(merged, expected, "{} 在上限 {} 下重组结果不同", name, mtu);
+        assert_eq!(packed.dropped_chunks, original.len() - expected.len(), "{} 丢弃的块数不符", name);
+        println!(
+            "datagram/{}/{}: {} 字节 → {} 个数据报，丢弃 {} 块",
+            name,
+            mtu,
+            json.len(),
+            packed.datagrams,
+            packed.dropped_chunks
+        );
+    }
+}
+
+fn main() {
+    let mut backend = SyntheticBackend::new(Duration::ZERO);
+    let metrics = backend.refresh();
+    let full = subscription::encode(&metrics, FieldMask::ALL).unwrap();
+    check("synthetic", &full, &[]);
+    check("names", &frame(60, 0), &[]);
+    // 单个字段接近重组上限: 拆成多个数据报，仍可重组
+    check("field-7k", &frame(10, 7000), &[]);
+    // 单个字段超过重组上限: 只丢该字段
+    check("field-10k", &frame(10, 10_000), &["blob"]);
+
+    // 没有可发送的块时整条丢弃
+    let only_blob = format!("{{\"seq\":1,\"sample_ms\":2,\"blob\":\"{}\"}}", "x".repeat(10_000));
+    assert!(datagram::pack(&only_blob, 1200, 0, &mut Vec::new()).is_none());
+    // 头部与公共字段之外至少能放下一个短字段的最小上限
+    assert!(datagram::chunk_fits(MAX_CHUNK_BYTES, MAX_MTU as u16));
+    assert!(!datagram::chunk_fits(MAX_CHUNK_BYTES, MIN_MTU as u16));
+
+    let json = frame(60, 0);
+    let mut datagrams = Vec::new();
+    let started = Instant::now();
+    for _ in 0..TIMED_ROUNDS {
+        datagrams.clear();
+        datagram::pack(&json, 1200, 0, &mut datagrams).unwrap();
+    }
+    println!(
+        "datagram/pack: {} 字节的帧按 1200 字节打包 {:.1} µs/帧",
+        json.len(),
+        started.elapsed().as_secs_f64() * 1e6 / f64::from(TIMED_ROUNDS)
+    );
+}
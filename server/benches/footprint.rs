@@ -0,0 +1,139 @@
+//! 服务端资源占用测试 (仅 Linux)
+//!
+//! 分别以默认模式和 `--lean` 低占用模式启动服务端 (合成数据后端，100ms 推送)，
+//! 一个 UDP 客户端订阅并持续接收，固定运行 [`RUN_SECS`] 秒后从 /proc 读取:
+//! - 常驻内存 (VmRSS) 与峰值 (VmHWM)
+//! - 线程数
+//! - 运行期间的 CPU 时间 (用户态 + 内核态) 占墙钟时间的比例
+//!
+//! 低占用模式超出 [`LEAN_RSS_BUDGET_KB`] 或 [`LEAN_CPU_BUDGET_PCT`] 时断言失败
+
+#[cfg(target_os = "linux")]
+mod common;
+
+#[cfg(target_os = "linux")]
+mod linux {
+    use crate::common::{clock_ticks, cpu_seconds, free_port};
+    use std::net::UdpSocket;
+    use std::process::{Child, Command, Stdio};
+    use std::thread;
+    use std::time::{Duration, Instant};
+
+    /// 启动后等待的时间 (首帧、后台探测完成)
+    const WARMUP: Duration = Duration::from_secs(2);
+    /// 测量时长 (秒)
+    const RUN_SECS: u64 = 10;
+    /// 客户端心跳间隔 (服务端 10 秒未收到心跳即注销客户端)
+    const PING_INTERVAL: Duration = Duration::from_secs(1);
+    /// 低占用模式的常驻内存上限 (KB)
+    const LEAN_RSS_BUDGET_KB: u64 = 8 * 1024;
+    /// 低占用模式的 CPU 占用上限 (单核百分比)
+    const LEAN_CPU_BUDGET_PCT: f64 = 1.0;
+
+    /// 一次运行的测量结果
+    struct Footprint {
+        rss_kb: u64,
+        hwm_kb: u64,
+        threads: u64,
+        cpu_pct: f64,
+        frames: u64,
+    }
+
+    /// /proc/<pid>/status 中的数值字段 (单位 kB 的字段返回 kB)
+    fn status_field(pid: u32, name: &str) -> u64 {
+        let status = std::fs::read_to_string(format!("/proc/{}/status", pid)).unwrap();
+        status
+            .lines()
+            .find_map(|line| line.strip_prefix(name)?.strip_prefix(':'))
+            .and_then(|rest| rest.split_whitespace().next()?.parse().ok())
+            .unwrap_or_else(|| panic!("/proc/{}/status 缺少 {}", pid, name))
+    }
+
+    fn spawn_server(extra: &[&str]) -> (Child, u16) {
+        let (ws, udp, metrics) = (free_port(), free_port(), free_port());
+        let child = Command::new(env!("CARGO_BIN_EXE_holographic-monitor"))
+            .arg("--synthetic")
+            .arg(format!("--ws-port={}", ws))
+            .arg(format!("--udp-port={}", udp))
+            .arg(format!("--metrics-port={}", metrics))
+            .args(extra)
+            .stdout(Stdio::null())
+            .spawn()
+            .unwrap();
+        (child, udp)
+    }
+
+    fn measure(extra: &[&str], ticks_per_sec: f64) -> Footprint {
+        let (mut child, udp_port) = spawn_server(extra);
+        let pid = child.id();
+        thread::sleep(WARMUP);
+
+        let socket = UdpSocket::bind("127.0.0.1:0").unwrap();
+        socket.connect(("127.0.0.1", udp_port)).unwrap();
+        socket.set_read_timeout(Some(Duration::from_millis(50))).unwrap();
+        socket.send(b"SUB cpu,memory,thermal,power").unwrap();
+
+        let cpu_start = cpu_seconds(pid, ticks_per_sec);
+        let started = Instant::now();
+        let mut last_ping = started;
+        let mut frames = 0;
+        let mut buf = [0u8; 2048];
+        while started.elapsed() < Duration::from_secs(RUN_SECS) {
+            if last_ping.elapsed() >= PING_INTERVAL {
+                socket.send(b"PING").unwrap();
+                last_ping = Instant::now();
+            }
+            if let Ok(len) = socket.recv(&mut buf) {
+                frames += buf[..len].starts_with(b"{") as u64;
+            }
+        }
+        let cpu = cpu_seconds(pid, ticks_per_sec) - cpu_start;
+        let footprint = Footprint {
+            rss_kb: status_field(pid, "VmRSS"),
+            hwm_kb: status_field(pid, "VmHWM"),
+            threads: status_field(pid, "Threads"),
+            cpu_pct: cpu * 100.0 / started.elapsed().as_secs_f64(),
+            frames,
+        };
+        let _ = child.kill();
+        let _ = child.wait();
+        footprint
+    }
+
+    pub fn main() {
+        let ticks_per_sec = clock_ticks();
+        let mut lean = None;
+        for (name, extra) in [("default", &[][..]), ("lean", &["--lean"][..])] {
+            let f = measure(extra, ticks_per_sec);
+            println!(
+                "footprint/{}: RSS {} KB (峰值 {} KB), {} 个线程, CPU {:.2}%, {} 秒收到 {} 帧",
+                name, f.rss_kb, f.hwm_kb, f.threads, f.cpu_pct, RUN_SECS, f.frames
+            );
+            assert!(f.frames > 0, "{} 模式没有收到数据帧", name);
+            if name == "lean" {
+                lean = Some(f);
+            }
+        }
+        let lean = lean.unwrap();
+        assert!(
+            lean.hwm_kb <= LEAN_RSS_BUDGET_KB,
+            "低占用模式常驻内存峰值 {} KB 超出预算 {} KB",
+            lean.hwm_kb,
+            LEAN_RSS_BUDGET_KB
+        );
+        assert!(
+            lean.cpu_pct <= LEAN_CPU_BUDGET_PCT,
+            "低占用模式 CPU 占用 {:.2}% 超出预算 {}%",
+            lean.cpu_pct,
+            LEAN_CPU_BUDGET_PCT
+        );
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn main() {
+    linux::main();
+}
+
+#[cfg(not(target_os = "linux"))]
+fn main() {}
@@ -0,0 +1,265 @@
+//! 内嵌网页的 HTTP 负载测试 (仅 Linux)
+//!
+//! 以合成数据后端启动服务端，[`CLIENTS`] 个线程各自用一条 keep-alive 连接反复加载整页
+//! (index.html 与它引用的脚本、样式，带 `Accept-Encoding: br, gzip`)，每 [`REVALIDATE_EVERY`]
+//! 次改为带 `If-None-Match` 的重新验证。结束时打印吞吐、单次整页加载的延迟分位数，并断言:
+//! - 压缩正文可解压出与 web/ 目录一致的内容，重新验证返回 304
+//! - 负载期间服务端进程没有块设备读取 (/proc/<pid>/io 的 read_bytes 不变)
+//! - 服务端每次整页加载的 CPU 时间低于本进程压缩一次整页的耗时 (即请求路径上没有压缩)
+//! - 负载期间另一条连接每 [`SLOW_BYTE_INTERVAL`] 只发送请求头的一个字节，服务端在
+//!   [`HEAD_TIMEOUT`] (与 `src/web.rs` 中的相同) 后关闭它
+
+#[cfg(target_os = "linux")]
+mod common;
+
+#[cfg(target_os = "linux")]
+mod linux {
+    use crate::common::{clock_ticks, cpu_seconds, free_port};
+    use flate2::read::GzDecoder;
+    use std::io::{BufRead, BufReader, Read, Write};
+    use std::net::TcpStream;
+    use std::process::{Command, Stdio};
+    use std::thread;
+    use std::time::{Duration, Instant};
+
+    /// 一次整页加载请求的资源
+    const PAGE: [&str; 4] = ["/", "/style.css", "/worker.js", "/main.js"];
+    /// 并发连接数
+    const CLIENTS: usize = 8;
+    /// 每个连接的整页加载次数
+    const LOADS_PER_CLIENT: usize = 500;
+    /// 每隔多少次加载改为带 ETag 的重新验证
+    const REVALIDATE_EVERY: usize = 4;
+    /// 读完一个请求头的总时间上限
+    const HEAD_TIMEOUT: Duration = Duration::from_secs(5);
+    /// 慢速连接发送请求头字节的间隔 (远小于上限，按单次读取计时的服务端永远不会超时)
+    const SLOW_BYTE_INTERVAL: Duration = Duration::from_millis(200);
+
+    /// 一个响应: 状态码、响应头 (名称小写) 与正文
+    struct Response {
+        status: u16,
+        headers: Vec<(String, String)>,
+        body: Vec<u8>,
+    }
+
+    impl Response {
+        fn header(&self, name: &str) -> Option<&str> {
+            self.headers.iter().find(|(n, _)| n == name).map(|(_, v)| v.as_str())
+        }
+    }
+
+    fn request(
+        writer: &mut TcpStream,
+        reader: &mut BufReader<TcpStream>,
+        path: &str,
+        if_none_match: Option<&str>,
+    ) -> Response {
+        let mut head = format!("GET {} HTTP/1.1\r\nHost: localhost\r\nAccept-Encoding: br, gzip\r\n", path);
+        if let Some(etag) = if_none_match {
+            head += &format!("If-None-Match: {}\r\n", etag);
+        }
+        head += "\r\n";
+        writer.write_all(head.as_bytes()).unwrap();
+
+        let mut line = String::new();
+        reader.read_line(&mut line).unwrap();
+        let status = line.split(' ').nth(1).and_then(|s| s.parse().ok()).unwrap_or(0);
+        let mut headers = Vec::new();
+        loop {
+            line.clear();
+            reader.read_line(&mut line).unwrap();
+            let Some((name, value)) = line.trim_end().split_once(':') else { break };
+            headers.push((name.to_ascii_lowercase(), value.trim().to_string()));
+        }
+        let mut response = Response { status, headers, body: Vec::new() };
+        let len = response.header("content-length").and_then(|v| v.parse().ok()).unwrap_or(0);
+        response.body.resize(len, 0);
+        reader.read_exact(&mut response.body).unwrap();
+        response
+    }
+
+    fn connect(port: u16) -> (TcpStream, BufReader<TcpStream>) {
+        let stream = TcpStream::connect(("127.0.0.1", port)).unwrap();
+        stream.set_nodelay(true).unwrap();
+        (stream.try_clone().unwrap(), BufReader::new(stream))
+    }
+
+    /// 逐字节慢速发送请求头 (永远不发送结束的空行)，返回服务端关闭连接的时间
+    fn slow_head(port: u16) -> Duration {
+        let (mut writer, mut reader) = connect(port);
+        reader.get_ref().set_read_timeout(Some(SLOW_BYTE_INTERVAL)).unwrap();
+        let started = Instant::now();
+        let mut head = b"GET / HTTP/1.1\r\nX-Slow: ".iter().chain(std::iter::repeat(&b'x'));
+        let mut buf = [0u8; 256];
+        loop {
+            assert!(started.elapsed() < HEAD_TIMEOUT * 3, "慢速请求头的连接 {} 秒后仍未关闭", (HEAD_TIMEOUT * 3).as_secs());
+            // 服务端关闭后写入被重置或读到 EOF；读超时表示连接仍然打开
+            if writer.write_all(&[*head.next().unwrap()]).is_err() {
+                return started.elapsed();
+            }
+            match reader.get_mut().read(&mut buf) {
+                Ok(0) => return started.elapsed(),
+                Err(e) if !matches!(e.kind(), std::io::ErrorKind::WouldBlock | std::io::ErrorKind::TimedOut) => {
+                    return started.elapsed()
+                }
+                _ => {}
+            }
+        }
+    }
+
+    /// /proc/<pid>/io 中的字段
+    fn io_field(pid: u32, name: &str) -> u64 {
+        std::fs::read_to_string(format!("/proc/{}/io", pid))
+            .ok()
+            .and_then(|io| io.lines().find_map(|l| l.strip_prefix(name)?.strip_prefix(':')?.trim().parse().ok()))
+            .unwrap_or(0)
+    }
+
+    /// 本进程用 gzip 压缩一次整页的耗时 (秒)，作为 "请求时压缩" 的代价参照
+    fn gzip_page_seconds() -> f64 {
+        let web = concat!(env!("CARGO_MANIFEST_DIR"), "/../web/");
+        let files: Vec<Vec<u8>> = ["index.html", "style.css", "worker.js", "main.js"]
+            .iter()
+            .map(|name| std::fs::read(format!("{}{}", web, name)).unwrap())
+            .collect();
+        let rounds = 50;
+        let started = Instant::now();
+        for _ in 0..rounds {
+            for file in &files {
+                let mut encoder = flate2::write::GzEncoder::new(Vec::new(), flate2::Compression::default());
+                encoder.write_all(file).unwrap();
+                std::hint::black_box(encoder.finish().unwrap());
+            }
+        }
+        started.elapsed().as_secs_f64() / rounds as f64
+    }
+
+    /// 首次加载: 检查状态码、编码与解压后的内容，返回各资源的 ETag
+    fn check_page(port: u16) -> Vec<String> {
+        let (mut writer, mut reader) = connect(port);
+        let web = concat!(env!("CARGO_MANIFEST_DIR"), "/../web");
+        PAGE.iter()
+            .map(|path| {
+                let response = request(&mut writer, &mut reader, path, None);
+                assert_eq!(response.status, 200, "{} 返回 {}", path, response.status);
+                assert!(response.header("cache-control").is_some(), "{} 缺少 Cache-Control", path);
+                let etag = response.header("etag").expect("缺少 ETag").to_string();
+                assert!(etag.starts_with('"'), "{} 的 ETag 不是强 ETag: {}", path, etag);
+                let file = if *path == "/" { "/index.html" } else { path };
+                let expected = std::fs::read(format!("{}{}", web, file)).unwrap();
+                if response.header("content-encoding") == Some("gzip") {
+                    let mut plain = Vec::new();
+                    GzDecoder::new(&response.body[..]).read_to_end(&mut plain).unwrap();
+                    assert_eq!(plain, expected, "{} 解压后与 web/ 不一致", path);
+                } else if response.header("content-encoding").is_none() {
+                    assert_eq!(response.body, expected, "{} 与 web/ 不一致", path);
+                }
+                let revalidated = request(&mut writer, &mut reader, path, Some(&etag));
+                assert_eq!(revalidated.status, 304, "{} 重新验证返回 {}", path, revalidated.status);
+                etag
+            })
+            .collect()
+    }
+
+    pub fn main() {
+        let (ws, udp, metrics) = (free_port(), free_port(), free_port());
+        let mut child = Command::new(env!("CARGO_BIN_EXE_holographic-monitor"))
+            .arg("--synthetic")
+            .arg(format!("--ws-port={}", ws))
+            .arg(format!("--udp-port={}", udp))
+            .arg(format!("--metrics-port={}", metrics))
+            .stdout(Stdio::null())
+            .spawn()
+            .unwrap();
+        let pid = child.id();
+        thread::sleep(Duration::from_secs(1));
+
+        let etags = check_page(ws);
+        let slow = thread::spawn(move || slow_head(ws));
+        let read_bytes = io_field(pid, "read_bytes");
+        let ticks_per_sec = clock_ticks();
+        let cpu_start = cpu_seconds(pid, ticks_per_sec);
+        let started = Instant::now();
+        let workers: Vec<_> = (0..CLIENTS)
+            .map(|_| {
+                let etags = etags.clone();
+                thread::spawn(move || {
+                    let (mut writer, mut reader) = connect(ws);
+                    let mut latencies = Vec::with_capacity(LOADS_PER_CLIENT);
+                    let mut bytes = 0;
+                    for load in 0..LOADS_PER_CLIENT {
+                        let revalidate = load % REVALIDATE_EVERY == REVALIDATE_EVERY - 1;
+                        let load_started = Instant::now();
+                        for (path, etag) in PAGE.iter().zip(&etags) {
+                            let response = request(&mut writer, &mut reader, path, revalidate.then_some(etag.as_str()));
+                            assert_eq!(response.status, if revalidate { 304 } else { 200 });
+                            bytes += response.body.len();
+                        }
+                        latencies.push(load_started.elapsed());
+                    }
+                    (latencies, bytes)
+                })
+            })
+            .collect();
+        let mut latencies = Vec::new();
+        let mut bytes = 0;
+        for worker in workers {
+            let (l, b) = worker.join().unwrap();
+            latencies.extend(l);
+            bytes += b;
+        }
+        let elapsed = started.elapsed().as_secs_f64();
+        let cpu = cpu_seconds(pid, ticks_per_sec) - cpu_start;
+        let disk_read = io_field(pid, "read_bytes") - read_bytes;
+        let slow_closed = slow.join().unwrap();
+        let _ = child.kill();
+        let _ = child.wait();
+
+        latencies.sort();
+        let loads = latencies.len();
+        let quantile = |q: f64| latencies[((loads - 1) as f64 * q) as usize].as_secs_f64() * 1e6;
+        let cpu_per_load = cpu / loads as f64;
+        let gzip_per_load = gzip_page_seconds();
+        println!(
+            "http: {} 个连接 × {} 次整页加载 ({} 个请求)，{:.0} 请求/秒，正文 {} KB",
+            CLIENTS,
+            LOADS_PER_CLIENT,
+            loads * PAGE.len(),
+            (loads * PAGE.len()) as f64 / elapsed,
+            bytes / 1024
+        );
+        println!("http: 整页加载延迟 p50 {:.0}µs, p99 {:.0}µs", quantile(0.5), quantile(0.99));
+        println!(
+            "http: 服务端 CPU 每次整页加载 {:.1}µs (参照: 压缩一次整页 {:.1}µs)，块设备读取 {} 字节",
+            cpu_per_load * 1e6,
+            gzip_per_load * 1e6,
+            disk_read
+        );
+        println!(
+            "http: 慢速请求头的连接 {:.1} 秒后被关闭 (上限 {} 秒)",
+            slow_closed.as_secs_f64(),
+            HEAD_TIMEOUT.as_secs()
+        );
+        assert_eq!(disk_read, 0, "负载期间服务端读取了磁盘");
+        assert!(
+            slow_closed < HEAD_TIMEOUT + SLOW_BYTE_INTERVAL * 5,
+            "慢速请求头的连接 {:.1} 秒后才被关闭，超出上限 {} 秒",
+            slow_closed.as_secs_f64(),
+            HEAD_TIMEOUT.as_secs()
+        );
+        assert!(
+            cpu_per_load < gzip_per_load,
+            "每次整页加载的 CPU 时间 ({:.1}µs) 不低于压缩一次整页 ({:.1}µs)",
+            cpu_per_load * 1e6,
+            gzip_per_load * 1e6
+        );
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn main() {
+    linux::main();
+}
+
+#[cfg(not(target_os = "linux"))]
+fn main() {}
@@ -0,0 +1,304 @@
+//! 服务端热路径基准测试
+//!
+//! - refresh: 合成后端 (替代真实传感器的模拟 Backend) 的单次刷新
+//! - encode: `SystemMetrics` 的 JSON 编码，以及每核心数组的十六进制紧凑编码
+//! - registry: 10 / 1k / 10k 个 3DS 客户端的心跳与每帧超时清理
+//! - fanout: 端到端回环，推送一帧到 N 个 UDP 客户端和 M 个 WebSocket 客户端，
+//!   计时到所有客户端都收到该帧为止
+//! - wire: WebSocket 各传输格式 (JSON / 二进制 / 跨消息保留上下文的 deflate) 每帧的编码耗时，
+//!   并打印每帧字节数
+//! - subscriptions: 同一批客户端全部订阅完整帧 vs 混合字段订阅 (3DS / Web / 精简挂件)，
+//!   比较每帧耗时，并打印每帧发出的总字节数
+//!
+//! 全部在本机回环上运行，不需要网络。基线与回归阈值见 `bench.sh`
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use futures_util::{SinkExt, StreamExt};
+use holographic_monitor::{
+    fanout::{self, ClientRegistry, Fanout, WsHub},
+    monitor::Backend,
+    packed,
+    subscription::{FieldMask, Projection},
+    synthetic::SyntheticBackend,
+    wire::{self, Deflater},
+};
+use std::{
+    net::SocketAddr,
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+use tokio::{
+    net::{TcpListener, TcpStream, UdpSocket},
+    runtime::Runtime,
+};
+use tokio_tungstenite::{client_async, tungstenite::Message};
+
+/// 低于该相对变化的差异视为噪声 (criterion 不报告为回归)
+const NOISE_THRESHOLD: f64 = 0.03;
+
+/// 紧凑编码基准使用的核心数
+const ENCODE_CORES: usize = 128;
+
+/// 混合订阅: 3DS 客户端实际解析的字段
+const SUB_3DS: &str = "cpu,core_usage,memory,thermal,power,battery,processes,hostname,os_name,cpu_model,cpu_cores,uptime_secs";
+/// 混合订阅: Web 仪表盘显示的字段
+const SUB_WEB: &str = "cpu_usage,cores,memory_usage,cpu_temp,fan_speeds,power_score";
+/// 混合订阅: 只显示 CPU 与功率的精简挂件
+const SUB_WIDGET: &str = "cpu_usage,power_score";
+
+fn bench_refresh(c: &mut Criterion) {
+    let mut backend = SyntheticBackend::new(Duration::ZERO);
+    c.bench_function("refresh/synthetic", |b| b.iter(|| backend.refresh()));
+}
+
+fn bench_encode(c: &mut Criterion) {
+    let mut group = c.benchmark_group("encode");
+
+    let metrics = SyntheticBackend::new(Duration::ZERO).refresh();
+    // 投影由 `SystemMetrics` 派生的 Serialize 驱动: 订阅全部字段时必须与完整编码逐字节相同
+    let full = serde_json::to_string(&metrics).unwrap();
+    let projected = serde_json::to_string(&Projection { metrics: &metrics, mask: FieldMask::ALL }).unwrap();
+    assert_eq!(projected, full, "订阅全部字段的投影与完整编码不一致");
+    group.bench_function("json", |b| b.iter(|| serde_json::to_string(&metrics).unwrap()));
+    for (name, list) in [("3ds", SUB_3DS), ("web", SUB_WEB), ("widget", SUB_WIDGET)] {
+        let mask = FieldMask::parse(list);
+        group.bench_function(BenchmarkId::new("projection", name), |b| {
+            b.iter(|| holographic_monitor::subscription::encode(&metrics, mask).unwrap())
+        });
+    }
+
+    let mut wide = metrics.clone();
+    wide.core_usage = (0..ENCODE_CORES).map(|i| (i * 7 % 100) as f32).collect();
+    wide.core_frequency_mhz = (0..ENCODE_CORES).map(|i| 2000 + (i as u64 * 37 % 3000)).collect();
+    group.bench_function(BenchmarkId::new("json", format!("{}_cores", ENCODE_CORES)), |b| {
+        b.iter(|| serde_json::to_string(&wide).unwrap())
+    });
+
+    let mut hex = String::with_capacity(ENCODE_CORES * 2);
+    group.bench_function(BenchmarkId::new("hex", ENCODE_CORES), |b| {
+        b.iter(|| {
+            hex.clear();
+            packed::push_hex(&mut hex, wide.core_usage.iter().map(|v| packed::quantize_percent(*v)));
+        })
+    });
+
+    group.finish();
+}
+
+/// 连续多帧的平均字节数 (deflate 的压缩率依赖前文，单帧不具代表性)
+const WIRE_FRAMES: usize = 30;
+/// 采样间隔与默认推送间隔一致，使相邻帧的数值变化接近实际
+const WIRE_INTERVAL: Duration = Duration::from_millis(100);
+
+fn bench_wire(c: &mut Criterion) {
+    let mut group = c.benchmark_group("wire");
+    let mut backend = SyntheticBackend::new(Duration::ZERO);
+    let frames: Vec<_> = (0..WIRE_FRAMES)
+        .map(|seq| {
+            std::thread::sleep(WIRE_INTERVAL);
+            let mut metrics = backend.refresh();
+            metrics.seq = seq as u64;
+            metrics
+        })
+        .collect();
+    let json: Vec<String> = frames.iter().map(|m| serde_json::to_string(m).unwrap()).collect();
+    let web = FieldMask::parse(SUB_WEB);
+    let web_json: Vec<String> = frames
+        .iter()
+        .map(|m| holographic_monitor::subscription::encode(m, web).unwrap())
+        .collect();
+
+    let mut out = Vec::new();
+    let mut bytes = |encode: &mut dyn FnMut(usize, &mut Vec<u8>)| {
+        (0..WIRE_FRAMES).map(|i| {
+            encode(i, &mut out);
+            out.len()
+        }).sum::<usize>() / WIRE_FRAMES
+    };
+    let json_bytes = json.iter().map(String::len).sum::<usize>() / WIRE_FRAMES;
+    let web_bytes = web_json.iter().map(String::len).sum::<usize>() / WIRE_FRAMES;
+    let binary_bytes = bytes(&mut |i, out| {
+        out.clear();
+        wire::encode_binary(&frames[i], FieldMask::ALL, out)
+    });
+    let binary_web_bytes = bytes(&mut |i, out| {
+        out.clear();
+        wire::encode_binary(&frames[i], web, out)
+    });
+    let mut deflater = Deflater::new();
+    let deflate_bytes = bytes(&mut |i, out| deflater.compress(&json[i], out));
+    let mut deflater = Deflater::new();
+    let deflate_web_bytes = bytes(&mut |i, out| deflater.compress(&web_json[i], out));
+    let fresh_bytes = bytes(&mut |i, out| Deflater::new().compress(&json[i], out));
+    println!(
+        "wire bytes/frame: json {} | json(web) {} | binary {} | binary(web) {} | deflate {} | deflate(web) {} | deflate(fresh context) {}",
+        json_bytes, web_bytes, binary_bytes, binary_web_bytes, deflate_bytes, deflate_web_bytes, fresh_bytes
+    );
+
+    let mut next = 0;
+    group.bench_function("json", |b| {
+        b.iter(|| {
+            next = (next + 1) % WIRE_FRAMES;
+            serde_json::to_string(&frames[next]).unwrap()
+        })
+    });
+    let mut out = Vec::new();
+    group.bench_function("binary", |b| {
+        b.iter(|| {
+            next = (next + 1) % WIRE_FRAMES;
+            out.clear();
+            wire::encode_binary(&frames[next], FieldMask::ALL, &mut out);
+        })
+    });
+    // deflate 每个连接各压缩一次 (不含 JSON 编码，JSON 每个订阅只编码一次)
+    let mut deflater = Deflater::new();
+    group.bench_function("deflate", |b| {
+        b.iter(|| {
+            next = (next + 1) % WIRE_FRAMES;
+            deflater.compress(&json[next], &mut out);
+        })
+    });
+    group.finish();
+}
+
+fn client_addr(i: usize) -> SocketAddr {
+    SocketAddr::from(([10, (i >> 16) as u8, (i >> 8) as u8, i as u8], 9001))
+}
+
+fn bench_registry(c: &mut Criterion) {
+    let mut group = c.benchmark_group("registry");
+    for count in [10usize, 1_000, 10_000] {
+        let mut registry = ClientRegistry::new(Duration::from_secs(10));
+        let now = Instant::now();
+        for i in 0..count {
+            registry.touch(client_addr(i), now);
+        }
+
+        let mut next = 0;
+        group.bench_with_input(BenchmarkId::new("touch", count), &count, |b, &count| {
+            b.iter(|| {
+                next = (next + 1) % count;
+                registry.touch(client_addr(next), now)
+            })
+        });
+
+        let mut alive = Vec::with_capacity(count);
+        group.bench_with_input(BenchmarkId::new("sweep", count), &count, |b, _| {
+            b.iter(|| registry.sweep(now, &mut alive, |_| {}))
+        });
+    }
+    group.finish();
+}
+
+/// 回环推送环境: 服务端 Fanout + N 个 UDP 客户端 + M 个 WebSocket 客户端
+struct Loopback {
+    fanout: Fanout,
+    backend: SyntheticBackend,
+    udp_clients: Vec<UdpSocket>,
+    ws_clients: Vec<tokio_tungstenite::WebSocketStream<TcpStream>>,
+    buf: Vec<u8>,
+    /// 最近一帧所有客户端收到的总字节数
+    bytes: usize,
+}
+
+impl Loopback {
+    /// 客户端按顺序轮流使用 `masks` 中的订阅 (空表示全部订阅完整帧)
+    async fn new(udp_count: usize, ws_count: usize, masks: &[&str]) -> Self {
+        let hub = WsHub::new(16);
+        let udp = Arc::new(UdpSocket::bind("127.0.0.1:0").await.unwrap());
+        let clients = Arc::new(Mutex::new(ClientRegistry::new(Duration::from_secs(10))));
+
+        let mut udp_clients = Vec::with_capacity(udp_count);
+        for i in 0..udp_count {
+            let socket = UdpSocket::bind("127.0.0.1:0").await.unwrap();
+            let mask = masks.get(i % masks.len().max(1)).map_or(FieldMask::ALL, |list| FieldMask::parse(list));
+            let added = clients.lock().unwrap().subscribe(socket.local_addr().unwrap(), mask, Instant::now());
+            assert!(added, "UDP 客户端数超过注册上限 {}", fanout::MAX_CLIENTS);
+            udp_clients.push(socket);
+        }
+
+        let listener = TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let ws_addr = listener.local_addr().unwrap();
+        let server_hub = hub.clone();
+        tokio::spawn(async move {
+            while let Ok((stream, peer)) = listener.accept().await {
+                tokio::spawn(fanout::serve_ws(stream, peer, server_hub.clone(), Vec::new));
+            }
+        });
+
+        let mut ws_clients = Vec::with_capacity(ws_count);
+        for i in 0..ws_count {
+            let stream = TcpStream::connect(ws_addr).await.unwrap();
+            let (mut ws, _) = client_async(format!("ws://{}/", ws_addr), stream).await.unwrap();
+            // 欢迎消息
+            ws.next().await.unwrap().unwrap();
+            if let Some(list) = masks.get(i % masks.len().max(1)) {
+                let names: Vec<&str> = list.split(',').collect();
+                let subscribe = serde_json::json!({ "subscribe": names }).to_string();
+                ws.send(Message::Text(subscribe)).await.unwrap();
+            }
+            ws_clients.push(ws);
+        }
+        // 等服务端处理完订阅消息
+        tokio::time::sleep(Duration::from_millis(100)).await;
+
+        Self {
+            fanout: Fanout::new(hub, udp, clients),
+            backend: SyntheticBackend::new(Duration::ZERO),
+            udp_clients,
+            ws_clients,
+            buf: vec![0; 65536],
+            bytes: 0,
+        }
+    }
+
+    /// 推送一帧并等待所有客户端收到
+    async fn tick(&mut self) {
+        self.fanout.tick(&mut self.backend).await.unwrap();
+        self.bytes = 0;
+        for socket in &self.udp_clients {
+            self.bytes += socket.recv(&mut self.buf).await.unwrap();
+        }
+        for ws in &mut self.ws_clients {
+            self.bytes += ws.next().await.unwrap().unwrap().len();
+        }
+    }
+}
+
+fn bench_fanout(c: &mut Criterion) {
+    let rt = Runtime::new().unwrap();
+    let mut group = c.benchmark_group("fanout");
+    for (udp_count, ws_count) in [(1usize, 1usize), (16, 4), (64, 16)] {
+        let mut loopback = rt.block_on(Loopback::new(udp_count, ws_count, &[]));
+        group.bench_function(BenchmarkId::from_parameter(format!("udp{}_ws{}", udp_count, ws_count)), |b| {
+            b.iter(|| rt.block_on(loopback.tick()))
+        });
+    }
+    group.finish();
+}
+
+fn bench_subscriptions(c: &mut Criterion) {
+    let rt = Runtime::new().unwrap();
+    let mut group = c.benchmark_group("subscriptions");
+    // UDP 客户端取注册上限，更多的客户端不会被登记
+    let (udp_count, ws_count) = (fanout::MAX_CLIENTS, 32usize);
+    for (name, masks) in [("full", &[][..]), ("mixed", &[SUB_3DS, SUB_WEB, SUB_WIDGET][..])] {
+        let mut loopback = rt.block_on(Loopback::new(udp_count, ws_count, masks));
+        rt.block_on(loopback.tick());
+        println!(
+            "subscriptions/{}: udp{} ws{} -> {} bytes/tick",
+            name, udp_count, ws_count, loopback.bytes
+        );
+        group.bench_function(BenchmarkId::new(name, format!("udp{}_ws{}", udp_count, ws_count)), |b| {
+            b.iter(|| rt.block_on(loopback.tick()))
+        });
+    }
+    group.finish();
+}
+
+criterion_group! {
+    name = benches;
+    config = Criterion::default().noise_threshold(NOISE_THRESHOLD);
+    targets = bench_refresh, bench_encode, bench_wire, bench_registry, bench_fanout, bench_subscriptions
+}
+criterion_main!(benches);
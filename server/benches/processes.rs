@@ -0,0 +1,26 @@
+//! 进程 Top-K 采样基准测试
+//!
+//! 使用合成进程表测量摊销后的单次采样开销。刷新预算固定，随进程数增长的是每 5 次采样一次的
+//! 进程列表刷新 (列出、排序、清理缓存表)，所以结果仍随进程数增长，约为 O(N log N) / 5。
+//! 参考结果: 1k 进程 25 µs，10k 进程 109 µs，100k 进程 1.5 ms
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use holographic_monitor::procs::{ProcessSampler, SyntheticProcesses};
+
+fn bench_sampler(c: &mut Criterion) {
+    let mut group = c.benchmark_group("process_sample");
+    for count in [1_000u32, 10_000, 100_000] {
+        let mut sampler = ProcessSampler::new(SyntheticProcesses::new(count), 5, 256, 5);
+        // 预热：填满缓存表
+        for _ in 0..(count as usize / 256 + 1) {
+            sampler.sample();
+        }
+        group.bench_with_input(BenchmarkId::from_parameter(count), &count, |b, _| {
+            b.iter(|| sampler.sample())
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_sampler);
+criterion_main!(benches);
@@ -0,0 +1,124 @@
+//! 聚合中继基准测试
+//!
+//! - ingest: 单个上游帧的解码、拆分静态字段与重新编码
+//! - round: N 个进程内合成上游 (Fanout + 合成后端，经本机回环 UDP) 各推送一帧，
+//!   中继收齐后合并转发给一个下游 UDP 客户端，计时到下游收到全部帧为止
+//!
+//! 上游帧由独立任务接收并解码 (与 `Relay::subscribe` 相同，只是省去 HELLO 握手)。
+//! 全部在本机回环上运行，不需要网络。基线与回归阈值见 `bench.sh`
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion};
+use holographic_monitor::{
+    fanout::{ClientRegistry, Fanout, WsHub},
+    monitor::Backend,
+    relay::Relay,
+    synthetic::SyntheticBackend,
+};
+use std::{
+    net::SocketAddr,
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+use tokio::{net::UdpSocket, runtime::Runtime};
+
+/// 低于该相对变化的差异视为噪声 (criterion 不报告为回归)
+const NOISE_THRESHOLD: f64 = 0.03;
+
+fn fanout_on(udp: Arc<UdpSocket>, clients: &[SocketAddr]) -> Fanout {
+    let registry = Arc::new(Mutex::new(ClientRegistry::new(Duration::from_secs(10))));
+    for addr in clients {
+        registry.lock().unwrap().touch(*addr, Instant::now());
+    }
+    Fanout::new(WsHub::new(16), udp, registry)
+}
+
+fn bench_ingest(c: &mut Criterion) {
+    let relay = Relay::new(vec![SocketAddr::from(([127, 0, 0, 1], 9001))]);
+    let mut backend = SyntheticBackend::new(Duration::ZERO);
+    let frame = serde_json::to_vec(&backend.refresh()).unwrap();
+    let mut out = Vec::new();
+    c.bench_function("relay/ingest", |b| {
+        b.iter(|| {
+            relay.ingest(0, &frame);
+            relay.drain(&mut out);
+        })
+    });
+}
+
+/// 上游 + 中继 + 下游客户端
+struct Mesh {
+    upstreams: Vec<(Fanout, SyntheticBackend)>,
+    relay: Arc<Relay>,
+    downstream: Fanout,
+    client: UdpSocket,
+    frames: Vec<String>,
+    buf: Vec<u8>,
+}
+
+impl Mesh {
+    async fn new(count: usize) -> Self {
+        let mut upstreams = Vec::with_capacity(count);
+        let mut subscribers = Vec::with_capacity(count);
+        for _ in 0..count {
+            let udp = Arc::new(UdpSocket::bind("127.0.0.1:0").await.unwrap());
+            let subscriber = UdpSocket::bind("127.0.0.1:0").await.unwrap();
+            subscriber.connect(udp.local_addr().unwrap()).await.unwrap();
+            upstreams.push((fanout_on(udp.clone(), &[subscriber.local_addr().unwrap()]), SyntheticBackend::new(Duration::ZERO)));
+            subscribers.push((udp.local_addr().unwrap(), subscriber));
+        }
+
+        let relay = Relay::new(subscribers.iter().map(|(addr, _)| *addr).collect());
+        for (id, (_, subscriber)) in subscribers.into_iter().enumerate() {
+            let relay = relay.clone();
+            tokio::spawn(async move {
+                let mut buf = vec![0u8; 65536];
+                while let Ok(len) = subscriber.recv(&mut buf).await {
+                    relay.ingest(id, &buf[..len]);
+                }
+            });
+        }
+
+        let client = UdpSocket::bind("127.0.0.1:0").await.unwrap();
+        let udp = Arc::new(UdpSocket::bind("127.0.0.1:0").await.unwrap());
+        let downstream = fanout_on(udp, &[client.local_addr().unwrap()]);
+
+        let mut mesh = Self { upstreams, relay, downstream, client, frames: Vec::new(), buf: vec![0; 65536] };
+        // 首轮包含各主机的静态信息，不计入测量
+        mesh.round().await;
+        mesh
+    }
+
+    /// 所有上游各推送一帧，中继收齐后转发，等待下游收到全部消息
+    async fn round(&mut self) {
+        for (fanout, backend) in &mut self.upstreams {
+            fanout.tick(backend).await.unwrap();
+        }
+        while self.relay.pending() < self.upstreams.len() {
+            tokio::task::yield_now().await;
+        }
+        self.relay.drain(&mut self.frames);
+        self.downstream.publish(&self.frames).await;
+        for _ in 0..self.frames.len() {
+            self.client.recv(&mut self.buf).await.unwrap();
+        }
+    }
+}
+
+fn bench_round(c: &mut Criterion) {
+    let rt = Runtime::new().unwrap();
+    let mut group = c.benchmark_group("relay/round");
+    for count in [10usize, 50, 100] {
+        let mut mesh = rt.block_on(Mesh::new(count));
+        group.bench_with_input(BenchmarkId::from_parameter(count), &count, |b, _| {
+            b.iter(|| rt.block_on(mesh.round()))
+        });
+    }
+    group.finish();
+}
+
+criterion_group! {
+    name = benches;
+    config = Criterion::default().noise_threshold(NOISE_THRESHOLD);
+    targets = bench_ingest, bench_round
+}
+criterion_main!(benches);
@@ -0,0 +1,241 @@
+//! 共享内存指标通道基准测试 (仅 Unix)
+//!
+//! - publish: 生产者写入一个已认领的槽位
+//! - read/N: 服务端读取 N 个已发布的指标
+//! - contended/W: W 个写者线程不停改写同一组 8 个指标，同时测量读取耗时。
+//!   写者每次写入 value = updated_ms = 递增序号，读到的每个指标都必须满足两者相等，
+//!   否则说明读到了写了一半的槽位 (断言失败)
+//! - stale-writer: 把槽位的 seq 改成奇数、owner 改成已退出进程的 PID，模拟写到一半就退出的
+//!   生产者，发布必须在 [`STALE_WRITER`] 后接管槽位，读者读到新值
+//! - stalled-writer: 一个写者在写完名称后持有写权睡眠数倍于 [`STALE_WRITER`] (被抢占但仍存活)，
+//!   其他写者同时改写同一槽位。名称总是 `v<值>`，读到的名称与值必须一致，写者不得被接管
+//!
+//! 每次运行使用独立的段名，结束后删除
+
+#[cfg(unix)]
+mod unix {
+    use criterion::{criterion_group, BenchmarkId, Criterion};
+    use holo_shm::{Producer, Reader, Segment, DEFAULT_SLOTS, HEADER_SIZE, SLOT_SIZE, STALE_WRITER};
+    use std::ffi::CString;
+    use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
+    use std::sync::Arc;
+    use std::thread;
+    use std::time::{Duration, Instant};
+
+    /// 低于该相对变化的差异视为噪声 (criterion 不报告为回归)
+    const NOISE_THRESHOLD: f64 = 0.03;
+    /// 读取时的最大年龄 (毫秒)；测试中的时间戳是序号，不能按真实时间过滤
+    const NO_AGE_LIMIT: u64 = u64::MAX;
+    /// 争用测试中共享的指标数
+    const CONTENDED_IDS: u32 = 8;
+    /// 槽位中 owner 字段的偏移
+    const OWNER_OFFSET: usize = 56;
+    /// 被抢占的写者持有写权的时间
+    const STALL: Duration = Duration::from_millis(50);
+
+    fn segment_name(tag: &str) -> String {
+        format!("/holo-bench-{}-{}", tag, std::process::id())
+    }
+
+    fn bench_publish(c: &mut Criterion) {
+        let name = segment_name("publish");
+        let _reader = Reader::create(&name, DEFAULT_SLOTS).unwrap();
+        let producer = Producer::open(&name).unwrap();
+        let mut value = 0.0;
+        c.bench_function("shm/publish", |b| {
+            b.iter(|| {
+                value += 1.0;
+                producer.publish(1, "queue_depth", value).unwrap();
+            })
+        });
+        let _ = Segment::unlink(&name);
+    }
+
+    fn bench_read(c: &mut Criterion) {
+        let mut group = c.benchmark_group("shm/read");
+        for count in [8u32, 64] {
+            let name = segment_name(&format!("read{}", count));
+            let reader = Reader::create(&name, DEFAULT_SLOTS).unwrap();
+            let producer = Producer::open(&name).unwrap();
+            for id in 1..=count {
+                producer.publish(id, &format!("gauge_{}", id), id as f64).unwrap();
+            }
+            let mut out = Vec::with_capacity(DEFAULT_SLOTS as usize);
+            group.bench_with_input(BenchmarkId::from_parameter(count), &count, |b, _| {
+                b.iter(|| {
+                    reader.read(holo_shm::now_ms(), NO_AGE_LIMIT, &mut out);
+                    assert_eq!(out.len(), count as usize);
+                })
+            });
+            let _ = Segment::unlink(&name);
+        }
+        group.finish();
+    }
+
+    fn bench_contended(c: &mut Criterion) {
+        let mut group = c.benchmark_group("shm/contended");
+        for writers in [1usize, 4, 8] {
+            let name = segment_name(&format!("contended{}", writers));
+            let reader = Reader::create(&name, DEFAULT_SLOTS).unwrap();
+            let stop = Arc::new(AtomicBool::new(false));
+            // 全部写者共用的序号，保证每次写入的值不同
+            let counter = Arc::new(AtomicU64::new(1));
+            let handles: Vec<_> = (0..writers)
+                .map(|w| {
+                    let producer = Producer::open(&name).unwrap();
+                    let stop = stop.clone();
+                    let counter = counter.clone();
+                    thread::spawn(move || {
+                        let mut id = w as u32 % CONTENDED_IDS;
+                        while !stop.load(Ordering::Relaxed) {
+                            let n = counter.fetch_add(1, Ordering::Relaxed);
+                            producer.publish_at(id + 1, "contended", n as f64, n).unwrap();
+                            id = (id + 1) % CONTENDED_IDS;
+                        }
+                    })
+                })
+                .collect();
+            // 等写者全部跑起来再开始测量
+            while counter.load(Ordering::Relaxed) < writers as u64 * 1000 {
+                thread::yield_now();
+            }
+
+            let mut out = Vec::with_capacity(DEFAULT_SLOTS as usize);
+            let mut reads = 0u64;
+            let mut skipped = 0u64;
+            group.bench_with_input(BenchmarkId::from_parameter(writers), &writers, |b, _| {
+                b.iter(|| {
+                    skipped += reader.read(0, NO_AGE_LIMIT, &mut out) as u64;
+                    reads += 1;
+                    for reading in &out {
+                        assert_eq!(reading.value as u64, reading.updated_ms, "读到不一致的槽位");
+                    }
+                })
+            });
+
+            stop.store(true, Ordering::Relaxed);
+            for handle in handles {
+                handle.join().unwrap();
+            }
+            println!(
+                "shm/contended/{}: {} 次读取，{} 个槽位因持续写入被跳过，写入 {} 次",
+                writers,
+                reads,
+                skipped,
+                counter.load(Ordering::Relaxed) - 1
+            );
+            let _ = Segment::unlink(&name);
+        }
+        group.finish();
+    }
+
+    /// 直接映射段，把第 `index` 个槽位的 seq 改成奇数、owner 改成 `owner` (模拟写入中途退出的生产者)
+    fn leave_slot_locked(name: &str, index: usize, owner: u32) {
+        let len = HEADER_SIZE + DEFAULT_SLOTS as usize * SLOT_SIZE;
+        let cname = CString::new(name).unwrap();
+        unsafe {
+            let fd = libc::shm_open(cname.as_ptr(), libc::O_RDWR, 0);
+            assert!(fd >= 0, "打开段失败");
+            let ptr = libc::mmap(std::ptr::null_mut(), len, libc::PROT_READ | libc::PROT_WRITE, libc::MAP_SHARED, fd, 0);
+            libc::close(fd);
+            assert!(ptr != libc::MAP_FAILED, "映射段失败");
+            let slot = (ptr as *mut u8).add(HEADER_SIZE + index * SLOT_SIZE);
+            (*(slot.add(OWNER_OFFSET) as *const AtomicU32)).store(owner, Ordering::Release);
+            (*(slot as *const AtomicU32)).fetch_add(1, Ordering::AcqRel);
+            libc::munmap(ptr, len);
+        }
+    }
+
+    fn bench_stale_writer(_c: &mut Criterion) {
+        let name = segment_name("stale");
+        let reader = Reader::create(&name, DEFAULT_SLOTS).unwrap();
+        let producer = Producer::open(&name).unwrap();
+        producer.publish_at(1, "stale", 1.0, 1).unwrap();
+        let mut out = Vec::new();
+        reader.read(0, NO_AGE_LIMIT, &mut out);
+        assert_eq!(out.len(), 1);
+        // ID 1 的槽位: 从哈希起点开始的第一个
+        let index = 1u32.wrapping_mul(0x9E37_79B9) as usize % DEFAULT_SLOTS as usize;
+        // 已退出并回收的子进程 PID
+        let mut child = std::process::Command::new("true").spawn().unwrap();
+        let dead = child.id();
+        child.wait().unwrap();
+        leave_slot_locked(&name, index, dead);
+        // 读者跳过写到一半的槽位
+        assert_eq!(reader.read(0, NO_AGE_LIMIT, &mut out), 1);
+
+        let started = Instant::now();
+        producer.publish_at(1, "stale", 2.0, 2).unwrap();
+        let waited = started.elapsed();
+        assert!(waited >= STALE_WRITER && waited < STALE_WRITER + Duration::from_secs(1), "接管用时 {:?}", waited);
+        assert_eq!(reader.read(0, NO_AGE_LIMIT, &mut out), 0);
+        assert_eq!((out.len(), out[0].value, out[0].updated_ms), (1, 2.0, 2));
+        // 接管后槽位恢复正常，之后的写入不再等待
+        let started = Instant::now();
+        producer.publish_at(1, "stale", 3.0, 3).unwrap();
+        assert!(started.elapsed() < STALE_WRITER);
+        println!("shm/stale-writer: {:.1} ms 后接管写到一半的槽位", waited.as_secs_f64() * 1e3);
+        let _ = Segment::unlink(&name);
+    }
+
+    fn bench_stalled_writer(_c: &mut Criterion) {
+        let name = segment_name("stalled");
+        let reader = Reader::create(&name, DEFAULT_SLOTS).unwrap();
+        let stop = Arc::new(AtomicBool::new(false));
+        let counter = Arc::new(AtomicU64::new(1));
+        let slow = {
+            let producer = Producer::open(&name).unwrap();
+            let counter = counter.clone();
+            thread::spawn(move || {
+                for _ in 0..6 {
+                    let n = counter.fetch_add(1, Ordering::Relaxed);
+                    producer.publish_stalled(1, &format!("v{}", n), n as f64, n, STALL);
+                    thread::sleep(STALL / 5);
+                }
+            })
+        };
+        let fast: Vec<_> = (0..2)
+            .map(|_| {
+                let producer = Producer::open(&name).unwrap();
+                let stop = stop.clone();
+                let counter = counter.clone();
+                thread::spawn(move || {
+                    while !stop.load(Ordering::Relaxed) {
+                        let n = counter.fetch_add(1, Ordering::Relaxed);
+                        producer.publish_at(1, &format!("v{}", n), n as f64, n).unwrap();
+                    }
+                })
+            })
+            .collect();
+
+        let mut out = Vec::new();
+        let mut reads = 0u64;
+        while !slow.is_finished() {
+            reader.read(0, NO_AGE_LIMIT, &mut out);
+            for reading in &out {
+                assert_eq!(reading.name(), format!("v{}", reading.updated_ms), "名称与值来自不同的写入");
+                assert_eq!(reading.value as u64, reading.updated_ms, "读到不一致的槽位");
+                reads += 1;
+            }
+        }
+        stop.store(true, Ordering::Relaxed);
+        slow.join().unwrap();
+        for handle in fast {
+            handle.join().unwrap();
+        }
+        println!("shm/stalled-writer: {} 次一致读取，写入 {} 次", reads, counter.load(Ordering::Relaxed) - 1);
+        let _ = Segment::unlink(&name);
+    }
+
+    criterion_group! {
+        name = benches;
+        config = Criterion::default().noise_threshold(NOISE_THRESHOLD);
+        targets = bench_stale_writer, bench_stalled_writer, bench_publish, bench_read, bench_contended
+    }
+}
+
+#[cfg(unix)]
+criterion::criterion_main!(unix::benches);
+
+#[cfg(not(unix))]
+fn main() {}
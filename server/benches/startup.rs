@@ -0,0 +1,84 @@
+//! 首帧耗时测试 (仅 Linux)
+//!
+//! 以合成数据后端启动服务端，一个 UDP 客户端从进程启动起每 [`PING_INTERVAL`] 发送一次心跳，
+//! 记录从启动到收到第一帧数据的时间。重复 [`RUNS`] 次，任意一次超出
+//! [`FIRST_FRAME_BUDGET_MS`] (与 `src/main.rs` 中的预算相同) 时断言失败
+
+#[cfg(target_os = "linux")]
+mod common;
+
+#[cfg(target_os = "linux")]
+mod linux {
+    use crate::common::free_port;
+    use std::net::UdpSocket;
+    use std::process::{Command, Stdio};
+    use std::time::{Duration, Instant};
+
+    /// 首帧预算 (毫秒)
+    const FIRST_FRAME_BUDGET_MS: u128 = 400;
+    /// 启动次数
+    const RUNS: usize = 5;
+    /// 等待首帧时的心跳间隔 (服务端启动前发出的心跳会丢失)
+    const PING_INTERVAL: Duration = Duration::from_millis(5);
+    /// 超过该时间仍未收到数据帧视为启动失败
+    const GIVE_UP: Duration = Duration::from_secs(10);
+
+    /// 启动一次服务端，返回从启动到收到首帧的时间
+    fn first_frame() -> Duration {
+        let (ws, udp, metrics) = (free_port(), free_port(), free_port());
+        let socket = UdpSocket::bind("127.0.0.1:0").unwrap();
+        socket.connect(("127.0.0.1", udp)).unwrap();
+        socket.set_read_timeout(Some(PING_INTERVAL)).unwrap();
+
+        let started = Instant::now();
+        let mut child = Command::new(env!("CARGO_BIN_EXE_holographic-monitor"))
+            .arg("--synthetic")
+            .arg(format!("--ws-port={}", ws))
+            .arg(format!("--udp-port={}", udp))
+            .arg(format!("--metrics-port={}", metrics))
+            .stdout(Stdio::null())
+            .spawn()
+            .unwrap();
+        let mut buf = [0u8; 4096];
+        let elapsed = loop {
+            assert!(started.elapsed() < GIVE_UP, "{} 秒内没有收到数据帧", GIVE_UP.as_secs());
+            // 服务端未就绪时发送可能失败 (ICMP 端口不可达)，继续重试
+            let _ = socket.send(b"PING");
+            if let Ok(len) = socket.recv(&mut buf) {
+                if buf[..len].starts_with(b"{") {
+                    break started.elapsed();
+                }
+            }
+        };
+        let _ = child.kill();
+        let _ = child.wait();
+        elapsed
+    }
+
+    pub fn main() {
+        let mut times: Vec<Duration> = (0..RUNS).map(|_| first_frame()).collect();
+        times.sort();
+        let worst = times[RUNS - 1];
+        println!(
+            "startup/first-frame: 中位数 {} ms, 最慢 {} ms ({} 次启动，预算 {} ms)",
+            times[RUNS / 2].as_millis(),
+            worst.as_millis(),
+            RUNS,
+            FIRST_FRAME_BUDGET_MS
+        );
+        assert!(
+            worst.as_millis() <= FIRST_FRAME_BUDGET_MS,
+            "首帧耗时 {} ms 超出预算 {} ms",
+            worst.as_millis(),
+            FIRST_FRAME_BUDGET_MS
+        );
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn main() {
+    linux::main();
+}
+
+#[cfg(not(target_os = "linux"))]
+fn main() {}
@@ -0,0 +1,95 @@
+//! 把 `../web` 目录内嵌进服务端二进制 (见 `src/web.rs`)
+//!
+//! 每个文件生成原文、gzip 与 brotli 三份 (压缩后不比原文小时不保留)，写入 OUT_DIR，
+//! 并生成 `web_assets.rs` 资源表: 路径、Content-Type、强 ETag (内容的 FNV-1a 64 位哈希)
+//! 和指向三份数据的 `include_bytes!`。压缩只在编译时做一次，运行时不读磁盘
+
+use std::fmt::Write as _;
+use std::io::Write as _;
+use std::path::{Path, PathBuf};
+
+/// gzip 压缩级别 (最高)
+const GZIP_LEVEL: u32 = 9;
+/// brotli 质量 (最高) 与窗口大小 (log2)
+const BROTLI_QUALITY: u32 = 11;
+const BROTLI_LGWIN: u32 = 22;
+
+fn content_type(path: &Path) -> &'static str {
+    match path.extension().and_then(|ext| ext.to_str()) {
+        Some("html") => "text/html; charset=utf-8",
+        Some("js") => "text/javascript; charset=utf-8",
+        Some("css") => "text/css; charset=utf-8",
+        Some("json") => "application/json",
+        Some("svg") => "image/svg+xml",
+        Some("png") => "image/png",
+        Some("ico") => "image/x-icon",
+        _ => "application/octet-stream",
+    }
+}
+
+fn fnv1a(bytes: &[u8]) -> u64 {
+    bytes.iter().fold(0xcbf2_9ce4_8422_2325, |hash, &b| (hash ^ b as u64).wrapping_mul(0x0000_0100_0000_01b3))
+}
+
+fn gzip(bytes: &[u8]) -> Vec<u8> {
+    let mut encoder = flate2::write::GzEncoder::new(Vec::new(), flate2::Compression::new(GZIP_LEVEL));
+    encoder.write_all(bytes).unwrap();
+    encoder.finish().unwrap()
+}
+
+fn brotli(bytes: &[u8]) -> Vec<u8> {
+    let mut out = Vec::new();
+    {
+        let mut encoder = brotli::CompressorWriter::new(&mut out, 4096, BROTLI_QUALITY, BROTLI_LGWIN);
+        encoder.write_all(bytes).unwrap();
+    }
+    out
+}
+
+/// 把 `data` 写入 OUT_DIR，返回 `Some(include_bytes!(..))` 表达式；比原文大时返回 `None`
+fn variant(out_dir: &Path, name: &str, data: Vec<u8>, original: usize) -> String {
+    if data.len() >= original {
+        return "None".to_string();
+    }
+    let path = out_dir.join(name);
+    std::fs::write(&path, data).unwrap();
+    format!("Some(include_bytes!({:?}))", path)
+}
+
+fn main() {
+    let web_dir = PathBuf::from(std::env::var("CARGO_MANIFEST_DIR").unwrap()).join("../web");
+    let out_dir = PathBuf::from(std::env::var("OUT_DIR").unwrap()).join("web");
+    println!("cargo:rerun-if-changed={}", web_dir.display());
+    std::fs::create_dir_all(&out_dir).unwrap();
+
+    let mut files: Vec<PathBuf> = match std::fs::read_dir(&web_dir) {
+        Ok(entries) => entries.filter_map(|e| Some(e.ok()?.path())).filter(|p| p.is_file()).collect(),
+        Err(_) => {
+            println!("cargo:warning=未找到 {}，服务端不内嵌网页", web_dir.display());
+            Vec::new()
+        }
+    };
+    files.sort();
+
+    let mut table = String::from("/// 内嵌的 web/ 资源 (build.rs 生成)\npub static ASSETS: &[Asset] = &[\n");
+    for file in &files {
+        let name = file.file_name().unwrap().to_string_lossy().into_owned();
+        let bytes = std::fs::read(file).unwrap();
+        let identity = out_dir.join(&name);
+        std::fs::write(&identity, &bytes).unwrap();
+        let gzip = variant(&out_dir, &format!("{}.gz", name), gzip(&bytes), bytes.len());
+        let brotli = variant(&out_dir, &format!("{}.br", name), brotli(&bytes), bytes.len());
+        let _ = writeln!(
+            table,
+            "    Asset {{ path: {:?}, content_type: {:?}, etag: \"\\\"{:016x}\\\"\", identity: include_bytes!({:?}), gzip: {}, brotli: {} }},",
+            format!("/{}", name),
+            content_type(file),
+            fnv1a(&bytes),
+            identity,
+            gzip,
+            brotli
+        );
+    }
+    table.push_str("];\n");
+    std::fs::write(PathBuf::from(std::env::var("OUT_DIR").unwrap()).join("web_assets.rs"), table).unwrap();
+}
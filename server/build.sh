@@ -29,13 +29,13 @@ if [ ! -f "$TEMP_SENSOR_SRC" ]; then
     exit 1
 fi
 
-# 使用 clang++ 编译，链接必要框架
+# 使用 clang++ 编译，链接必要框架 (风扇曲线控制器 fanctl.c 按 C 编译)
 clang++ -O3 -Wall \
     -framework IOKit \
     -framework CoreFoundation \
     -framework Foundation \
     -lobjc \
-    "$TEMP_SENSOR_SRC" -o dist/temp_sensor
+    "$TEMP_SENSOR_SRC" -x c temp-sensor/fanctl.c -o dist/temp_sensor
 
 # 4. 整理产物
 echo -e "${BLUE}📦 正在整理产物...${NC}"
@@ -0,0 +1,231 @@
+/**
+ * holo_shm.h - 共享内存指标通道 C 生产者
+ *
+ * 把数值指标写入服务端 (--shm) 创建的共享内存段，服务端每帧读取并随遥测推送。
+ * 布局与同步协议见 shm/src/lib.rs。单头文件，需要 C11 <stdatomic.h>；
+ * 以 -std=c11 编译时需定义 _POSIX_C_SOURCE=200809L (或用 -std=gnu11)，
+ * 旧版 glibc 链接时需加 -lrt。
+ *
+ *     holo_shm_t shm;
+ *     if (holo_shm_open(&shm, HOLO_SHM_DEFAULT_NAME) == 0) {
+ *         holo_shm_publish(&shm, 1, "queue_depth", 42.0);
+ *         ...
+ *         holo_shm_close(&shm);
+ *     }
+ */
+#ifndef HOLO_SHM_H
+#define HOLO_SHM_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <math.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOLO_SHM_DEFAULT_NAME "/holographic-monitor"
+#define HOLO_SHM_MAGIC 0x48534D48u
+#define HOLO_SHM_VERSION 2
+#define HOLO_SHM_HEADER_SIZE 64
+#define HOLO_SHM_SLOT_SIZE 64
+#define HOLO_SHM_NAME_LEN 32
+#define HOLO_SHM_HASH 0x9E3779B9u
+/* 写权被同一持有者持有超过该时间 (毫秒) 后检查其进程是否存活，已退出时接管槽位 */
+#define HOLO_SHM_STALE_WRITER_MS 10
+/* 等待写者时先忙等的次数，之后每次让出 CPU */
+#define HOLO_SHM_WRITE_SPINS 64
+
+typedef struct {
+    _Atomic uint32_t magic;
+    _Atomic uint16_t version;
+    _Atomic uint16_t slot_count;
+    _Atomic uint32_t slot_size;
+    uint32_t reserved[13];
+} holo_shm_header_t;
+
+typedef struct {
+    _Atomic uint32_t seq;
+    _Atomic uint32_t id;
+    _Atomic uint64_t value;       /* double 的位模式 */
+    _Atomic uint64_t updated_ms;
+    _Atomic uint64_t name[HOLO_SHM_NAME_LEN / 8];
+    _Atomic uint32_t owner;       /* 持有写权的生产者 PID，0 表示空闲 */
+    uint32_t reserved;
+} holo_shm_slot_t;
+
+_Static_assert(sizeof(holo_shm_header_t) == HOLO_SHM_HEADER_SIZE, "header layout");
+_Static_assert(sizeof(holo_shm_slot_t) == HOLO_SHM_SLOT_SIZE, "slot layout");
+
+typedef struct {
+    void* base;
+    size_t len;
+    holo_shm_slot_t* slots;
+    uint32_t slot_count;
+} holo_shm_t;
+
+/** 当前 Unix 时间 (毫秒) */
+static inline uint64_t holo_shm_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/** 打开服务端创建的段；段不存在或格式不符时返回 -1 */
+static inline int holo_shm_open(holo_shm_t* shm, const char* name) {
+    struct stat st;
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < HOLO_SHM_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    holo_shm_header_t* header = (holo_shm_header_t*)base;
+    uint32_t count = atomic_load_explicit(&header->slot_count, memory_order_relaxed);
+    if (atomic_load_explicit(&header->magic, memory_order_acquire) != HOLO_SHM_MAGIC ||
+        atomic_load_explicit(&header->version, memory_order_relaxed) != HOLO_SHM_VERSION ||
+        atomic_load_explicit(&header->slot_size, memory_order_relaxed) != HOLO_SHM_SLOT_SIZE ||
+        HOLO_SHM_HEADER_SIZE + (size_t)count * HOLO_SHM_SLOT_SIZE > (size_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return -1;
+    }
+    shm->base = base;
+    shm->len = (size_t)st.st_size;
+    shm->slots = (holo_shm_slot_t*)((char*)base + HOLO_SHM_HEADER_SIZE);
+    shm->slot_count = count;
+    return 0;
+}
+
+static inline void holo_shm_close(holo_shm_t* shm) {
+    if (shm->base) munmap(shm->base, shm->len);
+    shm->base = NULL;
+    shm->slots = NULL;
+    shm->slot_count = 0;
+}
+
+/** 查找 ID 对应的槽位，claim 非 0 时没有则认领空闲槽位 */
+static inline holo_shm_slot_t* holo_shm_find(holo_shm_t* shm, uint32_t id, int claim) {
+    if (shm->slot_count == 0) return NULL;
+    uint32_t start = (uint32_t)(id * HOLO_SHM_HASH) % shm->slot_count;
+    for (uint32_t k = 0; k < shm->slot_count; k++) {
+        holo_shm_slot_t* slot = &shm->slots[(start + k) % shm->slot_count];
+        uint32_t current = atomic_load_explicit(&slot->id, memory_order_acquire);
+        if (current == id) return slot;
+        if (current != 0) continue;
+        if (!claim) return NULL;
+        uint32_t expected = 0;
+        if (atomic_compare_exchange_strong_explicit(&slot->id, &expected, id,
+                                                    memory_order_acq_rel, memory_order_acquire) ||
+            expected == id) {
+            return slot;
+        }
+    }
+    return NULL;
+}
+
+/** 单调时钟 (毫秒)，只用于等待写者的计时 */
+static inline uint64_t holo_shm_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/** 进程是否存在 (无权发信号的进程也算存在) */
+static inline int holo_shm_process_alive(uint32_t pid) {
+    return kill((pid_t)pid, 0) == 0 || errno != ESRCH;
+}
+
+/** 取得写权，返回持有期间的 (奇数) seq；持有者进程已退出时接管 */
+static inline uint32_t holo_shm_lock(holo_shm_slot_t* slot, uint32_t pid) {
+    uint32_t waiting_owner = 0, waiting_seq = 0;
+    uint64_t waiting_since = 0;
+    uint32_t spins = 0;
+    for (;;) {
+        uint32_t owner = atomic_load_explicit(&slot->owner, memory_order_relaxed);
+        int taken = 0;
+        if (owner == 0) {
+            taken = atomic_compare_exchange_weak_explicit(&slot->owner, &owner, pid, memory_order_acquire,
+                                                          memory_order_relaxed);
+        } else {
+            uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+            if (waiting_owner != owner || waiting_seq != seq) {
+                waiting_owner = owner;
+                waiting_seq = seq;
+                waiting_since = holo_shm_monotonic_ms();
+            } else if (holo_shm_monotonic_ms() - waiting_since >= HOLO_SHM_STALE_WRITER_MS) {
+                if (holo_shm_process_alive(owner)) {
+                    /* 持有者只是被抢占: 继续等待，下次检查再隔一个周期 */
+                    waiting_since = holo_shm_monotonic_ms();
+                } else {
+                    taken = atomic_compare_exchange_strong_explicit(&slot->owner, &owner, pid, memory_order_acquire,
+                                                                    memory_order_relaxed);
+                }
+            }
+        }
+        if (taken) {
+            /* 只有持有者修改 seq；退出的写者可能停在奇数 */
+            uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+            if (!(seq & 1u)) atomic_store_explicit(&slot->seq, seq + 1u, memory_order_relaxed);
+            return seq | 1u;
+        }
+        if (spins < HOLO_SHM_WRITE_SPINS) {
+            spins++;
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+static inline void holo_shm_write(holo_shm_slot_t* slot, const char* name, double value, uint64_t updated_ms) {
+    uint32_t pid = (uint32_t)getpid();
+    uint32_t held = holo_shm_lock(slot, pid);
+    atomic_thread_fence(memory_order_release);
+
+    if (name) {
+        char padded[HOLO_SHM_NAME_LEN] = {0};
+        strncpy(padded, name, HOLO_SHM_NAME_LEN);
+        for (int i = 0; i < HOLO_SHM_NAME_LEN / 8; i++) {
+            uint64_t word;
+            memcpy(&word, padded + i * 8, sizeof word);
+            atomic_store_explicit(&slot->name[i], word, memory_order_relaxed);
+        }
+    }
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    atomic_store_explicit(&slot->value, bits, memory_order_relaxed);
+    atomic_store_explicit(&slot->updated_ms, updated_ms, memory_order_relaxed);
+    /* 失败说明槽位已被接管: 不发布、不释放别人的写权 */
+    uint32_t expected = held;
+    if (atomic_compare_exchange_strong_explicit(&slot->seq, &expected, held + 1u, memory_order_release,
+                                                memory_order_relaxed)) {
+        expected = pid;
+        atomic_compare_exchange_strong_explicit(&slot->owner, &expected, 0, memory_order_release,
+                                                memory_order_relaxed);
+    }
+}
+
+/** 发布指标 (ID 不能为 0，名称超过 32 字节时截断)；槽位已满返回 -1 */
+static inline int holo_shm_publish(holo_shm_t* shm, uint32_t id, const char* name, double value) {
+    if (id == 0) return -1;
+    holo_shm_slot_t* slot = holo_shm_find(shm, id, 1);
+    if (!slot) return -1;
+    holo_shm_write(slot, name, value, holo_shm_now_ms());
+    return 0;
+}
+
+/** 撤销指标 (服务端不再上报) */
+static inline void holo_shm_remove(holo_shm_t* shm, uint32_t id) {
+    holo_shm_slot_t* slot = holo_shm_find(shm, id, 0);
+    if (slot) holo_shm_write(slot, NULL, NAN, 0);
+}
+
+#endif /* HOLO_SHM_H */
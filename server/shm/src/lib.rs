@@ -0,0 +1,495 @@
+//! 共享内存指标通道
+//!
+//! 外部进程 (生产者) 把少量数值指标 (队列深度、请求速率等) 写入一段 POSIX 共享内存，
+//! 服务端每帧直接读取映射中的槽位并随遥测推送，不经过 socket，也不解析子进程输出。
+//! C 生产者使用 `include/holo_shm.h`，布局与本文件一致。
+//!
+//! 布局 (版本 2，本机字节序，段由服务端创建):
+//!
+//! ```text
+//! 头部 64 字节
+//!   0  u32     magic       0x48534D48
+//!   4  u16     version     2
+//!   6  u16     slot_count
+//!   8  u32     slot_size   64
+//!  12  ..      保留 (0)
+//! 槽位 slot_count 个，每个 64 字节，从偏移 64 开始
+//!   0  u32     seq         seqlock 序号，奇数表示正在写入
+//!   4  u32     id          指标 ID，0 表示空闲；生产者以 CAS 0 → id 认领，之后不再改变
+//!   8  f64     value
+//!  16  u64     updated_ms  最近一次写入的 Unix 时间 (毫秒)，0 表示未发布或已撤销
+//!  24  u8[32]  name        指标名 (ASCII，不足补 0)
+//!  56  u32     owner       持有写权的生产者 PID，0 表示空闲
+//!  60  u32     保留
+//! ```
+//!
+//! - 查找: 从 `id * 0x9E3779B9 % slot_count` 开始线性探测，同一 ID 的多个生产者共用一个槽位
+//! - 写入 (多生产者安全): 自旋直到 CAS 把 owner 从 0 改成本进程 PID，把 seq 改成奇数，写字段，
+//!   CAS 把 seq 改成下一个偶数，最后 CAS 把 owner 改回 0。持有者只是被抢占时其他写者一直等待；
+//!   同一 owner 与 seq 保持超过 [`STALE_WRITER`] 后才检查持有者进程，`kill(pid, 0)` 确认已退出时
+//!   CAS 把 owner 改成自己接管槽位 (seq 若停在奇数则保持奇数继续写)。释放 seq 的 CAS 失败说明
+//!   槽位已被接管，本次写入作废。生产者与服务端需在同一 PID 命名空间
+//! - 读取: acquire 读 seq (奇数则重试)，读字段，acquire 栅栏后再读 seq，两次相同才采用
+
+use std::ffi::CString;
+use std::fmt;
+use std::io;
+use std::sync::atomic::{fence, AtomicU16, AtomicU32, AtomicU64, Ordering};
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+pub const MAGIC: u32 = 0x4853_4D48;
+pub const VERSION: u16 = 2;
+pub const HEADER_SIZE: usize = 64;
+pub const SLOT_SIZE: usize = 64;
+/// 服务端创建段时的默认槽位数
+pub const DEFAULT_SLOTS: u16 = 64;
+/// 指标名最大字节数
+pub const NAME_LEN: usize = 32;
+/// 默认共享内存对象名 (shm_open)
+pub const DEFAULT_NAME: &str = "/holographic-monitor";
+
+/// 读取时遇到并发写入的最多重试次数，超过后本次跳过该槽位
+const READ_RETRIES: usize = 4;
+/// 写权被同一持有者持有超过该时间后检查其进程是否存活 (正常写入只持有几十纳秒；与 C 头文件一致)
+pub const STALE_WRITER: Duration = Duration::from_millis(10);
+/// 等待写者时先忙等的次数，之后每次让出 CPU
+const WRITE_SPINS: u32 = 64;
+/// 槽位起点哈希乘数 (与 C 头文件一致)
+const HASH: u32 = 0x9E37_79B9;
+
+#[repr(C)]
+struct Header {
+    magic: AtomicU32,
+    version: AtomicU16,
+    slot_count: AtomicU16,
+    slot_size: AtomicU32,
+    reserved: [u32; 13],
+}
+
+#[repr(C)]
+struct Slot {
+    seq: AtomicU32,
+    id: AtomicU32,
+    value: AtomicU64,
+    updated_ms: AtomicU64,
+    name: [AtomicU64; NAME_LEN / 8],
+    owner: AtomicU32,
+    reserved: u32,
+}
+
+const _: () = assert!(std::mem::size_of::<Header>() == HEADER_SIZE);
+const _: () = assert!(std::mem::size_of::<Slot>() == SLOT_SIZE);
+
+impl Slot {
+    /// 取得写权，返回持有期间的 (奇数) seq。持有者进程已退出时接管 (见模块文档)
+    fn lock(&self, pid: u32) -> u32 {
+        // 正在等待的 (owner, seq) 及开始等待的时间
+        let mut waiting: Option<(u32, u32, Instant)> = None;
+        let mut spins = 0u32;
+        loop {
+            let owner = self.owner.load(Ordering::Relaxed);
+            let taken = if owner == 0 {
+                self.owner.compare_exchange_weak(0, pid, Ordering::Acquire, Ordering::Relaxed).is_ok()
+            } else {
+                let seq = self.seq.load(Ordering::Relaxed);
+                match waiting {
+                    Some((held_by, held_seq, since)) if (held_by, held_seq) == (owner, seq) => {
+                        if since.elapsed() < STALE_WRITER {
+                            false
+                        } else if process_alive(owner) {
+                            // 持有者只是被抢占: 继续等待，下次检查再隔一个周期
+                            waiting = Some((owner, seq, Instant::now()));
+                            false
+                        } else {
+                            self.owner.compare_exchange(owner, pid, Ordering::Acquire, Ordering::Relaxed).is_ok()
+                        }
+                    }
+                    _ => {
+                        waiting = Some((owner, seq, Instant::now()));
+                        false
+                    }
+                }
+            };
+            if taken {
+                // 只有持有者修改 seq；退出的写者可能停在奇数
+                let seq = self.seq.load(Ordering::Relaxed);
+                if seq & 1 == 0 {
+                    self.seq.store(seq.wrapping_add(1), Ordering::Relaxed);
+                }
+                return seq | 1;
+            }
+            if spins < WRITE_SPINS {
+                spins += 1;
+                std::hint::spin_loop();
+            } else {
+                std::thread::yield_now();
+            }
+        }
+    }
+
+    /// seqlock 写入 (多个写者之间互斥)。`stall` 在写完名称、写值之前调用 (测试被抢占的写者)
+    fn write(&self, name: Option<&[u8; NAME_LEN]>, value: f64, updated_ms: u64, stall: impl FnOnce()) {
+        let pid = std::process::id();
+        let held = self.lock(pid);
+        // 字段写入不得早于奇数序号对读者可见
+        fence(Ordering::Release);
+        if let Some(name) = name {
+            for (word, chunk) in self.name.iter().zip(name.chunks_exact(8)) {
+                word.store(u64::from_ne_bytes(chunk.try_into().unwrap()), Ordering::Relaxed);
+            }
+        }
+        stall();
+        self.value.store(value.to_bits(), Ordering::Relaxed);
+        self.updated_ms.store(updated_ms, Ordering::Relaxed);
+        // 失败说明槽位已被接管: 不发布、不释放别人的写权
+        if self.seq.compare_exchange(held, held.wrapping_add(1), Ordering::Release, Ordering::Relaxed).is_ok() {
+            let _ = self.owner.compare_exchange(pid, 0, Ordering::Release, Ordering::Relaxed);
+        }
+    }
+
+    /// seqlock 读取；与写入冲突超过重试次数时返回 None
+    fn read(&self) -> Option<(f64, u64, [u8; NAME_LEN])> {
+        for _ in 0..READ_RETRIES {
+            let before = self.seq.load(Ordering::Acquire);
+            if before & 1 == 1 {
+                std::hint::spin_loop();
+                continue;
+            }
+            let value = f64::from_bits(self.value.load(Ordering::Relaxed));
+            let updated_ms = self.updated_ms.load(Ordering::Relaxed);
+            let mut name = [0u8; NAME_LEN];
+            for (chunk, word) in name.chunks_exact_mut(8).zip(&self.name) {
+                chunk.copy_from_slice(&word.load(Ordering::Relaxed).to_ne_bytes());
+            }
+            fence(Ordering::Acquire);
+            if self.seq.load(Ordering::Relaxed) == before {
+                return Some((value, updated_ms, name));
+            }
+        }
+        None
+    }
+}
+
+/// 映射的共享内存段
+pub struct Segment {
+    ptr: *mut u8,
+    len: usize,
+    /// 创建或打开时校验过的槽位数。段对所有用户可写，之后不再从头部读取
+    slot_count: usize,
+}
+
+// 段内所有共享字段都是原子类型
+unsafe impl Send for Segment {}
+unsafe impl Sync for Segment {}
+
+impl Segment {
+    /// 创建 (或打开已有的) 段并初始化头部。已有的有效段保持原样，生产者的槽位跨服务端重启保留
+    pub fn create(name: &str, slots: u16) -> io::Result<Self> {
+        let fd = shm_open(name, libc::O_CREAT | libc::O_RDWR)?;
+        let wanted = HEADER_SIZE + slots as usize * SLOT_SIZE;
+        let result = (|| {
+            // 不受 umask 影响: 其他用户的服务也要能写入
+            if unsafe { libc::fchmod(fd, 0o666) } != 0 {
+                return Err(io::Error::last_os_error());
+            }
+            let mut len = file_len(fd)?;
+            if len < wanted {
+                if unsafe { libc::ftruncate(fd, wanted as libc::off_t) } != 0 {
+                    return Err(io::Error::last_os_error());
+                }
+                len = wanted;
+            }
+            let mut segment = Self::map(fd, len)?;
+            segment.slot_count = match segment.validate() {
+                Ok(count) => count,
+                Err(_) => {
+                    segment.init(slots);
+                    slots as usize
+                }
+            };
+            Ok(segment)
+        })();
+        unsafe { libc::close(fd) };
+        result
+    }
+
+    /// 打开服务端已创建的段 (生产者使用)
+    pub fn open(name: &str) -> io::Result<Self> {
+        let fd = shm_open(name, libc::O_RDWR)?;
+        let result = file_len(fd).and_then(|len| {
+            if len < HEADER_SIZE {
+                return Err(io::Error::new(io::ErrorKind::InvalidData, "共享内存段尚未初始化"));
+            }
+            Self::map(fd, len)
+        });
+        unsafe { libc::close(fd) };
+        let mut segment = result?;
+        segment.slot_count = segment.validate()?;
+        Ok(segment)
+    }
+
+    /// 删除共享内存对象 (已映射的进程不受影响)
+    pub fn unlink(name: &str) -> io::Result<()> {
+        let name = CString::new(name).map_err(|e| io::Error::new(io::ErrorKind::InvalidInput, e))?;
+        if unsafe { libc::shm_unlink(name.as_ptr()) } != 0 {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(())
+    }
+
+    fn map(fd: libc::c_int, len: usize) -> io::Result<Self> {
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Self { ptr: ptr as *mut u8, len, slot_count: 0 })
+    }
+
+    fn header(&self) -> &Header {
+        unsafe { &*(self.ptr as *const Header) }
+    }
+
+    fn init(&self, slots: u16) {
+        let header = self.header();
+        header.magic.store(0, Ordering::Relaxed);
+        for slot in self.slots_unchecked(slots as usize) {
+            slot.seq.store(0, Ordering::Relaxed);
+            slot.id.store(0, Ordering::Relaxed);
+            slot.updated_ms.store(0, Ordering::Relaxed);
+            slot.owner.store(0, Ordering::Relaxed);
+        }
+        header.version.store(VERSION, Ordering::Relaxed);
+        header.slot_count.store(slots, Ordering::Relaxed);
+        header.slot_size.store(SLOT_SIZE as u32, Ordering::Relaxed);
+        // magic 最后写入: 生产者看到 magic 时其余字段已就绪
+        header.magic.store(MAGIC, Ordering::Release);
+    }
+
+    /// 校验头部，返回槽位数
+    fn validate(&self) -> io::Result<usize> {
+        let header = self.header();
+        let invalid = |msg: &str| Err(io::Error::new(io::ErrorKind::InvalidData, msg.to_string()));
+        if header.magic.load(Ordering::Acquire) != MAGIC {
+            return invalid("共享内存段 magic 不符");
+        }
+        if header.version.load(Ordering::Relaxed) != VERSION {
+            return invalid("共享内存段版本不符");
+        }
+        if header.slot_size.load(Ordering::Relaxed) as usize != SLOT_SIZE {
+            return invalid("共享内存段槽位大小不符");
+        }
+        let count = header.slot_count.load(Ordering::Relaxed) as usize;
+        if HEADER_SIZE + count * SLOT_SIZE > self.len {
+            return invalid("共享内存段长度不足");
+        }
+        Ok(count)
+    }
+
+    fn slots_unchecked(&self, count: usize) -> &[Slot] {
+        unsafe { std::slice::from_raw_parts(self.ptr.add(HEADER_SIZE) as *const Slot, count) }
+    }
+
+    fn slots(&self) -> &[Slot] {
+        self.slots_unchecked(self.slot_count)
+    }
+
+    pub fn slot_count(&self) -> usize {
+        self.slot_count
+    }
+
+    /// 查找 ID 对应的槽位；`claim` 时没有则认领一个空闲槽位
+    fn find(&self, id: u32, claim: bool) -> Option<&Slot> {
+        let slots = self.slots();
+        if slots.is_empty() {
+            return None;
+        }
+        let start = id.wrapping_mul(HASH) as usize % slots.len();
+        for k in 0..slots.len() {
+            let slot = &slots[(start + k) % slots.len()];
+            match slot.id.load(Ordering::Acquire) {
+                current if current == id => return Some(slot),
+                0 if claim => match slot.id.compare_exchange(0, id, Ordering::AcqRel, Ordering::Acquire) {
+                    Ok(_) => return Some(slot),
+                    Err(current) if current == id => return Some(slot),
+                    Err(_) => {}
+                },
+                // 槽位从不释放，遇到空闲槽位说明该 ID 不存在
+                0 => return None,
+                _ => {}
+            }
+        }
+        None
+    }
+}
+
+impl Drop for Segment {
+    fn drop(&mut self) {
+        unsafe { libc::munmap(self.ptr as *mut libc::c_void, self.len) };
+    }
+}
+
+fn shm_open(name: &str, flags: libc::c_int) -> io::Result<libc::c_int> {
+    let name = CString::new(name).map_err(|e| io::Error::new(io::ErrorKind::InvalidInput, e))?;
+    let fd = unsafe { libc::shm_open(name.as_ptr(), flags, 0o666 as libc::c_uint) };
+    if fd < 0 {
+        return Err(io::Error::last_os_error());
+    }
+    Ok(fd)
+}
+
+fn file_len(fd: libc::c_int) -> io::Result<usize> {
+    let mut stat: libc::stat = unsafe { std::mem::zeroed() };
+    if unsafe { libc::fstat(fd, &mut stat) } != 0 {
+        return Err(io::Error::last_os_error());
+    }
+    Ok(stat.st_size as usize)
+}
+
+/// 进程是否存在 (无权发信号的进程也算存在)
+fn process_alive(pid: u32) -> bool {
+    let signaled = unsafe { libc::kill(pid as libc::pid_t, 0) } == 0;
+    signaled || io::Error::last_os_error().raw_os_error() != Some(libc::ESRCH)
+}
+
+/// 当前 Unix 时间 (毫秒)
+pub fn now_ms() -> u64 {
+    SystemTime::now().duration_since(UNIX_EPOCH).map_or(0, |d| d.as_millis() as u64)
+}
+
+/// 发布失败的原因
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum PublishError {
+    /// ID 0 保留表示空闲槽位
+    ReservedId,
+    /// 所有槽位都已被其他 ID 认领
+    Full,
+}
+
+impl fmt::Display for PublishError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        match self {
+            PublishError::ReservedId => write!(f, "指标 ID 0 为保留值"),
+            PublishError::Full => write!(f, "共享内存段槽位已满"),
+        }
+    }
+}
+
+impl std::error::Error for PublishError {}
+
+/// 指标名补 0 到定长 (超过 32 字节时截断)
+fn name_bytes(name: &str) -> [u8; NAME_LEN] {
+    let mut bytes = [0u8; NAME_LEN];
+    let len = name.len().min(NAME_LEN);
+    bytes[..len].copy_from_slice(&name.as_bytes()[..len]);
+    bytes
+}
+
+/// 生产者
+pub struct Producer {
+    segment: Segment,
+}
+
+impl Producer {
+    pub fn open(name: &str) -> io::Result<Self> {
+        Ok(Self { segment: Segment::open(name)? })
+    }
+
+    /// 发布一个指标值 (名称超过 32 字节时截断)
+    pub fn publish(&self, id: u32, name: &str, value: f64) -> Result<(), PublishError> {
+        self.publish_at(id, name, value, now_ms())
+    }
+
+    /// 以指定时间戳发布 (回放或测试用)
+    pub fn publish_at(&self, id: u32, name: &str, value: f64, updated_ms: u64) -> Result<(), PublishError> {
+        if id == 0 {
+            return Err(PublishError::ReservedId);
+        }
+        let slot = self.segment.find(id, true).ok_or(PublishError::Full)?;
+        slot.write(Some(&name_bytes(name)), value, updated_ms, || {});
+        Ok(())
+    }
+
+    /// 与 [`Producer::publish_at`] 相同，但写完名称后在持有写权时睡眠 `stall` (模拟被抢占的写者，测试用)
+    #[doc(hidden)]
+    pub fn publish_stalled(&self, id: u32, name: &str, value: f64, updated_ms: u64, stall: Duration) {
+        let Some(slot) = self.segment.find(id, true) else { return };
+        slot.write(Some(&name_bytes(name)), value, updated_ms, || std::thread::sleep(stall));
+    }
+
+    /// 撤销指标 (服务端不再上报；槽位保留给同一 ID)
+    pub fn remove(&self, id: u32) {
+        if let Some(slot) = self.segment.find(id, false) {
+            slot.write(None, f64::NAN, 0, || {});
+        }
+    }
+}
+
+/// 读到的一个指标
+#[derive(Debug, Clone, Copy)]
+pub struct Reading {
+    pub id: u32,
+    pub value: f64,
+    pub updated_ms: u64,
+    name: [u8; NAME_LEN],
+    name_len: u8,
+}
+
+impl Reading {
+    /// 指标名 (非 `[A-Za-z0-9_.-]` 的字节已替换为 `_`，总是合法 ASCII)
+    pub fn name(&self) -> &str {
+        std::str::from_utf8(&self.name[..self.name_len as usize]).unwrap_or("")
+    }
+}
+
+/// 服务端读取端
+pub struct Reader {
+    segment: Segment,
+}
+
+impl Reader {
+    /// 创建或打开段 (见 [`Segment::create`])
+    pub fn create(name: &str, slots: u16) -> io::Result<Self> {
+        Ok(Self { segment: Segment::create(name, slots)? })
+    }
+
+    pub fn slot_count(&self) -> usize {
+        self.segment.slot_count()
+    }
+
+    /// 读取全部已发布、且在 `max_age_ms` 内更新过的指标，写入 `out` (清空后复用)。
+    /// 返回因并发写入重试耗尽而跳过的槽位数
+    pub fn read(&self, now_ms: u64, max_age_ms: u64, out: &mut Vec<Reading>) -> usize {
+        out.clear();
+        let mut contended = 0;
+        for slot in self.segment.slots() {
+            let id = slot.id.load(Ordering::Acquire);
+            if id == 0 {
+                continue;
+            }
+            let Some((value, updated_ms, raw)) = slot.read() else {
+                contended += 1;
+                continue;
+            };
+            if updated_ms == 0 || now_ms.saturating_sub(updated_ms) > max_age_ms {
+                continue;
+            }
+            let mut name = [0u8; NAME_LEN];
+            let mut name_len = 0;
+            for &b in raw.iter().take_while(|b| **b != 0) {
+                name[name_len] = if b.is_ascii_alphanumeric() || b"_.-".contains(&b) { b } else { b'_' };
+                name_len += 1;
+            }
+            out.push(Reading { id, value, updated_ms, name, name_len: name_len as u8 });
+        }
+        contended
+    }
+}
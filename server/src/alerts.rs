@@ -0,0 +1,391 @@
+//! 告警引擎
+//!
+//! 服务端对每帧 `SystemMetrics` 维护增量统计 (见 [`crate::streamstats`])，按规则判断告警，
+//! 状态变化时在帧内附带紧凑的告警事件 (`"alerts":[{"rule":..,"on":..,"value":..}]`)。
+//! 客户端不需要自己解释数值，也不需要一直盯着屏幕。
+//!
+//! 规则 = 信号 + 阈值。信号是某个指标上的一个统计量 (当前值、EWMA、滑动最小/最大值、
+//! 分位数、变化率，或温度达到阈值时的降频幅度)；阈值为 `above` 或 `below` 之一，
+//! `hysteresis` 为解除告警的回差:
+//!
+//! ```json
+//! [
+//!   {"name": "cpu_hot", "stat": "min", "metric": "cpu_temp", "window_s": 30, "above": 95, "hysteresis": 5},
+//!   {"name": "memory_leak", "stat": "rate", "metric": "memory_used", "window_s": 300, "above": 1.0},
+//!   {"name": "cpu_throttle", "stat": "throttle", "temp_c": 90, "window_s": 10, "above": 25, "hysteresis": 10}
+//! ]
+//! ```
+//!
+//! 每帧开销与规则数基本无关:
+//! - 相同的信号只计算一次 (按规格去重)，统计量的更新与规则数无关
+//! - 同一信号上的规则按触发阈值与解除阈值排序。信号从上一帧的值变到本帧的值时，
+//!   只有阈值落在两者之间的规则可能改变状态，二分查找后只检查这些规则
+//! - 告警中的规则每隔 [`REPEAT_MS`] 重发一次 "on" 事件 (UDP 可能丢包)，
+//!   客户端超过约两倍间隔没有收到重发就自行清除
+
+use crate::monitor::{Backend, SystemMetrics};
+use crate::stats::STATS;
+use crate::streamstats::{Ewma, QuantileSketch, SlidingExtreme, SlidingRate};
+use serde::{Deserialize, Serialize};
+use std::time::{Duration, Instant};
+
+/// 告警中的规则重发 "on" 事件的间隔 (服务端单调时钟毫秒)
+pub const REPEAT_MS: u64 = 5000;
+
+/// 可用于规则的指标
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Deserialize)]
+#[serde(rename_all = "snake_case")]
+pub enum Metric {
+    CpuUsage,
+    CpuFrequencyMhz,
+    MemoryUsage,
+    /// 已用内存 (MB)
+    MemoryUsed,
+    SwapUsage,
+    CpuTemp,
+    GpuTemp,
+    /// 第一个风扇的转速 (RPM)
+    FanSpeed,
+    PowerScore,
+}
+
+impl Metric {
+    fn read(self, m: &SystemMetrics) -> Option<f32> {
+        match self {
+            Metric::CpuUsage => Some(m.cpu_usage),
+            Metric::CpuFrequencyMhz => Some(m.cpu_frequency_mhz as f32),
+            Metric::MemoryUsage => Some(m.memory_usage),
+            Metric::MemoryUsed => Some(m.memory_used as f32),
+            Metric::SwapUsage => Some(m.swap_usage),
+            Metric::CpuTemp => m.cpu_temp,
+            Metric::GpuTemp => m.gpu_temp,
+            Metric::FanSpeed => m.fan_speeds.first().copied(),
+            Metric::PowerScore => m.power_score,
+        }
+    }
+}
+
+/// 信号: 指标上的统计量 (`stat` 字段区分)
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize)]
+#[serde(tag = "stat", rename_all = "snake_case")]
+pub enum SignalSpec {
+    /// 当前值
+    Value { metric: Metric },
+    /// 指数加权移动平均
+    Ewma { metric: Metric, half_life_s: f32 },
+    /// 滑动窗口最小值 (窗口填满后才参与判断；"持续高于" 用它表达)
+    Min { metric: Metric, window_s: f32 },
+    /// 滑动窗口最大值 (窗口填满后才参与判断)
+    Max { metric: Metric, window_s: f32 },
+    /// 窗口内第 `q` 分位数 (0..=1，近似值，相对误差约 2%)
+    Percentile { metric: Metric, q: f32, window_s: f32 },
+    /// 与 `window_s` 秒前相比每秒的变化量
+    Rate { metric: Metric, window_s: f32 },
+    /// 降频: CPU 温度不低于 `temp_c` 时，CPU 频率相对窗口内最高频率的降幅 (%)，否则为 0
+    Throttle { temp_c: f32, window_s: f32 },
+}
+
+/// 告警规则
+#[derive(Debug, Clone, Deserialize)]
+pub struct RuleSpec {
+    pub name: String,
+    #[serde(flatten)]
+    pub signal: SignalSpec,
+    /// 信号不低于该值时告警
+    #[serde(default)]
+    pub above: Option<f32>,
+    /// 信号不高于该值时告警
+    #[serde(default)]
+    pub below: Option<f32>,
+    /// 解除告警的回差: `above` 规则在信号低于 `above - hysteresis` 时解除，`below` 规则反之
+    #[serde(default)]
+    pub hysteresis: f32,
+}
+
+impl RuleSpec {
+    fn threshold(&self) -> Result<(bool, f32), String> {
+        match (self.above, self.below) {
+            (Some(on), None) => Ok((true, on)),
+            (None, Some(on)) => Ok((false, on)),
+            _ => Err(format!("规则 {} 必须且只能指定 above 或 below 之一", self.name)),
+        }
+    }
+}
+
+/// 解析 JSON 规则数组
+pub fn parse_rules(json: &str) -> Result<Vec<RuleSpec>, String> {
+    let rules: Vec<RuleSpec> = serde_json::from_str(json).map_err(|e| e.to_string())?;
+    for rule in &rules {
+        rule.threshold()?;
+        if rule.hysteresis < 0.0 {
+            return Err(format!("规则 {} 的 hysteresis 不能为负", rule.name));
+        }
+    }
+    Ok(rules)
+}
+
+/// 未指定规则文件时使用的内置规则
+pub fn default_rules() -> Vec<RuleSpec> {
+    let rule = |name: &str, signal, above, hysteresis| RuleSpec {
+        name: name.to_string(),
+        signal,
+        above: Some(above),
+        below: None,
+        hysteresis,
+    };
+    vec![
+        // 持续 30 秒不低于 95 °C
+        rule("cpu_hot", SignalSpec::Min { metric: Metric::CpuTemp, window_s: 30.0 }, 95.0, 5.0),
+        // 5 分钟内已用内存平均每秒增长 1 MB 以上
+        rule("memory_leak", SignalSpec::Rate { metric: Metric::MemoryUsed, window_s: 300.0 }, 1.0, 0.5),
+        // 90 °C 以上时频率比 10 秒内的最高值低 25% 以上
+        rule("cpu_throttle", SignalSpec::Throttle { temp_c: 90.0, window_s: 10.0 }, 25.0, 10.0),
+        // 1 分钟内 90% 的样本 CPU 使用率在 95% 以上
+        rule("cpu_saturated", SignalSpec::Percentile { metric: Metric::CpuUsage, q: 0.1, window_s: 60.0 }, 95.0, 10.0),
+        rule("swap_pressure", SignalSpec::Ewma { metric: Metric::SwapUsage, half_life_s: 10.0 }, 50.0, 10.0),
+    ]
+}
+
+/// 告警事件 (状态变化，或告警中的定期重发)
+#[derive(Debug, Clone, PartialEq, Serialize)]
+pub struct AlertEvent {
+    pub rule: String,
+    pub on: bool,
+    /// 触发时的信号值
+    pub value: f32,
+}
+
+/// 信号的统计状态
+enum Stat {
+    Value(Metric),
+    Ewma(Metric, Ewma),
+    Extreme(Metric, SlidingExtreme),
+    Percentile(Metric, f32, QuantileSketch),
+    Rate(Metric, SlidingRate),
+    Throttle(f32, SlidingExtreme),
+}
+
+impl Stat {
+    fn new(spec: SignalSpec, period_s: f32) -> Self {
+        let samples = |seconds: f32| ((seconds / period_s).round() as usize).max(1);
+        match spec {
+            SignalSpec::Value { metric } => Stat::Value(metric),
+            SignalSpec::Ewma { metric, half_life_s } => {
+                Stat::Ewma(metric, Ewma::with_half_life(half_life_s / period_s))
+            }
+            SignalSpec::Min { metric, window_s } => Stat::Extreme(metric, SlidingExtreme::min(samples(window_s))),
+            SignalSpec::Max { metric, window_s } => Stat::Extreme(metric, SlidingExtreme::max(samples(window_s))),
+            SignalSpec::Percentile { metric, q, window_s } => {
+                Stat::Percentile(metric, q, QuantileSketch::new(samples(window_s)))
+            }
+            SignalSpec::Rate { metric, window_s } => Stat::Rate(metric, SlidingRate::new(samples(window_s))),
+            SignalSpec::Throttle { temp_c, window_s } => Stat::Throttle(temp_c, SlidingExtreme::max(samples(window_s))),
+        }
+    }
+
+    /// 加入本帧样本，返回信号值；指标缺失或窗口尚未填满时返回 None
+    fn update(&mut self, m: &SystemMetrics) -> Option<f32> {
+        match self {
+            Stat::Value(metric) => metric.read(m),
+            Stat::Ewma(metric, ewma) => metric.read(m).map(|x| ewma.push(x)),
+            Stat::Extreme(metric, extreme) => {
+                let value = extreme.push(metric.read(m)?);
+                extreme.full().then_some(value)
+            }
+            Stat::Percentile(metric, q, sketch) => {
+                sketch.push(metric.read(m)?);
+                sketch.quantile(*q)
+            }
+            Stat::Rate(metric, rate) => rate.push(m.sample_ms, metric.read(m)?),
+            Stat::Throttle(temp_c, max) => {
+                let freq = m.cpu_frequency_mhz as f32;
+                let peak = max.push(freq);
+                let hot = m.cpu_temp.is_some_and(|t| t >= *temp_c);
+                Some(if hot && peak > 0.0 { (peak - freq) / peak * 100.0 } else { 0.0 })
+            }
+        }
+    }
+}
+
+/// 按阈值排序的规则下标
+#[derive(Default)]
+struct ThresholdIndex {
+    entries: Vec<(f32, u32)>,
+}
+
+impl ThresholdIndex {
+    fn insert(&mut self, threshold: f32, rule: u32) {
+        let at = self.entries.partition_point(|(t, _)| *t <= threshold);
+        self.entries.insert(at, (threshold, rule));
+    }
+
+    /// 阈值落在 [lo, hi] 内的规则
+    fn range(&self, lo: f32, hi: f32) -> &[(f32, u32)] {
+        let start = self.entries.partition_point(|(t, _)| *t < lo);
+        let end = self.entries.partition_point(|(t, _)| *t <= hi);
+        &self.entries[start..end.max(start)]
+    }
+}
+
+struct Signal {
+    spec: SignalSpec,
+    stat: Stat,
+    /// 上一帧的信号值 (None 表示还没有值，下一次检查该信号上的全部规则)
+    prev: Option<f32>,
+    /// 该信号上规则的触发阈值与解除阈值
+    on: ThresholdIndex,
+    off: ThresholdIndex,
+}
+
+struct Rule {
+    name: String,
+    signal: usize,
+    above: bool,
+    on: f32,
+    off: f32,
+    firing: bool,
+}
+
+impl Rule {
+    /// 按信号值更新状态，状态变化时返回 true
+    fn evaluate(&mut self, value: f32) -> bool {
+        let next = if self.above {
+            if self.firing { value >= self.off } else { value >= self.on }
+        } else if self.firing {
+            value <= self.off
+        } else {
+            value <= self.on
+        };
+        std::mem::replace(&mut self.firing, next) != next
+    }
+}
+
+/// 告警引擎
+pub struct AlertEngine {
+    signals: Vec<Signal>,
+    rules: Vec<Rule>,
+    active: usize,
+    last_repeat_ms: u64,
+    /// 每帧检查全部规则 (见 [`AlertEngine::exhaustive`])
+    exhaustive: bool,
+}
+
+impl AlertEngine {
+    /// `period` 为推送间隔，用于把以秒为单位的窗口换算为样本数
+    pub fn new(specs: &[RuleSpec], period: Duration) -> Result<Self, String> {
+        let period_s = period.as_secs_f32().max(0.001);
+        let mut signals: Vec<Signal> = Vec::new();
+        let mut rules = Vec::with_capacity(specs.len());
+        for spec in specs {
+            let (above, on) = spec.threshold()?;
+            let off = if above { on - spec.hysteresis } else { on + spec.hysteresis };
+            let signal = match signals.iter().position(|s| s.spec == spec.signal) {
+                Some(index) => index,
+                None => {
+                    signals.push(Signal {
+                        spec: spec.signal,
+                        stat: Stat::new(spec.signal, period_s),
+                        prev: None,
+                        on: ThresholdIndex::default(),
+                        off: ThresholdIndex::default(),
+                    });
+                    signals.len() - 1
+                }
+            };
+            let index = rules.len() as u32;
+            signals[signal].on.insert(on, index);
+            signals[signal].off.insert(off, index);
+            rules.push(Rule { name: spec.name.clone(), signal, above, on, off, firing: false });
+        }
+        Ok(Self { signals, rules, active: 0, last_repeat_ms: 0, exhaustive: false })
+    }
+
+    /// 每帧逐条检查全部规则，不按阈值索引跳过。产生的事件与默认方式相同，
+    /// 基准测试用它对照检查索引 (benches/alerts.rs)
+    pub fn exhaustive(mut self) -> Self {
+        self.exhaustive = true;
+        self
+    }
+
+    pub fn rule_count(&self) -> usize {
+        self.rules.len()
+    }
+
+    /// 去重后的信号数 (每帧统计量的更新次数)
+    pub fn signal_count(&self) -> usize {
+        self.signals.len()
+    }
+
+    /// 告警中的规则数
+    pub fn active(&self) -> usize {
+        self.active
+    }
+
+    /// 加入一帧，把状态变化 (以及到期的重发) 追加到 `events`
+    pub fn observe(&mut self, metrics: &SystemMetrics, events: &mut Vec<AlertEvent>) {
+        let exhaustive = self.exhaustive;
+        for signal in &mut self.signals {
+            let Some(value) = signal.stat.update(metrics).filter(|v| !v.is_nan()) else { continue };
+            let (lo, hi) = match signal.prev {
+                Some(prev) if !exhaustive => (prev.min(value), prev.max(value)),
+                _ => (f32::NEG_INFINITY, f32::INFINITY),
+            };
+            signal.prev = Some(value);
+            // 阈值都不在 [lo, hi] 内的规则，与各阈值的大小关系和上一帧相同，状态不变。
+            // 两个阈值都在区间内的规则会被检查两次，第二次不会再变化
+            for &(_, rule) in signal.on.range(lo, hi).iter().chain(signal.off.range(lo, hi)) {
+                let rule = &mut self.rules[rule as usize];
+                if rule.evaluate(value) {
+                    if rule.firing {
+                        self.active += 1;
+                    } else {
+                        self.active -= 1;
+                    }
+                    events.push(AlertEvent { rule: rule.name.clone(), on: rule.firing, value });
+                }
+            }
+        }
+
+        if self.active > 0 && metrics.sample_ms.saturating_sub(self.last_repeat_ms) >= REPEAT_MS {
+            self.last_repeat_ms = metrics.sample_ms;
+            let fresh = events.len();
+            for rule in self.rules.iter().filter(|r| r.firing) {
+                if events[..fresh].iter().any(|e| e.rule == rule.name) {
+                    continue;
+                }
+                let value = self.signals[rule.signal].prev.unwrap_or(f32::NAN);
+                events.push(AlertEvent { rule: rule.name.clone(), on: true, value });
+            }
+        }
+    }
+}
+
+/// 在原有后端的结果上附加告警事件
+pub struct AlertBackend {
+    inner: Box<dyn Backend>,
+    engine: AlertEngine,
+}
+
+impl AlertBackend {
+    pub fn new(inner: Box<dyn Backend>, engine: AlertEngine) -> Self {
+        Self { inner, engine }
+    }
+}
+
+impl Backend for AlertBackend {
+    fn refresh(&mut self) -> SystemMetrics {
+        let mut metrics = self.inner.refresh();
+        let started = Instant::now();
+        let mut alerts = std::mem::take(&mut metrics.alerts);
+        self.engine.observe(&metrics, &mut alerts);
+        metrics.alerts = alerts;
+        STATS.alert_seconds.observe_since(started);
+        STATS.alert_events.add(metrics.alerts.len() as u64);
+        STATS.alerts_active.set(self.engine.active() as i64);
+        metrics
+    }
+
+    fn first_sample_delay(&self) -> Duration {
+        self.inner.first_sample_delay()
+    }
+}
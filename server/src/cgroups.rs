@@ -0,0 +1,544 @@
+//! cgroup v2 与压力停顿 (PSI) 采集
+//!
+//! 主机整体的 CPU/内存使用率看不出是哪个 slice 或容器饱和，也看不出任务是否真的在等资源。
+//! 该采集器读取 cgroup v2 各组的 `cpu.stat`、`memory.current`、`io.stat` 和
+//! `{cpu,memory,io}.pressure`，以及主机的 `/proc/pressure/{cpu,memory,io}`:
+//! - 累计计数器 (CPU 时间、限流时间、I/O 字节、停顿时间) 按相邻两次采样的差分换算为速率
+//! - 每个组的文件在发现时打开一次，之后每次采样逐个 `pread` 到同一个复用缓冲区并原地解析:
+//!   每个文件一次系统调用，采样路径上不分配 (Top-N 的名称除外)
+//! - 组的发现 (遍历目录) 每 `RESCAN_EVERY` 次采样一次；已删除的组在读取失败时立即移除
+//! - 持久打开的文件数有上限 (见 [`fd_budget`])，超出后新发现的组不跟踪
+//!
+//! 输出主机 PSI 和按停顿比例排序的 Top-N 组。所有路径都相对于 `root`，基准测试指向夹具目录
+
+use serde::ser::{SerializeMap, SerializeSeq};
+use serde::{Serialize, Serializer};
+use std::str::FromStr;
+use std::sync::mpsc::Receiver;
+use std::time::Duration;
+#[cfg(unix)]
+use crate::procfs::{parse_u64, PinnedFile};
+#[cfg(unix)]
+use std::{
+    collections::HashMap,
+    fs, io,
+    path::{Path, PathBuf},
+    time::Instant,
+};
+
+/// 默认跟踪的层数 (根之下两层，例如 `system.slice/docker-<id>.scope`)
+pub const DEFAULT_DEPTH: usize = 2;
+
+/// 每隔多少次采样重新发现一次组
+#[cfg(unix)]
+const RESCAN_EVERY: u32 = 10;
+/// 每个组最多持久打开的文件数
+#[cfg(unix)]
+const FILES_PER_GROUP: usize = 6;
+/// 采样耗时与周期的最小比例
+#[cfg(target_os = "linux")]
+const DUTY_CYCLE_DIVISOR: u32 = 100;
+/// 尚未取走的报告上限 (推送循环停顿时采样线程在发送处等待，报告不会堆积)
+#[cfg(target_os = "linux")]
+const REPORT_BACKLOG: usize = 4;
+
+/// PSI 资源，顺序与各数组下标一致
+const RESOURCES: [&str; 3] = ["cpu", "memory", "io"];
+
+/// 跟踪哪些 cgroup
+#[derive(Debug, Clone, PartialEq)]
+pub enum CgroupSelection {
+    /// 根之下 1..=N 层的全部组
+    Depth(usize),
+    /// 指定的组 (相对 cgroup 根的路径)
+    Paths(Vec<String>),
+}
+
+impl FromStr for CgroupSelection {
+    type Err = String;
+
+    /// `"3"` 为层数，否则为逗号分隔的路径列表 (`"system.slice,user.slice"`)
+    fn from_str(s: &str) -> Result<Self, Self::Err> {
+        if let Ok(depth) = s.parse::<usize>() {
+            return Ok(Self::Depth(depth.max(1)));
+        }
+        let paths: Vec<String> = s
+            .split(',')
+            .map(|p| p.trim().trim_matches('/'))
+            .filter(|p| !p.is_empty())
+            .map(str::to_string)
+            .collect();
+        if paths.is_empty() {
+            Err("没有指定 cgroup".to_string())
+        } else {
+            Ok(Self::Paths(paths))
+        }
+    }
+}
+
+/// 停顿比例 (%) 编码为 0.1% 单位的整数
+fn permille(percent: f32) -> u32 {
+    (percent * 10.0).round() as u32
+}
+
+/// 一个 cgroup 的速率
+#[derive(Debug, Clone, Default)]
+pub struct CgroupRate {
+    /// 相对 cgroup 根的路径
+    pub name: String,
+    /// CPU 使用 (%，单核为 100)
+    pub cpu: f32,
+    /// 配额限流时间 (%，与 CPU 相同按单核 100 计)
+    pub throttled: f32,
+    /// 内存 (字节)
+    pub memory: u64,
+    /// I/O [读, 写] (字节/秒)
+    pub io: [f64; 2],
+    /// cpu/memory/io 的 some 停顿比例 (%)
+    pub pressure: [f32; 3],
+}
+
+impl Serialize for CgroupRate {
+    /// 编码为 [名称, CPU, 限流, 内存 MB, 读 B/s, 写 B/s, CPU 停顿, 内存停顿, I/O 停顿]，百分比为 0.1% 单位
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        let mut seq = serializer.serialize_seq(Some(9))?;
+        seq.serialize_element(&self.name)?;
+        seq.serialize_element(&permille(self.cpu))?;
+        seq.serialize_element(&permille(self.throttled))?;
+        seq.serialize_element(&(self.memory / 1024 / 1024))?;
+        for rate in &self.io {
+            seq.serialize_element(&(rate.round() as u64))?;
+        }
+        for pressure in &self.pressure {
+            seq.serialize_element(&permille(*pressure))?;
+        }
+        seq.end()
+    }
+}
+
+/// 主机整体的停顿比例 (%)，cpu/memory/io 各 [some, full]
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct HostPressure(pub [[f32; 2]; 3]);
+
+impl Serialize for HostPressure {
+    /// 编码为 {"cpu":[some, full],"memory":[..],"io":[..]}，0.1% 单位
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        let mut map = serializer.serialize_map(Some(3))?;
+        for (name, [some, full]) in RESOURCES.iter().zip(self.0) {
+            map.serialize_entry(name, &[permille(some), permille(full)])?;
+        }
+        map.end()
+    }
+}
+
+/// 一次 cgroup 采样的报告
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct CgroupReport {
+    /// 主机 PSI (`/proc/pressure` 不可用时为 None)。不能叫 `host`: 3DS 按 `"host":` 查找中转主机编号
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub psi: Option<HostPressure>,
+    /// 跟踪中的组数
+    pub tracked: usize,
+    /// 按停顿比例 (其次按 CPU) 排序的 Top-N，只含叶子组 (父组的计数包含子组)，没有活动的组不列出
+    pub top: Vec<CgroupRate>,
+}
+
+/// 解析 PSI 文件，返回 [some, full] 的累计停顿时间 (µs)；没有 full 行时为 0
+///
+/// 每行形如 `some avg10=0.00 avg60=0.00 avg300=0.00 total=12345`
+#[cfg(unix)]
+fn parse_pressure(data: &[u8]) -> [u64; 2] {
+    let mut totals = [0; 2];
+    for line in data.split(|b| *b == b'\n') {
+        let slot = match line.get(..5) {
+            Some(b"some ") => 0,
+            Some(b"full ") => 1,
+            _ => continue,
+        };
+        if let Some(total) = line.rsplit(|b| *b == b' ').next().and_then(|t| t.strip_prefix(b"total=")) {
+            totals[slot] = parse_u64(total);
+        }
+    }
+    totals
+}
+
+/// 一个组的累计计数器
+#[cfg(unix)]
+#[derive(Debug, Default, Clone, Copy)]
+struct Counters {
+    cpu_usec: u64,
+    throttled_usec: u64,
+    read_bytes: u64,
+    write_bytes: u64,
+    /// cpu/memory/io 的 some 停顿时间 (µs)
+    stall_usec: [u64; 3],
+}
+
+/// 跟踪中的组
+#[cfg(unix)]
+struct Group {
+    cpu_stat: Option<PinnedFile>,
+    memory_current: Option<PinnedFile>,
+    io_stat: Option<PinnedFile>,
+    pressure: [Option<PinnedFile>; 3],
+    prev: Counters,
+    /// 已有基线 (新组的第一次读数只记录基线)
+    primed: bool,
+    /// 没有跟踪中的子组 (见 [`CgroupCollector::rescan`])
+    leaf: bool,
+    /// 最近一次的速率 (名称即组路径)
+    rate: CgroupRate,
+}
+
+#[cfg(unix)]
+impl Group {
+    /// 打开组的接口文件 (控制器未启用的文件不存在)；一个都打不开时不是 cgroup
+    fn open(mount: &Path, name: String) -> Option<Self> {
+        let dir = mount.join(&name);
+        let open = |file: &str| PinnedFile::open(&dir.join(file)).ok();
+        let group = Self {
+            cpu_stat: open("cpu.stat"),
+            memory_current: open("memory.current"),
+            io_stat: open("io.stat"),
+            pressure: RESOURCES.map(|r| open(&format!("{}.pressure", r))),
+            prev: Counters::default(),
+            primed: false,
+            leaf: true,
+            rate: CgroupRate { name, ..CgroupRate::default() },
+        };
+        (group.file_count() > 0).then_some(group)
+    }
+
+    fn file_count(&self) -> usize {
+        [&self.cpu_stat, &self.memory_current, &self.io_stat].iter().filter(|f| f.is_some()).count()
+            + self.pressure.iter().filter(|f| f.is_some()).count()
+    }
+
+    /// 读取全部文件并更新速率；任一文件读取失败 (组已删除) 时返回错误
+    fn read(&mut self, buf: &mut Vec<u8>, elapsed_usec: f64) -> io::Result<()> {
+        let mut cur = Counters::default();
+        if let Some(file) = &self.cpu_stat {
+            for line in file.read_once(buf)?.split(|b| *b == b'\n') {
+                if let Some(v) = line.strip_prefix(b"usage_usec ") {
+                    cur.cpu_usec = parse_u64(v);
+                } else if let Some(v) = line.strip_prefix(b"throttled_usec ") {
+                    cur.throttled_usec = parse_u64(v);
+                }
+            }
+        }
+        if let Some(file) = &self.io_stat {
+            // 每个设备一行: "8:0 rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N"
+            for token in file.read_once(buf)?.split(|b| *b == b' ' || *b == b'\n') {
+                if let Some(v) = token.strip_prefix(b"rbytes=") {
+                    cur.read_bytes += parse_u64(v);
+                } else if let Some(v) = token.strip_prefix(b"wbytes=") {
+                    cur.write_bytes += parse_u64(v);
+                }
+            }
+        }
+        for (slot, file) in cur.stall_usec.iter_mut().zip(&self.pressure) {
+            if let Some(file) = file {
+                *slot = parse_pressure(file.read_once(buf)?)[0];
+            }
+        }
+        if let Some(file) = &self.memory_current {
+            self.rate.memory = file.read_u64()?;
+        }
+
+        if self.primed && elapsed_usec > 0.0 {
+            // 计数器回退 (同名组被删除后重建) 时该周期记 0
+            let percent = |prev: u64, cur: u64| (cur.saturating_sub(prev) as f64 / elapsed_usec * 100.0) as f32;
+            let per_sec = |prev: u64, cur: u64| cur.saturating_sub(prev) as f64 / elapsed_usec * 1e6;
+            let prev = &self.prev;
+            self.rate.cpu = percent(prev.cpu_usec, cur.cpu_usec);
+            self.rate.throttled = percent(prev.throttled_usec, cur.throttled_usec);
+            self.rate.io = [per_sec(prev.read_bytes, cur.read_bytes), per_sec(prev.write_bytes, cur.write_bytes)];
+            for i in 0..3 {
+                self.rate.pressure[i] = percent(prev.stall_usec[i], cur.stall_usec[i]);
+            }
+        }
+        self.prev = cur;
+        self.primed = true;
+        Ok(())
+    }
+
+    /// 排序键: 最大停顿比例，其次 CPU
+    fn score(&self) -> (f32, f32) {
+        (self.rate.pressure.iter().copied().fold(0.0, f32::max), self.rate.cpu)
+    }
+}
+
+/// cgroup v2 挂载点: 纯 v2 为 `/sys/fs/cgroup`，混合模式为 `/sys/fs/cgroup/unified`
+#[cfg(unix)]
+fn find_mount(root: &Path) -> io::Result<PathBuf> {
+    ["sys/fs/cgroup", "sys/fs/cgroup/unified"]
+        .iter()
+        .map(|p| root.join(p))
+        .find(|p| p.join("cgroup.controllers").exists())
+        .ok_or_else(|| io::Error::new(io::ErrorKind::NotFound, "未挂载 cgroup v2"))
+}
+
+/// 收集 `dir` 之下 `depth` 层内的子组 (只看目录项类型，不逐个 stat)
+#[cfg(unix)]
+fn walk(dir: &Path, prefix: &str, depth: usize, out: &mut Vec<String>) {
+    let Ok(entries) = fs::read_dir(dir) else { return };
+    for entry in entries.filter_map(|e| e.ok()) {
+        if !entry.file_type().is_ok_and(|t| t.is_dir()) {
+            continue;
+        }
+        let Some(name) = entry.file_name().to_str().map(|n| format!("{}{}", prefix, n)) else { continue };
+        if depth > 1 {
+            walk(&entry.path(), &format!("{}/", name), depth - 1, out);
+        }
+        out.push(name);
+    }
+}
+
+/// cgroup v2 与 PSI 采集器
+#[cfg(unix)]
+pub struct CgroupCollector {
+    mount: PathBuf,
+    selection: CgroupSelection,
+    /// 持久打开的文件数上限
+    max_files: usize,
+    open_files: usize,
+    /// 上次发现时因文件数上限未跟踪的组数
+    skipped: usize,
+    /// /proc/pressure/{cpu,memory,io}
+    host: [Option<PinnedFile>; 3],
+    /// 主机 [some, full] 累计停顿时间 (µs)
+    host_prev: [[u64; 2]; 3],
+    /// 按名称排序
+    groups: Vec<Group>,
+    samples: u32,
+    last: Option<Instant>,
+    /// 文件读取缓冲区 (复用)
+    buf: Vec<u8>,
+    /// 排序用的组下标 (复用)
+    ranked: Vec<usize>,
+}
+
+#[cfg(unix)]
+impl CgroupCollector {
+    /// 打开主机 PSI 文件并发现组；`root` 通常为 `/`，`max_files` 为持久打开的文件数上限
+    pub fn open(root: &Path, selection: CgroupSelection, max_files: usize) -> io::Result<Self> {
+        let mount = find_mount(root)?;
+        let host = RESOURCES.map(|r| PinnedFile::open(&root.join("proc/pressure").join(r)).ok());
+        let host_prev = [[0; 2]; 3];
+        let mut collector = Self {
+            mount,
+            selection,
+            max_files,
+            open_files: 0,
+            skipped: 0,
+            host,
+            host_prev,
+            groups: Vec::new(),
+            samples: 0,
+            last: None,
+            buf: vec![0; 4096],
+            ranked: Vec::new(),
+        };
+        collector.rescan();
+        Ok(collector)
+    }
+
+    /// 跟踪中的组数
+    pub fn group_count(&self) -> usize {
+        self.groups.len()
+    }
+
+    /// 上次发现时因文件数上限未跟踪的组数
+    pub fn skipped(&self) -> usize {
+        self.skipped
+    }
+
+    /// 主机 PSI 是否可用
+    pub fn has_host_pressure(&self) -> bool {
+        self.host.iter().any(Option::is_some)
+    }
+
+    /// 重新发现组: 保留仍存在的组 (连同已打开的文件和基线)，打开新组，关闭消失的组
+    fn rescan(&mut self) {
+        let mut names = Vec::new();
+        match &self.selection {
+            CgroupSelection::Depth(depth) => walk(&self.mount, "", *depth, &mut names),
+            CgroupSelection::Paths(paths) => {
+                names.extend(paths.iter().filter(|p| self.mount.join(p).is_dir()).cloned())
+            }
+        }
+        names.sort_unstable();
+        names.dedup();
+
+        let mut existing: HashMap<String, Group> =
+            self.groups.drain(..).map(|g| (g.rate.name.clone(), g)).collect();
+        self.open_files = existing.values().map(Group::file_count).sum();
+        self.skipped = 0;
+        for name in names {
+            if let Some(group) = existing.remove(&name) {
+                self.groups.push(group);
+            } else if self.open_files + FILES_PER_GROUP <= self.max_files {
+                if let Some(group) = Group::open(&self.mount, name) {
+                    self.open_files += group.file_count();
+                    self.groups.push(group);
+                }
+            } else {
+                self.skipped += 1;
+            }
+        }
+        // 剩下的组已消失，文件随之关闭
+        self.open_files -= existing.values().map(Group::file_count).sum::<usize>();
+
+        // 父组的计数包含子组，同时排名会重复计算；只有叶子组 (没有跟踪中的子组) 参与 Top-N。
+        // 组按名称排序，子组 "a/..." 都在 "a/" 之后的连续区间内
+        for i in 0..self.groups.len() {
+            let prefix = format!("{}/", self.groups[i].rate.name);
+            let next = self.groups.partition_point(|g| g.rate.name < prefix);
+            self.groups[i].leaf = self.groups.get(next).is_none_or(|g| !g.rate.name.starts_with(&prefix));
+        }
+    }
+
+    /// 读取主机 PSI，返回本周期的停顿比例
+    fn sample_host(&mut self, elapsed_usec: f64) -> Option<HostPressure> {
+        let mut pressure = HostPressure::default();
+        for i in 0..3 {
+            let Some(file) = &self.host[i] else { continue };
+            let Ok(data) = file.read_once(&mut self.buf) else { continue };
+            let totals = parse_pressure(data);
+            for j in 0..2 {
+                if elapsed_usec > 0.0 {
+                    let delta = totals[j].saturating_sub(self.host_prev[i][j]);
+                    pressure.0[i][j] = (delta as f64 / elapsed_usec * 100.0) as f32;
+                }
+                self.host_prev[i][j] = totals[j];
+            }
+        }
+        self.has_host_pressure().then_some(pressure)
+    }
+
+    /// 执行一次采样，返回 Top-N (第一次只建立基线，速率为 0)
+    pub fn sample(&mut self, top_n: usize) -> CgroupReport {
+        if self.samples % RESCAN_EVERY == 0 {
+            self.rescan();
+        }
+        self.samples = self.samples.wrapping_add(1);
+
+        let now = Instant::now();
+        let elapsed_usec = self.last.map_or(0.0, |t| (now - t).as_secs_f64() * 1e6);
+        self.last = Some(now);
+
+        let psi = self.sample_host(elapsed_usec);
+
+        let Self { groups, buf, open_files, .. } = self;
+        groups.retain_mut(|group| {
+            let alive = group.read(buf, elapsed_usec).is_ok();
+            if !alive {
+                *open_files -= group.file_count();
+            }
+            alive
+        });
+
+        let ranked = &mut self.ranked;
+        ranked.clear();
+        ranked.extend((0..groups.len()).filter(|&i| groups[i].leaf && groups[i].score() > (0.0, 0.0)));
+        ranked.sort_unstable_by(|&a, &b| {
+            let ((a_stall, a_cpu), (b_stall, b_cpu)) = (groups[a].score(), groups[b].score());
+            b_stall.total_cmp(&a_stall).then(b_cpu.total_cmp(&a_cpu))
+        });
+        let top = ranked.iter().take(top_n).map(|&i| groups[i].rate.clone()).collect();
+
+        CgroupReport { psi, tracked: groups.len(), top }
+    }
+}
+
+/// 文件描述符软上限的目标值 (见 [`raise_fd_limit`])
+#[cfg(unix)]
+const FD_TARGET: libc::rlim_t = 65536;
+
+/// 把进程的文件描述符软上限提到硬上限 (至多 65536)，返回 (原上限, 新上限)；无需或无法提高时返回 None
+///
+/// 默认软上限 1024 只够约 80 个组。只在启动时由 main 调用一次 (之后启动的子进程继承提高后的上限)，
+/// [`fd_budget`] 只读取当前上限
+#[cfg(unix)]
+pub fn raise_fd_limit() -> Option<(u64, u64)> {
+    let mut limit = libc::rlimit { rlim_cur: 0, rlim_max: 0 };
+    // SAFETY: getrlimit/setrlimit 只读写传入的结构体
+    unsafe {
+        if libc::getrlimit(libc::RLIMIT_NOFILE, &mut limit) != 0 {
+            return None;
+        }
+        let wanted = limit.rlim_max.min(FD_TARGET);
+        if limit.rlim_cur >= wanted {
+            return None;
+        }
+        let raised = libc::rlimit { rlim_cur: wanted, rlim_max: limit.rlim_max };
+        (libc::setrlimit(libc::RLIMIT_NOFILE, &raised) == 0).then_some((limit.rlim_cur as u64, wanted as u64))
+    }
+}
+
+/// 持久打开文件数的预算: 当前文件描述符软上限 (至多 65536) 的一半
+///
+/// 服务端的网络与采集只占少量描述符，其余留给 cgroup 文件
+#[cfg(unix)]
+pub fn fd_budget() -> usize {
+    let mut limit = libc::rlimit { rlim_cur: 0, rlim_max: 0 };
+    // SAFETY: getrlimit 只写入传入的结构体
+    if unsafe { libc::getrlimit(libc::RLIMIT_NOFILE, &mut limit) } != 0 {
+        return 512;
+    }
+    (limit.rlim_cur.min(FD_TARGET) / 2) as usize
+}
+
+/// 在独立线程上按 `period` 采样 cgroup 与 PSI，返回报告通道
+///
+/// 单次采样耗时超过周期的 1/`DUTY_CYCLE_DIVISOR` 时相应拉长间隔。
+/// 不是 Linux 或没有挂载 cgroup v2 时返回 None
+pub fn spawn_sampler(period: Duration, selection: CgroupSelection, top_n: usize) -> Option<Receiver<CgroupReport>> {
+    #[cfg(target_os = "linux")]
+    {
+        use crate::stats::STATS;
+        use std::sync::mpsc;
+        use std::thread;
+
+        let mut collector = match CgroupCollector::open(Path::new("/"), selection, fd_budget()) {
+            Ok(collector) => collector,
+            Err(e) => {
+                println!("⚠️  cgroup 采集不可用: {}", e);
+                return None;
+            }
+        };
+        println!(
+            "✅ cgroup 采样: 每 {}ms, 跟踪 {} 个组, 主机 PSI {}, Top-{}",
+            period.as_millis(),
+            collector.group_count(),
+            if collector.has_host_pressure() { "可用" } else { "不可用" },
+            top_n
+        );
+
+        let (tx, rx) = mpsc::sync_channel(REPORT_BACKLOG);
+        thread::spawn(move || {
+            let mut warned = false;
+            loop {
+                let started = Instant::now();
+                let report = collector.sample(top_n);
+                STATS.collectors.cgroups.observe_since(started);
+                STATS.cgroups_tracked.set(report.tracked as i64);
+                if collector.skipped() > 0 && !warned {
+                    println!("⚠️  cgroup 数超出文件描述符预算，{} 个组未跟踪", collector.skipped());
+                    warned = true;
+                }
+                if tx.send(report).is_err() {
+                    break;
+                }
+                thread::sleep(period.max(started.elapsed() * DUTY_CYCLE_DIVISOR));
+            }
+        });
+        Some(rx)
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        let _ = (period, selection, top_n);
+        println!("⚠️  cgroup v2 采集仅支持 Linux，已忽略");
+        None
+    }
+}
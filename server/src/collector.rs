@@ -0,0 +1,143 @@
+//! 独立调度的采集器
+//!
+//! 每个数据源运行在自己的线程上，有自己的周期和超时，结果写入共享的最新值快照:
+//! - 采集本身在锁外进行，锁只在写入结果时短暂持有，慢速数据源不会拖慢其他数据源
+//! - 每个结果带采样时间 ([`Stamped`])，读取方据此丢弃过期数据
+//! - 单次采集耗时记入该采集器的直方图，超过超时时打印警告
+//!
+//! 工作线程只持有快照的弱引用，快照的所有者 (`Monitor`) 释放后线程自行退出
+
+use crate::stats::Histogram;
+use std::sync::{Arc, Condvar, Mutex, MutexGuard, OnceLock, Weak};
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// 服务端单调时钟的起点 (首次调用 [`millis`] 时确定)
+static EPOCH: OnceLock<Instant> = OnceLock::new();
+
+/// 把 `at` 换算为服务端单调时钟毫秒，用于帧内的采样时间与 PONG 回复
+///
+/// 早于时钟起点的时刻记为 0
+pub fn millis(at: Instant) -> u64 {
+    let epoch = *EPOCH.get_or_init(Instant::now);
+    at.saturating_duration_since(epoch).as_millis() as u64
+}
+
+/// 带采样时间的值
+#[derive(Debug, Clone)]
+pub struct Stamped<T> {
+    pub value: T,
+    pub at: Instant,
+}
+
+impl<T> Stamped<T> {
+    pub fn new(value: T, at: Instant) -> Self {
+        Self { value, at }
+    }
+
+    /// 采样时间在 `max_age` 之内时返回值
+    pub fn fresh(&self, max_age: Duration) -> Option<&T> {
+        (self.at.elapsed() <= max_age).then_some(&self.value)
+    }
+}
+
+/// 共享的最新值快照
+pub struct Shared<S> {
+    state: Mutex<S>,
+    updated: Condvar,
+}
+
+impl<S> Shared<S> {
+    pub fn new(state: S) -> Arc<Self> {
+        Arc::new(Self {
+            state: Mutex::new(state),
+            updated: Condvar::new(),
+        })
+    }
+
+    pub fn lock(&self) -> MutexGuard<'_, S> {
+        self.state.lock().unwrap()
+    }
+
+    /// 加锁，`pending` 成立时最多等待 `timeout` (用于等待首个样本)
+    pub fn lock_when(&self, timeout: Duration, pending: impl FnMut(&mut S) -> bool) -> MutexGuard<'_, S> {
+        let guard = self.lock();
+        self.updated.wait_timeout_while(guard, timeout, pending).unwrap().0
+    }
+
+    /// 写入结果并唤醒等待者
+    fn update(&self, f: impl FnOnce(&mut S)) {
+        f(&mut self.lock());
+        self.updated.notify_all();
+    }
+}
+
+/// 采集器调度参数
+pub struct Schedule {
+    pub name: &'static str,
+    /// 采集周期 (从上一次开始计，采集耗时计入周期)
+    pub period: Duration,
+    /// 单次采集的预期上限，超出时打印警告；读取方也以此判断结果是否过期
+    pub timeout: Duration,
+    /// 首次采集前的等待
+    pub initial_delay: Duration,
+    /// 单次采集耗时
+    pub cost: &'static Histogram,
+}
+
+/// 在独立线程上按 `schedule` 周期采集
+///
+/// `init` 在采集线程上构造采集函数 (数据源句柄不必是 `Send`)；采集函数把结果写入
+/// 线程私有的缓冲 `T` (复用其内存)，返回 false 时该采集器停止；`store` 在快照锁内
+/// 把缓冲合并进快照
+pub fn spawn<S, T, C>(
+    schedule: Schedule,
+    shared: Weak<Shared<S>>,
+    init: impl FnOnce() -> C + Send + 'static,
+    store: impl Fn(&mut S, &T, Instant) + Send + 'static,
+) where
+    S: Send + 'static,
+    T: Default + 'static,
+    C: FnMut(&mut T) -> bool,
+{
+    println!(
+        "⏱️  采集器 {}: 每 {} ms (超时 {} ms)",
+        schedule.name,
+        schedule.period.as_millis(),
+        schedule.timeout.as_millis()
+    );
+    thread::spawn(move || {
+        let mut collect = init();
+        thread::sleep(schedule.initial_delay);
+        let mut buf = T::default();
+        let mut overrun = false;
+        loop {
+            let started = Instant::now();
+            let running = collect(&mut buf);
+            let cost = started.elapsed();
+            schedule.cost.observe_duration(cost);
+
+            // 只在进入/离开超时状态时打印，避免持续超时刷屏
+            if cost > schedule.timeout && !overrun {
+                println!(
+                    "⚠️  采集器 {} 超时: {} ms (上限 {} ms)",
+                    schedule.name,
+                    cost.as_millis(),
+                    schedule.timeout.as_millis()
+                );
+            } else if cost <= schedule.timeout && overrun {
+                println!("✅ 采集器 {} 已恢复: {} ms", schedule.name, cost.as_millis());
+            }
+            overrun = cost > schedule.timeout;
+
+            let Some(shared) = shared.upgrade() else { break };
+            shared.update(|state| store(state, &buf, started));
+            drop(shared);
+
+            if !running {
+                break;
+            }
+            thread::sleep(schedule.period.saturating_sub(cost));
+        }
+    });
+}
@@ -0,0 +1,219 @@
+//! 3DS UDP 分片帧
+//!
+//! 3DS 客户端随心跳发送 `MTU <字节数>` 声明单个数据报的上限。放得下的消息原样发送 (与旧版协议相同)；
+//! 超过上限的消息按顶层字段装箱成若干个块，每个块都是完整的 JSON 对象，带上公共字段
+//! (`seq`、`sample_ms`，中继消息还有 `host`)，客户端可以单独解码，丢一个数据报只丢它携带的字段。
+//! 单个字段本身就超过上限时，它所在的块按字节切成连续的几个数据报，由客户端重组
+//! (`3ds/source/reassembly.c`)。每个数据报带 [`HEADER_LEN`] 字节的头部 (小端):
+//!
+//! ```text
+//!  0  u8   0xFD 标记 (不是 '{'，也不是文本命令的首字母)
+//!  1  u8   版本 (1)
+//!  2  u16  frame   帧号 (每打包一条消息加一，回绕)
+//!  4  u8   count   本帧数据报数
+//!  5  u8   index   本数据报序号 (0..count)
+//!  6  u8   first   所在块的第一个数据报序号
+//!  7  u8   parts   所在块的数据报数 (1 = 负载本身就是完整的 JSON 对象)
+//!  8  u16  offset  负载在块中的字节偏移
+//! 10  ...  负载
+//! ```
+
+use crate::stats::STATS;
+use crate::subscription::FieldMask;
+
+/// 数据报首字节标记
+pub const MARKER: u8 = 0xFD;
+/// 头部版本
+pub const VERSION: u8 = 1;
+/// 头部长度
+pub const HEADER_LEN: usize = 10;
+/// 客户端可声明的上限范围 (更小时头部和公共字段占比过高；更大时超过以太网 MTU 会在 IP 层分片)
+pub const MIN_MTU: usize = 256;
+pub const MAX_MTU: usize = 1472;
+/// 一帧最多的数据报数 (`count` 为 u8)
+pub const MAX_PARTS: usize = 255;
+/// 一个块最多的数据报数 (客户端按 32 位位图记录，`REASM_MAX_BYTES` 之外的另一个上限)
+pub const MAX_CHUNK_PARTS: usize = 32;
+/// 一个块的字节上限 (客户端重组槽位的大小，与 `3ds/source/reassembly.h` 的 `REASM_MAX_BYTES` 一致)
+pub const MAX_CHUNK_BYTES: usize = 8192;
+/// 每个块都携带的顶层字段
+const COMMON_FIELDS: [&str; 3] = ["seq", "sample_ms", "host"];
+
+/// 解析客户端的 `MTU <字节数>`，限制在 [`MIN_MTU`]..=[`MAX_MTU`]
+pub fn parse_mtu(arg: &str) -> Option<u16> {
+    let mtu: usize = arg.trim().parse().ok()?;
+    Some(mtu.clamp(MIN_MTU, MAX_MTU) as u16)
+}
+
+/// 一条消息的打包结果
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Packed {
+    /// 追加的数据报数
+    pub datagrams: usize,
+    /// 超过客户端重组上限 ([`MAX_CHUNK_BYTES`] 或 [`MAX_CHUNK_PARTS`]) 而丢弃的块数
+    pub dropped_chunks: usize,
+}
+
+/// 一个块能否被客户端重组
+pub fn chunk_fits(len: usize, mtu: u16) -> bool {
+    len <= MAX_CHUNK_BYTES && len.div_ceil(usize::from(mtu) - HEADER_LEN) <= MAX_CHUNK_PARTS
+}
+
+/// 把一条 JSON 对象消息按 `mtu` 打包成数据报，追加到 `out`
+///
+/// 放得下时原样追加一个数据报 (不带头部)。客户端无法重组的块 (单个字段过大) 丢弃，
+/// 其余块照常发送；不是 JSON 对象、所有块都被丢弃或整帧超过 255 个数据报时返回 `None`，不追加
+pub fn pack(json: &str, mtu: u16, frame: u16, out: &mut Vec<Vec<u8>>) -> Option<Packed> {
+    if json.len() <= usize::from(mtu) {
+        out.push(json.as_bytes().to_vec());
+        return Some(Packed { datagrams: 1, dropped_chunks: 0 });
+    }
+    let fits = |chunk: &String| chunk_fits(chunk.len(), mtu);
+    let mtu = usize::from(mtu);
+    let payload = mtu - HEADER_LEN;
+    let fields = split_fields(json)?;
+
+    // 公共字段组成每个块的前缀
+    let mut prefix = String::from("{");
+    for field in fields.iter().filter(|field| is_common(field)) {
+        if prefix.len() > 1 {
+            prefix.push(',');
+        }
+        prefix.push_str(field);
+    }
+
+    // 按原顺序装箱 (相邻字段通常属于同一组)，装不下时另起一块
+    let mut chunks: Vec<String> = Vec::new();
+    let mut chunk = prefix.clone();
+    for field in fields.iter().filter(|field| !is_common(field)) {
+        if chunk.len() > prefix.len() && chunk.len() + 1 + field.len() + 1 > payload {
+            chunk.push('}');
+            chunks.push(std::mem::replace(&mut chunk, prefix.clone()));
+        }
+        if chunk.len() > 1 {
+            chunk.push(',');
+        }
+        chunk.push_str(field);
+    }
+    if chunk.len() > prefix.len() {
+        chunk.push('}');
+        chunks.push(chunk);
+    }
+    let total = chunks.len();
+    chunks.retain(fits);
+    let dropped_chunks = total - chunks.len();
+    if chunks.is_empty() {
+        return None;
+    }
+
+    let parts: Vec<usize> = chunks.iter().map(|chunk| chunk.len().div_ceil(payload)).collect();
+    let count: usize = parts.iter().sum();
+    if count > MAX_PARTS {
+        return None;
+    }
+
+    let mut index = 0;
+    for (chunk, &n) in chunks.iter().zip(&parts) {
+        let first = index;
+        for (i, piece) in chunk.as_bytes().chunks(payload).enumerate() {
+            let offset = (i * payload) as u16;
+            let mut datagram = Vec::with_capacity(HEADER_LEN + piece.len());
+            datagram.extend_from_slice(&[MARKER, VERSION]);
+            datagram.extend_from_slice(&frame.to_le_bytes());
+            datagram.extend_from_slice(&[count as u8, index as u8, first as u8, n as u8]);
+            datagram.extend_from_slice(&offset.to_le_bytes());
+            datagram.extend_from_slice(piece);
+            out.push(datagram);
+            index += 1;
+        }
+    }
+    Some(Packed { datagrams: count, dropped_chunks })
+}
+
+fn is_common(field: &str) -> bool {
+    let Some(key) = field.strip_prefix('"') else { return false };
+    COMMON_FIELDS
+        .iter()
+        .any(|name| key.strip_prefix(name).is_some_and(|rest| rest.starts_with("\":")))
+}
+
+/// 把 JSON 对象文本拆成顶层成员 (`"key":value`)，只跟踪字符串与嵌套深度，不解析数值
+fn split_fields(json: &str) -> Option<Vec<&str>> {
+    let body = json.trim().strip_prefix('{')?.strip_suffix('}')?;
+    let bytes = body.as_bytes();
+    let mut fields = Vec::new();
+    let (mut depth, mut in_string, mut escaped, mut start) = (0usize, false, false, 0);
+    for (i, &b) in bytes.iter().enumerate() {
+        if in_string {
+            match b {
+                _ if escaped => escaped = false,
+                b'\\' => escaped = true,
+                b'"' => in_string = false,
+                _ => {}
+            }
+            continue;
+        }
+        match b {
+            b'"' => in_string = true,
+            b'{' | b'[' => depth += 1,
+            b'}' | b']' => depth = depth.checked_sub(1)?,
+            b',' if depth == 0 => {
+                fields.push(body[start..i].trim());
+                start = i + 1;
+            }
+            _ => {}
+        }
+    }
+    if in_string || depth != 0 {
+        return None;
+    }
+    let last = body[start..].trim();
+    if !last.is_empty() {
+        fields.push(last);
+    }
+    Some(fields)
+}
+
+/// 一次扇出中打包好的数据报 (复用缓冲): 同一条消息按同样的订阅和上限只打包一次，
+/// 发给声明了相同上限的各个客户端
+#[derive(Default)]
+pub struct Packer {
+    /// 下一条打包消息的帧号
+    frame: u16,
+    /// (消息序号, 订阅, 上限) → `datagrams` 中的区间 (`None` 表示无法打包，整条丢弃)
+    packed: Vec<((usize, FieldMask, u16), Option<(usize, usize)>)>,
+    datagrams: Vec<Vec<u8>>,
+}
+
+impl Packer {
+    /// 开始新一轮扇出 (帧号继续递增)
+    pub fn clear(&mut self) {
+        self.packed.clear();
+        self.datagrams.clear();
+    }
+
+    /// 第 `message` 条消息按 `mask` 编码的 `json` 打包成不超过 `mtu` 的数据报
+    ///
+    /// 丢弃的块和无法打包的消息在首次打包时计入 `holo_udp_oversize_drops_total`
+    pub fn pack(&mut self, message: usize, mask: FieldMask, mtu: u16, json: &str) -> Option<&[Vec<u8>]> {
+        let key = (message, mask, mtu);
+        let range = match self.packed.iter().find(|(k, _)| *k == key) {
+            Some((_, range)) => *range,
+            None => {
+                let start = self.datagrams.len();
+                let packed = pack(json, mtu, self.frame, &mut self.datagrams);
+                match packed {
+                    Some(packed) => {
+                        self.frame = self.frame.wrapping_add(1);
+                        STATS.udp_oversize_drops.add(packed.dropped_chunks as u64);
+                    }
+                    None => STATS.udp_oversize_drops.inc(),
+                }
+                let range = packed.map(|packed| (start, start + packed.datagrams));
+                self.packed.push((key, range));
+                range
+            }
+        };
+        range.map(|(start, end)| &self.datagrams[start..end])
+    }
+}
@@ -0,0 +1,253 @@
+//! 风扇曲线控制 (CUSTOM 风扇模式)
+//!
+//! 服务端不再为每条 FAN 命令执行一次 `sudo temp_sensor -s <模式>`，而是在第一条命令时启动常驻的
+//! `temp_sensor --control` 特权辅助进程，整个运行期间复用同一个 SMC 连接:
+//! - 启动后先下发温度→转速曲线 (`--fan-curve=curve.json`，默认 [`default_curve`])，之后每条 FAN 命令只写一行 `MODE <模式>`
+//! - 辅助进程每 500ms 按曲线调速 (滞回 + 限速)，并输出一行状态 JSON，由 [`FanControlBackend`] 作为
+//!   `fan_control` 字段推送给客户端
+//! - 控制逻辑在 C 侧 (`temp-sensor/fanctl.c`)，`make -C server/temp-sensor sim` 在热模型上仿真检验
+//! - 辅助进程在 stdin 关闭 (服务端退出) 时恢复系统自动控制；进程意外退出时下一条 FAN 命令重新启动
+//!
+//! `--fan-helper="<命令> <参数>..."` 可替换辅助进程，例如在没有 SMC 的机器上用
+//! `temp-sensor/fan_sim --helper` (热模型) 联调整条链路
+
+use crate::monitor::{Backend, SystemMetrics};
+use crate::stats::STATS;
+use serde::{Deserialize, Serialize};
+use std::{
+    io::{BufRead, BufReader, Write},
+    path::PathBuf,
+    process::{Child, ChildStdin, ChildStdout, Command, Stdio},
+    sync::{
+        mpsc::{self, Receiver, RecvTimeoutError, SyncSender},
+        Arc, Mutex,
+    },
+    thread,
+    time::Duration,
+};
+
+/// 曲线点数上限 (与 fanctl.h 的 FAN_CURVE_MAX_POINTS 一致)
+pub const MAX_POINTS: usize = 16;
+/// 滞回上限 (°C，与 fanctl.c 一致)
+const MAX_HYSTERESIS_C: f32 = 20.0;
+/// 命令确认的等待时间
+const ACK_TIMEOUT: Duration = Duration::from_secs(2);
+/// 启动辅助进程后等待曲线确认的时间 (sudo 可能在终端上询问密码)
+const START_TIMEOUT: Duration = Duration::from_secs(60);
+/// 尚未取走的确认上限 (超时未取的确认在下一条命令前丢弃)
+const ACK_BACKLOG: usize = 4;
+/// 可切换的风扇模式 (与 fanctl.c 的 MODE_NAMES 一致)
+pub const MODES: [&str; 4] = ["auto", "silent", "turbo", "custom"];
+
+/// 温度→转速曲线
+#[derive(Debug, Clone, PartialEq, Deserialize)]
+pub struct FanCurve {
+    /// (温度 °C, 转速 RPM)，温度严格递增；转速超出风扇范围时由辅助进程截断
+    pub points: Vec<(f32, f32)>,
+    /// 降温超过该值才降低转速 (°C)
+    #[serde(default = "default_hysteresis")]
+    pub hysteresis_c: f32,
+    /// 转速变化率上限 (RPM/秒)
+    #[serde(default = "default_slew")]
+    pub slew_rpm_per_s: f32,
+}
+
+fn default_hysteresis() -> f32 {
+    3.0
+}
+
+fn default_slew() -> f32 {
+    300.0
+}
+
+/// 内置曲线 (与 fan_sim.c 的仿真曲线一致)
+pub fn default_curve() -> FanCurve {
+    FanCurve {
+        points: vec![(45.0, 1200.0), (60.0, 2500.0), (75.0, 4500.0), (90.0, 6000.0)],
+        hysteresis_c: default_hysteresis(),
+        slew_rpm_per_s: default_slew(),
+    }
+}
+
+/// 解析并检查曲线 JSON: `{"points":[[45,1200],[60,2500],...],"hysteresis_c":3,"slew_rpm_per_s":300}`
+pub fn parse_curve(json: &str) -> Result<FanCurve, String> {
+    let curve: FanCurve = serde_json::from_str(json).map_err(|e| e.to_string())?;
+    if curve.points.is_empty() || curve.points.len() > MAX_POINTS {
+        return Err(format!("曲线需要 1 到 {} 个点", MAX_POINTS));
+    }
+    if curve.points.iter().any(|(t, rpm)| !t.is_finite() || !rpm.is_finite() || *rpm < 0.0) {
+        return Err("温度和转速必须是有限值，转速不能为负".to_string());
+    }
+    if curve.points.windows(2).any(|w| w[1].0 <= w[0].0) {
+        return Err("温度必须严格递增".to_string());
+    }
+    if !(0.0..=MAX_HYSTERESIS_C).contains(&curve.hysteresis_c) {
+        return Err(format!("hysteresis_c 必须在 0 到 {} 之间", MAX_HYSTERESIS_C));
+    }
+    if !(curve.slew_rpm_per_s > 0.0 && curve.slew_rpm_per_s.is_finite()) {
+        return Err("slew_rpm_per_s 必须为正数".to_string());
+    }
+    Ok(curve)
+}
+
+impl FanCurve {
+    /// 下发给辅助进程的命令行: `CURVE 45:1200,60:2500 hyst=3 slew=300`
+    pub fn command(&self) -> String {
+        let points: Vec<String> = self.points.iter().map(|(t, rpm)| format!("{}:{}", t, rpm)).collect();
+        format!("CURVE {} hyst={} slew={}", points.join(","), self.hysteresis_c, self.slew_rpm_per_s)
+    }
+}
+
+/// 辅助进程上报的控制器状态 (`fan_control` 字段)；自动模式下转速为 null
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct FanControlState {
+    /// auto / silent / turbo / custom
+    pub mode: String,
+    /// 控制器读到的温度 (°C)
+    pub temp: Option<f32>,
+    /// 曲线给出的目标转速 (滞回之后)
+    pub target_rpm: Option<f32>,
+    /// 限速之后实际下发的转速
+    pub command_rpm: Option<f32>,
+}
+
+/// 查找 temp_sensor，返回以 sudo 运行其常驻模式的命令
+pub fn locate_helper() -> Option<Vec<String>> {
+    let mut possible_paths = vec![
+        PathBuf::from("temp-sensor/temp_sensor"),
+        PathBuf::from("../temp-sensor/temp_sensor"),
+        PathBuf::from("server/temp-sensor/temp_sensor"),
+    ];
+    // 打包后与服务端二进制放在同一目录
+    if let Some(parent) = std::env::current_exe().ok().and_then(|exe| exe.parent().map(|p| p.to_path_buf())) {
+        possible_paths.push(parent.join("temp_sensor"));
+    }
+    let path = possible_paths.into_iter().find(|path| path.exists())?;
+    Some(vec!["sudo".to_string(), path.to_string_lossy().into_owned(), "--control".to_string()])
+}
+
+struct Running {
+    child: Child,
+    stdin: ChildStdin,
+    acks: Receiver<Result<String, String>>,
+}
+
+/// 常驻的风扇控制辅助进程 (首次切换模式时启动)
+pub struct FanHelper {
+    command: Vec<String>,
+    curve: FanCurve,
+    running: Mutex<Option<Running>>,
+    state: Arc<Mutex<Option<FanControlState>>>,
+}
+
+impl FanHelper {
+    /// `command` 为辅助进程的程序与参数 (见 [`locate_helper`])
+    pub fn new(command: Vec<String>, curve: FanCurve) -> Self {
+        Self {
+            command,
+            curve,
+            running: Mutex::new(None),
+            state: Arc::new(Mutex::new(None)),
+        }
+    }
+
+    /// 最新的控制器状态 (辅助进程未运行时为 None)，供 [`FanControlBackend`] 读取
+    pub fn state(&self) -> Arc<Mutex<Option<FanControlState>>> {
+        self.state.clone()
+    }
+
+    /// 切换风扇模式并等待辅助进程确认 (阻塞，最长等待启动和确认的超时)
+    ///
+    /// `mode` 必须是 [`MODES`] 之一: 它原样写入特权辅助进程的 stdin，其他文本 (例如内嵌换行) 会变成额外的命令
+    pub fn set_mode(&self, mode: &str) -> Result<(), String> {
+        if !MODES.contains(&mode) {
+            return Err(format!("unknown mode {:?}", mode));
+        }
+        let mut running = self.running.lock().unwrap();
+        let alive = running.as_mut().is_some_and(|r| matches!(r.child.try_wait(), Ok(None)));
+        if !alive {
+            *running = None;
+            let mut started = self.spawn()?;
+            Self::send(&mut started, &self.curve.command(), START_TIMEOUT)?;
+            *running = Some(started);
+        }
+        let result = Self::send(running.as_mut().unwrap(), &format!("MODE {}", mode), ACK_TIMEOUT);
+        if result.is_err() && running.as_mut().is_some_and(|r| !matches!(r.child.try_wait(), Ok(None))) {
+            *running = None;
+        }
+        result
+    }
+
+    fn spawn(&self) -> Result<Running, String> {
+        let (program, args) = self.command.split_first().ok_or("辅助进程命令为空")?;
+        let mut child = Command::new(program)
+            .args(args)
+            .stdin(Stdio::piped())
+            .stdout(Stdio::piped())
+            .spawn()
+            .map_err(|e| format!("{}: {}", program, e))?;
+        STATS.fan_helper_starts.inc();
+        let stdin = child.stdin.take().ok_or("辅助进程没有 stdin")?;
+        let stdout = child.stdout.take().ok_or("辅助进程没有 stdout")?;
+        let (tx, acks) = mpsc::sync_channel(ACK_BACKLOG);
+        let state = self.state.clone();
+        thread::Builder::new()
+            .name("fan-helper".into())
+            .spawn(move || read_output(stdout, tx, state))
+            .map_err(|e| e.to_string())?;
+        Ok(Running { child, stdin, acks })
+    }
+
+    fn send(running: &mut Running, line: &str, timeout: Duration) -> Result<(), String> {
+        while running.acks.try_recv().is_ok() {}
+        writeln!(running.stdin, "{}", line)
+            .and_then(|_| running.stdin.flush())
+            .map_err(|e| format!("辅助进程已退出: {}", e))?;
+        match running.acks.recv_timeout(timeout) {
+            Ok(result) => result.map(|_| ()),
+            Err(RecvTimeoutError::Timeout) => Err("辅助进程未响应".to_string()),
+            Err(RecvTimeoutError::Disconnected) => Err("辅助进程已退出".to_string()),
+        }
+    }
+}
+
+/// 读取辅助进程输出: 状态行更新控制器状态，OK/ERR 行转为命令确认；进程退出时清除状态
+fn read_output(stdout: ChildStdout, acks: SyncSender<Result<String, String>>, state: Arc<Mutex<Option<FanControlState>>>) {
+    for line in BufReader::new(stdout).lines() {
+        let Ok(line) = line else { break };
+        if line.starts_with('{') {
+            if let Ok(status) = serde_json::from_str::<FanControlState>(&line) {
+                *state.lock().unwrap() = Some(status);
+            }
+        } else if let Some(ok) = line.strip_prefix("OK") {
+            let _ = acks.try_send(Ok(ok.trim().to_string()));
+        } else if let Some(err) = line.strip_prefix("ERR") {
+            let _ = acks.try_send(Err(err.trim().to_string()));
+        }
+    }
+    *state.lock().unwrap() = None;
+}
+
+/// 在原有后端的结果上附加风扇控制器状态
+pub struct FanControlBackend {
+    inner: Box<dyn Backend>,
+    state: Arc<Mutex<Option<FanControlState>>>,
+}
+
+impl FanControlBackend {
+    pub fn new(inner: Box<dyn Backend>, helper: &FanHelper) -> Self {
+        Self { inner, state: helper.state() }
+    }
+}
+
+impl Backend for FanControlBackend {
+    fn refresh(&mut self) -> SystemMetrics {
+        let mut metrics = self.inner.refresh();
+        metrics.fan_control = self.state.lock().unwrap().clone();
+        metrics
+    }
+
+    fn first_sample_delay(&self) -> Duration {
+        self.inner.first_sample_delay()
+    }
+}
@@ -0,0 +1,447 @@
+//! 数据分发
+//!
+//! 3DS 客户端注册表 (UDP 心跳) 与每帧的扇出: 采样 → 按订阅 JSON 编码 → WebSocket 广播 + UDP 单播。
+//! 从 main.rs 中拆出，供服务端二进制和基准测试共用
+
+use crate::collector;
+use crate::datagram::Packer;
+use crate::monitor::Backend;
+use crate::stats::STATS;
+use crate::subscription::{self, FieldMask, Frame};
+use crate::wire::{self, Deflater, Format};
+use futures_util::{SinkExt, StreamExt};
+use std::{
+    collections::HashMap,
+    net::SocketAddr,
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+use tokio::{
+    io::{AsyncRead, AsyncWrite},
+    net::UdpSocket,
+    sync::broadcast,
+};
+use tokio_tungstenite::{
+    accept_async_with_config,
+    tungstenite::{protocol::WebSocketConfig, Message},
+};
+
+/// 注册的 3DS 客户端上限 (表满时新地址的心跳被忽略，直到有客户端超时)
+pub const MAX_CLIENTS: usize = 64;
+/// WebSocket 客户端消息上限 (客户端只发送很短的控制消息)
+const WS_MAX_MESSAGE: usize = 64 << 10;
+/// WebSocket 发送缓冲上限 (发送逐条等待完成，正常情况下远低于该值)
+const WS_MAX_WRITE_BUFFER: usize = 1 << 20;
+
+/// 已注册的 3DS 客户端
+struct Client {
+    last_seen: Instant,
+    mask: FieldMask,
+    /// 客户端声明的数据报上限 (`MTU <字节数>`，见 [`crate::datagram`])；旧版客户端没有，按原样整帧发送
+    mtu: Option<u16>,
+}
+
+/// 已注册的 3DS 客户端 (地址 → 最近一次心跳与字段订阅)，至多 [`MAX_CLIENTS`] 个
+pub struct ClientRegistry {
+    clients: HashMap<SocketAddr, Client>,
+    timeout: Duration,
+}
+
+impl ClientRegistry {
+    pub fn new(timeout: Duration) -> Self {
+        Self {
+            clients: HashMap::new(),
+            timeout,
+        }
+    }
+
+    /// 记录心跳，返回是否为新客户端 (新客户端订阅全部字段；表满时不登记)
+    pub fn touch(&mut self, addr: SocketAddr, now: Instant) -> bool {
+        let full = self.clients.len() >= MAX_CLIENTS;
+        match self.clients.get_mut(&addr) {
+            Some(client) => {
+                client.last_seen = now;
+                false
+            }
+            None if full => false,
+            None => {
+                self.clients.insert(addr, Client { last_seen: now, mask: FieldMask::ALL, mtu: None });
+                true
+            }
+        }
+    }
+
+    /// 更新字段订阅 (同时算作一次心跳)，返回是否为新客户端 (表满时不登记)
+    pub fn subscribe(&mut self, addr: SocketAddr, mask: FieldMask, now: Instant) -> bool {
+        self.update(addr, now, |client| client.mask = mask)
+    }
+
+    /// 更新数据报上限 (同时算作一次心跳)，返回是否为新客户端 (表满时不登记)
+    pub fn set_mtu(&mut self, addr: SocketAddr, mtu: u16, now: Instant) -> bool {
+        self.update(addr, now, |client| client.mtu = Some(mtu))
+    }
+
+    fn update(&mut self, addr: SocketAddr, now: Instant, apply: impl FnOnce(&mut Client)) -> bool {
+        if let Some(client) = self.clients.get_mut(&addr) {
+            client.last_seen = now;
+            apply(client);
+            return false;
+        }
+        if self.clients.len() >= MAX_CLIENTS {
+            return false;
+        }
+        let mut client = Client { last_seen: now, mask: FieldMask::ALL, mtu: None };
+        apply(&mut client);
+        self.clients.insert(addr, client);
+        true
+    }
+
+    /// 清理超时的客户端 (逐个回调 `on_expired`)，并把存活地址及其订阅、数据报上限写入 `alive` (复用缓冲)
+    pub fn sweep(
+        &mut self,
+        now: Instant,
+        alive: &mut Vec<(SocketAddr, FieldMask, Option<u16>)>,
+        mut on_expired: impl FnMut(SocketAddr),
+    ) {
+        let timeout = self.timeout;
+        alive.clear();
+        self.clients.retain(|addr, client| {
+            if now.saturating_duration_since(client.last_seen) < timeout {
+                alive.push((*addr, client.mask, client.mtu));
+                true
+            } else {
+                on_expired(*addr);
+                false
+            }
+        });
+    }
+
+    pub fn len(&self) -> usize {
+        self.clients.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.clients.is_empty()
+    }
+}
+
+/// 在 UDP 接收任务与推送任务之间共享的注册表
+pub type SharedRegistry = Arc<Mutex<ClientRegistry>>;
+
+/// WebSocket 广播: 每帧广播一次全部编码，各连接按自己的订阅和传输格式取出对应的一份
+pub struct WsHub {
+    tx: broadcast::Sender<Arc<Frame>>,
+    /// JSON/deflate 连接的订阅 → 连接数
+    subscriptions: Mutex<HashMap<FieldMask, usize>>,
+    /// 二进制格式连接的订阅 → 连接数 (每个不同的订阅每帧编码一份二进制帧)
+    binary: Mutex<HashMap<FieldMask, usize>>,
+}
+
+impl WsHub {
+    pub fn new(capacity: usize) -> Arc<Self> {
+        let (tx, _rx) = broadcast::channel(capacity);
+        Arc::new(Self {
+            tx,
+            subscriptions: Mutex::new(HashMap::new()),
+            binary: Mutex::new(HashMap::new()),
+        })
+    }
+
+    fn counts(&self, format: Format) -> &Mutex<HashMap<FieldMask, usize>> {
+        if format == Format::Binary {
+            &self.binary
+        } else {
+            &self.subscriptions
+        }
+    }
+
+    fn join(&self, mask: FieldMask, format: Format) {
+        *self.counts(format).lock().unwrap().entry(mask).or_insert(0) += 1;
+    }
+
+    fn leave(&self, mask: FieldMask, format: Format) {
+        let mut counts = self.counts(format).lock().unwrap();
+        if let Some(count) = counts.get_mut(&mask) {
+            *count -= 1;
+            if *count == 0 {
+                counts.remove(&mask);
+            }
+        }
+    }
+
+    /// 把当前 JSON/deflate 连接 (`Format::Json`) 或二进制连接 (`Format::Binary`) 的订阅 (去重) 追加到 `out`
+    fn masks(&self, format: Format, out: &mut Vec<FieldMask>) {
+        for mask in self.counts(format).lock().unwrap().keys() {
+            if !out.contains(mask) {
+                out.push(*mask);
+            }
+        }
+    }
+}
+
+/// 每帧扇出
+pub struct Fanout {
+    ws: Arc<WsHub>,
+    udp: Arc<UdpSocket>,
+    clients: SharedRegistry,
+    /// 本帧存活的 UDP 客户端及其订阅、数据报上限 (复用缓冲)
+    addrs: Vec<(SocketAddr, FieldMask, Option<u16>)>,
+    /// 本帧需要编码的不同订阅 (复用缓冲)
+    masks: Vec<FieldMask>,
+    /// 本帧需要编码二进制帧的不同订阅 (复用缓冲)
+    binary_masks: Vec<FieldMask>,
+    /// 超过客户端数据报上限的消息拆分后的数据报 (复用缓冲)
+    packer: Packer,
+    /// 下一帧的序号
+    seq: u64,
+}
+
+impl Fanout {
+    pub fn new(ws: Arc<WsHub>, udp: Arc<UdpSocket>, clients: SharedRegistry) -> Self {
+        Self {
+            ws,
+            udp,
+            clients,
+            addrs: Vec::new(),
+            masks: Vec::new(),
+            binary_masks: Vec::new(),
+            packer: Packer::default(),
+            seq: 0,
+        }
+    }
+
+    /// 推送一帧: 采样、按每个不同的订阅各编码一次、通过 WebSocket 广播并发送给所有已注册的 3DS 客户端
+    pub async fn tick(&mut self, backend: &mut dyn Backend) -> serde_json::Result<()> {
+        let started = Instant::now();
+        let mut metrics = backend.refresh();
+        STATS.refresh_seconds.observe_since(started);
+        metrics.seq = self.seq;
+        self.seq += 1;
+
+        self.sweep();
+        self.masks.clear();
+        for (_, mask, _) in &self.addrs {
+            if !self.masks.contains(mask) {
+                self.masks.push(*mask);
+            }
+        }
+        self.ws.masks(Format::Json, &mut self.masks);
+        STATS.subscriptions.set(self.masks.len() as i64);
+
+        let mut frame = Frame::default();
+        for mask in &self.masks {
+            let encode_started = Instant::now();
+            let json = subscription::encode(&metrics, *mask)?;
+            STATS.serialize_seconds.observe_since(encode_started);
+            STATS.serialize_bytes.observe(json.len() as u64);
+            frame.push(*mask, json);
+        }
+        STATS.encodings.add(self.masks.len() as u64);
+        self.binary_masks.clear();
+        self.ws.masks(Format::Binary, &mut self.binary_masks);
+        for mask in &self.binary_masks {
+            let encode_started = Instant::now();
+            let mut bytes = Vec::new();
+            wire::encode_binary(&metrics, *mask, &mut bytes);
+            STATS.serialize_seconds.observe_since(encode_started);
+            STATS.serialize_bytes.observe(bytes.len() as u64);
+            frame.push_binary(*mask, bytes);
+        }
+        STATS.encodings.add(self.binary_masks.len() as u64);
+        if !self.binary_masks.is_empty() && !metrics.alerts.is_empty() {
+            frame.set_alerts(serde_json::json!({ "type": "alerts", "alerts": metrics.alerts }).to_string());
+        }
+
+        self.deliver(&[Arc::new(frame)]).await;
+        Ok(())
+    }
+
+    /// 扇出一批已编码的完整消息 (中继模式): 所有客户端不论订阅都收到原样消息
+    pub async fn publish(&mut self, frames: &[String]) {
+        let frames: Vec<Arc<Frame>> = frames.iter().map(|json| Arc::new(Frame::shared(json.clone()))).collect();
+        self.sweep();
+        self.deliver(&frames).await;
+    }
+
+    /// 清理超时的客户端，刷新本帧的存活列表
+    fn sweep(&mut self) {
+        let mut clients = self.clients.lock().unwrap();
+        clients.sweep(Instant::now(), &mut self.addrs, |addr| println!("⏰ 3DS 客户端超时: {}", addr));
+        STATS.udp_clients.set(clients.len() as i64);
+    }
+
+    /// 逐帧通过 WebSocket 广播，并逐帧把各客户端订阅的那份编码发给所有已注册的 3DS 客户端
+    /// (超过客户端数据报上限的按字段拆成多个数据报，见 [`crate::datagram`])
+    async fn deliver(&mut self, frames: &[Arc<Frame>]) {
+        let fanout_started = Instant::now();
+        // 通过 WebSocket 广播 (没有订阅者时返回错误，忽略)
+        for frame in frames {
+            let _ = self.ws.tx.send(frame.clone());
+        }
+
+        self.packer.clear();
+        for (addr, mask, mtu) in &self.addrs {
+            for (i, frame) in frames.iter().enumerate() {
+                let Some(json) = frame.get(*mask) else { continue };
+                let mtu = match *mtu {
+                    Some(mtu) if json.len() > usize::from(mtu) => mtu,
+                    _ => {
+                        send(&self.udp, json.as_bytes(), addr).await;
+                        continue;
+                    }
+                };
+                // 无法按客户端上限打包的消息整条丢弃 (超过上限的数据报会被客户端截断)
+                let Some(datagrams) = self.packer.pack(i, *mask, mtu, json) else { continue };
+                STATS.udp_split_frames.inc();
+                for datagram in datagrams {
+                    send(&self.udp, datagram, addr).await;
+                }
+            }
+        }
+        STATS.fanout_seconds.observe_since(fanout_started);
+        STATS.frames.add(frames.len() as u64);
+    }
+}
+
+async fn send(udp: &UdpSocket, bytes: &[u8], addr: &SocketAddr) {
+    match udp.send_to(bytes, addr).await {
+        Ok(sent) => STATS.udp_sent_bytes.add(sent as u64),
+        Err(_) => STATS.udp_send_errors.inc(),
+    }
+}
+
+/// 处理 3DS 的 `PING <客户端毫秒>`，返回 `PONG <客户端毫秒> <服务端毫秒>`
+///
+/// 客户端据往返时间估计两端时钟偏移，再结合帧内的 `sample_ms` 计算端到端延迟。
+/// 不带时间戳的旧版 PING 只作心跳，不回复
+pub fn pong(msg: &str, now: Instant) -> Option<String> {
+    let client_ms: u64 = msg.strip_prefix("PING")?.trim().parse().ok()?;
+    Some(format!("PONG {} {}", client_ms, collector::millis(now)))
+}
+
+/// 处理单个 WebSocket 连接
+///
+/// `intro` 在订阅广播之后调用，返回的消息紧跟欢迎消息发送 (中继模式用来补发各主机的静态信息)。
+/// 客户端发送 `{"subscribe":[...]}` 更新字段订阅 (之前默认订阅全部字段)，
+/// 发送 `{"format":"json"|"binary"|"deflate"}` 切换传输格式 (见 [`crate::wire`])
+pub async fn serve_ws<S: AsyncRead + AsyncWrite + Unpin>(
+    stream: S,
+    peer: SocketAddr,
+    hub: Arc<WsHub>,
+    intro: impl FnOnce() -> Vec<String>,
+) {
+    let mut config = WebSocketConfig::default();
+    config.max_message_size = Some(WS_MAX_MESSAGE);
+    config.max_frame_size = Some(WS_MAX_MESSAGE);
+    config.max_write_buffer_size = WS_MAX_WRITE_BUFFER;
+    let ws_stream = match accept_async_with_config(stream, Some(config)).await {
+        Ok(ws) => ws,
+        Err(e) => {
+            eprintln!("❌ WebSocket 握手失败 {}: {}", peer, e);
+            return;
+        }
+    };
+
+    let (mut ws_sender, mut ws_receiver) = ws_stream.split();
+    let mut rx = hub.tx.subscribe();
+    let mut mask = FieldMask::ALL;
+    let mut format = Format::Json;
+    let mut deflater = Deflater::new();
+    hub.join(mask, format);
+    STATS.ws_clients.inc();
+
+    // 发送欢迎消息
+    let welcome = serde_json::json!({
+        "type": "connected",
+        "message": "欢迎连接到 3D 全息仪表盘"
+    });
+    let _ = ws_sender.send(Message::Text(welcome.to_string().into())).await;
+    for msg in intro() {
+        let _ = ws_sender.send(Message::Text(msg.into())).await;
+    }
+
+    // 同时处理：接收客户端消息 & 推送监控数据
+    loop {
+        tokio::select! {
+            // 接收广播的监控数据并发送给客户端
+            result = rx.recv() => {
+                match result {
+                    Ok(frame) => {
+                        // 中继转发的帧没有二进制编码，二进制连接收到原样 JSON
+                        let message = if let Some(bytes) = frame.binary(mask).filter(|_| format == Format::Binary) {
+                            Message::Binary(bytes.to_vec())
+                        } else {
+                            let Some(json) = frame.get(mask) else { continue };
+                            if format == Format::Deflate {
+                                let started = Instant::now();
+                                let mut deflated = Vec::new();
+                                deflater.compress(json, &mut deflated);
+                                STATS.ws_deflate_seconds.observe_since(started);
+                                Message::Binary(deflated)
+                            } else {
+                                Message::Text(json.into())
+                            }
+                        };
+                        let binary = matches!(message, Message::Binary(_)) && format == Format::Binary;
+                        STATS.ws_sent_bytes.add(message.len() as u64);
+                        if ws_sender.send(message).await.is_err() {
+                            STATS.ws_dropped.inc();
+                            break;
+                        }
+                        // 二进制帧不含告警，订阅了告警的连接另收一条文本消息
+                        if let Some(alerts) = frame.alerts().filter(|_| binary && mask.contains(subscription::ALERTS)) {
+                            STATS.ws_sent_bytes.add(alerts.len() as u64);
+                            if ws_sender.send(Message::Text(alerts.into())).await.is_err() {
+                                STATS.ws_dropped.inc();
+                                break;
+                            }
+                        }
+                    }
+                    // 客户端跟不上广播，跳过了 n 帧
+                    Err(broadcast::error::RecvError::Lagged(n)) => STATS.ws_lagged_frames.add(n),
+                    Err(_) => continue,
+                }
+            }
+            // 接收客户端消息 (字段订阅、传输格式，以及检测断开)
+            msg = ws_receiver.next() => {
+                match msg {
+                    Some(Ok(Message::Close(_))) | None => break,
+                    Some(Err(_)) => break,
+                    Some(Ok(Message::Text(text))) => {
+                        let Some((new_mask, new_format)) = parse_control(&text) else { continue };
+                        hub.leave(mask, format);
+                        mask = new_mask.unwrap_or(mask);
+                        hub.join(mask, new_format.unwrap_or(format));
+                        if let Some(new_format) = new_format {
+                            format = new_format;
+                            if format == Format::Deflate {
+                                // 客户端每次切换都新建解压流，压缩上下文随之重置
+                                deflater = Deflater::new();
+                            }
+                            let ack = serde_json::json!({ "type": "format", "format": format.name() });
+                            if ws_sender.send(Message::Text(ack.to_string().into())).await.is_err() {
+                                break;
+                            }
+                        }
+                    }
+                    _ => {}
+                }
+            }
+        }
+    }
+
+    hub.leave(mask, format);
+    STATS.ws_clients.dec();
+    println!("🔌 WebSocket 断开: {}", peer);
+}
+
+/// 解析 WebSocket 客户端的控制消息 `{"subscribe":["cpu", ...], "format":"binary"}` (两项都可省略)
+fn parse_control(text: &str) -> Option<(Option<FieldMask>, Option<Format>)> {
+    let value: serde_json::Value = serde_json::from_str(text).ok()?;
+    let mask = value
+        .get("subscribe")
+        .and_then(|names| names.as_array())
+        .map(|names| FieldMask::from_names(names.iter().filter_map(|name| name.as_str())));
+    let format = value.get("format").and_then(|name| name.as_str()).and_then(Format::parse);
+    Some((mask, format))
+}
@@ -0,0 +1,25 @@
+//! 3D 全息仪表盘服务端库
+//!
+//! 采集模块以库的形式导出，供服务端二进制和基准测试共用
+
+pub mod alerts;
+pub mod cgroups;
+pub mod collector;
+pub mod datagram;
+pub mod fanctl;
+pub mod fanout;
+pub mod monitor;
+pub mod packed;
+#[cfg(unix)]
+pub mod procfs;
+pub mod procs;
+pub mod relay;
+#[cfg(unix)]
+pub mod shm;
+pub mod stats;
+pub mod streamstats;
+pub mod subscription;
+pub mod synthetic;
+pub mod throughput;
+pub mod web;
+pub mod wire;
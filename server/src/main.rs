@@ -1,60 +1,194 @@
 //! 3D 全息仪表盘服务端
 //!
 //! 采集系统信息并通过 WebSocket 和 UDP 实时推送给客户端
-//! - WebSocket (端口 9000): 用于 Web 仪表盘
-//! - UDP (端口 9001): 用于 3DS 客户端 (自动发现)
-
-mod monitor;
+//! - WebSocket (端口 9000): 用于 Web 仪表盘；同一端口以 HTTP 提供内嵌的网页 (见 [`web`])
+//! - UDP (端口 9001): 用于 3DS 客户端 (自动发现)；超过客户端 `MTU` 的帧按字段拆成多个数据报 (见 [`datagram`])
+//!
+//! `--lean` 低占用模式: 单线程运行时，只启动推送需要的采集器 (见 [`MonitorOptions::lean`])。
+//! 各模式的常驻内存与空闲 CPU 见 readMe 与 `benches/footprint.rs`
+//!
+//! 风扇模式由常驻的 `temp_sensor --control` 辅助进程执行，CUSTOM 模式按 `--fan-curve` 曲线闭环调速 (见 [`fanctl`])
 
-use futures_util::{SinkExt, StreamExt};
-use monitor::Monitor;
+use holographic_monitor::{
+    alerts::{self, AlertBackend, AlertEngine},
+    cgroups::{self, CgroupSelection},
+    datagram,
+    fanctl::{self, FanControlBackend, FanHelper},
+    fanout::{self, ClientRegistry, Fanout, SharedRegistry, WsHub},
+    monitor::{Backend, Monitor, MonitorOptions},
+    relay::{self, Relay},
+    stats::{self, STATS},
+    subscription::FieldMask,
+    synthetic::SyntheticBackend,
+    web,
+};
+#[cfg(unix)]
+use holographic_monitor::shm;
 use std::{
-    collections::HashMap,
     net::SocketAddr,
     sync::{Arc, Mutex},
     time::{Duration, Instant},
 };
 use tokio::{
-    net::{TcpListener, TcpStream, UdpSocket},
-    sync::broadcast,
-    time::interval,
+    net::{TcpListener, UdpSocket},
+    runtime,
+    sync::Semaphore,
+    time::{interval, MissedTickBehavior},
 };
-use tokio_tungstenite::{accept_async, tungstenite::Message};
 
-/// WebSocket 服务端口
+/// WebSocket 与网页服务端口 (可用 --ws-port=N 覆盖)
 const WS_PORT: u16 = 9000;
-/// UDP 服务端口 (接收 3DS 心跳，发送数据)
+/// UDP 服务端口 (接收 3DS 心跳，发送数据；可用 --udp-port=N 覆盖)
 const UDP_PORT: u16 = 9001;
-/// 数据推送间隔 (毫秒)
+/// 自身性能指标端口 (Prometheus 文本格式，仅监听本机；可用 --metrics-port=N 覆盖)
+const METRICS_PORT: u16 = 9002;
+/// 默认数据推送间隔 (毫秒)，可用 --push-interval-ms=N 覆盖
 const PUSH_INTERVAL_MS: u64 = 100;
 /// 3DS 客户端超时时间 (秒)
 const CLIENT_TIMEOUT_SECS: u64 = 10;
+/// 同时服务的 TCP 连接上限 (WebSocket 与网页请求共用，超出时新连接直接关闭)
+const MAX_WS_CONNECTIONS: usize = 32;
+/// 首帧推送耗时预算 (毫秒)，超出时打印警告 (benches/startup.rs 按同一预算断言)
+const FIRST_FRAME_BUDGET_MS: u128 = 400;
+/// 进程采样间隔 (毫秒)，仅在 --processes 时启用
+const PROCESS_SAMPLE_INTERVAL_MS: u64 = 2000;
+/// 进程榜单条目数
+const PROCESS_TOP_K: usize = 5;
+/// 磁盘/网络吞吐采样间隔 (毫秒)，可用 --io-interval-ms=N 覆盖
+const IO_SAMPLE_INTERVAL_MS: u64 = 1000;
+/// 吞吐榜单设备数
+const IO_TOP_N: usize = 3;
+/// cgroup 与 PSI 采样间隔 (毫秒)，仅在 --cgroups 时启用
+const CGROUP_SAMPLE_INTERVAL_MS: u64 = 2000;
+/// cgroup 榜单条目数
+const CGROUP_TOP_N: usize = 5;
+/// 共享内存指标段的默认名称 (--shm 未指定名称时)
+const SHM_NAME: &str = "/holographic-monitor";
+
+/// 读取 `--name=value` 形式的命令行参数
+fn flag_value<T: std::str::FromStr>(name: &str) -> Option<T> {
+    let prefix = format!("{}=", name);
+    std::env::args().find_map(|arg| arg.strip_prefix(&prefix).and_then(|v| v.parse().ok()))
+}
 
-/// 已注册的 3DS 客户端
-type ClientMap = Arc<Mutex<HashMap<SocketAddr, Instant>>>;
+/// 记录推送节拍的抖动与被跳过的节拍数
+fn observe_tick(deadline: tokio::time::Instant, period: Duration) {
+    let jitter = deadline.elapsed();
+    STATS.tick_jitter_seconds.observe_duration(jitter);
+    if jitter >= period {
+        STATS.ticks_skipped.add((jitter.as_nanos() / period.as_nanos()) as u64);
+    }
+}
+
+fn main() -> Result<(), Box<dyn std::error::Error>> {
+    // --lean: 低占用模式，单线程运行时 (推送、UDP 与 WebSocket 都是轻量任务，一个线程足够)
+    let lean = std::env::args().any(|arg| arg == "--lean");
+    let mut builder = if lean {
+        runtime::Builder::new_current_thread()
+    } else {
+        runtime::Builder::new_multi_thread()
+    };
+    builder.enable_all().build()?.block_on(run(lean))
+}
 
-#[tokio::main]
-async fn main() -> Result<(), Box<dyn std::error::Error>> {
+async fn run(lean: bool) -> Result<(), Box<dyn std::error::Error>> {
+    let started = Instant::now();
     println!("🚀 3D 全息仪表盘服务端启动中...");
+    if lean {
+        println!("🪶 低占用模式: 单线程运行时，只启动必要的采集器");
+    }
+
+    // --synthetic: 使用合成数据后端 (无需真实传感器)
+    let synthetic = std::env::args().any(|arg| arg == "--synthetic");
+    // --processes: 启用进程 Top-K 采样
+    let processes = std::env::args().any(|arg| arg == "--processes");
+    // --cgroups[=N|路径,...]: 启用 cgroup v2 与 PSI 采集 (默认根之下 2 层；N 为层数，或逗号分隔的组路径)
+    let cgroup_selection = flag_value::<CgroupSelection>("--cgroups").or_else(|| {
+        std::env::args()
+            .any(|arg| arg == "--cgroups")
+            .then_some(CgroupSelection::Depth(cgroups::DEFAULT_DEPTH))
+    });
+    // cgroup 采集为每个组持久打开多个文件: 启动时一次性提高文件描述符软上限 (之后启动的子进程继承)
+    #[cfg(unix)]
+    if cgroup_selection.is_some() {
+        if let Some((from, to)) = cgroups::raise_fd_limit() {
+            println!("📈 文件描述符软上限 {} → {} (cgroup 文件预算 {})", from, to, cgroups::fd_budget());
+        }
+    }
+    // --push-interval-ms=N: 推送间隔。3DS 会在样本之间插值，降到 250-500ms 仍然流畅，
+    // 可节省 Wi-Fi 流量和掌机电量
+    let push_interval_ms = flag_value::<u64>("--push-interval-ms")
+        .filter(|ms| *ms > 0)
+        .unwrap_or(PUSH_INTERVAL_MS);
+    // --io-interval-ms=N: 磁盘/网络吞吐采样间隔
+    let io_interval_ms = flag_value::<u64>("--io-interval-ms")
+        .filter(|ms| *ms > 0)
+        .unwrap_or(IO_SAMPLE_INTERVAL_MS);
+    let ws_port = flag_value::<u16>("--ws-port").unwrap_or(WS_PORT);
+    let udp_port = flag_value::<u16>("--udp-port").unwrap_or(UDP_PORT);
+    let metrics_port = flag_value::<u16>("--metrics-port").unwrap_or(METRICS_PORT);
+    // --shm[=/name]: 创建共享内存段，接收外部进程发布的指标 (仅 Unix)
+    let shm_name = flag_value::<String>("--shm")
+        .or_else(|| std::env::args().any(|arg| arg == "--shm").then(|| SHM_NAME.to_string()));
+    // --alerts=rules.json: 告警规则 (默认使用内置规则)；--no-alerts: 关闭告警引擎
+    let alert_rules = if std::env::args().any(|arg| arg == "--no-alerts") {
+        None
+    } else {
+        match flag_value::<String>("--alerts") {
+            Some(path) => match std::fs::read_to_string(&path).map_err(|e| e.to_string()).and_then(|json| alerts::parse_rules(&json)) {
+                Ok(rules) => Some(rules),
+                Err(e) => {
+                    println!("⚠️  告警规则 {} 加载失败，使用内置规则: {}", path, e);
+                    Some(alerts::default_rules())
+                }
+            },
+            None => Some(alerts::default_rules()),
+        }
+    };
+    // --fan-helper="<命令> <参数>...": 风扇控制辅助进程 (默认以 sudo 运行找到的 temp_sensor --control)；
+    // --fan-curve=curve.json: CUSTOM 模式的温度→转速曲线 (默认使用内置曲线)
+    let fan_curve = match flag_value::<String>("--fan-curve") {
+        Some(path) => std::fs::read_to_string(&path)
+            .map_err(|e| e.to_string())
+            .and_then(|json| fanctl::parse_curve(&json))
+            .unwrap_or_else(|e| {
+                println!("⚠️  风扇曲线 {} 加载失败，使用内置曲线: {}", path, e);
+                fanctl::default_curve()
+            }),
+        None => fanctl::default_curve(),
+    };
+    let fan_helper = flag_value::<String>("--fan-helper")
+        .map(|command| command.split_whitespace().map(String::from).collect())
+        .or_else(fanctl::locate_helper)
+        .map(|command| Arc::new(FanHelper::new(command, fan_curve)));
+    // --relay=host[:port],...: 中继模式，订阅多个上游服务端并合并转发 (不采集本机)
+    let relay = match flag_value::<String>("--relay") {
+        Some(list) => Some(Relay::new(relay::resolve(&list, UDP_PORT).await?)),
+        None => None,
+    };
 
     // 创建广播通道，用于向所有 WebSocket 客户端推送数据
-    let (tx, _rx) = broadcast::channel::<String>(16);
-    let tx = Arc::new(tx);
+    // (中继模式每个推送周期每台主机一条消息，容量随上游数量放大)
+    let capacity = relay.as_ref().map_or(16, |relay| 16.max(relay.upstreams().len() * 4));
+    let hub = WsHub::new(capacity);
 
     // 创建 UDP socket (绑定固定端口，接收 3DS 心跳)
-    let udp_socket = Arc::new(UdpSocket::bind(format!("0.0.0.0:{}", UDP_PORT)).await?);
+    let udp_socket = Arc::new(UdpSocket::bind(format!("0.0.0.0:{}", udp_port)).await?);
     
     // 已注册的 3DS 客户端列表
-    let clients: ClientMap = Arc::new(Mutex::new(HashMap::new()));
+    let clients: SharedRegistry = Arc::new(Mutex::new(ClientRegistry::new(Duration::from_secs(CLIENT_TIMEOUT_SECS))));
 
     // 启动 UDP 接收任务 (接收 3DS 心跳和发现请求)
     let recv_socket = udp_socket.clone();
     let recv_clients = clients.clone();
+    let recv_relay = relay.clone();
+    let recv_fan = fan_helper.clone();
     tokio::spawn(async move {
-        let mut buf = [0u8; 64];
+        let mut buf = [0u8; 512];
         loop {
             if let Ok((len, addr)) = recv_socket.recv_from(&mut buf).await {
                 let msg = String::from_utf8_lossy(&buf[..len]);
+                let mut is_new = false;
                 
                 if msg.starts_with("DISCOVER") {
                     // 3DS 发送发现请求，回复 SERVER
@@ -62,189 +196,222 @@ async fn main() -> Result<(), Box<dyn std::error::Error>> {
                     let _ = recv_socket.send_to(b"SERVER", addr).await;
                     
                     // 同时注册为客户端
-                    let mut map = recv_clients.lock().unwrap();
-                    map.insert(addr, Instant::now());
+                    is_new = recv_clients.lock().unwrap().touch(addr, Instant::now());
                 }
                 else if msg.starts_with("HELLO") || msg.starts_with("PING") {
-                    let mut map = recv_clients.lock().unwrap();
-                    let is_new = !map.contains_key(&addr);
-                    map.insert(addr, Instant::now());
+                    let now = Instant::now();
+                    // 尽快回复 PONG，减少服务端处理时间对往返时间的影响
+                    if let Some(reply) = fanout::pong(&msg, now) {
+                        let _ = recv_socket.send_to(reply.as_bytes(), addr).await;
+                    }
+                    is_new = recv_clients.lock().unwrap().touch(addr, now);
                     if is_new {
                         println!("🎮 新 3DS 客户端: {}", addr);
                     }
                 }
+                else if let Some(list) = msg.strip_prefix("SUB") {
+                    // 字段订阅: SUB <字段或字段组>,...
+                    is_new = recv_clients.lock().unwrap().subscribe(addr, FieldMask::parse(list), Instant::now());
+                }
+                else if let Some(mtu) = msg.strip_prefix("MTU ").and_then(datagram::parse_mtu) {
+                    // 数据报上限: MTU <字节数>，超过的帧按字段拆成多个数据报
+                    is_new = recv_clients.lock().unwrap().set_mtu(addr, mtu, Instant::now());
+                }
                 else if msg.starts_with("FAN:") {
                     // 处理风扇控制命令
                     let mode = msg.trim_start_matches("FAN:").trim().to_lowercase();
-                    println!("🌀 收到风扇控制命令: {} (来自 {})", mode, addr);
-                    
-                    // 查找 temp_sensor 路径并执行
-                    let mut possible_paths = vec![
-                        "temp-sensor/temp_sensor".to_string(),
-                        "../temp-sensor/temp_sensor".to_string(),
-                        "server/temp-sensor/temp_sensor".to_string(),
-                    ];
-
-                    // 增加对当前目录下二进制文件的支持 (用于打包后运行)
-                    if let Ok(exe_path) = std::env::current_exe() {
-                        if let Some(parent) = exe_path.parent() {
-                            possible_paths.push(parent.join("temp_sensor").to_string_lossy().to_string());
-                        }
-                    }
-                    
-                    let mut executed = false;
-                    for path in possible_paths {
-                        if std::path::Path::new(&path).exists() {
-                            let output = std::process::Command::new("sudo")
-                                .args([&path, "-s", &mode])
-                                .output();
-                            
-                            match output {
-                                Ok(out) => {
-                                    let stdout = String::from_utf8_lossy(&out.stdout);
-                                    let stderr = String::from_utf8_lossy(&out.stderr);
-                                    if out.status.success() {
+                    println!("🌀 收到风扇控制命令: {:?} (来自 {})", mode, addr);
+                    let fan_started = Instant::now();
+                    // 只接受已知模式: 命令原样转给 root 辅助进程，局域网内任何人都能发送
+                    let known = fanctl::MODES.contains(&mode.as_str());
+
+                    // 由常驻辅助进程切换模式 (首次命令时启动并下发曲线，可能要等很久)。
+                    // 在独立任务中等待确认后再回复，接收循环继续处理其他客户端的心跳
+                    let fan_socket = recv_socket.clone();
+                    let fan = recv_fan.clone();
+                    tokio::spawn(async move {
+                        let reply = match fan {
+                            _ if !known => {
+                                println!("❌ 未知风扇模式: {:?}", mode);
+                                "FAN_ERR:unknown mode".to_string()
+                            }
+                            Some(helper) => {
+                                let helper_mode = mode.clone();
+                                match tokio::task::spawn_blocking(move || helper.set_mode(&helper_mode)).await {
+                                    Ok(Ok(())) => {
                                         println!("✅ 风扇模式已设置: {}", mode);
-                                        println!("{}", stdout);
-                                        let _ = recv_socket.send_to(format!("FAN_OK:{}", mode).as_bytes(), addr).await;
-                                    } else {
-                                        println!("❌ 设置失败: {}", stderr);
-                                        let _ = recv_socket.send_to(format!("FAN_ERR:{}", stderr).as_bytes(), addr).await;
+                                        format!("FAN_OK:{}", mode)
                                     }
-                                    executed = true;
-                                    break;
-                                }
-                                Err(e) => {
-                                    println!("❌ 执行失败: {}", e);
+                                    Ok(Err(e)) => {
+                                        println!("❌ 设置失败: {}", e);
+                                        format!("FAN_ERR:{}", e)
+                                    }
+                                    Err(e) => format!("FAN_ERR:{}", e),
                                 }
                             }
-                        }
-                    }
-                    
-                    if !executed {
-                        println!("❌ 未找到 temp_sensor 工具");
-                        let _ = recv_socket.send_to(b"FAN_ERR:temp_sensor not found", addr).await;
-                    }
+                            None => {
+                                println!("❌ 未找到 temp_sensor 工具");
+                                "FAN_ERR:temp_sensor not found".to_string()
+                            }
+                        };
+                        let _ = fan_socket.send_to(reply.as_bytes(), addr).await;
+                        STATS.fan_command_seconds.observe_since(fan_started);
+                    });
                     
                     // 更新客户端心跳
-                    let mut map = recv_clients.lock().unwrap();
-                    map.insert(addr, Instant::now());
+                    is_new = recv_clients.lock().unwrap().touch(addr, Instant::now());
+                }
+                
+                // 中继模式: 给新客户端补发各主机的静态信息
+                if let (true, Some(relay)) = (is_new, recv_relay.as_ref()) {
+                    for msg in relay.intro() {
+                        let _ = recv_socket.send_to(msg.as_bytes(), addr).await;
+                    }
                 }
             }
         }
     });
 
     // 启动系统监控线程
-    let monitor_tx = tx.clone();
+    let monitor_hub = hub.clone();
     let monitor_udp = udp_socket.clone();
     let monitor_clients = clients.clone();
-    tokio::spawn(async move {
-        let monitor = Arc::new(Mutex::new(Monitor::new()));
-        let mut tick = interval(Duration::from_millis(PUSH_INTERVAL_MS));
+    let period = Duration::from_millis(push_interval_ms);
+    if let Some(relay) = relay.clone() {
+        // 中继模式: 各上游由独立任务订阅，这里每个周期转发一次合并后的消息
+        println!("🛰️  中继模式: 订阅 {} 个上游服务端", relay.upstreams().len());
+        relay.spawn_upstreams();
+        tokio::spawn(async move {
+            let mut tick = interval(period);
+            tick.set_missed_tick_behavior(MissedTickBehavior::Skip);
+            let mut fanout = Fanout::new(monitor_hub, monitor_udp, monitor_clients);
+            let mut frames = Vec::new();
+            loop {
+                observe_tick(tick.tick().await, period);
+                relay.drain(&mut frames);
+                if !frames.is_empty() {
+                    fanout.publish(&frames).await;
+                }
+            }
+        });
+    } else {
+        tokio::spawn(async move {
+            let mut backend: Box<dyn Backend> = if synthetic {
+                println!("🧪 使用合成数据后端");
+                Box::new(SyntheticBackend::default())
+            } else {
+                // 低占用模式不采集磁盘/网络吞吐 (Web 与 3DS 客户端都不显示)
+                let mut monitor = if lean {
+                    Monitor::with_options(MonitorOptions::lean(period))
+                } else {
+                    let mut monitor = Monitor::new();
+                    monitor.enable_io_sampler(Duration::from_millis(io_interval_ms), IO_TOP_N);
+                    monitor
+                };
+                if processes {
+                    monitor.enable_process_sampler(Duration::from_millis(PROCESS_SAMPLE_INTERVAL_MS), PROCESS_TOP_K);
+                }
+                if let Some(selection) = cgroup_selection {
+                    monitor.enable_cgroup_sampler(Duration::from_millis(CGROUP_SAMPLE_INTERVAL_MS), selection, CGROUP_TOP_N);
+                }
+                Box::new(monitor)
+            };
+            #[cfg(unix)]
+            if let Some(name) = &shm_name {
+                match shm::Reader::create(name, shm::DEFAULT_SLOTS) {
+                    Ok(reader) => {
+                        println!("📥 共享内存指标通道: {} ({} 个槽位)", name, reader.slot_count());
+                        backend = Box::new(shm::GaugeBackend::new(backend, reader));
+                    }
+                    Err(e) => println!("⚠️  共享内存段 {} 创建失败，已忽略: {}", name, e),
+                }
+            }
+            #[cfg(not(unix))]
+            if shm_name.is_some() {
+                println!("⚠️  --shm 仅支持 Unix 平台，已忽略");
+            }
+            if let Some(helper) = &fan_helper {
+                backend = Box::new(FanControlBackend::new(backend, helper));
+            }
+            if let Some(rules) = &alert_rules {
+                match AlertEngine::new(rules, period) {
+                    Ok(engine) => {
+                        println!("🚨 告警引擎: {} 条规则 ({} 个信号)", engine.rule_count(), engine.signal_count());
+                        backend = Box::new(AlertBackend::new(backend, engine));
+                    }
+                    Err(e) => println!("⚠️  告警规则无效，告警引擎未启动: {}", e),
+                }
+            }
 
-        // 首次需要等待一小段时间让 sysinfo 收集初始数据
-        tokio::time::sleep(Duration::from_millis(500)).await;
+            // 只等待 CPU 使用率的最短采样间隔，慢速字段由后台探测稍后补齐
+            tokio::time::sleep(backend.first_sample_delay()).await;
+            let mut tick = interval(period);
+            // 卡顿后跳过错过的节拍并回到原有节奏，不连发补帧
+            tick.set_missed_tick_behavior(MissedTickBehavior::Skip);
+            let mut fanout = Fanout::new(monitor_hub, monitor_udp, monitor_clients);
+            let mut first_frame = true;
 
-        loop {
-            tick.tick().await;
-            
-            let metrics = {
-                let mut m = monitor.lock().unwrap();
-                m.refresh()
-            };
+            loop {
+                observe_tick(tick.tick().await, period);
 
-            if let Ok(json) = serde_json::to_string(&metrics) {
-                // 通过 WebSocket 广播
-                let _ = monitor_tx.send(json.clone());
-                
-                // 发送给所有已注册的 3DS 客户端
-                let addrs: Vec<SocketAddr> = {
-                    let mut map = monitor_clients.lock().unwrap();
-                    let timeout = Duration::from_secs(CLIENT_TIMEOUT_SECS);
-                    // 清理超时的客户端
-                    map.retain(|addr, last_seen| {
-                        let alive = last_seen.elapsed() < timeout;
-                        if !alive {
-                            println!("⏰ 3DS 客户端超时: {}", addr);
+                if fanout.tick(backend.as_mut()).await.is_ok() {
+                    if first_frame {
+                        first_frame = false;
+                        let elapsed_ms = started.elapsed().as_millis();
+                        println!("⏱️  首帧已推送: 启动后 {} ms", elapsed_ms);
+                        if elapsed_ms > FIRST_FRAME_BUDGET_MS {
+                            println!("⚠️  首帧耗时超出预算 ({} ms)", FIRST_FRAME_BUDGET_MS);
                         }
-                        alive
-                    });
-                    map.keys().cloned().collect()
-                };
-                
-                for addr in addrs {
-                    let _ = monitor_udp.send_to(json.as_bytes(), addr).await;
+                    }
                 }
             }
+        });
+    }
+
+    // 启动自身性能指标服务
+    tokio::spawn(async move {
+        if let Err(e) = stats::serve(SocketAddr::from(([127, 0, 0, 1], metrics_port))).await {
+            println!("⚠️  性能指标服务启动失败: {}", e);
         }
     });
 
     // 启动 WebSocket 服务器
-    let addr = SocketAddr::from(([0, 0, 0, 0], WS_PORT));
+    let addr = SocketAddr::from(([0, 0, 0, 0], ws_port));
     let listener = TcpListener::bind(&addr).await?;
     
-    println!("✅ WebSocket 服务已启动: ws://localhost:{}", WS_PORT);
-    println!("✅ UDP 服务已启动: 端口 {} (等待 3DS 连接)", UDP_PORT);
-    println!("📊 数据推送频率: 每 {}ms", PUSH_INTERVAL_MS);
+    println!("✅ WebSocket 服务已启动: ws://localhost:{}", ws_port);
+    println!("✅ 网页仪表盘: http://localhost:{}/ ({} 个内嵌文件)", ws_port, web::ASSETS.len());
+    println!("✅ UDP 服务已启动: 端口 {} (等待 3DS 连接)", udp_port);
+    println!("✅ 性能指标: http://127.0.0.1:{}/metrics", metrics_port);
+    println!("📊 数据推送频率: 每 {}ms", push_interval_ms);
     println!("\n💡 3DS 会自动发送心跳包注册自己\n");
 
-    while let Ok((stream, peer)) = listener.accept().await {
-        println!("🔗 新 WebSocket 连接: {}", peer);
-        let tx = tx.clone();
-        tokio::spawn(handle_connection(stream, peer, tx));
-    }
-
-    Ok(())
-}
-
-/// 处理单个 WebSocket 连接
-async fn handle_connection(
-    stream: TcpStream,
-    peer: SocketAddr,
-    tx: Arc<broadcast::Sender<String>>,
-) {
-    let ws_stream = match accept_async(stream).await {
-        Ok(ws) => ws,
-        Err(e) => {
-            eprintln!("❌ WebSocket 握手失败 {}: {}", peer, e);
-            return;
-        }
-    };
-
-    let (mut ws_sender, mut ws_receiver) = ws_stream.split();
-    let mut rx = tx.subscribe();
-
-    // 发送欢迎消息
-    let welcome = serde_json::json!({
-        "type": "connected",
-        "message": "欢迎连接到 3D 全息仪表盘"
-    });
-    let _ = ws_sender.send(Message::Text(welcome.to_string().into())).await;
-
-    // 同时处理：接收客户端消息 & 推送监控数据
+    let connections = Arc::new(Semaphore::new(MAX_WS_CONNECTIONS));
     loop {
-        tokio::select! {
-            // 接收广播的监控数据并发送给客户端
-            result = rx.recv() => {
-                match result {
-                    Ok(msg) => {
-                        if ws_sender.send(Message::Text(msg.into())).await.is_err() {
-                            break;
-                        }
-                    }
-                    Err(_) => continue,
-                }
+        let (stream, peer) = match listener.accept().await {
+            Ok(accepted) => accepted,
+            Err(e) => {
+                println!("⚠️  WebSocket 端口 accept 失败: {}", e);
+                tokio::time::sleep(stats::ACCEPT_BACKOFF).await;
+                continue;
             }
-            // 接收客户端消息（主要用于检测断开）
-            msg = ws_receiver.next() => {
-                match msg {
-                    Some(Ok(Message::Close(_))) | None => break,
-                    Some(Err(_)) => break,
-                    _ => {}
-                }
+        };
+        let Ok(permit) = connections.clone().try_acquire_owned() else {
+            println!("⚠️  连接数已达上限 ({})，拒绝: {}", MAX_WS_CONNECTIONS, peer);
+            continue;
+        };
+        let hub = hub.clone();
+        let relay = relay.clone();
+        tokio::spawn(async move {
+            // 先按 HTTP 处理网页请求，遇到 WebSocket 升级请求再交给推送逻辑
+            if let Some(stream) = web::serve(stream).await {
+                println!("🔗 新 WebSocket 连接: {}", peer);
+                fanout::serve_ws(stream, peer, hub, move || {
+                    relay.map(|relay| relay.intro()).unwrap_or_default()
+                })
+                .await;
             }
-        }
+            drop(permit);
+        });
     }
-
-    println!("🔌 WebSocket 断开: {}", peer);
 }
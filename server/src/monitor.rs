@@ -1,24 +1,115 @@
 //! 系统信息采集模块
-//! 
+//!
 //! 采集 CPU 使用率、内存使用、CPU 温度、风扇转速等信息
 //! 使用内置的 temp_sensor（IOKit HID API + AppleSMC）获取 Apple Silicon 硬件数据
+//!
+//! 启动时只同步创建 CPU 和内存采集，其余慢速探测 (temp_sensor、温度组件、
+//! libmacchina) 在后台线程并发执行，结果就绪后再填入后续帧
+//!
+//! 各数据源是独立调度的采集器 (见 [`crate::collector`])，各有周期、超时和线程，
+//! 结果写入带采样时间的共享快照；`refresh()` 只读取快照，不等待任何数据源
+//!
+//! 启用哪些采集器由 [`MonitorOptions`] 决定；低占用模式 ([`MonitorOptions::lean`])
+//! 只保留推送需要的采集器，用完的数据源句柄随即释放
 
 use serde::{Deserialize, Serialize};
-use std::path::PathBuf;
-use std::process::Command;
-use sysinfo::{System, Components};
+use std::io::Read;
+use std::path::{Path, PathBuf};
+use std::process::{Command, Stdio};
+use std::sync::mpsc::{self, Receiver};
+use std::sync::{Arc, Weak};
+use std::thread;
+use std::time::{Duration, Instant};
+use sysinfo::{Components, CpuRefreshKind, MemoryRefreshKind, RefreshKind, System};
+#[cfg(target_os = "linux")]
+use crate::procfs::ProcfsCollector;
+use crate::alerts::AlertEvent;
+use crate::cgroups::{self, CgroupReport, CgroupSelection};
+use crate::fanctl::FanControlState;
+use crate::collector::{self, Schedule, Shared, Stamped};
+use crate::packed;
+use crate::procs::{self, ProcessReport};
+use crate::stats::STATS;
+use crate::throughput::{self, IoReport};
 use libmacchina::{
     GeneralReadout, BatteryReadout, KernelReadout,
     traits::{GeneralReadout as _, BatteryReadout as _, KernelReadout as _},
 };
 
+/// 主机核心指标 (CPU/内存/温度/RAPL) 采集周期
+const HOST_PERIOD: Duration = Duration::from_millis(100);
+/// 主机核心指标单次采集上限
+const HOST_TIMEOUT: Duration = Duration::from_secs(1);
+/// 首帧等待首个主机样本的最长时间
+const HOST_FIRST_SAMPLE_WAIT: Duration = Duration::from_millis(250);
+/// temp_sensor 采集周期
+const SENSOR_PERIOD: Duration = Duration::from_secs(1);
+/// temp_sensor 子进程超时，超时后结束子进程
+const SENSOR_TIMEOUT: Duration = Duration::from_secs(2);
+/// 等待子进程退出的轮询间隔
+const SENSOR_POLL: Duration = Duration::from_millis(5);
+/// 电池状态轮询间隔
+const BATTERY_POLL_INTERVAL: Duration = Duration::from_secs(5);
+/// 电池读数单次采集上限
+const BATTERY_TIMEOUT: Duration = Duration::from_secs(1);
+
+/// power_score 与瓦特的换算 (客户端按 power_score / 100000 显示瓦数)
+pub const POWER_SCORE_PER_WATT: f32 = 100_000.0;
+
+/// 采集器选项
+#[derive(Debug, Clone)]
+pub struct MonitorOptions {
+    /// 主机核心指标采集周期
+    pub host_period: Duration,
+    /// 是否查找并轮询 temp_sensor
+    pub temp_sensor: bool,
+    /// 首次读取没有电池时停止电池采集器 (并释放 readout)
+    pub battery_if_present: bool,
+    /// Linux 原生采集器可用时是否仍保留 sysinfo 作为备用 (否则在回退时才创建)
+    pub keep_sysinfo: bool,
+}
+
+impl Default for MonitorOptions {
+    fn default() -> Self {
+        Self {
+            host_period: HOST_PERIOD,
+            temp_sensor: true,
+            battery_if_present: false,
+            keep_sysinfo: true,
+        }
+    }
+}
+
+impl MonitorOptions {
+    /// 低占用模式: 主机指标按推送周期采集 (不快于默认周期)，temp_sensor 只在 macOS 上查找，
+    /// 没有电池时不轮询，原生采集器可用时不保留 sysinfo
+    pub fn lean(push_period: Duration) -> Self {
+        Self {
+            host_period: push_period.max(HOST_PERIOD),
+            temp_sensor: cfg!(target_os = "macos"),
+            battery_if_present: true,
+            keep_sysinfo: false,
+        }
+    }
+}
+
 /// 系统监控数据结构
 #[derive(Debug, Serialize, Clone)]
 pub struct SystemMetrics {
+    /// 帧序号 (由推送循环逐帧递增，客户端据此统计丢包与乱序)
+    pub seq: u64,
+    /// 采样时间 (服务端单调时钟毫秒，见 [`collector::millis`])
+    pub sample_ms: u64,
     /// CPU 使用率 (%)
     pub cpu_usage: f32,
     /// CPU 频率 (MHz)
     pub cpu_frequency_mhz: u64,
+    /// 每核心使用率 (%)，编码为每核 1 字节的十六进制串
+    #[serde(serialize_with = "packed::serialize_percent")]
+    pub core_usage: Vec<f32>,
+    /// 每核心频率 (MHz)，编码为每核 1 字节 (100 MHz 单位) 的十六进制串
+    #[serde(serialize_with = "packed::serialize_freq")]
+    pub core_frequency_mhz: Vec<u64>,
     /// 内存使用率 (%)
     pub memory_usage: f32,
     /// 总内存 (MB)
@@ -35,7 +126,7 @@ pub struct SystemMetrics {
     pub fan_speeds: Vec<f32>,
     /// 估算功耗 (系统负荷分数)
     pub power_score: Option<f32>,
-    
+
     // ===== libmacchina 新增字段 =====
     /// 主机名
     pub hostname: Option<String>,
@@ -55,10 +146,74 @@ pub struct SystemMetrics {
     pub battery_status: Option<String>,
     /// 分辨率
     pub resolution: Option<String>,
+    /// 进程 Top-K (仅在进程采样器产出新报告的那一帧携带)
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub processes: Option<ProcessReport>,
+    /// 磁盘/网络吞吐 (仅在吞吐采样器产出新报告的那一帧携带)
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub io: Option<IoReport>,
+    /// 外部生产者经共享内存发布的指标 (仅在 --shm 且有数据时携带，见 [`crate::shm`])
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub gauges: Vec<ExternalGauge>,
+    /// 告警事件 (仅在有状态变化或定期重发的那一帧携带，见 [`crate::alerts`])
+    #[serde(skip_serializing_if = "Vec::is_empty")]
+    pub alerts: Vec<AlertEvent>,
+    /// 风扇曲线控制器状态 (风扇控制辅助进程运行时携带，见 [`crate::fanctl`])
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub fan_control: Option<FanControlState>,
+    /// cgroup 与 PSI (仅在 cgroup 采样器产出新报告的那一帧携带，见 [`crate::cgroups`])
+    #[serde(skip_serializing_if = "Option::is_none")]
+    pub cgroups: Option<CgroupReport>,
+}
+
+/// 外部生产者发布的一个数值指标
+#[derive(Debug, Serialize, Clone, PartialEq)]
+pub struct ExternalGauge {
+    pub id: u32,
+    pub name: String,
+    pub value: f64,
+}
+
+/// 单次采样的主机核心指标 (sysinfo 路径与原生采集器共用)
+///
+/// 由 `Monitor` 持有并在每次采样时原地覆盖，每核心数组的容量得以复用
+#[derive(Debug, Default, Clone)]
+pub struct HostSample {
+    /// CPU 使用率 (%)
+    pub cpu_usage: f32,
+    /// 平均 CPU 频率 (MHz)
+    pub cpu_frequency_mhz: u64,
+    /// 每核心使用率 (%)
+    pub core_usage: Vec<f32>,
+    /// 每核心频率 (MHz)
+    pub core_frequency_mhz: Vec<u64>,
+    /// 总内存 (MB)
+    pub memory_total: u64,
+    /// 已用内存 (MB)
+    pub memory_used: u64,
+    /// Swap 使用率 (%)
+    pub swap_usage: f32,
+    /// CPU 温度 (°C)
+    pub cpu_temp: Option<f32>,
+    /// 封装功耗 (W)，来自 RAPL 等真实计数器
+    pub package_power_watts: Option<f32>,
+}
+
+/// 采集后端
+///
+/// `Monitor` 采集真实系统；`SyntheticBackend` 生成合成数据，用于测量启动耗时和压测
+pub trait Backend: Send {
+    /// 刷新并获取最新的系统指标
+    fn refresh(&mut self) -> SystemMetrics;
+
+    /// 距离首个有效样本还需等待的时间 (CPU 使用率需要间隔两次采样)
+    fn first_sample_delay(&self) -> Duration {
+        Duration::ZERO
+    }
 }
 
 /// temp_sensor 工具的 JSON 输出格式
-#[derive(Debug, Deserialize)]
+#[derive(Debug, Clone, Deserialize)]
 struct SensorOutput {
     cpu_temp: f32,
     fan_speed: Vec<f32>,
@@ -68,84 +223,449 @@ struct SensorOutput {
     battery_status: Option<String>,
 }
 
+/// 静态系统信息 (启动后只需获取一次)
+#[derive(Debug, Default, Clone)]
+struct StaticInfo {
+    hostname: Option<String>,
+    os_name: Option<String>,
+    kernel_version: Option<String>,
+    cpu_model: Option<String>,
+    cpu_cores: Option<usize>,
+    resolution: Option<String>,
+}
+
+impl StaticInfo {
+    /// 通过 libmacchina 读取静态信息，readout 用完即释放
+    fn probe() -> Self {
+        let general_readout = GeneralReadout::new();
+        let kernel_readout = KernelReadout::new();
+
+        Self {
+            hostname: general_readout.hostname().ok(),
+            os_name: general_readout.os_name().ok(),
+            kernel_version: kernel_readout.os_release().ok(),
+            cpu_model: general_readout.cpu_model_name().ok(),
+            cpu_cores: general_readout.cpu_cores().ok(),
+            resolution: general_readout.resolution().ok(),
+        }
+    }
+}
+
+/// libmacchina 电池读数 (电量, 状态)
+type BatteryReading = (Option<u8>, Option<String>);
+
+/// 各采集器的最新结果，每项带采样时间
+#[derive(Default)]
+struct Snapshot {
+    host: Option<Stamped<HostSample>>,
+    sensor: Option<Stamped<SensorOutput>>,
+    battery: Option<Stamped<BatteryReading>>,
+    static_info: StaticInfo,
+    /// 尚未完成的一次性探测数量
+    pending_probes: usize,
+}
+
+impl Snapshot {
+    /// 记录一项一次性探测完成，全部完成时输出启动耗时
+    fn finish_probe(&mut self, started: Instant) {
+        self.pending_probes -= 1;
+        if self.pending_probes == 0 {
+            println!("⏱️  全部启动探测完成: {} ms", started.elapsed().as_millis());
+        }
+    }
+}
+
+/// 在快照上记录一项探测完成 (快照已释放时忽略)
+fn finish_probe(shared: &Weak<Shared<Snapshot>>, started: Instant) {
+    if let Some(shared) = shared.upgrade() {
+        shared.lock().finish_probe(started);
+    }
+}
+
+/// 主机核心指标采集 (运行在 host 采集器线程上)
+struct HostCollector {
+    /// sysinfo 采集 (原生采集器可用且不保留备用时为 None，回退时再创建)
+    system: Option<System>,
+    /// Linux 原生采集器 (可用时替代 sysinfo 的 CPU/内存/温度路径)
+    #[cfg(target_os = "linux")]
+    native: Option<ProcfsCollector>,
+    /// 跨平台温度组件信息 (后台探测完成前为 None)
+    components: Option<Components>,
+    /// 温度组件探测结果通道 (收到后置为 None)
+    components_rx: Option<Receiver<Components>>,
+}
+
+impl HostCollector {
+    /// 采集主机核心指标到 `host`：Linux 优先使用原生采集器，失败时永久回退到 sysinfo
+    fn sample(&mut self, host: &mut HostSample) {
+        if let Some(components) = self.components_rx.as_ref().and_then(|rx| rx.try_recv().ok()) {
+            self.components = Some(components);
+            self.components_rx = None;
+        }
+
+        #[cfg(target_os = "linux")]
+        if let Some(ref mut native) = self.native {
+            match native.sample_into(host) {
+                Ok(()) => return,
+                Err(e) => {
+                    println!("⚠️  Linux 原生采集失败，回退到 sysinfo: {}", e);
+                    self.native = None;
+                }
+            }
+        }
+        self.sample_sysinfo(host)
+    }
+
+    /// 通过 sysinfo 采集主机核心指标 (跨平台路径)
+    fn sample_sysinfo(&mut self, host: &mut HostSample) {
+        let system = self.system.get_or_insert_with(new_system);
+        // 刷新 CPU、内存和温度信息
+        system.refresh_cpu_usage();
+        system.refresh_memory();
+        if let Some(ref mut components) = self.components {
+            components.refresh();
+        }
+
+        // 每核心使用率与频率
+        host.core_usage.clear();
+        host.core_usage.extend(system.cpus().iter().map(|cpu| cpu.cpu_usage()));
+        host.core_frequency_mhz.clear();
+        host.core_frequency_mhz.extend(system.cpus().iter().map(|cpu| cpu.frequency()));
+
+        // 计算 CPU 平均使用率
+        let cpu_usage = system.cpus().iter()
+            .map(|cpu| cpu.cpu_usage())
+            .sum::<f32>() / system.cpus().len() as f32;
+
+        // 获取 CPU 频率 (取平均值)
+        let cpu_frequency_mhz = system.cpus().iter()
+            .map(|cpu| cpu.frequency())
+            .sum::<u64>() / system.cpus().len() as u64;
+
+        // 计算内存使用
+        let memory_total = system.total_memory() / 1024 / 1024;
+        let memory_used = system.used_memory() / 1024 / 1024;
+
+        // 计算 Swap 使用率
+        let swap_total = system.total_swap();
+        let swap_used = system.used_swap();
+        let swap_usage = if swap_total > 0 {
+            (swap_used as f32 / swap_total as f32) * 100.0
+        } else {
+            0.0
+        };
+
+        // 从 sysinfo::Components 获取温度 (Linux/Windows 兼容)
+        let mut cpu_temp = None;
+        if let Some(components) = self.components.as_ref() {
+            let mut max_temp = 0.0f32;
+            for component in components {
+                let label = component.label().to_lowercase();
+                // 寻找包含 core, package, cpu 等关键词的传感器
+                if label.contains("core") || label.contains("package") || label.contains("cpu") || label.contains("soc") {
+                    let t = component.temperature();
+                    if t > max_temp && t < 150.0 {
+                        max_temp = t;
+                    }
+                }
+            }
+            if max_temp > 0.0 {
+                cpu_temp = Some(max_temp);
+            }
+        }
+
+        host.cpu_usage = cpu_usage;
+        host.cpu_frequency_mhz = cpu_frequency_mhz;
+        host.memory_total = memory_total;
+        host.memory_used = memory_used;
+        host.swap_usage = swap_usage;
+        host.cpu_temp = cpu_temp;
+        host.package_power_watts = None;
+    }
+}
+
+/// 只创建需要的刷新类型，避免 new_all() 枚举全部进程、磁盘和网卡
+fn new_system() -> System {
+    System::new_with_specifics(
+        RefreshKind::new()
+            .with_cpu(CpuRefreshKind::new().with_cpu_usage().with_frequency())
+            .with_memory(MemoryRefreshKind::everything()),
+    )
+}
+
 /// 系统监控器
 pub struct Monitor {
-    system: System,
-    /// 跨平台温度组件信息
-    components: Components,
-    /// 温度传感器路径（如果可用）
-    temp_sensor_path: Option<PathBuf>,
-    /// 缓存的传感器数据
-    cached_sensor_data: Option<SensorOutput>,
-    /// 刷新计数器
-    refresh_counter: u32,
-    /// libmacchina readouts (缓存静态信息)
-    general_readout: GeneralReadout,
-    battery_readout: BatteryReadout,
-    kernel_readout: KernelReadout,
-    /// 缓存的静态系统信息
-    cached_hostname: Option<String>,
-    cached_os_name: Option<String>,
-    cached_kernel_version: Option<String>,
-    cached_cpu_model: Option<String>,
-    cached_cpu_cores: Option<usize>,
-    cached_resolution: Option<String>,
+    /// 各采集器写入的最新值快照
+    shared: Arc<Shared<Snapshot>>,
+    /// CPU 首次采样时间 (计算首个有效 CPU 使用率的等待时间)
+    cpu_primed_at: Instant,
+    /// 首帧是否已等待过首个主机样本 (只等一次，主机采集线程退出后不再每帧等待)
+    host_waited: bool,
+    /// 进程采样器报告通道 (可选)
+    processes: Option<Receiver<ProcessReport>>,
+    /// 吞吐采样器报告通道 (可选)
+    io: Option<Receiver<IoReport>>,
+    /// cgroup 采样器报告通道 (可选)
+    cgroups: Option<Receiver<CgroupReport>>,
 }
 
 impl Monitor {
-    /// 创建新的监控器实例
+    /// 创建新的监控器实例 (默认选项)
     pub fn new() -> Self {
-        // 查找 temp_sensor 可执行文件
-        let temp_sensor_path = Self::find_temp_sensor();
-        
-        if let Some(ref path) = temp_sensor_path {
-            println!("✅ 硬件监控源: temp_sensor ({})", path.display());
-            println!("   (包含: CPU温度, 风扇转速, 功耗估算)");
-        } else {
-            println!("⚠️  未找到 temp_sensor 工具");
-            println!("   请编译: cd server/temp-sensor && clang -framework IOKit -framework Foundation -o temp_sensor temp_sensor.m");
+        Self::with_options(MonitorOptions::default())
+    }
+
+    /// 按 `options` 创建监控器
+    ///
+    /// 只同步初始化 CPU 和内存采集，其他探测在后台并发执行；
+    /// 之后每个数据源由各自的采集器线程按自己的周期刷新
+    pub fn with_options(options: MonitorOptions) -> Self {
+        let started = Instant::now();
+
+        let system = new_system();
+        let cpu_primed_at = Instant::now();
+
+        #[cfg(target_os = "linux")]
+        let native = match ProcfsCollector::open(Path::new("/")) {
+            Ok(collector) => {
+                println!(
+                    "✅ Linux 原生采集: {} 个温度传感器, RAPL {}",
+                    collector.temp_sensor_count(),
+                    if collector.has_rapl() { "可用" } else { "不可用" }
+                );
+                Some(collector)
+            }
+            Err(e) => {
+                println!("⚠️  Linux 原生采集不可用，使用 sysinfo: {}", e);
+                None
+            }
+        };
+        // 原生采集器已筛选 hwmon 传感器，无需再探测 sysinfo 温度组件
+        #[cfg(target_os = "linux")]
+        let need_components = native.is_none();
+        // 原生采集器可用时 sysinfo 只是备用，低占用模式下不保留
+        #[cfg(target_os = "linux")]
+        let system = (native.is_none() || options.keep_sysinfo).then_some(system);
+        #[cfg(not(target_os = "linux"))]
+        let system = Some(system);
+        #[cfg(not(target_os = "linux"))]
+        let need_components = true;
+
+        // 一次性探测: libmacchina 静态信息，以及可选的 temp_sensor 查找和温度组件
+        let shared = Shared::new(Snapshot {
+            pending_probes: 1 + options.temp_sensor as usize + need_components as usize,
+            ..Snapshot::default()
+        });
+        let weak = Arc::downgrade(&shared);
+
+        let components_rx = need_components.then(|| {
+            let (tx, rx) = mpsc::channel();
+            let weak = weak.clone();
+            thread::spawn(move || {
+                let components = Components::new_with_refreshed_list();
+                println!("⏱️  温度组件探测完成: {} 个 [{} ms]", components.list().len(), started.elapsed().as_millis());
+                let _ = tx.send(components);
+                finish_probe(&weak, started);
+            });
+            rx
+        });
+
+        let static_weak = weak.clone();
+        thread::spawn(move || {
+            let info = StaticInfo::probe();
+            println!("✅ libmacchina: 已初始化系统信息采集 [{} ms]", started.elapsed().as_millis());
+            if let Some(ref host) = info.hostname {
+                println!("   主机名: {}", host);
+            }
+            if let Some(ref cpu) = info.cpu_model {
+                println!("   CPU: {}", cpu);
+            }
+            if let Some(shared) = static_weak.upgrade() {
+                let mut state = shared.lock();
+                state.static_info = info;
+                state.finish_probe(started);
+            }
+        });
+
+        let mut host = HostCollector {
+            system,
+            #[cfg(target_os = "linux")]
+            native,
+            components: None,
+            components_rx,
+        };
+        collector::spawn(
+            Schedule {
+                name: "host",
+                period: options.host_period,
+                timeout: HOST_TIMEOUT,
+                // CPU 使用率需要间隔两次采样
+                initial_delay: sysinfo::MINIMUM_CPU_UPDATE_INTERVAL.saturating_sub(cpu_primed_at.elapsed()),
+                cost: &STATS.collectors.host,
+            },
+            weak.clone(),
+            move || {
+                move |out: &mut HostSample| {
+                    host.sample(out);
+                    true
+                }
+            },
+            |state: &mut Snapshot, sample: &HostSample, at| match state.host {
+                // clone_from 复用每核心数组的容量
+                Some(ref mut host) => {
+                    host.value.clone_from(sample);
+                    host.at = at;
+                }
+                None => state.host = Some(Stamped::new(sample.clone(), at)),
+            },
+        );
+
+        if options.temp_sensor {
+            let sensor_weak = weak.clone();
+            collector::spawn(
+                Schedule {
+                    name: "sensor",
+                    period: SENSOR_PERIOD,
+                    timeout: SENSOR_TIMEOUT,
+                    initial_delay: Duration::ZERO,
+                    cost: &STATS.collectors.sensor,
+                },
+                weak.clone(),
+                move || {
+                    let mut path: Option<Option<PathBuf>> = None;
+                    move |out: &mut Option<SensorOutput>| {
+                        // 首次运行时查找 temp_sensor，找不到则停止该采集器
+                        let path = path.get_or_insert_with(|| {
+                            let path = Self::find_temp_sensor();
+                            Self::log_temp_sensor(path.as_deref(), started);
+                            finish_probe(&sensor_weak, started);
+                            path
+                        });
+                        *out = path.as_deref().and_then(Self::get_sensor_data);
+                        path.is_some()
+                    }
+                },
+                |state: &mut Snapshot, sensor: &Option<SensorOutput>, at| {
+                    state.sensor = sensor.clone().map(|data| Stamped::new(data, at));
+                },
+            );
         }
-        
-        // 初始化 libmacchina readouts
-        let general_readout = GeneralReadout::new();
-        let battery_readout = BatteryReadout::new();
-        let kernel_readout = KernelReadout::new();
-        
-        // 缓存静态系统信息 (只需获取一次)
-        let cached_hostname = general_readout.hostname().ok();
-        let cached_os_name = general_readout.os_name().ok();
-        let cached_kernel_version = kernel_readout.os_release().ok();
-        let cached_cpu_model = general_readout.cpu_model_name().ok();
-        let cached_cpu_cores = general_readout.cpu_cores().ok();
-        let cached_resolution = general_readout.resolution().ok();
-        
-        println!("✅ libmacchina: 已初始化系统信息采集");
-        if let Some(ref host) = cached_hostname {
-            println!("   主机名: {}", host);
+
+        // 电池状态会变化，由采集器线程持有 readout 周期轮询
+        // (battery_if_present 时首次读不到电量即停止，readout 随采集函数释放)
+        let battery_if_present = options.battery_if_present;
+        collector::spawn(
+            Schedule {
+                name: "battery",
+                period: BATTERY_POLL_INTERVAL,
+                timeout: BATTERY_TIMEOUT,
+                initial_delay: Duration::ZERO,
+                cost: &STATS.collectors.battery,
+            },
+            weak,
+            move || {
+                let readout = BatteryReadout::new();
+                let mut first = true;
+                move |out: &mut BatteryReading| {
+                    *out = Self::read_battery(&readout);
+                    let running = !(first && battery_if_present && out.0.is_none());
+                    first = false;
+                    running
+                }
+            },
+            |state: &mut Snapshot, reading: &BatteryReading, at| {
+                state.battery = Some(Stamped::new(reading.clone(), at));
+            },
+        );
+
+        println!("⏱️  CPU/内存采集已就绪: {} ms", started.elapsed().as_millis());
+
+        Self {
+            shared,
+            cpu_primed_at,
+            host_waited: false,
+            processes: None,
+            io: None,
+            cgroups: None,
         }
-        if let Some(ref cpu) = cached_cpu_model {
-            println!("   CPU: {}", cpu);
+    }
+
+    /// 启用进程 Top-K 采样 (独立线程，按 `period` 增量采样)
+    pub fn enable_process_sampler(&mut self, period: Duration, k: usize) {
+        println!("✅ 进程采样: 每 {}ms, Top-{}", period.as_millis(), k);
+        self.processes = Some(procs::spawn_sampler(period, k, 256, 5));
+    }
+
+    /// 启用磁盘/网络吞吐采样 (独立线程，按 `period` 计算速率)
+    pub fn enable_io_sampler(&mut self, period: Duration, top_n: usize) {
+        self.io = throughput::spawn_sampler(period, top_n);
+        if self.io.is_some() {
+            println!("✅ 吞吐采样: 每 {}ms, Top-{}", period.as_millis(), top_n);
+        } else {
+            println!("⚠️  吞吐计数器不可用，跳过磁盘/网络采集");
         }
+    }
 
-        Self {
-            system: System::new_all(),
-            components: Components::new_with_refreshed_list(),
-            temp_sensor_path,
-            cached_sensor_data: None,
-            refresh_counter: 0,
-            general_readout,
-            battery_readout,
-            kernel_readout,
-            cached_hostname,
-            cached_os_name,
-            cached_kernel_version,
-            cached_cpu_model,
-            cached_cpu_cores,
-            cached_resolution,
+    /// 启用 cgroup v2 与 PSI 采样 (独立线程，按 `period` 计算速率)
+    pub fn enable_cgroup_sampler(&mut self, period: Duration, selection: CgroupSelection, top_n: usize) {
+        self.cgroups = cgroups::spawn_sampler(period, selection, top_n);
+    }
+
+    /// 取出最新的 cgroup 报告 (没有新报告时为 None)
+    fn latest_cgroups(&mut self) -> Option<CgroupReport> {
+        self.cgroups.as_ref()?.try_iter().last()
+    }
+
+    /// 取出最新的吞吐报告 (没有新报告时为 None)
+    fn latest_io(&mut self) -> Option<IoReport> {
+        self.io.as_ref()?.try_iter().last()
+    }
+
+    /// 取出最新的进程报告 (没有新报告时为 None)
+    fn latest_processes(&mut self) -> Option<ProcessReport> {
+        let rx = self.processes.as_ref()?;
+        let mut latest: Option<ProcessReport> = None;
+        while let Ok(mut report) = rx.try_recv() {
+            // 合并被跳过的报告中的进程名，保证名称不丢失
+            if let Some(prev) = latest.take() {
+                let mut names = prev.names;
+                names.append(&mut report.names);
+                report.names = names;
+            }
+            latest = Some(report);
         }
+        latest
     }
-    
+
+    /// 读取 libmacchina 电池电量与状态
+    fn read_battery(readout: &BatteryReadout) -> BatteryReading {
+        let percentage = readout.percentage().ok();
+        let status = percentage.map(|pct| match readout.status() {
+            Ok(libmacchina::traits::BatteryState::Charging) => "Charging".to_string(),
+            Ok(libmacchina::traits::BatteryState::Discharging) => "Discharging".to_string(),
+            // libmacchina currently only supports Charging/Discharging.
+            // If status fails but we have percentage, try to infer.
+            Err(_) if pct >= 95 => "Full".to_string(),
+            Err(_) => "Unknown".to_string(),
+        });
+        (percentage, status)
+    }
+
+    /// 输出 temp_sensor 查找结果
+    fn log_temp_sensor(path: Option<&Path>, started: Instant) {
+        let elapsed_ms = started.elapsed().as_millis();
+        if let Some(path) = path {
+            println!("✅ 硬件监控源: temp_sensor ({}) [{} ms]", path.display(), elapsed_ms);
+            println!("   (包含: CPU温度, 风扇转速, 功耗估算)");
+        } else {
+            println!("⚠️  未找到 temp_sensor 工具 [{} ms]", elapsed_ms);
+            println!("   请编译: cd server/temp-sensor && clang -framework IOKit -framework Foundation -o temp_sensor temp_sensor.m");
+        }
+    }
+
     /// 查找 temp_sensor 可执行文件
+    ///
+    /// 每个候选路径都要实际执行一次 (工具内部会等待 100ms 采样)，因此并发验证
     fn find_temp_sensor() -> Option<PathBuf> {
         // 可能的路径列表
         let possible_paths = [
@@ -156,22 +676,20 @@ impl Monitor {
             // server 目录下
             PathBuf::from("server/temp-sensor/temp_sensor"),
         ];
-        
-        for path in possible_paths {
-            if path.exists() {
-                // 验证可以执行并返回 JSON
-                if let Ok(output) = Command::new(&path).arg("-j").output() {
-                    if output.status.success() {
-                        // 尝试解析一次 JSON 确保格式正确
-                        let stdout = String::from_utf8_lossy(&output.stdout);
-                        if serde_json::from_str::<SensorOutput>(&stdout).is_ok() {
-                             return path.canonicalize().ok().or(Some(path));
-                        }
-                    }
-                }
-            }
+
+        // 按优先级顺序取第一个验证通过的路径
+        let found = thread::scope(|scope| {
+            let handles: Vec<_> = possible_paths
+                .iter()
+                .filter(|path| path.exists())
+                .map(|path| scope.spawn(move || Self::verify_temp_sensor(path)))
+                .collect();
+            handles.into_iter().find_map(|h| h.join().ok().flatten())
+        });
+        if found.is_some() {
+            return found;
         }
-        
+
         // 尝试绝对路径
         if let Ok(cwd) = std::env::current_dir() {
             let abs_path = cwd.join("temp-sensor/temp_sensor");
@@ -179,95 +697,86 @@ impl Monitor {
                  return Some(abs_path);
             }
         }
-        
+
         None
     }
-    
-    /// 从 temp_sensor 获取完整数据
-    fn get_sensor_data(&self) -> Option<SensorOutput> {
-        let path = self.temp_sensor_path.as_ref()?;
-        
-        // 运行 temp_sensor -j 获取 JSON 输出
-        let output = Command::new(path)
-            .arg("-j")
-            .output()
-            .ok()?;
-        
-        if !output.status.success() {
-            return None;
-        }
-        
-        let stdout = String::from_utf8_lossy(&output.stdout);
-        serde_json::from_str(&stdout).ok()
+
+    /// 验证 temp_sensor 可以执行并返回 JSON
+    fn verify_temp_sensor(path: &Path) -> Option<PathBuf> {
+        // 尝试解析一次 JSON 确保格式正确
+        Self::get_sensor_data(path)?;
+        path.canonicalize().ok().or_else(|| Some(path.to_path_buf()))
     }
 
-    /// 刷新并获取最新的系统指标
-    pub fn refresh(&mut self) -> SystemMetrics {
-        // 刷新 CPU、内存和温度信息
-        self.system.refresh_cpu_usage();
-        self.system.refresh_memory();
-        self.components.refresh();
+    /// 运行 temp_sensor -j 获取完整数据，超过 `SENSOR_TIMEOUT` 时结束子进程
+    fn get_sensor_data(path: &Path) -> Option<SensorOutput> {
+        let started = Instant::now();
+        let output = Self::run_with_timeout(Command::new(path).arg("-j"), SENSOR_TIMEOUT);
+        STATS.sensor_seconds.observe_since(started);
 
-        // 计算 CPU 平均使用率
-        let cpu_usage = self.system.cpus().iter()
-            .map(|cpu| cpu.cpu_usage())
-            .sum::<f32>() / self.system.cpus().len() as f32;
+        let stdout = output?;
+        serde_json::from_slice(&stdout).ok()
+    }
 
-        // 获取 CPU 频率 (取平均值)
-        let cpu_frequency_mhz = self.system.cpus().iter()
-            .map(|cpu| cpu.frequency())
-            .sum::<u64>() / self.system.cpus().len() as u64;
+    /// 运行子进程并收集 stdout，超时或失败时返回 None
+    ///
+    /// 输出只有一小段 JSON，不会写满管道缓冲，因此可以等进程退出后再读取
+    fn run_with_timeout(command: &mut Command, timeout: Duration) -> Option<Vec<u8>> {
+        let mut child = command.stdout(Stdio::piped()).stderr(Stdio::null()).spawn().ok()?;
+        let deadline = Instant::now() + timeout;
+        loop {
+            match child.try_wait() {
+                Ok(Some(status)) if status.success() => {
+                    let mut stdout = Vec::new();
+                    child.stdout.take()?.read_to_end(&mut stdout).ok()?;
+                    return Some(stdout);
+                }
+                Ok(Some(_)) => return None,
+                Ok(None) if Instant::now() < deadline => thread::sleep(SENSOR_POLL),
+                _ => {
+                    // 超时: 结束并回收子进程，下个周期重试
+                    let _ = child.kill();
+                    let _ = child.wait();
+                    return None;
+                }
+            }
+        }
+    }
 
-        // 计算内存使用
-        let memory_total = self.system.total_memory() / 1024 / 1024;
-        let memory_used = self.system.used_memory() / 1024 / 1024;
-        let memory_usage = (memory_used as f32 / memory_total as f32) * 100.0;
+    /// 从快照组装最新的系统指标 (不等待任何数据源)
+    pub fn refresh(&mut self) -> SystemMetrics {
+        let processes = self.latest_processes();
+        let io = self.latest_io();
+        let cgroups = self.latest_cgroups();
 
-        // 计算 Swap 使用率
-        let swap_total = self.system.total_swap();
-        let swap_used = self.system.used_swap();
-        let swap_usage = if swap_total > 0 {
-            (swap_used as f32 / swap_total as f32) * 100.0
+        // 只有首帧可能需要等待首个主机样本；之后直接读取快照
+        let state = if self.host_waited {
+            self.shared.lock()
         } else {
-            0.0
+            self.host_waited = true;
+            self.shared.lock_when(HOST_FIRST_SAMPLE_WAIT, |state| state.host.is_none())
         };
+        let empty = HostSample::default();
+        let host = state.host.as_ref().map_or(&empty, |host| &host.value);
+        let sampled_at = state.host.as_ref().map_or_else(Instant::now, |host| host.at);
+        // 超过一个周期加超时仍未更新的结果视为失效 (数据源卡住或已消失)
+        let sensor = state.sensor.as_ref().and_then(|s| s.fresh(SENSOR_PERIOD + SENSOR_TIMEOUT));
+        let battery = state.battery.as_ref().and_then(|b| b.fresh(BATTERY_POLL_INTERVAL + BATTERY_TIMEOUT));
 
-        // 获取传感器数据（每 10 次刷新调用一次，避免频繁调用外部进程）
-        if self.temp_sensor_path.is_some() {
-            self.refresh_counter += 1;
-            if self.refresh_counter >= 10 || self.cached_sensor_data.is_none() {
-                self.refresh_counter = 0;
-                self.cached_sensor_data = self.get_sensor_data();
-            }
+        let cpu_usage = host.cpu_usage;
+        let memory_usage = if host.memory_total > 0 {
+            (host.memory_used as f32 / host.memory_total as f32) * 100.0
         } else {
-            self.cached_sensor_data = None;
-        }
+            0.0
+        };
 
         // 提取数据
-        let (mut cpu_temp, fan_speeds, mut power_score) = if let Some(ref data) = self.cached_sensor_data {
+        let (cpu_temp, fan_speeds, mut power_score) = if let Some(data) = sensor {
             (Some(data.cpu_temp), data.fan_speed.clone(), Some(data.estimated_power_score))
         } else {
-            (None, vec![], None)
+            (host.cpu_temp, vec![], host.package_power_watts.map(|w| w * POWER_SCORE_PER_WATT))
         };
 
-        // 如果 temp_sensor 不可用或数据为空，尝试从 sysinfo::Components 获取温度 (Linux/Windows 兼容)
-        if cpu_temp.is_none() {
-            let mut max_temp = 0.0f32;
-            for component in &self.components {
-                let label = component.label().to_lowercase();
-                // 寻找包含 core, package, cpu 等关键词的传感器
-                if label.contains("core") || label.contains("package") || label.contains("cpu") || label.contains("soc") {
-                    let t = component.temperature();
-                    if t > max_temp && t < 150.0 {
-                        max_temp = t;
-                    }
-                }
-            }
-            if max_temp > 0.0 {
-                cpu_temp = Some(max_temp);
-            }
-        }
-
         // 功耗分数回退逻辑：基于 CPU 使用率估算 (适用于非 macOS)
         if power_score.is_none() {
             // 基准功耗 2.0 (空闲) + CPU 贡献 + 内存压力贡献
@@ -277,67 +786,66 @@ impl Monitor {
 
         // GPU 温度 = CPU 温度 + 少量偏移 (Apple Silicon SOC 集成)
         let gpu_temp = cpu_temp.map(|t| t + 3.0 + cpu_usage * 0.05);
-        
+
         // 获取动态数据 (电池状态, uptime)
         // 优先使用 temp_sensor 的数据，因为它更准确 (能识别 AC Attached)
-        let (ts_battery_limit, ts_battery_status) = if let Some(ref data) = self.cached_sensor_data {
+        // 电池状态逻辑: temp_sensor > libmacchina (后台线程轮询并推断)
+        let (ts_battery_limit, ts_battery_status) = if let Some(data) = sensor {
             (data.battery_percentage, data.battery_status.clone())
         } else {
             (None, None)
         };
 
-        let battery_percentage = ts_battery_limit.or_else(|| self.battery_readout.percentage().ok());
-        
-        // 电池状态逻辑: temp_sensor > libmacchina > 推断
-        let battery_status = if let Some(status) = ts_battery_status {
-             Some(status)
-        } else if let Some(pct) = battery_percentage {
-            match self.battery_readout.status() {
-                Ok(s) => Some(match s {
-                    libmacchina::traits::BatteryState::Charging => "Charging".to_string(),
-                    libmacchina::traits::BatteryState::Discharging => "Discharging".to_string(),
-                }),
-                Err(_) => {
-                    // libmacchina currently only supports Charging/Discharging.
-                    // If status fails but we have percentage, try to infer.
-                    if pct >= 95 {
-                        Some("Full".to_string())
-                    } else {
-                        Some("Unknown".to_string())
-                    }
-                }
-            }
-        } else {
-            None
-        };
-        let uptime_secs = self.general_readout.uptime().ok().map(|v| v as u64);
+        let battery_percentage = ts_battery_limit.or(battery.and_then(|b| b.0));
+        let battery_status = ts_battery_status.or_else(|| battery.and_then(|b| b.1.clone()));
+        let uptime_secs = Some(System::uptime());
 
         SystemMetrics {
+            seq: 0,
+            sample_ms: collector::millis(sampled_at),
             cpu_usage,
-            cpu_frequency_mhz,
+            cpu_frequency_mhz: host.cpu_frequency_mhz,
+            core_usage: host.core_usage.clone(),
+            core_frequency_mhz: host.core_frequency_mhz.clone(),
             memory_usage,
-            memory_total,
-            memory_used,
-            swap_usage,
+            memory_total: host.memory_total,
+            memory_used: host.memory_used,
+            swap_usage: host.swap_usage,
             cpu_temp,
             gpu_temp,
             fan_speeds,
             power_score,
             // libmacchina 字段
-            hostname: self.cached_hostname.clone(),
+            hostname: state.static_info.hostname.clone(),
             // hostname: Some("MY-MacBook".to_string()),
-            os_name: self.cached_os_name.clone(),
-            kernel_version: self.cached_kernel_version.clone(),
-            cpu_model: self.cached_cpu_model.clone(),
-            cpu_cores: self.cached_cpu_cores,
+            os_name: state.static_info.os_name.clone(),
+            kernel_version: state.static_info.kernel_version.clone(),
+            cpu_model: state.static_info.cpu_model.clone(),
+            cpu_cores: state.static_info.cpu_cores,
             uptime_secs,
             battery_percentage,
             battery_status,
-            resolution: self.cached_resolution.clone(),
+            resolution: state.static_info.resolution.clone(),
+            processes,
+            io,
+            gauges: Vec::new(),
+            alerts: Vec::new(),
+            fan_control: None,
+            cgroups,
         }
     }
 }
 
+impl Backend for Monitor {
+    fn refresh(&mut self) -> SystemMetrics {
+        Monitor::refresh(self)
+    }
+
+    fn first_sample_delay(&self) -> Duration {
+        sysinfo::MINIMUM_CPU_UPDATE_INTERVAL.saturating_sub(self.cpu_primed_at.elapsed())
+    }
+}
+
 impl Default for Monitor {
     fn default() -> Self {
         Self::new()
@@ -0,0 +1,45 @@
+//! 紧凑编码
+//!
+//! 每核心数组在 JSON 中编码为十六进制字符串，每核心 1 字节 (2 个字符)，
+//! 64 核机器每个数组只占 128 字节，客户端无需解析浮点数组:
+//! - 使用率: 四舍五入后的整数百分比 (0-100)
+//! - 频率: 以 100 MHz 为单位 (最大 25.5 GHz)
+
+use serde::Serializer;
+
+/// 频率量化单位 (MHz)
+pub const FREQ_UNIT_MHZ: u64 = 100;
+
+const HEX: &[u8; 16] = b"0123456789abcdef";
+
+/// 将字节序列编码为小写十六进制，追加到 `out`
+pub fn push_hex(out: &mut String, bytes: impl IntoIterator<Item = u8>) {
+    for b in bytes {
+        out.push(HEX[(b >> 4) as usize] as char);
+        out.push(HEX[(b & 0x0f) as usize] as char);
+    }
+}
+
+/// 量化使用率 (%) 为单字节
+pub fn quantize_percent(percent: f32) -> u8 {
+    percent.round().clamp(0.0, 100.0) as u8
+}
+
+/// 量化频率 (MHz) 为单字节
+pub fn quantize_freq(mhz: u64) -> u8 {
+    ((mhz + FREQ_UNIT_MHZ / 2) / FREQ_UNIT_MHZ).min(u8::MAX as u64) as u8
+}
+
+/// serde: 每核心使用率序列化为紧凑十六进制
+pub fn serialize_percent<S: Serializer>(values: &[f32], serializer: S) -> Result<S::Ok, S::Error> {
+    let mut out = String::with_capacity(values.len() * 2);
+    push_hex(&mut out, values.iter().map(|v| quantize_percent(*v)));
+    serializer.serialize_str(&out)
+}
+
+/// serde: 每核心频率序列化为紧凑十六进制
+pub fn serialize_freq<S: Serializer>(values: &[u64], serializer: S) -> Result<S::Ok, S::Error> {
+    let mut out = String::with_capacity(values.len() * 2);
+    push_hex(&mut out, values.iter().map(|v| quantize_freq(*v)));
+    serializer.serialize_str(&out)
+}
@@ -0,0 +1,462 @@
+//! Linux 原生采集器
+//!
+//! 直接读取 `/proc/stat`、`/proc/meminfo`、`/sys/class/hwmon` 和
+//! `/sys/class/powercap` (RAPL)，替代 sysinfo 的通用路径；吞吐计数器来自
+//! `/proc/diskstats` 与 `/proc/net/dev` (见 [`IoCounterFiles`]):
+//! - 文件在启动时打开一次，之后每次采样用 `pread` 从偏移 0 读入复用缓冲区
+//! - 温度传感器只在启动时筛选一次，采样时不再遍历、不再分配字符串
+//! - 功耗来自 RAPL 能量计数器的差分，而不是估算公式
+//!
+//! 所有路径都相对于 `root`，因此可以指向测试夹具目录 (基准测试使用)
+
+use crate::monitor::HostSample;
+use crate::throughput::{CounterSource, RateTracker};
+use std::fs::{self, File};
+use std::io;
+use std::os::unix::fs::FileExt;
+use std::path::{Path, PathBuf};
+use std::time::Instant;
+
+/// 单值 sysfs 属性文件的读取缓冲大小
+const ATTR_BUF_SIZE: usize = 32;
+
+/// 持久打开的文件，每次从偏移 0 重新读取
+pub(crate) struct PinnedFile {
+    file: File,
+}
+
+impl PinnedFile {
+    pub(crate) fn open(path: &Path) -> io::Result<Self> {
+        Ok(Self { file: File::open(path)? })
+    }
+
+    /// 读取完整内容到复用缓冲区 (缓冲区不足时扩容，之后保持该容量)
+    pub(crate) fn read_all<'a>(&self, buf: &'a mut Vec<u8>) -> io::Result<&'a [u8]> {
+        let mut len = 0;
+        loop {
+            if len == buf.len() {
+                buf.resize(buf.len() * 2, 0);
+            }
+            let n = self.file.read_at(&mut buf[len..], len as u64)?;
+            if n == 0 {
+                return Ok(&buf[..len]);
+            }
+            len += n;
+        }
+    }
+
+    /// 一次 pread 读取完整内容 (内容填满缓冲区时才继续读取)，适合内容远小于缓冲区的文件
+    pub(crate) fn read_once<'a>(&self, buf: &'a mut Vec<u8>) -> io::Result<&'a [u8]> {
+        let n = self.file.read_at(buf, 0)?;
+        if n < buf.len() {
+            return Ok(&buf[..n]);
+        }
+        self.read_all(buf)
+    }
+
+    /// 读取 sysfs 单值属性 (一次 pread，整数文本)
+    pub(crate) fn read_u64(&self) -> io::Result<u64> {
+        let mut buf = [0u8; ATTR_BUF_SIZE];
+        let n = self.file.read_at(&mut buf, 0)?;
+        Ok(parse_u64(&buf[..n]))
+    }
+}
+
+/// 解析前导十进制整数，忽略前导空白和尾部内容
+pub(crate) fn parse_u64(bytes: &[u8]) -> u64 {
+    bytes
+        .iter()
+        .skip_while(|b| b.is_ascii_whitespace())
+        .take_while(|b| b.is_ascii_digit())
+        .fold(0u64, |acc, b| acc * 10 + (b - b'0') as u64)
+}
+
+/// 按空白切分的数字字段
+pub(crate) fn fields(line: &[u8]) -> impl Iterator<Item = u64> + '_ {
+    line.split(|b| *b == b' ')
+        .filter(|f| !f.is_empty())
+        .map(parse_u64)
+}
+
+/// /proc/stat 中一行 CPU 时间 (jiffies)
+#[derive(Debug, Default, Clone, Copy)]
+struct CpuTimes {
+    busy: u64,
+    total: u64,
+}
+
+impl CpuTimes {
+    /// 解析 "cpu  user nice system idle iowait irq softirq steal ..." 的数值部分
+    fn parse(values: &[u8]) -> Self {
+        let mut total = 0;
+        let mut idle = 0;
+        // guest/guest_nice 已计入 user/nice，只取前 8 列
+        for (i, v) in fields(values).take(8).enumerate() {
+            total += v;
+            if i == 3 || i == 4 {
+                idle += v;
+            }
+        }
+        Self { busy: total - idle, total }
+    }
+
+    /// 相对上次采样的使用率 (%)
+    fn usage_since(&self, prev: &CpuTimes) -> f32 {
+        let total = self.total.saturating_sub(prev.total);
+        if total == 0 {
+            return 0.0;
+        }
+        self.busy.saturating_sub(prev.busy) as f32 / total as f32 * 100.0
+    }
+}
+
+/// RAPL 封装级能量计数器
+struct RaplDomain {
+    energy_uj: PinnedFile,
+    /// 计数器回绕上限 (µJ)
+    max_energy_uj: u64,
+    last_uj: u64,
+}
+
+impl RaplDomain {
+    /// 上次读数到 `energy` 消耗的能量 (µJ)
+    ///
+    /// 计数器取值 0..=max_energy_uj，回绕时先走到上限再从 0 计到 `energy`，共 max - last + energy + 1
+    fn delta_uj(&self, energy: u64) -> u64 {
+        if energy >= self.last_uj {
+            energy - self.last_uj
+        } else {
+            // 读不到上限时为 u64::MAX，用饱和加法避免溢出
+            self.max_energy_uj.saturating_sub(self.last_uj).saturating_add(energy).saturating_add(1)
+        }
+    }
+}
+
+/// Linux 原生采集器
+pub struct ProcfsCollector {
+    stat: PinnedFile,
+    meminfo: PinnedFile,
+    /// 启动时筛选出的 CPU 温度传感器 (temp*_input)
+    temps: Vec<PinnedFile>,
+    /// 各核心当前频率 (scaling_cur_freq, kHz)
+    freqs: Vec<PinnedFile>,
+    rapl: Vec<RaplDomain>,
+    /// 上次 RAPL 采样时间
+    rapl_at: Instant,
+    prev_cpu: CpuTimes,
+    /// 上次采样的每核心 CPU 时间，按 cpuN 的编号 N 索引 (离线核心为 None)
+    prev_cores: Vec<Option<CpuTimes>>,
+    /// /proc 文件读取缓冲区 (复用)
+    buf: Vec<u8>,
+}
+
+impl ProcfsCollector {
+    /// 打开采集所需的文件并筛选传感器，`root` 通常为 `/`
+    pub fn open(root: &Path) -> io::Result<Self> {
+        let stat = PinnedFile::open(&root.join("proc/stat"))?;
+        let meminfo = PinnedFile::open(&root.join("proc/meminfo"))?;
+        let temps = select_cpu_temps(&root.join("sys/class/hwmon"));
+        let freqs = open_cpu_freqs(&root.join("sys/devices/system/cpu"));
+        let rapl = open_rapl(&root.join("sys/class/powercap"));
+
+        let mut collector = Self {
+            stat,
+            meminfo,
+            temps,
+            freqs,
+            rapl,
+            rapl_at: Instant::now(),
+            prev_cpu: CpuTimes::default(),
+            prev_cores: Vec::new(),
+            buf: vec![0; 4096],
+        };
+        // 以首次读数为基准，后续采样计算差分
+        collector.prev_cpu = collector.read_cpu_times(&mut Vec::new())?;
+        Ok(collector)
+    }
+
+    /// 已选中的温度传感器数量
+    pub fn temp_sensor_count(&self) -> usize {
+        self.temps.len()
+    }
+
+    /// 是否有可读的 RAPL 能量计数器
+    pub fn has_rapl(&self) -> bool {
+        !self.rapl.is_empty()
+    }
+
+    /// 读取 /proc/stat，返回总 CPU 时间，并将每核心使用率 (相对 `prev_cores`) 写入 `core_usage`
+    fn read_cpu_times(&mut self, core_usage: &mut Vec<f32>) -> io::Result<CpuTimes> {
+        let data = self.stat.read_all(&mut self.buf)?;
+        let mut lines = data.split(|b| *b == b'\n');
+        let total = match lines.next().and_then(|line| line.strip_prefix(b"cpu ")) {
+            Some(values) => CpuTimes::parse(values),
+            None => return Err(io::Error::new(io::ErrorKind::InvalidData, "/proc/stat: missing cpu line")),
+        };
+
+        // 每核心行 "cpuN ..." 紧随总行之后，按 N 递增；离线核心不会出现。
+        // 基准按 N 对应，核心下线后其余核心不会错用相邻核心的基准
+        core_usage.clear();
+        let mut next_id = 0;
+        for line in lines.take_while(|l| l.starts_with(b"cpu")) {
+            let mut parts = line.splitn(2, |b| *b == b' ');
+            let id = parse_u64(&parts.next().unwrap_or_default()[3..]) as usize;
+            let times = CpuTimes::parse(parts.next().unwrap_or_default());
+            if id >= self.prev_cores.len() {
+                self.prev_cores.resize(id + 1, None);
+            }
+            // 本次未出现的核心 (已下线) 丢弃基准
+            for prev in self.prev_cores.iter_mut().take(id).skip(next_id) {
+                *prev = None;
+            }
+            next_id = id + 1;
+            // 核心热插拔：新上线的核心从本次读数开始计算
+            let prev = self.prev_cores[id].replace(times).unwrap_or(times);
+            core_usage.push(times.usage_since(&prev));
+        }
+        self.prev_cores.truncate(next_id);
+        Ok(total)
+    }
+
+    /// 读取 /proc/meminfo，返回 (总内存 kB, 可用内存 kB, swap 总量 kB, swap 空闲 kB)
+    fn read_meminfo(&mut self) -> io::Result<(u64, u64, u64, u64)> {
+        let data = self.meminfo.read_all(&mut self.buf)?;
+        let (mut total, mut available, mut swap_total, mut swap_free) = (0, 0, 0, 0);
+        for line in data.split(|b| *b == b'\n') {
+            if let Some(v) = line.strip_prefix(b"MemTotal:") {
+                total = parse_u64(v);
+            } else if let Some(v) = line.strip_prefix(b"MemAvailable:") {
+                available = parse_u64(v);
+            } else if let Some(v) = line.strip_prefix(b"SwapTotal:") {
+                swap_total = parse_u64(v);
+            } else if let Some(v) = line.strip_prefix(b"SwapFree:") {
+                swap_free = parse_u64(v);
+                // SwapFree 在所需字段中最靠后
+                break;
+            }
+        }
+        Ok((total, available, swap_total, swap_free))
+    }
+
+    /// 读取所有选中传感器的最高温度 (°C)
+    fn read_cpu_temp(&self) -> Option<f32> {
+        self.temps
+            .iter()
+            .filter_map(|t| t.read_u64().ok())
+            .map(|milli| milli as f32 / 1000.0)
+            .filter(|t| *t > 0.0 && *t < 150.0)
+            .reduce(f32::max)
+    }
+
+    /// 读取每核心频率 (MHz) 到 `core_freq`，返回平均值
+    fn read_cpu_frequency(&self, core_freq: &mut Vec<u64>) -> u64 {
+        core_freq.clear();
+        core_freq.extend(self.freqs.iter().map(|f| f.read_u64().unwrap_or(0) / 1000));
+        if core_freq.is_empty() {
+            0
+        } else {
+            core_freq.iter().sum::<u64>() / core_freq.len() as u64
+        }
+    }
+
+    /// 根据 RAPL 能量差分计算封装功耗 (W)，首次采样返回 None
+    fn read_package_power(&mut self) -> Option<f32> {
+        if self.rapl.is_empty() {
+            return None;
+        }
+        let now = Instant::now();
+        let elapsed = now.duration_since(self.rapl_at).as_secs_f32();
+        self.rapl_at = now;
+
+        let mut delta_uj = 0u64;
+        for domain in &mut self.rapl {
+            let Ok(energy) = domain.energy_uj.read_u64() else { continue };
+            delta_uj = delta_uj.saturating_add(domain.delta_uj(energy));
+            domain.last_uj = energy;
+        }
+        (elapsed > 0.0).then(|| delta_uj as f32 / 1_000_000.0 / elapsed)
+    }
+
+    /// 采集一次主机核心指标，原地写入 `out` (复用其每核心数组)
+    pub fn sample_into(&mut self, out: &mut HostSample) -> io::Result<()> {
+        let cpu = self.read_cpu_times(&mut out.core_usage)?;
+        let cpu_usage = cpu.usage_since(&self.prev_cpu);
+        self.prev_cpu = cpu;
+
+        let (total_kb, available_kb, swap_total_kb, swap_free_kb) = self.read_meminfo()?;
+        let swap_usage = if swap_total_kb > 0 {
+            (swap_total_kb - swap_free_kb.min(swap_total_kb)) as f32 / swap_total_kb as f32 * 100.0
+        } else {
+            0.0
+        };
+
+        out.cpu_usage = cpu_usage;
+        out.cpu_frequency_mhz = self.read_cpu_frequency(&mut out.core_frequency_mhz);
+        out.memory_total = total_kb / 1024;
+        out.memory_used = total_kb.saturating_sub(available_kb) / 1024;
+        out.swap_usage = swap_usage;
+        out.cpu_temp = self.read_cpu_temp();
+        out.package_power_watts = self.read_package_power();
+        Ok(())
+    }
+}
+
+/// /proc/diskstats 中的扇区大小 (与设备实际扇区大小无关)
+const DISKSTATS_SECTOR_BYTES: u64 = 512;
+
+/// 磁盘与网卡吞吐计数器 (`/proc/diskstats`、`/proc/net/dev`)
+///
+/// 物理设备判定: `/sys/block/<dev>/device` (且不是分区) 或 `/sys/class/net/<if>/device` 存在，
+/// 分区、loop、dm、md、veth、网桥等不计入总量，磁盘的 Top-N 也不列出。判定只在设备首次出现时进行
+pub struct IoCounterFiles {
+    diskstats: Option<PinnedFile>,
+    net_dev: Option<PinnedFile>,
+    sys_block: PathBuf,
+    sys_net: PathBuf,
+    /// /proc 文件读取缓冲区 (复用)
+    buf: Vec<u8>,
+}
+
+impl IoCounterFiles {
+    /// 打开计数器文件，两者都不可用时返回错误
+    pub fn open(root: &Path) -> io::Result<Self> {
+        let diskstats = PinnedFile::open(&root.join("proc/diskstats")).ok();
+        let net_dev = PinnedFile::open(&root.join("proc/net/dev")).ok();
+        if diskstats.is_none() && net_dev.is_none() {
+            return Err(io::Error::new(io::ErrorKind::NotFound, "/proc/diskstats 与 /proc/net/dev 均不可用"));
+        }
+        Ok(Self {
+            diskstats,
+            net_dev,
+            sys_block: root.join("sys/block"),
+            sys_net: root.join("sys/class/net"),
+            buf: vec![0; 16384],
+        })
+    }
+}
+
+impl CounterSource for IoCounterFiles {
+    fn read(&mut self, disks: &mut RateTracker, nets: &mut RateTracker) -> io::Result<()> {
+        let Self { diskstats, net_dev, sys_block, sys_net, buf } = self;
+
+        if let Some(file) = diskstats {
+            // "major minor name reads merged sectors ms writes merged sectors ms ..."
+            for line in file.read_all(buf)?.split(|b| *b == b'\n') {
+                let mut tokens = line.split(|b| *b == b' ').filter(|t| !t.is_empty());
+                let Some(name) = tokens.nth(2).and_then(|n| std::str::from_utf8(n).ok()) else { continue };
+                let mut values = [0u64; 7];
+                for (slot, token) in values.iter_mut().zip(tokens) {
+                    *slot = parse_u64(token);
+                }
+                let counters = [
+                    values[2] * DISKSTATS_SECTOR_BYTES,
+                    values[6] * DISKSTATS_SECTOR_BYTES,
+                    values[0],
+                    values[4],
+                ];
+                disks.observe(name, counters, |n| {
+                    let dev = sys_block.join(n);
+                    dev.join("device").exists() && !dev.join("partition").exists()
+                });
+            }
+        }
+
+        if let Some(file) = net_dev {
+            // 两行表头之后: "  eth0: rx_bytes rx_packets errs drop fifo frame compressed multicast tx_bytes tx_packets ..."
+            for line in file.read_all(buf)?.split(|b| *b == b'\n').skip(2) {
+                let Some(colon) = line.iter().position(|b| *b == b':') else { continue };
+                let Some(name) = std::str::from_utf8(&line[..colon]).ok().map(str::trim) else { continue };
+                let mut values = [0u64; 10];
+                for (slot, value) in values.iter_mut().zip(fields(&line[colon + 1..])) {
+                    *slot = value;
+                }
+                let counters = [values[0], values[8], values[1], values[9]];
+                nets.observe(name, counters, |n| sys_net.join(n).join("device").exists());
+            }
+        }
+        Ok(())
+    }
+}
+
+/// 读取小文本文件并去除首尾空白 (仅启动时使用)
+fn read_trimmed(path: &Path) -> Option<String> {
+    fs::read_to_string(path).ok().map(|s| s.trim().to_string())
+}
+
+/// 目录下按名称排序的条目
+pub(crate) fn sorted_entries(dir: &Path) -> Vec<PathBuf> {
+    let mut entries: Vec<PathBuf> = fs::read_dir(dir)
+        .map(|rd| rd.filter_map(|e| e.ok()).map(|e| e.path()).collect())
+        .unwrap_or_default();
+    entries.sort();
+    entries
+}
+
+/// 筛选 CPU 温度传感器
+///
+/// 优先选择封装级传感器 (Package / Tctl / Tdie)；没有时退回到 CPU 类芯片
+/// 的全部传感器，或标签中含 core/cpu/soc 的传感器
+fn select_cpu_temps(hwmon: &Path) -> Vec<PinnedFile> {
+    const CPU_CHIPS: [&str; 6] = ["coretemp", "k10temp", "zenpower", "cpu_thermal", "cpu-thermal", "soc_thermal"];
+
+    let mut package = Vec::new();
+    let mut fallback = Vec::new();
+    for chip in sorted_entries(hwmon) {
+        let name = read_trimmed(&chip.join("name")).unwrap_or_default();
+        let cpu_chip = CPU_CHIPS.contains(&name.as_str());
+
+        for input in sorted_entries(&chip) {
+            let Some(file_name) = input.file_name().and_then(|n| n.to_str()) else { continue };
+            let Some(index) = file_name.strip_prefix("temp").and_then(|s| s.strip_suffix("_input")) else { continue };
+            let label = read_trimmed(&chip.join(format!("temp{}_label", index)))
+                .unwrap_or_default()
+                .to_lowercase();
+
+            if label.starts_with("package") || label == "tctl" || label == "tdie" {
+                package.push(input);
+            } else if cpu_chip || label.contains("core") || label.contains("cpu") || label.contains("soc") {
+                fallback.push(input);
+            }
+        }
+    }
+
+    let selected = if package.is_empty() { fallback } else { package };
+    selected.iter().filter_map(|p| PinnedFile::open(p).ok()).collect()
+}
+
+/// 打开每个核心的 scaling_cur_freq
+fn open_cpu_freqs(cpu_dir: &Path) -> Vec<PinnedFile> {
+    let mut cores: Vec<(usize, PathBuf)> = sorted_entries(cpu_dir)
+        .into_iter()
+        .filter_map(|p| {
+            let index = p.file_name()?.to_str()?.strip_prefix("cpu")?.parse().ok()?;
+            Some((index, p.join("cpufreq/scaling_cur_freq")))
+        })
+        .collect();
+    cores.sort_by_key(|(index, _)| *index);
+    cores.iter().filter_map(|(_, p)| PinnedFile::open(p).ok()).collect()
+}
+
+/// 打开封装级 RAPL 域 (intel-rapl:N，不含子域 intel-rapl:N:M)
+///
+/// 新内核上 energy_uj 默认仅 root 可读，打开失败时视为不可用
+fn open_rapl(powercap: &Path) -> Vec<RaplDomain> {
+    sorted_entries(powercap)
+        .into_iter()
+        .filter(|p| {
+            p.file_name()
+                .and_then(|n| n.to_str())
+                .and_then(|n| n.strip_prefix("intel-rapl:"))
+                .is_some_and(|rest| !rest.contains(':'))
+        })
+        .filter(|p| read_trimmed(&p.join("name")).is_some_and(|n| n.starts_with("package")))
+        .filter_map(|p| {
+            let energy_uj = PinnedFile::open(&p.join("energy_uj")).ok()?;
+            let last_uj = energy_uj.read_u64().ok()?;
+            let max_energy_uj = read_trimmed(&p.join("max_energy_range_uj"))
+                .and_then(|s| s.parse().ok())
+                .unwrap_or(u64::MAX);
+            Some(RaplDomain { energy_uj, max_energy_uj, last_uj })
+        })
+        .collect()
+}
@@ -0,0 +1,355 @@
+//! 进程 Top-K 采样
+//!
+//! 完整刷新所有进程在繁忙机器上代价很高，不能放在 100ms 的推送周期里。
+//! 采样器运行在独立线程、独立周期上，并且每次只增量刷新一部分进程:
+//! - 进程列表 (只有 PID) 每 `list_every` 次采样刷新一次，用于发现新进程
+//! - 每次采样按轮转游标刷新至多 `refresh_budget` 个进程的 CPU/RSS
+//! - 按轮次累积 CPU 和 RSS 的 Top-K (见 [`RoundTopK`])
+//!
+//! 开销: 普通采样只与 `refresh_budget` 和 K 有关；每 `list_every` 次采样中有一次要重新列出全部进程、
+//! 排序并清理缓存表，是 O(N log N)。摊到每次采样仍随进程总数 N 增长，只是除以了 `list_every`
+//!
+//! 输出只包含 K 个条目，条目以 PID 标识；进程名只在该 PID 首次进入 Top-K 时
+//! 随报告发送一次 (每隔 `NAME_RESEND_SAMPLES` 次采样整体重发，照顾后加入的客户端)
+
+use serde::ser::{SerializeSeq, SerializeStruct};
+use serde::{Serialize, Serializer};
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, HashMap, HashSet};
+use std::sync::mpsc::{self, Receiver};
+use std::thread;
+use std::time::Duration;
+use sysinfo::{Pid, ProcessRefreshKind, ProcessesToUpdate, System};
+
+/// 进程名整体重发间隔 (采样次数)
+const NAME_RESEND_SAMPLES: u32 = 30;
+/// 尚未取走的报告上限 (推送循环停顿时采样线程在发送处等待，报告不会堆积)
+const REPORT_BACKLOG: usize = 4;
+
+/// 单个进程的一次读数
+#[derive(Debug, Clone, Copy)]
+pub struct ProcStat {
+    pub pid: u32,
+    /// CPU 使用率 (%，单核为 100)
+    pub cpu: f32,
+    /// 常驻内存 (字节)
+    pub rss: u64,
+}
+
+/// 进程数据来源
+pub trait ProcessSource {
+    /// 列出当前全部进程的 PID (低频调用)
+    fn list(&mut self, out: &mut Vec<u32>);
+    /// 刷新指定进程的 CPU/RSS，已退出的进程不输出
+    fn refresh(&mut self, pids: &[u32], out: &mut Vec<ProcStat>);
+    /// 进程名 (每个 PID 只在首次进入 Top-K 时调用)
+    fn name(&mut self, pid: u32) -> Option<String>;
+}
+
+/// 基于 sysinfo 的进程来源
+pub struct SysinfoProcesses {
+    system: System,
+    /// sysinfo 刷新所需的 Pid 缓冲 (复用)
+    pid_buf: Vec<Pid>,
+}
+
+impl SysinfoProcesses {
+    pub fn new() -> Self {
+        Self {
+            system: System::new(),
+            pid_buf: Vec::new(),
+        }
+    }
+}
+
+impl Default for SysinfoProcesses {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ProcessSource for SysinfoProcesses {
+    fn list(&mut self, out: &mut Vec<u32>) {
+        // 不带 CPU/内存，只更新进程表并移除已退出的进程
+        self.system
+            .refresh_processes_specifics(ProcessesToUpdate::All, ProcessRefreshKind::new());
+        out.clear();
+        out.extend(self.system.processes().keys().map(|pid| pid.as_u32()));
+    }
+
+    fn refresh(&mut self, pids: &[u32], out: &mut Vec<ProcStat>) {
+        self.pid_buf.clear();
+        self.pid_buf.extend(pids.iter().map(|pid| Pid::from_u32(*pid)));
+        self.system.refresh_processes_specifics(
+            ProcessesToUpdate::Some(&self.pid_buf),
+            ProcessRefreshKind::new().with_cpu().with_memory(),
+        );
+        out.extend(self.pid_buf.iter().filter_map(|pid| {
+            let process = self.system.process(*pid)?;
+            Some(ProcStat {
+                pid: pid.as_u32(),
+                cpu: process.cpu_usage(),
+                rss: process.memory(),
+            })
+        }));
+    }
+
+    fn name(&mut self, pid: u32) -> Option<String> {
+        let process = self.system.process(Pid::from_u32(pid))?;
+        Some(process.name().to_string_lossy().into_owned())
+    }
+}
+
+/// 合成进程表 (基准测试用)：固定数量的进程，读数按伪随机序列变化
+pub struct SyntheticProcesses {
+    count: u32,
+    seed: u64,
+}
+
+impl SyntheticProcesses {
+    pub fn new(count: u32) -> Self {
+        Self { count, seed: 0x9e37_79b9_7f4a_7c15 }
+    }
+
+    fn next(&mut self) -> u64 {
+        // xorshift64
+        self.seed ^= self.seed << 13;
+        self.seed ^= self.seed >> 7;
+        self.seed ^= self.seed << 17;
+        self.seed
+    }
+}
+
+impl ProcessSource for SyntheticProcesses {
+    fn list(&mut self, out: &mut Vec<u32>) {
+        out.clear();
+        out.extend(1..=self.count);
+    }
+
+    fn refresh(&mut self, pids: &[u32], out: &mut Vec<ProcStat>) {
+        for &pid in pids {
+            let r = self.next();
+            out.push(ProcStat {
+                pid,
+                cpu: (r % 10_000) as f32 / 100.0,
+                rss: (r >> 16) % (8 << 30),
+            });
+        }
+    }
+
+    fn name(&mut self, pid: u32) -> Option<String> {
+        Some(format!("proc-{}", pid))
+    }
+}
+
+/// Top-K 条目
+#[derive(Debug, Clone, Copy)]
+pub struct TopEntry {
+    pub pid: u32,
+    /// CPU 使用率 (%)
+    pub cpu: f32,
+    /// 常驻内存 (字节)
+    pub rss: u64,
+}
+
+impl Serialize for TopEntry {
+    /// 编码为 [pid, CPU 千分比 (0.1%), RSS MB] 三元组
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        let mut seq = serializer.serialize_seq(Some(3))?;
+        seq.serialize_element(&self.pid)?;
+        seq.serialize_element(&((self.cpu * 10.0).round() as u32))?;
+        seq.serialize_element(&(self.rss / 1024 / 1024))?;
+        seq.end()
+    }
+}
+
+/// 一次进程采样的报告
+#[derive(Debug, Clone, Default)]
+pub struct ProcessReport {
+    /// 按 CPU 排序的 Top-K
+    pub top_cpu: Vec<TopEntry>,
+    /// 按 RSS 排序的 Top-K
+    pub top_rss: Vec<TopEntry>,
+    /// 本次新出现的 PID 的名称
+    pub names: Vec<(u32, String)>,
+}
+
+impl Serialize for ProcessReport {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        let mut s = serializer.serialize_struct("ProcessReport", 3)?;
+        s.serialize_field("cpu", &self.top_cpu)?;
+        s.serialize_field("rss", &self.top_rss)?;
+        s.serialize_field("names", &self.names)?;
+        s.end()
+    }
+}
+
+/// 缓存的进程读数
+#[derive(Debug, Clone, Copy)]
+struct Cached {
+    cpu: f32,
+    rss: u64,
+}
+
+/// 非负 f32 的可排序键 (非负数范围内位模式保持顺序)
+fn score_bits(v: f32) -> u32 {
+    v.max(0.0).to_bits()
+}
+
+/// 按轮次累积的 Top-K
+///
+/// 每次采样只刷新一批进程，游标回绕一次即为一轮，所有进程都刷新过一次。
+/// 当前轮的候选在大小为 K 的堆中累积，上一轮的结果保留其 PID；输出时两者
+/// 合并，并按缓存表中的最新值重新排序。开销只与批大小和 K 有关，与进程总数无关
+struct RoundTopK {
+    k: usize,
+    key: fn(&Cached) -> f32,
+    current: BinaryHeap<Reverse<(u32, u32)>>,
+    previous: Vec<u32>,
+}
+
+impl RoundTopK {
+    fn new(k: usize, key: fn(&Cached) -> f32) -> Self {
+        Self {
+            k,
+            key,
+            current: BinaryHeap::with_capacity(k + 1),
+            previous: Vec::with_capacity(k),
+        }
+    }
+
+    fn push(&mut self, pid: u32, cached: &Cached) {
+        self.current.push(Reverse((score_bits((self.key)(cached)), pid)));
+        if self.current.len() > self.k {
+            self.current.pop();
+        }
+    }
+
+    /// 一轮结束：当前轮结果成为下一轮的基线
+    fn finish_round(&mut self) {
+        self.previous.clear();
+        self.previous.extend(self.current.drain().map(|Reverse((_, pid))| pid));
+    }
+
+    /// 合并两轮候选，按最新值降序取前 K 个
+    fn top(&self, table: &HashMap<u32, Cached>) -> Vec<TopEntry> {
+        let mut candidates: Vec<(u32, u32)> = self
+            .previous
+            .iter()
+            .chain(self.current.iter().map(|Reverse((_, pid))| pid))
+            .filter_map(|pid| table.get(pid).map(|c| (score_bits((self.key)(c)), *pid)))
+            .collect();
+        candidates.sort_unstable_by(|a, b| b.cmp(a));
+        candidates.dedup();
+        candidates
+            .into_iter()
+            .take(self.k)
+            .map(|(_, pid)| {
+                let cached = table[&pid];
+                TopEntry { pid, cpu: cached.cpu, rss: cached.rss }
+            })
+            .collect()
+    }
+}
+
+/// 增量 Top-K 进程采样器
+pub struct ProcessSampler<S: ProcessSource> {
+    source: S,
+    refresh_budget: usize,
+    list_every: u32,
+    samples: u32,
+    pids: Vec<u32>,
+    cursor: usize,
+    table: HashMap<u32, Cached>,
+    by_cpu: RoundTopK,
+    by_rss: RoundTopK,
+    /// 已发送过名称的 PID
+    named: HashSet<u32>,
+    scratch: Vec<ProcStat>,
+}
+
+impl<S: ProcessSource> ProcessSampler<S> {
+    /// `k`: 每个榜单条目数；`refresh_budget`: 每次采样最多刷新的进程数；
+    /// `list_every`: 每隔多少次采样刷新一次进程列表
+    pub fn new(source: S, k: usize, refresh_budget: usize, list_every: u32) -> Self {
+        Self {
+            source,
+            refresh_budget: refresh_budget.max(1),
+            list_every: list_every.max(1),
+            samples: 0,
+            pids: Vec::new(),
+            cursor: 0,
+            table: HashMap::new(),
+            by_cpu: RoundTopK::new(k, |c| c.cpu),
+            by_rss: RoundTopK::new(k, |c| c.rss as f32),
+            named: HashSet::new(),
+            scratch: Vec::with_capacity(refresh_budget),
+        }
+    }
+
+    /// 执行一次增量采样
+    pub fn sample(&mut self) -> ProcessReport {
+        if self.samples % self.list_every == 0 {
+            // 排序后轮转游标在两次列表刷新之间保持有效 (游标位置不重置)
+            self.source.list(&mut self.pids);
+            self.pids.sort_unstable();
+            let pids = &self.pids;
+            self.table.retain(|pid, _| pids.binary_search(pid).is_ok());
+            self.named.retain(|pid| pids.binary_search(pid).is_ok());
+        }
+        if self.samples % NAME_RESEND_SAMPLES == 0 {
+            self.named.clear();
+        }
+        self.samples = self.samples.wrapping_add(1);
+
+        // 轮转刷新一批进程
+        if !self.pids.is_empty() {
+            let start = self.cursor.min(self.pids.len());
+            let end = (start + self.refresh_budget).min(self.pids.len());
+            self.scratch.clear();
+            self.source.refresh(&self.pids[start..end], &mut self.scratch);
+            for stat in &self.scratch {
+                let cached = Cached { cpu: stat.cpu, rss: stat.rss };
+                self.table.insert(stat.pid, cached);
+                self.by_cpu.push(stat.pid, &cached);
+                self.by_rss.push(stat.pid, &cached);
+            }
+            if end == self.pids.len() {
+                self.cursor = 0;
+                self.by_cpu.finish_round();
+                self.by_rss.finish_round();
+            } else {
+                self.cursor = end;
+            }
+        }
+
+        let top_cpu = self.by_cpu.top(&self.table);
+        let top_rss = self.by_rss.top(&self.table);
+
+        let mut names = Vec::new();
+        for entry in top_cpu.iter().chain(top_rss.iter()) {
+            if self.named.insert(entry.pid) {
+                if let Some(name) = self.source.name(entry.pid) {
+                    names.push((entry.pid, name));
+                }
+            }
+        }
+
+        ProcessReport { top_cpu, top_rss, names }
+    }
+}
+
+/// 在独立线程上按 `period` 运行 sysinfo 进程采样器，返回报告接收端
+pub fn spawn_sampler(period: Duration, k: usize, refresh_budget: usize, list_every: u32) -> Receiver<ProcessReport> {
+    let (tx, rx) = mpsc::sync_channel(REPORT_BACKLOG);
+    thread::spawn(move || {
+        let mut sampler = ProcessSampler::new(SysinfoProcesses::new(), k, refresh_budget, list_every);
+        loop {
+            if tx.send(sampler.sample()).is_err() {
+                break;
+            }
+            thread::sleep(period);
+        }
+    });
+    rx
+}
@@ -0,0 +1,199 @@
+//! 多主机聚合中继
+//!
+//! 中继模式下服务端不采集本机，而是像 3DS 客户端一样 (UDP HELLO 心跳) 订阅 N 个上游
+//! holographic-monitor，把各主机的帧合并成一路流，再通过同一套扇出发给 3DS 和 Web 客户端:
+//! - 每台上游按命令行顺序分配紧凑的主机 ID (0..N)
+//! - 动态帧: 上游帧去掉静态字段后加上 `"host":id`，保留上游自己的 `seq`/`sample_ms`
+//! - 静态信息 (主机名、系统、CPU 型号等): `{"host":id,"static":{...}}`，只在首次出现或
+//!   变化时广播一次；之后连接的客户端在注册时补发一次
+//! - 每个推送周期每台主机只转发最新一帧
+//!
+//! 每个上游由独立任务订阅，解码与重新编码在任务内 (多线程运行时上并发) 完成，
+//! 共享表只在写入结果时短暂加锁
+
+use crate::stats::STATS;
+use serde_json::{Map, Value};
+use std::{
+    net::{IpAddr, SocketAddr},
+    sync::{Arc, Mutex},
+    time::{Duration, Instant},
+};
+use tokio::{net::UdpSocket, time::interval};
+
+/// 向上游发送心跳的间隔 (上游 3DS 客户端超时为 10 秒)
+const UPSTREAM_HEARTBEAT: Duration = Duration::from_secs(2);
+/// 超过该时间没有收到帧的上游视为离线
+const UPSTREAM_TIMEOUT: Duration = Duration::from_secs(3);
+
+/// 只需发送一次的静态字段
+const STATIC_FIELDS: &[&str] = &["hostname", "os_name", "kernel_version", "cpu_model", "cpu_cores", "resolution"];
+
+/// 单台上游主机的状态
+#[derive(Default)]
+struct Host {
+    /// 最近一次的静态信息消息
+    statics: Option<String>,
+    /// 尚未转发的最新帧
+    latest: Option<String>,
+    last_frame: Option<Instant>,
+}
+
+#[derive(Default)]
+struct Table {
+    hosts: Vec<Host>,
+    /// 尚未转发的静态信息消息 (先于帧发送)
+    announce: Vec<String>,
+}
+
+/// 聚合中继
+pub struct Relay {
+    upstreams: Vec<SocketAddr>,
+    table: Mutex<Table>,
+}
+
+impl Relay {
+    pub fn new(upstreams: Vec<SocketAddr>) -> Arc<Self> {
+        let hosts = upstreams.iter().map(|_| Host::default()).collect();
+        Arc::new(Self {
+            upstreams,
+            table: Mutex::new(Table { hosts, announce: Vec::new() }),
+        })
+    }
+
+    pub fn upstreams(&self) -> &[SocketAddr] {
+        &self.upstreams
+    }
+
+    /// 为每个上游启动一个订阅任务
+    pub fn spawn_upstreams(self: &Arc<Self>) {
+        for id in 0..self.upstreams.len() {
+            tokio::spawn(self.clone().subscribe(id));
+        }
+    }
+
+    /// 订阅一个上游: 周期性发送 HELLO，收到的帧交给 `ingest`
+    pub async fn subscribe(self: Arc<Self>, id: usize) {
+        let addr = self.upstreams[id];
+        let bind = if addr.is_ipv4() { "0.0.0.0:0" } else { "[::]:0" };
+        let socket = match UdpSocket::bind(bind).await {
+            Ok(socket) => socket,
+            Err(e) => {
+                println!("❌ 上游 #{} {} 订阅失败: {}", id, addr, e);
+                return;
+            }
+        };
+        if let Err(e) = socket.connect(addr).await {
+            println!("❌ 上游 #{} {} 订阅失败: {}", id, addr, e);
+            return;
+        }
+
+        let mut buf = vec![0u8; 65536];
+        let mut heartbeat = interval(UPSTREAM_HEARTBEAT);
+        loop {
+            tokio::select! {
+                _ = heartbeat.tick() => {
+                    let _ = socket.send(b"HELLO").await;
+                }
+                result = socket.recv(&mut buf) => {
+                    // 上游未启动时会收到 ICMP 端口不可达，下次心跳重试
+                    if let Ok(len) = result {
+                        self.ingest(id, &buf[..len]);
+                    }
+                }
+            }
+        }
+    }
+
+    /// 处理上游 `id` 的一个数据报: 拆出静态信息，加上主机 ID 重新编码
+    pub fn ingest(&self, id: usize, datagram: &[u8]) {
+        // 上游只会回复数据帧 (HELLO 没有应答)，其他消息直接忽略
+        if datagram.first() != Some(&b'{') {
+            return;
+        }
+        let started = Instant::now();
+        let mut frame = match serde_json::from_slice::<Map<String, Value>>(datagram) {
+            Ok(frame) => frame,
+            Err(_) => {
+                STATS.relay_decode_errors.inc();
+                return;
+            }
+        };
+
+        let mut statics = Map::new();
+        for key in STATIC_FIELDS {
+            if let Some(value) = frame.remove(*key) {
+                if !value.is_null() {
+                    statics.insert(key.to_string(), value);
+                }
+            }
+        }
+        frame.insert("host".to_string(), id.into());
+        let json = Value::Object(frame).to_string();
+        let announce = (!statics.is_empty())
+            .then(|| serde_json::json!({ "host": id, "static": statics }).to_string());
+
+        {
+            let mut table = self.table.lock().unwrap();
+            let Table { hosts, announce: queue } = &mut *table;
+            let Some(host) = hosts.get_mut(id) else { return };
+            if let Some(announce) = announce {
+                if host.statics.as_deref() != Some(announce.as_str()) {
+                    if host.statics.is_none() {
+                        println!("🛰️  上游 #{} 已上线: {}", id, self.upstreams[id]);
+                    }
+                    queue.push(announce.clone());
+                    host.statics = Some(announce);
+                }
+            }
+            host.latest = Some(json);
+            host.last_frame = Some(Instant::now());
+        }
+        STATS.relay_ingest_seconds.observe_since(started);
+        STATS.relay_frames.inc();
+    }
+
+    /// 取出待转发的消息 (静态信息在前，随后是每台主机的最新帧)，写入 `out` (复用缓冲)
+    pub fn drain(&self, out: &mut Vec<String>) {
+        out.clear();
+        let now = Instant::now();
+        let mut table = self.table.lock().unwrap();
+        out.append(&mut table.announce);
+        let mut live = 0;
+        for host in &mut table.hosts {
+            out.extend(host.latest.take());
+            if host.last_frame.is_some_and(|at| now.saturating_duration_since(at) < UPSTREAM_TIMEOUT) {
+                live += 1;
+            }
+        }
+        STATS.relay_upstreams.set(live);
+    }
+
+    /// 全部已知主机的静态信息 (新客户端连接时补发)
+    pub fn intro(&self) -> Vec<String> {
+        let table = self.table.lock().unwrap();
+        table.hosts.iter().filter_map(|host| host.statics.clone()).collect()
+    }
+
+    /// 尚未转发的帧数 (不含静态信息)
+    pub fn pending(&self) -> usize {
+        let table = self.table.lock().unwrap();
+        table.hosts.iter().filter(|host| host.latest.is_some()).count()
+    }
+}
+
+/// 解析上游列表 (逗号分隔的 `host[:port]`，省略端口时使用 `default_port`)
+pub async fn resolve(list: &str, default_port: u16) -> std::io::Result<Vec<SocketAddr>> {
+    let mut addrs = Vec::new();
+    for entry in list.split(',').map(str::trim).filter(|e| !e.is_empty()) {
+        if let Ok(ip) = entry.parse::<IpAddr>() {
+            addrs.push(SocketAddr::new(ip, default_port));
+            continue;
+        }
+        let target = if entry.contains(':') { entry.to_string() } else { format!("{}:{}", entry, default_port) };
+        let addr = tokio::net::lookup_host(&target).await?.next().ok_or_else(|| {
+            std::io::Error::new(std::io::ErrorKind::NotFound, format!("无法解析上游地址: {}", entry))
+        })?;
+        addrs.push(addr);
+    }
+    Ok(addrs)
+}
@@ -0,0 +1,59 @@
+//! 共享内存外部指标
+//!
+//! `--shm` 启用后服务端创建共享内存段 (布局见 `holo-shm` crate)，外部进程用
+//! [`holo_shm::Producer`] 或 C 头文件 `shm/include/holo_shm.h` 写入指标。
+//! [`GaugeBackend`] 包装原有后端，每次采样后读取全部槽位，填入 `SystemMetrics::gauges`:
+//! - 读取是若干次原子加载，不经过系统调用，也不会因生产者卡住而阻塞 (重试有上限)
+//! - 超过 [`MAX_AGE_MS`] 未更新的指标视为生产者已退出，不再上报
+
+use crate::monitor::{Backend, ExternalGauge, SystemMetrics};
+use crate::stats::STATS;
+use holo_shm::Reading;
+use std::time::Duration;
+
+pub use holo_shm::{Reader, DEFAULT_SLOTS};
+
+/// 超过该时长未更新的指标不再上报 (毫秒)
+pub const MAX_AGE_MS: u64 = 30_000;
+
+/// 在原有后端的结果上附加共享内存中的外部指标
+pub struct GaugeBackend {
+    inner: Box<dyn Backend>,
+    reader: Reader,
+    readings: Vec<Reading>,
+}
+
+impl GaugeBackend {
+    /// `reader` 由 [`Reader::create`] 创建 (或打开已有的) 共享内存段
+    pub fn new(inner: Box<dyn Backend>, reader: Reader) -> Self {
+        let readings = Vec::with_capacity(reader.slot_count());
+        Self { inner, reader, readings }
+    }
+
+    /// 读取当前的外部指标 (按槽位顺序)
+    pub fn read_into(&mut self, gauges: &mut Vec<ExternalGauge>) {
+        let contended = self.reader.read(holo_shm::now_ms(), MAX_AGE_MS, &mut self.readings);
+        STATS.shm_contended.add(contended as u64);
+        STATS.shm_gauges.set(self.readings.len() as i64);
+        gauges.clear();
+        gauges.extend(self.readings.iter().map(|r| ExternalGauge {
+            id: r.id,
+            name: r.name().to_string(),
+            value: r.value,
+        }));
+    }
+}
+
+impl Backend for GaugeBackend {
+    fn refresh(&mut self) -> SystemMetrics {
+        let mut metrics = self.inner.refresh();
+        let mut gauges = std::mem::take(&mut metrics.gauges);
+        self.read_into(&mut gauges);
+        metrics.gauges = gauges;
+        metrics
+    }
+
+    fn first_sample_delay(&self) -> Duration {
+        self.inner.first_sample_delay()
+    }
+}
@@ -0,0 +1,468 @@
+//! 服务端自身性能指标
+//!
+//! 以 Prometheus 文本格式在独立端口上导出 (`/metrics`)，用于发现仪表盘服务端
+//! 本身占用被监控机器的 CPU。记录路径只做原子加法:
+//! - 直方图的桶、总和与计数都是 `AtomicU64`，以整数基本单位 (纳秒/字节) 累加
+//! - 全部指标位于静态变量 [`STATS`] 中，记录时不加锁、不分配
+//!
+//! 只有导出时才格式化文本，导出频率由抓取方决定
+
+use std::fmt::Write as _;
+use std::net::SocketAddr;
+use std::sync::atomic::{AtomicI64, AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+use tokio::io::{AsyncReadExt, AsyncWriteExt};
+use tokio::net::TcpListener;
+
+/// 直方图最多的桶数 (含 +Inf)
+const MAX_BUCKETS: usize = 16;
+
+/// 耗时直方图的桶上界 (纳秒): 50µs .. 2.5s
+const DURATION_BOUNDS_NS: &[u64] = &[
+    50_000, 100_000, 250_000, 500_000, 1_000_000, 2_500_000, 5_000_000, 10_000_000, 25_000_000,
+    50_000_000, 100_000_000, 250_000_000, 500_000_000, 1_000_000_000, 2_500_000_000,
+];
+
+/// 慢操作 (子进程) 耗时直方图的桶上界 (纳秒): 1ms .. 10s
+const SLOW_DURATION_BOUNDS_NS: &[u64] = &[
+    1_000_000, 5_000_000, 10_000_000, 25_000_000, 50_000_000, 100_000_000, 250_000_000,
+    500_000_000, 1_000_000_000, 2_500_000_000, 5_000_000_000, 10_000_000_000,
+];
+
+/// 字节数直方图的桶上界
+const BYTES_BOUNDS: &[u64] = &[128, 256, 512, 1024, 1400, 2048, 4096, 8192, 16384, 65536];
+
+/// 纳秒 → 秒
+const NANOS: f64 = 1e-9;
+
+#[allow(clippy::declare_interior_mutable_const)]
+const ZERO: AtomicU64 = AtomicU64::new(0);
+
+/// 固定桶直方图
+pub struct Histogram {
+    name: &'static str,
+    help: &'static str,
+    /// 同名直方图族中的 `collector` 标签值
+    collector: Option<&'static str>,
+    /// 桶上界 (基本单位)，最后隐含 +Inf
+    bounds: &'static [u64],
+    /// 导出时基本单位到 Prometheus 单位的换算系数
+    scale: f64,
+    buckets: [AtomicU64; MAX_BUCKETS],
+    sum: AtomicU64,
+    count: AtomicU64,
+}
+
+impl Histogram {
+    const fn new(name: &'static str, help: &'static str, bounds: &'static [u64], scale: f64) -> Self {
+        assert!(bounds.len() < MAX_BUCKETS);
+        Self {
+            name,
+            help,
+            collector: None,
+            bounds,
+            scale,
+            buckets: [ZERO; MAX_BUCKETS],
+            sum: ZERO,
+            count: ZERO,
+        }
+    }
+
+    /// 采集器耗时直方图族的一员 (以 `collector` 标签区分)
+    const fn collector(name: &'static str) -> Self {
+        let mut histogram = Self::new(
+            "holo_collector_seconds",
+            "Per-collector sample duration",
+            DURATION_BOUNDS_NS,
+            NANOS,
+        );
+        histogram.collector = Some(name);
+        histogram
+    }
+
+    /// 记录一个值 (基本单位)
+    pub fn observe(&self, value: u64) {
+        let index = self.bounds.iter().position(|b| value <= *b).unwrap_or(self.bounds.len());
+        self.buckets[index].fetch_add(1, Ordering::Relaxed);
+        self.sum.fetch_add(value, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+    }
+
+    /// 记录一段耗时 (仅用于纳秒单位的直方图)
+    pub fn observe_duration(&self, elapsed: Duration) {
+        self.observe(elapsed.as_nanos().min(u64::MAX as u128) as u64);
+    }
+
+    /// 记录从 `started` 到现在的耗时
+    pub fn observe_since(&self, started: Instant) {
+        self.observe_duration(started.elapsed());
+    }
+
+    fn render(&self, out: &mut String) {
+        self.render_header(out);
+        self.render_series(out);
+    }
+
+    fn render_header(&self, out: &mut String) {
+        let _ = writeln!(out, "# HELP {} {}", self.name, self.help);
+        let _ = writeln!(out, "# TYPE {} histogram", self.name);
+    }
+
+    fn render_series(&self, out: &mut String) {
+        let (labels, sep) = match self.collector {
+            Some(collector) => (format!("collector=\"{}\"", collector), ","),
+            None => (String::new(), ""),
+        };
+        let mut cumulative = 0;
+        for (bound, bucket) in self.bounds.iter().zip(&self.buckets) {
+            cumulative += bucket.load(Ordering::Relaxed);
+            let le = *bound as f64 * self.scale;
+            let _ = writeln!(out, "{}_bucket{{{}{}le=\"{}\"}} {}", self.name, labels, sep, le, cumulative);
+        }
+        cumulative += self.buckets[self.bounds.len()].load(Ordering::Relaxed);
+        let _ = writeln!(out, "{}_bucket{{{}{}le=\"+Inf\"}} {}", self.name, labels, sep, cumulative);
+        let labels = if labels.is_empty() { labels } else { format!("{{{}}}", labels) };
+        let sum = self.sum.load(Ordering::Relaxed) as f64 * self.scale;
+        let _ = writeln!(out, "{}_sum{} {}", self.name, labels, sum);
+        let _ = writeln!(out, "{}_count{} {}", self.name, labels, self.count.load(Ordering::Relaxed));
+    }
+}
+
+/// 单调递增计数器
+pub struct Counter {
+    name: &'static str,
+    help: &'static str,
+    value: AtomicU64,
+}
+
+impl Counter {
+    const fn new(name: &'static str, help: &'static str) -> Self {
+        Self { name, help, value: ZERO }
+    }
+
+    pub fn inc(&self) {
+        self.add(1);
+    }
+
+    pub fn add(&self, n: u64) {
+        self.value.fetch_add(n, Ordering::Relaxed);
+    }
+
+    fn render(&self, out: &mut String) {
+        let _ = writeln!(out, "# HELP {} {}", self.name, self.help);
+        let _ = writeln!(out, "# TYPE {} counter", self.name);
+        let _ = writeln!(out, "{} {}", self.name, self.value.load(Ordering::Relaxed));
+    }
+}
+
+/// 可增可减的瞬时值
+pub struct Gauge {
+    name: &'static str,
+    help: &'static str,
+    value: AtomicI64,
+}
+
+impl Gauge {
+    const fn new(name: &'static str, help: &'static str) -> Self {
+        Self { name, help, value: AtomicI64::new(0) }
+    }
+
+    pub fn set(&self, value: i64) {
+        self.value.store(value, Ordering::Relaxed);
+    }
+
+    pub fn inc(&self) {
+        self.value.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub fn dec(&self) {
+        self.value.fetch_sub(1, Ordering::Relaxed);
+    }
+
+    fn render(&self, out: &mut String) {
+        let _ = writeln!(out, "# HELP {} {}", self.name, self.help);
+        let _ = writeln!(out, "# TYPE {} gauge", self.name);
+        let _ = writeln!(out, "{} {}", self.name, self.value.load(Ordering::Relaxed));
+    }
+}
+
+/// 服务端自身指标
+pub struct ServerStats {
+    pub refresh_seconds: Histogram,
+    pub sensor_seconds: Histogram,
+    pub serialize_seconds: Histogram,
+    pub serialize_bytes: Histogram,
+    pub fanout_seconds: Histogram,
+    pub fan_command_seconds: Histogram,
+    pub tick_jitter_seconds: Histogram,
+    pub relay_ingest_seconds: Histogram,
+    pub ws_deflate_seconds: Histogram,
+    pub alert_seconds: Histogram,
+    pub collectors: CollectorStats,
+    pub frames: Counter,
+    pub encodings: Counter,
+    pub udp_sent_bytes: Counter,
+    pub ws_sent_bytes: Counter,
+    pub ticks_skipped: Counter,
+    pub udp_send_errors: Counter,
+    pub udp_split_frames: Counter,
+    pub udp_oversize_drops: Counter,
+    pub ws_lagged_frames: Counter,
+    pub ws_dropped: Counter,
+    pub relay_frames: Counter,
+    pub relay_decode_errors: Counter,
+    pub shm_contended: Counter,
+    pub alert_events: Counter,
+    pub http_requests: Counter,
+    pub http_not_modified: Counter,
+    pub http_sent_bytes: Counter,
+    pub fan_helper_starts: Counter,
+    pub udp_clients: Gauge,
+    pub ws_clients: Gauge,
+    pub subscriptions: Gauge,
+    pub relay_upstreams: Gauge,
+    pub shm_gauges: Gauge,
+    pub alerts_active: Gauge,
+    pub cgroups_tracked: Gauge,
+}
+
+/// 各采集器的单次采集耗时
+pub struct CollectorStats {
+    pub host: Histogram,
+    pub sensor: Histogram,
+    pub battery: Histogram,
+    pub cgroups: Histogram,
+}
+
+impl CollectorStats {
+    fn all(&self) -> [&Histogram; 4] {
+        [&self.host, &self.sensor, &self.battery, &self.cgroups]
+    }
+}
+
+/// 全局指标实例
+pub static STATS: ServerStats = ServerStats {
+    refresh_seconds: Histogram::new(
+        "holo_refresh_seconds",
+        "Backend refresh duration per tick",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    sensor_seconds: Histogram::new(
+        "holo_sensor_seconds",
+        "temp_sensor subprocess latency",
+        SLOW_DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    serialize_seconds: Histogram::new(
+        "holo_serialize_seconds",
+        "Frame serialization duration",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    serialize_bytes: Histogram::new("holo_serialize_bytes", "Serialized frame size", BYTES_BOUNDS, 1.0),
+    fanout_seconds: Histogram::new(
+        "holo_fanout_seconds",
+        "Per-tick fan-out duration (WebSocket broadcast and UDP sends)",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    fan_command_seconds: Histogram::new(
+        "holo_fan_command_seconds",
+        "FAN command latency",
+        SLOW_DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    tick_jitter_seconds: Histogram::new(
+        "holo_tick_jitter_seconds",
+        "Delay between a push tick's deadline and when it actually ran",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    relay_ingest_seconds: Histogram::new(
+        "holo_relay_ingest_seconds",
+        "Relay mode: decode and re-encode of one upstream frame",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    ws_deflate_seconds: Histogram::new(
+        "holo_ws_deflate_seconds",
+        "Per-message compression for WebSocket clients on the deflate format",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    alert_seconds: Histogram::new(
+        "holo_alert_seconds",
+        "Per-tick alert engine update (statistics and rule evaluation)",
+        DURATION_BOUNDS_NS,
+        NANOS,
+    ),
+    collectors: CollectorStats {
+        host: Histogram::collector("host"),
+        sensor: Histogram::collector("sensor"),
+        battery: Histogram::collector("battery"),
+        cgroups: Histogram::collector("cgroups"),
+    },
+    frames: Counter::new("holo_frames_total", "Frames pushed"),
+    encodings: Counter::new("holo_encodings_total", "Frame encodings (one per distinct field subscription per tick)"),
+    udp_sent_bytes: Counter::new("holo_udp_sent_bytes_total", "Payload bytes sent to 3DS (UDP) clients"),
+    ws_sent_bytes: Counter::new("holo_ws_sent_bytes_total", "Payload bytes sent to WebSocket clients"),
+    ticks_skipped: Counter::new("holo_ticks_skipped_total", "Push ticks skipped after a stall"),
+    udp_send_errors: Counter::new("holo_udp_send_errors_total", "Failed UDP sends"),
+    udp_split_frames: Counter::new(
+        "holo_udp_split_frames_total",
+        "Frames split into several datagrams for 3DS clients that declared an MTU",
+    ),
+    udp_oversize_drops: Counter::new(
+        "holo_udp_oversize_drops_total",
+        "Field chunks or whole frames dropped because they exceed a 3DS client's reassembly limits",
+    ),
+    ws_lagged_frames: Counter::new(
+        "holo_ws_lagged_frames_total",
+        "Frames skipped by WebSocket clients that fell behind the broadcast",
+    ),
+    ws_dropped: Counter::new("holo_ws_dropped_total", "WebSocket connections dropped on send failure"),
+    relay_frames: Counter::new("holo_relay_frames_total", "Relay mode: frames received from upstream servers"),
+    relay_decode_errors: Counter::new("holo_relay_decode_errors_total", "Relay mode: upstream datagrams that failed to decode"),
+    shm_contended: Counter::new(
+        "holo_shm_contended_total",
+        "Shared-memory slots skipped because a producer kept writing during the read",
+    ),
+    alert_events: Counter::new("holo_alert_events_total", "Alert events pushed (state changes and repeats)"),
+    http_requests: Counter::new("holo_http_requests_total", "Embedded web dashboard HTTP requests"),
+    http_not_modified: Counter::new("holo_http_not_modified_total", "HTTP requests answered 304 from a matching ETag"),
+    http_sent_bytes: Counter::new("holo_http_sent_bytes_total", "HTTP response bytes sent (headers and bodies)"),
+    fan_helper_starts: Counter::new("holo_fan_helper_starts_total", "Fan control helper processes started"),
+    udp_clients: Gauge::new("holo_udp_clients", "Registered 3DS (UDP) clients"),
+    ws_clients: Gauge::new("holo_ws_clients", "Connected WebSocket clients"),
+    subscriptions: Gauge::new("holo_subscriptions", "Distinct field subscriptions encoded in the last tick"),
+    relay_upstreams: Gauge::new("holo_relay_upstreams", "Relay mode: upstream servers that sent a frame recently"),
+    shm_gauges: Gauge::new("holo_shm_gauges", "Live external gauges read from shared memory in the last tick"),
+    alerts_active: Gauge::new("holo_alerts_active", "Alert rules currently firing"),
+    cgroups_tracked: Gauge::new("holo_cgroups_tracked", "cgroups tracked by the cgroup/PSI collector"),
+};
+
+impl ServerStats {
+    /// 以 Prometheus 文本格式输出全部指标
+    pub fn render(&self, out: &mut String) {
+        for histogram in [
+            &self.refresh_seconds,
+            &self.sensor_seconds,
+            &self.serialize_seconds,
+            &self.serialize_bytes,
+            &self.fanout_seconds,
+            &self.fan_command_seconds,
+            &self.tick_jitter_seconds,
+            &self.relay_ingest_seconds,
+            &self.ws_deflate_seconds,
+            &self.alert_seconds,
+        ] {
+            histogram.render(out);
+        }
+        let collectors = self.collectors.all();
+        collectors[0].render_header(out);
+        for histogram in collectors {
+            histogram.render_series(out);
+        }
+        for counter in [
+            &self.frames,
+            &self.encodings,
+            &self.udp_sent_bytes,
+            &self.ws_sent_bytes,
+            &self.ticks_skipped,
+            &self.udp_send_errors,
+            &self.udp_split_frames,
+            &self.udp_oversize_drops,
+            &self.ws_lagged_frames,
+            &self.ws_dropped,
+            &self.relay_frames,
+            &self.relay_decode_errors,
+            &self.shm_contended,
+            &self.alert_events,
+            &self.http_requests,
+            &self.http_not_modified,
+            &self.http_sent_bytes,
+            &self.fan_helper_starts,
+        ] {
+            counter.render(out);
+        }
+        self.udp_clients.render(out);
+        self.ws_clients.render(out);
+        self.subscriptions.render(out);
+        self.relay_upstreams.render(out);
+        self.shm_gauges.render(out);
+        self.alerts_active.render(out);
+        self.cgroups_tracked.render(out);
+        render_process(out);
+    }
+}
+
+/// 本进程的 CPU 时间与常驻内存 (Linux)
+#[cfg(target_os = "linux")]
+fn render_process(out: &mut String) {
+    /// /proc/self/stat 的时钟频率 (USER_HZ，Linux 上固定为 100)
+    const USER_HZ: f64 = 100.0;
+
+    if let Ok(stat) = std::fs::read_to_string("/proc/self/stat") {
+        // comm 可能含空格，从右括号之后开始数字段: utime 与 stime 为第 12、13 个
+        let ticks: u64 = stat
+            .rsplit_once(')')
+            .map(|(_, rest)| rest.split_whitespace().skip(11).take(2).filter_map(|f| f.parse::<u64>().ok()).sum())
+            .unwrap_or(0);
+        let _ = writeln!(out, "# HELP process_cpu_seconds_total Total user and system CPU time");
+        let _ = writeln!(out, "# TYPE process_cpu_seconds_total counter");
+        let _ = writeln!(out, "process_cpu_seconds_total {}", ticks as f64 / USER_HZ);
+    }
+    if let Ok(status) = std::fs::read_to_string("/proc/self/status") {
+        if let Some(kb) = status
+            .lines()
+            .find_map(|l| l.strip_prefix("VmRSS:"))
+            .and_then(|v| v.split_whitespace().next())
+            .and_then(|v| v.parse::<u64>().ok())
+        {
+            let _ = writeln!(out, "# HELP process_resident_memory_bytes Resident memory size");
+            let _ = writeln!(out, "# TYPE process_resident_memory_bytes gauge");
+            let _ = writeln!(out, "process_resident_memory_bytes {}", kb * 1024);
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn render_process(_out: &mut String) {}
+
+/// accept 失败 (例如文件描述符耗尽) 后重试前的等待，错误持续时不空转
+pub const ACCEPT_BACKOFF: Duration = Duration::from_millis(100);
+
+/// 在 `addr` 上提供 `/metrics` (最小 HTTP/1.1，每个请求后关闭连接)
+///
+/// 只有绑定失败时返回错误；accept 失败是暂时的 (连接在握手后被重置、描述符耗尽)，记录后继续
+pub async fn serve(addr: SocketAddr) -> std::io::Result<()> {
+    let listener = TcpListener::bind(addr).await?;
+    loop {
+        let mut stream = match listener.accept().await {
+            Ok((stream, _)) => stream,
+            Err(e) => {
+                println!("⚠️  性能指标端点 accept 失败: {}", e);
+                tokio::time::sleep(ACCEPT_BACKOFF).await;
+                continue;
+            }
+        };
+        tokio::spawn(async move {
+            let mut request = [0u8; 1024];
+            let Ok(n) = stream.read(&mut request).await else { return };
+            let is_metrics = request[..n].starts_with(b"GET /metrics ");
+            let response = if is_metrics {
+                let mut body = String::with_capacity(8192);
+                STATS.render(&mut body);
+                format!(
+                    "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+                    body.len(),
+                    body
+                )
+            } else {
+                "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n".to_string()
+            };
+            let _ = stream.write_all(response.as_bytes()).await;
+        });
+    }
+}
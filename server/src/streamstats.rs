@@ -0,0 +1,202 @@
+//! 增量流式统计
+//!
+//! 告警引擎 (见 [`crate::alerts`]) 对指标流维护的统计量。每个样本 O(1) (滑动极值为均摊 O(1))，
+//! 容量在创建时按窗口长度固定，运行中不再分配:
+//! - [`Ewma`]: 指数加权移动平均
+//! - [`SlidingExtreme`]: 滑动窗口最小值/最大值 (单调队列)
+//! - [`SlidingRate`]: 滑动窗口变化率
+//! - [`QuantileSketch`]: 对数分桶的近似分位数
+
+use std::collections::VecDeque;
+
+/// 指数加权移动平均
+#[derive(Debug, Clone)]
+pub struct Ewma {
+    alpha: f32,
+    value: Option<f32>,
+}
+
+impl Ewma {
+    /// 半衰期 `samples` 个样本: 一个样本的权重经过这么多个样本后减半
+    pub fn with_half_life(samples: f32) -> Self {
+        let alpha = 1.0 - 0.5f32.powf(1.0 / samples.max(1.0));
+        Self { alpha, value: None }
+    }
+
+    pub fn push(&mut self, x: f32) -> f32 {
+        let value = match self.value {
+            Some(v) => v + self.alpha * (x - v),
+            None => x,
+        };
+        self.value = Some(value);
+        value
+    }
+
+    pub fn value(&self) -> Option<f32> {
+        self.value
+    }
+}
+
+/// 最近 `window` 个样本的最小值或最大值
+///
+/// 单调队列: 新样本入队前弹出队尾所有不可能再成为极值的样本，队首即当前极值。
+/// 每个样本至多入队、出队各一次
+#[derive(Debug, Clone)]
+pub struct SlidingExtreme {
+    window: u64,
+    max: bool,
+    /// (样本序号, 值)，按序号递增，值单调
+    deque: VecDeque<(u64, f32)>,
+    next: u64,
+}
+
+impl SlidingExtreme {
+    pub fn min(window: usize) -> Self {
+        Self::new(window, false)
+    }
+
+    pub fn max(window: usize) -> Self {
+        Self::new(window, true)
+    }
+
+    fn new(window: usize, max: bool) -> Self {
+        let window = window.max(1);
+        Self { window: window as u64, max, deque: VecDeque::with_capacity(window + 1), next: 0 }
+    }
+
+    /// 加入一个样本，返回窗口内的极值
+    pub fn push(&mut self, x: f32) -> f32 {
+        while let Some(&(_, back)) = self.deque.back() {
+            let dominated = if self.max { back <= x } else { back >= x };
+            if !dominated {
+                break;
+            }
+            self.deque.pop_back();
+        }
+        self.deque.push_back((self.next, x));
+        while let Some(&(index, _)) = self.deque.front() {
+            if index + self.window > self.next {
+                break;
+            }
+            self.deque.pop_front();
+        }
+        self.next += 1;
+        self.deque.front().map_or(x, |&(_, v)| v)
+    }
+
+    /// 窗口是否已经填满 (此前的极值只覆盖了部分窗口)
+    pub fn full(&self) -> bool {
+        self.next >= self.window
+    }
+}
+
+/// 滑动窗口变化率: 当前值与 `window` 个样本之前的值之差除以两者的时间间隔 (每秒)
+#[derive(Debug, Clone)]
+pub struct SlidingRate {
+    /// (采样时间毫秒, 值) 环形缓冲区
+    ring: Box<[(u64, f32)]>,
+    head: usize,
+    len: usize,
+}
+
+impl SlidingRate {
+    pub fn new(window: usize) -> Self {
+        Self { ring: vec![(0, 0.0); window.max(1) + 1].into_boxed_slice(), head: 0, len: 0 }
+    }
+
+    /// 加入一个样本；窗口填满之前返回 None
+    pub fn push(&mut self, t_ms: u64, x: f32) -> Option<f32> {
+        let cap = self.ring.len();
+        self.ring[self.head] = (t_ms, x);
+        self.head = (self.head + 1) % cap;
+        if self.len < cap {
+            self.len += 1;
+            if self.len < cap {
+                return None;
+            }
+        }
+        // 环形缓冲区已满: head 指向最旧的样本
+        let (t0, x0) = self.ring[self.head];
+        let dt = t_ms.saturating_sub(t0);
+        (dt > 0).then(|| (x - x0) * 1000.0 / dt as f32)
+    }
+}
+
+/// 分位数草图的桶数
+const SKETCH_BUCKETS: usize = 640;
+/// 相邻桶的比值: 桶内取几何中点时相对误差约 2%
+const SKETCH_GAMMA: f32 = 1.04;
+/// 最小的非零桶下界；更小的值 (含负值) 计入零桶
+const SKETCH_MIN: f32 = 0.01;
+
+/// 对数分桶的近似分位数 (相对误差约 2%，覆盖 0.01 .. 约 8e8)
+///
+/// 窗口由两个半窗口轮换近似: 每个半窗口计满 `window / 2` 个样本后清空较旧的一个，
+/// 查询合并两者，覆盖最近 `window / 2` 到 `window` 个样本。
+/// 插入 O(1)，清空 O(桶数) 每半窗口一次；查询 O(桶数)，与规则数无关
+#[derive(Debug, Clone)]
+pub struct QuantileSketch {
+    counts: [Box<[u32]>; 2],
+    totals: [u32; 2],
+    current: usize,
+    half: u32,
+    inv_ln_gamma: f32,
+}
+
+impl QuantileSketch {
+    pub fn new(window: usize) -> Self {
+        // 下标 0 是零桶
+        let buckets = || vec![0u32; SKETCH_BUCKETS + 1].into_boxed_slice();
+        Self {
+            counts: [buckets(), buckets()],
+            totals: [0; 2],
+            current: 0,
+            half: (window / 2).max(1) as u32,
+            inv_ln_gamma: 1.0 / SKETCH_GAMMA.ln(),
+        }
+    }
+
+    fn bucket(&self, x: f32) -> usize {
+        if !(x >= SKETCH_MIN) {
+            return 0;
+        }
+        let index = ((x / SKETCH_MIN).ln() * self.inv_ln_gamma) as usize;
+        1 + index.min(SKETCH_BUCKETS - 1)
+    }
+
+    /// 桶的代表值 (几何中点)
+    fn value(bucket: usize) -> f32 {
+        if bucket == 0 {
+            return 0.0;
+        }
+        SKETCH_MIN * SKETCH_GAMMA.powf(bucket as f32 - 0.5)
+    }
+
+    pub fn push(&mut self, x: f32) {
+        if self.totals[self.current] >= self.half {
+            self.current ^= 1;
+            self.counts[self.current].fill(0);
+            self.totals[self.current] = 0;
+        }
+        let bucket = self.bucket(x);
+        self.counts[self.current][bucket] += 1;
+        self.totals[self.current] += 1;
+    }
+
+    /// 第 `q` 分位数 (0..=1)；没有样本时返回 None
+    pub fn quantile(&self, q: f32) -> Option<f32> {
+        let total = self.totals[0] + self.totals[1];
+        if total == 0 {
+            return None;
+        }
+        let rank = ((q.clamp(0.0, 1.0) * total as f32).ceil() as u32).max(1);
+        let mut seen = 0;
+        for bucket in 0..=SKETCH_BUCKETS {
+            seen += self.counts[0][bucket] + self.counts[1][bucket];
+            if seen >= rank {
+                return Some(Self::value(bucket));
+            }
+        }
+        Some(Self::value(SKETCH_BUCKETS))
+    }
+}
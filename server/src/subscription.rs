@@ -0,0 +1,371 @@
+//! 字段订阅
+//!
+//! 客户端可以只订阅自己显示的字段或字段组，服务端每帧按不同的订阅各编码一次
+//! (而不是每个客户端一次)，再把对应的投影发给各客户端:
+//! - 3DS: UDP 发送 `SUB <名称>,<名称>,...`
+//! - Web: WebSocket 发送 `{"subscribe":["名称", ...]}`
+//!
+//! 名称可以是 `SystemMetrics` 的字段名，也可以是字段组 (见 [`GROUPS`])；未知名称忽略。
+//! `seq` 与 `sample_ms` 总是携带 (客户端据此统计丢包和插值)
+
+use crate::monitor::SystemMetrics;
+use serde::{
+    ser::{self, Impossible, SerializeStruct},
+    Serialize, Serializer,
+};
+
+/// 字段集合，每个 `SystemMetrics` 字段占一位 (按结构体字段顺序)
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct FieldMask(u32);
+
+pub const CPU_USAGE: FieldMask = FieldMask(1 << 0);
+pub const CPU_FREQUENCY_MHZ: FieldMask = FieldMask(1 << 1);
+pub const CORE_USAGE: FieldMask = FieldMask(1 << 2);
+pub const CORE_FREQUENCY_MHZ: FieldMask = FieldMask(1 << 3);
+pub const MEMORY_USAGE: FieldMask = FieldMask(1 << 4);
+pub const MEMORY_TOTAL: FieldMask = FieldMask(1 << 5);
+pub const MEMORY_USED: FieldMask = FieldMask(1 << 6);
+pub const SWAP_USAGE: FieldMask = FieldMask(1 << 7);
+pub const CPU_TEMP: FieldMask = FieldMask(1 << 8);
+pub const GPU_TEMP: FieldMask = FieldMask(1 << 9);
+pub const FAN_SPEEDS: FieldMask = FieldMask(1 << 10);
+pub const POWER_SCORE: FieldMask = FieldMask(1 << 11);
+pub const HOSTNAME: FieldMask = FieldMask(1 << 12);
+pub const OS_NAME: FieldMask = FieldMask(1 << 13);
+pub const KERNEL_VERSION: FieldMask = FieldMask(1 << 14);
+pub const CPU_MODEL: FieldMask = FieldMask(1 << 15);
+pub const CPU_CORES: FieldMask = FieldMask(1 << 16);
+pub const UPTIME_SECS: FieldMask = FieldMask(1 << 17);
+pub const BATTERY_PERCENTAGE: FieldMask = FieldMask(1 << 18);
+pub const BATTERY_STATUS: FieldMask = FieldMask(1 << 19);
+pub const RESOLUTION: FieldMask = FieldMask(1 << 20);
+pub const PROCESSES: FieldMask = FieldMask(1 << 21);
+pub const IO: FieldMask = FieldMask(1 << 22);
+pub const GAUGES: FieldMask = FieldMask(1 << 23);
+pub const ALERTS: FieldMask = FieldMask(1 << 24);
+pub const FAN_CONTROL: FieldMask = FieldMask(1 << 25);
+pub const CGROUPS: FieldMask = FieldMask(1 << 26);
+
+/// 字段名 → 位
+pub const FIELDS: [(&str, FieldMask); 27] = [
+    ("cpu_usage", CPU_USAGE),
+    ("cpu_frequency_mhz", CPU_FREQUENCY_MHZ),
+    ("core_usage", CORE_USAGE),
+    ("core_frequency_mhz", CORE_FREQUENCY_MHZ),
+    ("memory_usage", MEMORY_USAGE),
+    ("memory_total", MEMORY_TOTAL),
+    ("memory_used", MEMORY_USED),
+    ("swap_usage", SWAP_USAGE),
+    ("cpu_temp", CPU_TEMP),
+    ("gpu_temp", GPU_TEMP),
+    ("fan_speeds", FAN_SPEEDS),
+    ("power_score", POWER_SCORE),
+    ("hostname", HOSTNAME),
+    ("os_name", OS_NAME),
+    ("kernel_version", KERNEL_VERSION),
+    ("cpu_model", CPU_MODEL),
+    ("cpu_cores", CPU_CORES),
+    ("uptime_secs", UPTIME_SECS),
+    ("battery_percentage", BATTERY_PERCENTAGE),
+    ("battery_status", BATTERY_STATUS),
+    ("resolution", RESOLUTION),
+    ("processes", PROCESSES),
+    ("io", IO),
+    ("gauges", GAUGES),
+    ("alerts", ALERTS),
+    ("fan_control", FAN_CONTROL),
+    ("cgroups", CGROUPS),
+];
+
+/// 字段组名 → 位
+pub const GROUPS: [(&str, FieldMask); 12] = [
+    ("cpu", CPU_USAGE.with(CPU_FREQUENCY_MHZ)),
+    ("cores", CORE_USAGE.with(CORE_FREQUENCY_MHZ)),
+    ("memory", MEMORY_USAGE.with(MEMORY_TOTAL).with(MEMORY_USED).with(SWAP_USAGE)),
+    ("thermal", CPU_TEMP.with(GPU_TEMP).with(FAN_SPEEDS)),
+    ("power", POWER_SCORE),
+    ("battery", BATTERY_PERCENTAGE.with(BATTERY_STATUS)),
+    (
+        "system",
+        HOSTNAME
+            .with(OS_NAME)
+            .with(KERNEL_VERSION)
+            .with(CPU_MODEL)
+            .with(CPU_CORES)
+            .with(UPTIME_SECS)
+            .with(RESOLUTION),
+    ),
+    ("processes", PROCESSES),
+    ("io", IO),
+    ("gauges", GAUGES),
+    ("alerts", ALERTS),
+    ("cgroups", CGROUPS),
+];
+
+impl FieldMask {
+    /// 全部字段 (未订阅的客户端默认值，编码结果与直接序列化 `SystemMetrics` 相同)
+    pub const ALL: FieldMask = FieldMask((1 << FIELDS.len()) - 1);
+    pub const NONE: FieldMask = FieldMask(0);
+
+    pub const fn with(self, other: FieldMask) -> FieldMask {
+        FieldMask(self.0 | other.0)
+    }
+
+    pub const fn contains(self, other: FieldMask) -> bool {
+        self.0 & other.0 == other.0
+    }
+
+    /// 只保留 `other` 中也有的字段
+    pub const fn only(self, other: FieldMask) -> FieldMask {
+        FieldMask(self.0 & other.0)
+    }
+
+    /// 位图 (位号同 [`FIELDS`] 的下标)
+    pub const fn bits(self) -> u32 {
+        self.0
+    }
+
+    /// 解析逗号分隔的字段名/字段组名 (`all` 或 `*` 表示全部)
+    pub fn parse(list: &str) -> FieldMask {
+        Self::from_names(list.split(','))
+    }
+
+    pub fn from_names<'a>(names: impl IntoIterator<Item = &'a str>) -> FieldMask {
+        names.into_iter().map(str::trim).fold(Self::NONE, |mask, name| {
+            if name == "all" || name == "*" {
+                return Self::ALL;
+            }
+            FIELDS
+                .iter()
+                .chain(GROUPS.iter())
+                .find(|(n, _)| *n == name)
+                .map_or(mask, |(_, bits)| mask.with(*bits))
+        })
+    }
+}
+
+/// `SystemMetrics` 按订阅的投影
+///
+/// 由 `SystemMetrics` 派生的 `Serialize` 驱动 (见 [`Masked`])，字段顺序、格式与跳过规则都与完整编码一致
+pub struct Projection<'a> {
+    pub metrics: &'a SystemMetrics,
+    pub mask: FieldMask,
+}
+
+impl Serialize for Projection<'_> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        self.metrics.serialize(Masked { inner: serializer, mask: self.mask })
+    }
+}
+
+/// 包装序列化器: 派生代码逐个写入结构体字段时，只转发订阅了的字段；
+/// 不在 [`FIELDS`] 中的字段 (`seq`、`sample_ms`) 总是转发。只支持结构体
+struct Masked<S> {
+    inner: S,
+    mask: FieldMask,
+}
+
+/// 按订阅过滤字段的结构体序列化
+struct MaskedStruct<S> {
+    inner: S,
+    mask: FieldMask,
+    /// 下一个字段在 [`FIELDS`] 中的预期位置 (派生代码按结构体字段顺序写入，通常一次比较就命中)
+    next: usize,
+}
+
+impl<S> MaskedStruct<S> {
+    fn selected(&mut self, key: &str) -> bool {
+        let found = FIELDS[self.next..]
+            .iter()
+            .position(|(name, _)| *name == key)
+            .map(|i| self.next + i)
+            .or_else(|| FIELDS.iter().position(|(name, _)| *name == key));
+        match found {
+            Some(i) => {
+                self.next = i + 1;
+                self.mask.contains(FIELDS[i].1)
+            }
+            None => true,
+        }
+    }
+}
+
+impl<S: SerializeStruct> SerializeStruct for MaskedStruct<S> {
+    type Ok = S::Ok;
+    type Error = S::Error;
+
+    fn serialize_field<T: ?Sized + Serialize>(&mut self, key: &'static str, value: &T) -> Result<(), S::Error> {
+        if self.selected(key) {
+            self.inner.serialize_field(key, value)?;
+        }
+        Ok(())
+    }
+
+    fn skip_field(&mut self, key: &'static str) -> Result<(), S::Error> {
+        self.inner.skip_field(key)
+    }
+
+    fn end(self) -> Result<S::Ok, S::Error> {
+        self.inner.end()
+    }
+}
+
+fn unsupported<E: ser::Error>() -> E {
+    E::custom("subscription projection only supports structs")
+}
+
+macro_rules! unsupported {
+    ($($method:ident($($arg:ty),*);)*) => {
+        $(fn $method(self, $(_: $arg),*) -> Result<S::Ok, S::Error> {
+            Err(unsupported())
+        })*
+    };
+}
+
+impl<S: Serializer> Serializer for Masked<S> {
+    type Ok = S::Ok;
+    type Error = S::Error;
+    type SerializeSeq = Impossible<S::Ok, S::Error>;
+    type SerializeTuple = Impossible<S::Ok, S::Error>;
+    type SerializeTupleStruct = Impossible<S::Ok, S::Error>;
+    type SerializeTupleVariant = Impossible<S::Ok, S::Error>;
+    type SerializeMap = Impossible<S::Ok, S::Error>;
+    type SerializeStruct = MaskedStruct<S::SerializeStruct>;
+    type SerializeStructVariant = Impossible<S::Ok, S::Error>;
+
+    fn serialize_struct(self, name: &'static str, len: usize) -> Result<Self::SerializeStruct, S::Error> {
+        Ok(MaskedStruct { inner: self.inner.serialize_struct(name, len)?, mask: self.mask, next: 0 })
+    }
+
+    unsupported! {
+        serialize_bool(bool);
+        serialize_i8(i8);
+        serialize_i16(i16);
+        serialize_i32(i32);
+        serialize_i64(i64);
+        serialize_u8(u8);
+        serialize_u16(u16);
+        serialize_u32(u32);
+        serialize_u64(u64);
+        serialize_f32(f32);
+        serialize_f64(f64);
+        serialize_char(char);
+        serialize_str(&str);
+        serialize_bytes(&[u8]);
+        serialize_none();
+        serialize_unit();
+        serialize_unit_struct(&'static str);
+        serialize_unit_variant(&'static str, u32, &'static str);
+    }
+
+    fn serialize_some<T: ?Sized + Serialize>(self, _: &T) -> Result<S::Ok, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_newtype_struct<T: ?Sized + Serialize>(self, _: &'static str, _: &T) -> Result<S::Ok, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_newtype_variant<T: ?Sized + Serialize>(
+        self,
+        _: &'static str,
+        _: u32,
+        _: &'static str,
+        _: &T,
+    ) -> Result<S::Ok, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_seq(self, _: Option<usize>) -> Result<Self::SerializeSeq, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_tuple(self, _: usize) -> Result<Self::SerializeTuple, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_tuple_struct(self, _: &'static str, _: usize) -> Result<Self::SerializeTupleStruct, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_tuple_variant(
+        self,
+        _: &'static str,
+        _: u32,
+        _: &'static str,
+        _: usize,
+    ) -> Result<Self::SerializeTupleVariant, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_map(self, _: Option<usize>) -> Result<Self::SerializeMap, S::Error> {
+        Err(unsupported())
+    }
+
+    fn serialize_struct_variant(
+        self,
+        _: &'static str,
+        _: u32,
+        _: &'static str,
+        _: usize,
+    ) -> Result<Self::SerializeStructVariant, S::Error> {
+        Err(unsupported())
+    }
+}
+
+/// 按订阅编码
+pub fn encode(metrics: &SystemMetrics, mask: FieldMask) -> serde_json::Result<String> {
+    if mask == FieldMask::ALL {
+        serde_json::to_string(metrics)
+    } else {
+        serde_json::to_string(&Projection { metrics, mask })
+    }
+}
+
+/// 一帧的全部编码 (每个不同的订阅一份 JSON，二进制客户端的每个不同订阅另有一份二进制帧)
+#[derive(Debug, Default)]
+pub struct Frame {
+    encodings: Vec<(FieldMask, String)>,
+    binary: Vec<(FieldMask, Vec<u8>)>,
+    alerts: Option<String>,
+}
+
+impl Frame {
+    /// 已编码好的完整消息 (中继转发的帧)，所有订阅都收到原样消息
+    pub fn shared(json: String) -> Self {
+        Self { encodings: vec![(FieldMask::ALL, json)], binary: Vec::new(), alerts: None }
+    }
+
+    pub fn push_binary(&mut self, mask: FieldMask, bytes: Vec<u8>) {
+        self.binary.push((mask, bytes));
+    }
+
+    /// 给定订阅的二进制帧 (见 [`crate::wire::encode_binary`])；中继转发的帧、
+    /// 以及订阅在本帧编码之后才变化时没有
+    pub fn binary(&self, mask: FieldMask) -> Option<&[u8]> {
+        self.binary.iter().find(|(m, _)| *m == mask).map(|(_, bytes)| bytes.as_slice())
+    }
+
+    /// 二进制帧不含告警，有告警事件时另附一条 `{"type":"alerts","alerts":[...]}` 文本消息
+    pub fn set_alerts(&mut self, json: String) {
+        self.alerts = Some(json);
+    }
+
+    pub fn alerts(&self) -> Option<&str> {
+        self.alerts.as_deref()
+    }
+
+    pub fn push(&mut self, mask: FieldMask, json: String) {
+        self.encodings.push((mask, json));
+    }
+
+    /// 取给定订阅的编码: 优先完全匹配，其次任一包含它的编码；
+    /// 都没有时返回 None (订阅在本帧编码之后才变化，跳过这一帧)
+    pub fn get(&self, mask: FieldMask) -> Option<&str> {
+        self.encodings
+            .iter()
+            .find(|(m, _)| *m == mask)
+            .or_else(|| self.encodings.iter().find(|(m, _)| m.contains(mask)))
+            .map(|(_, json)| json.as_str())
+    }
+}
@@ -0,0 +1,82 @@
+//! 合成数据后端
+//!
+//! 不访问真实硬件，按时间生成平滑变化的指标。用于测量启动耗时、压测推送链路，
+//! 以及在没有传感器的机器上演示客户端。静态信息在 `probe_delay` 之后才出现，
+//! 模拟真实后端中慢速探测稍后补齐字段的行为
+
+use crate::collector;
+use crate::monitor::{Backend, SystemMetrics};
+use std::time::{Duration, Instant};
+
+/// 合成数据后端
+pub struct SyntheticBackend {
+    started: Instant,
+    /// 静态信息 (主机名等) 出现前的模拟探测延迟
+    probe_delay: Duration,
+}
+
+impl SyntheticBackend {
+    /// 创建合成后端
+    pub fn new(probe_delay: Duration) -> Self {
+        Self {
+            started: Instant::now(),
+            probe_delay,
+        }
+    }
+}
+
+impl Default for SyntheticBackend {
+    fn default() -> Self {
+        Self::new(Duration::from_millis(300))
+    }
+}
+
+impl Backend for SyntheticBackend {
+    fn refresh(&mut self) -> SystemMetrics {
+        let t = self.started.elapsed().as_secs_f32();
+        let probed = self.started.elapsed() >= self.probe_delay;
+
+        let cpu_usage = 35.0 + 30.0 * (t * 0.7).sin();
+        let memory_total = 16384;
+        let memory_used = (memory_total as f32 * (0.55 + 0.1 * (t * 0.1).sin())) as u64;
+        let memory_usage = memory_used as f32 / memory_total as f32 * 100.0;
+        let cpu_temp = 55.0 + cpu_usage * 0.3;
+        // 8 个核心相位错开，其中 0 号核心模拟单线程饱和
+        let core_usage: Vec<f32> = (0..8)
+            .map(|i| if i == 0 { 98.0 } else { (cpu_usage + 25.0 * (t + i as f32).sin()).clamp(0.0, 100.0) })
+            .collect();
+        let core_frequency_mhz: Vec<u64> = core_usage.iter().map(|u| 1800 + (*u * 18.0) as u64).collect();
+
+        SystemMetrics {
+            seq: 0,
+            sample_ms: collector::millis(Instant::now()),
+            cpu_usage,
+            cpu_frequency_mhz: core_frequency_mhz.iter().sum::<u64>() / core_frequency_mhz.len() as u64,
+            core_usage,
+            core_frequency_mhz,
+            memory_usage,
+            memory_total,
+            memory_used,
+            swap_usage: 5.0,
+            cpu_temp: probed.then_some(cpu_temp),
+            gpu_temp: probed.then_some(cpu_temp + 3.0),
+            fan_speeds: if probed { vec![1200.0 + cpu_usage * 20.0] } else { vec![] },
+            power_score: Some(2.0 + cpu_usage * 0.15 + memory_usage * 0.05),
+            hostname: probed.then(|| "synthetic".to_string()),
+            os_name: probed.then(|| "SyntheticOS".to_string()),
+            kernel_version: probed.then(|| "0.0.0".to_string()),
+            cpu_model: probed.then(|| "Synthetic CPU".to_string()),
+            cpu_cores: probed.then_some(8),
+            uptime_secs: Some(self.started.elapsed().as_secs()),
+            battery_percentage: None,
+            battery_status: None,
+            resolution: None,
+            processes: None,
+            io: None,
+            gauges: Vec::new(),
+            alerts: Vec::new(),
+            fan_control: None,
+            cgroups: None,
+        }
+    }
+}
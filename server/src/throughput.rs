@@ -0,0 +1,302 @@
+//! 磁盘与网络吞吐采集
+//!
+//! 内核只提供单调递增的累计计数器，速率由相邻两次采样的差分除以间隔得到:
+//! - 回退时只有回绕后的增量不超过 [`WRAP_WINDOW`] (回退前接近 32 位上限) 才按 32 位回绕处理，
+//!   其他回退视为计数器重置，该周期记 0
+//! - 设备热插拔: 新设备首次出现只记录基线，消失的设备在本次采样后移除
+//! - 每组最多跟踪 `MAX_DEVICES` 个设备，单次采样的解析量有上限
+//! - 采样线程按耗时拉长周期，采集占用不超过单核的 1/`DUTY_CYCLE_DIVISOR`
+//!
+//! 输出每组的总量 (只计物理设备，避免 loop/dm/veth 等重复计数) 和按字节速率排序的 Top-N。
+//! 磁盘的 Top-N 同样只列整块物理盘: 分区、dm、loop 的流量已经计在底层的盘上
+
+use serde::ser::SerializeSeq;
+use serde::{Serialize, Serializer};
+use std::collections::HashMap;
+use std::io;
+use std::sync::mpsc::{self, Receiver};
+use std::thread;
+use std::time::{Duration, Instant};
+
+/// 每组最多跟踪的设备数
+pub const MAX_DEVICES: usize = 256;
+
+/// 采样耗时与周期的最小比例
+const DUTY_CYCLE_DIVISOR: u32 = 100;
+/// 按 32 位回绕处理的最大增量: 回退前的读数离 `u32::MAX` 不超过该值，且回绕后的增量同样很小。
+/// 32 位计数器一个采样周期内的正常增量远小于该值，更大的回退只可能是重置
+const WRAP_WINDOW: u64 = 1 << 30;
+/// 尚未取走的报告上限 (推送循环停顿时采样线程在发送处等待，报告不会堆积)
+const REPORT_BACKLOG: usize = 4;
+
+/// 一个设备的四个累计计数器: [入字节, 出字节, 入次数, 出次数]
+///
+/// 磁盘为 [读字节, 写字节, 读次数, 写次数]，网卡为 [收字节, 发字节, 收包, 发包]
+pub type Counters = [u64; 4];
+
+/// 两次读数之间的增量，处理回绕与重置
+fn counter_delta(prev: u64, cur: u64) -> u64 {
+    if cur >= prev {
+        return cur - prev;
+    }
+    let wrapped = (u32::MAX as u64 + 1).checked_sub(prev).map(|rest| rest + cur);
+    match wrapped {
+        // 32 位计数器回绕
+        Some(delta) if delta <= WRAP_WINDOW => delta,
+        // 计数器重置 (设备重新出现、驱动重新加载等)
+        _ => 0,
+    }
+}
+
+/// 单个设备的速率 (每秒)
+#[derive(Debug, Clone, Default)]
+pub struct IoRate {
+    pub name: String,
+    /// 与 [`Counters`] 同序的每秒速率
+    pub rates: [f64; 4],
+}
+
+impl Serialize for IoRate {
+    /// 编码为 [名称, 入 B/s, 出 B/s, 入 次/s, 出 次/s]
+    fn serialize<S: Serializer>(&self, serializer: S) -> Result<S::Ok, S::Error> {
+        let mut seq = serializer.serialize_seq(Some(5))?;
+        seq.serialize_element(&self.name)?;
+        for rate in &self.rates {
+            seq.serialize_element(&(rate.round() as u64))?;
+        }
+        seq.end()
+    }
+}
+
+/// 一组设备 (磁盘或网卡) 的汇总
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct IoGroup {
+    /// 物理设备总速率，与 [`Counters`] 同序
+    pub total: [u64; 4],
+    /// 按字节速率 (入 + 出) 排序的 Top-N
+    pub top: Vec<IoRate>,
+}
+
+/// 一次吞吐采样的报告
+#[derive(Debug, Clone, Default, Serialize)]
+pub struct IoReport {
+    pub disk: IoGroup,
+    pub net: IoGroup,
+}
+
+/// 跟踪中的设备
+struct Device {
+    prev: Counters,
+    rates: [f64; 4],
+    /// 计入总量 (物理设备)
+    physical: bool,
+    /// 最近一次出现的采样代数
+    seen: u64,
+}
+
+/// 计数器到速率的转换 (一组设备)
+pub struct RateTracker {
+    devices: HashMap<String, Device>,
+    generation: u64,
+    elapsed_secs: f64,
+    /// Top-N 只列物理设备 (磁盘: 分区与 dm/loop 会与底层的盘重复)
+    physical_only: bool,
+}
+
+impl RateTracker {
+    pub fn new() -> Self {
+        Self {
+            devices: HashMap::new(),
+            generation: 0,
+            elapsed_secs: 0.0,
+            physical_only: false,
+        }
+    }
+
+    /// 总量与 Top-N 都只计物理设备 (非物理设备仍然跟踪，判定结果随设备缓存)
+    pub fn physical_only() -> Self {
+        Self { physical_only: true, ..Self::new() }
+    }
+
+    fn begin(&mut self, elapsed: Duration) {
+        self.generation += 1;
+        self.elapsed_secs = elapsed.as_secs_f64();
+    }
+
+    /// 记录一个设备的读数
+    ///
+    /// `is_physical` 只在设备首次出现时调用一次，其结果随设备缓存
+    pub fn observe(&mut self, name: &str, counters: Counters, is_physical: impl FnOnce(&str) -> bool) {
+        // 已知设备按 &str 查找，不分配
+        if let Some(device) = self.devices.get_mut(name) {
+            for i in 0..4 {
+                let delta = counter_delta(device.prev[i], counters[i]);
+                device.rates[i] = if self.elapsed_secs > 0.0 { delta as f64 / self.elapsed_secs } else { 0.0 };
+            }
+            device.prev = counters;
+            device.seen = self.generation;
+        } else if self.devices.len() < MAX_DEVICES {
+            // 新设备只记录基线
+            self.devices.insert(
+                name.to_string(),
+                Device {
+                    prev: counters,
+                    rates: [0.0; 4],
+                    physical: is_physical(name),
+                    seen: self.generation,
+                },
+            );
+        }
+    }
+
+    /// 移除本次未出现的设备，生成汇总
+    fn finish(&mut self, top_n: usize) -> IoGroup {
+        let generation = self.generation;
+        self.devices.retain(|_, device| device.seen == generation);
+
+        let mut total = [0.0f64; 4];
+        for device in self.devices.values().filter(|d| d.physical) {
+            for i in 0..4 {
+                total[i] += device.rates[i];
+            }
+        }
+
+        let physical_only = self.physical_only;
+        let mut ranked: Vec<(&String, &Device)> =
+            self.devices.iter().filter(|(_, device)| device.physical || !physical_only).collect();
+        let bytes = |d: &Device| d.rates[0] + d.rates[1];
+        ranked.sort_unstable_by(|a, b| bytes(b.1).total_cmp(&bytes(a.1)));
+        let top = ranked
+            .into_iter()
+            .filter(|(_, device)| bytes(device) > 0.0)
+            .take(top_n)
+            .map(|(name, device)| IoRate { name: name.clone(), rates: device.rates })
+            .collect();
+
+        IoGroup { total: total.map(|r| r.round() as u64), top }
+    }
+}
+
+impl Default for RateTracker {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+/// 吞吐计数器来源
+pub trait CounterSource: Send {
+    /// 读取一次全部计数器，逐设备调用 [`RateTracker::observe`]
+    fn read(&mut self, disks: &mut RateTracker, nets: &mut RateTracker) -> io::Result<()>;
+}
+
+/// 吞吐采样器
+pub struct IoSampler<S: CounterSource> {
+    source: S,
+    top_n: usize,
+    disks: RateTracker,
+    nets: RateTracker,
+    last: Option<Instant>,
+}
+
+impl<S: CounterSource> IoSampler<S> {
+    pub fn new(source: S, top_n: usize) -> Self {
+        Self {
+            source,
+            top_n,
+            disks: RateTracker::physical_only(),
+            nets: RateTracker::new(),
+            last: None,
+        }
+    }
+
+    /// 执行一次采样 (第一次只建立基线，速率为 0)
+    pub fn sample(&mut self) -> io::Result<IoReport> {
+        let now = Instant::now();
+        let elapsed = self.last.map(|t| now - t).unwrap_or_default();
+        self.last = Some(now);
+
+        self.disks.begin(elapsed);
+        self.nets.begin(elapsed);
+        self.source.read(&mut self.disks, &mut self.nets)?;
+        Ok(IoReport {
+            disk: self.disks.finish(self.top_n),
+            net: self.nets.finish(self.top_n),
+        })
+    }
+}
+
+/// 非 Linux: 只有 sysinfo 提供的网卡计数器 (sysinfo 0.31 不提供磁盘 I/O 计数)
+#[cfg(not(target_os = "linux"))]
+pub struct SysinfoNetworks {
+    networks: sysinfo::Networks,
+    reads: u32,
+}
+
+#[cfg(not(target_os = "linux"))]
+impl SysinfoNetworks {
+    /// 每隔多少次读取重新枚举网卡 (热插拔)
+    const RELIST_EVERY: u32 = 10;
+
+    pub fn new() -> Self {
+        Self {
+            networks: sysinfo::Networks::new_with_refreshed_list(),
+            reads: 0,
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+impl CounterSource for SysinfoNetworks {
+    fn read(&mut self, _disks: &mut RateTracker, nets: &mut RateTracker) -> io::Result<()> {
+        self.reads += 1;
+        if self.reads % Self::RELIST_EVERY == 0 {
+            self.networks.refresh_list();
+        } else {
+            self.networks.refresh();
+        }
+        for (name, data) in &self.networks {
+            let counters = [
+                data.total_received(),
+                data.total_transmitted(),
+                data.total_packets_received(),
+                data.total_packets_transmitted(),
+            ];
+            // 回环与隧道 (utun/gif/stf) 不计入总量
+            nets.observe(name, counters, |n| {
+                !["lo", "utun", "gif", "stf", "awdl", "llw", "bridge"].iter().any(|p| n.starts_with(p))
+            });
+        }
+        Ok(())
+    }
+}
+
+/// 在独立线程上按 `period` 采样吞吐，返回报告通道
+///
+/// 单次采样耗时超过周期的 1/`DUTY_CYCLE_DIVISOR` 时相应拉长间隔。
+/// 计数器来源不可用时返回 None
+pub fn spawn_sampler(period: Duration, top_n: usize) -> Option<Receiver<IoReport>> {
+    #[cfg(target_os = "linux")]
+    let source = crate::procfs::IoCounterFiles::open(std::path::Path::new("/")).ok()?;
+    #[cfg(not(target_os = "linux"))]
+    let source = SysinfoNetworks::new();
+
+    let (tx, rx) = mpsc::sync_channel(REPORT_BACKLOG);
+    thread::spawn(move || {
+        let mut sampler = IoSampler::new(source, top_n);
+        loop {
+            let started = Instant::now();
+            let report = match sampler.sample() {
+                Ok(report) => report,
+                Err(e) => {
+                    println!("⚠️  吞吐采样失败，停止采集: {}", e);
+                    break;
+                }
+            };
+            if tx.send(report).is_err() {
+                break;
+            }
+            thread::sleep(period.max(started.elapsed() * DUTY_CYCLE_DIVISOR));
+        }
+    });
+    Some(rx)
+}
@@ -0,0 +1,251 @@
+//! 内嵌 Web 仪表盘
+//!
+//! `web/` 目录在编译时由 build.rs 读入二进制，并预先压缩为 gzip 与 brotli 两份，ETag 取内容哈希。
+//! 网页与 WebSocket 共用同一端口: 读完一个请求头后，升级请求连同已读的字节交给
+//! [`crate::fanout::serve_ws`]，其余请求按路径返回内嵌资源 (keep-alive，同一连接可连续请求)。
+//! 响应只拷贝静态字节，不读磁盘、不在请求时压缩
+
+use crate::stats::STATS;
+use std::{
+    io,
+    pin::Pin,
+    task::{Context, Poll},
+    time::Duration,
+};
+use tokio::{
+    io::{AsyncRead, AsyncReadExt, AsyncWrite, AsyncWriteExt, ReadBuf},
+    net::TcpStream,
+    time::{timeout_at, Instant},
+};
+
+/// 一个内嵌资源
+pub struct Asset {
+    /// 请求路径 (以 `/` 开头)
+    pub path: &'static str,
+    pub content_type: &'static str,
+    /// 强 ETag (含引号)
+    pub etag: &'static str,
+    pub identity: &'static [u8],
+    /// 预压缩的编码 (压缩后不比原文小时为 None)
+    pub gzip: Option<&'static [u8]>,
+    pub brotli: Option<&'static [u8]>,
+}
+
+include!(concat!(env!("OUT_DIR"), "/web_assets.rs"));
+
+/// 请求头上限 (超出时返回 431 并关闭连接)
+const MAX_HEAD: usize = 8 << 10;
+/// 从开始等待一个请求到读完它的请求头的总时间 (包括 keep-alive 连接的空闲等待)；
+/// 按总时间而不是每次读取计时，逐字节慢速发送请求头的连接同样在该时间后关闭
+const HEAD_TIMEOUT: Duration = Duration::from_secs(5);
+/// 文件名不含内容哈希，每次使用缓存前都用 ETag 向服务端确认 (未变化时是不带正文的 304)
+const CACHE_CONTROL: &str = "no-cache";
+
+/// 按请求路径查找资源 (`/` 对应 index.html，忽略查询串)
+pub fn find(path: &str) -> Option<&'static Asset> {
+    let path = path.split(['?', '#']).next().unwrap_or(path);
+    let path = if path == "/" { "/index.html" } else { path };
+    ASSETS.iter().find(|asset| asset.path == path)
+}
+
+/// `Accept-Encoding` 是否接受 `coding` (`q=0` 视为不接受，其余 q 值不区分)
+pub fn accepts(accept_encoding: &str, coding: &str) -> bool {
+    accept_encoding.split(',').any(|item| {
+        let mut parts = item.split(';').map(str::trim);
+        parts.next().is_some_and(|name| name.eq_ignore_ascii_case(coding))
+            && !parts.any(|param| {
+                param
+                    .strip_prefix("q=")
+                    .and_then(|q| q.trim().parse::<f32>().ok())
+                    .is_some_and(|q| q == 0.0)
+            })
+    })
+}
+
+impl Asset {
+    /// 按 `Accept-Encoding` 选择正文: 优先 brotli，其次 gzip，都不接受 (或资源没有压缩版本) 时返回原文。
+    /// 第二项为 `Content-Encoding`
+    pub fn body(&self, accept_encoding: &str) -> (&'static [u8], Option<&'static str>) {
+        match (self.brotli, self.gzip) {
+            (Some(brotli), _) if accepts(accept_encoding, "br") => (brotli, Some("br")),
+            (_, Some(gzip)) if accepts(accept_encoding, "gzip") => (gzip, Some("gzip")),
+            _ => (self.identity, None),
+        }
+    }
+}
+
+/// 解析出的请求头 (只保留用到的字段)
+#[derive(Debug, Default)]
+pub struct Request<'a> {
+    pub method: &'a str,
+    pub path: &'a str,
+    /// `Upgrade: websocket`
+    pub upgrade: bool,
+    pub accept_encoding: &'a str,
+    pub if_none_match: Option<&'a str>,
+    /// HTTP/1.0 或 `Connection: close`
+    pub close: bool,
+}
+
+/// 解析请求头 (`head` 不含结尾的空行)
+pub fn parse_head(head: &[u8]) -> Option<Request<'_>> {
+    let head = std::str::from_utf8(head).ok()?;
+    let mut lines = head.split("\r\n");
+    let mut request_line = lines.next()?.split(' ');
+    let mut request = Request {
+        method: request_line.next()?,
+        path: request_line.next()?,
+        close: request_line.next()? == "HTTP/1.0",
+        ..Default::default()
+    };
+    for line in lines {
+        let Some((name, value)) = line.split_once(':') else { continue };
+        let value = value.trim();
+        if name.eq_ignore_ascii_case("upgrade") {
+            request.upgrade = value.eq_ignore_ascii_case("websocket");
+        } else if name.eq_ignore_ascii_case("accept-encoding") {
+            request.accept_encoding = value;
+        } else if name.eq_ignore_ascii_case("if-none-match") {
+            request.if_none_match = Some(value);
+        } else if name.eq_ignore_ascii_case("connection") {
+            request.close = value.split(',').any(|token| token.trim().eq_ignore_ascii_case("close"));
+        }
+    }
+    Some(request)
+}
+
+/// `If-None-Match` 是否包含 `etag` (或为 `*`)
+fn etag_matches(if_none_match: &str, etag: &str) -> bool {
+    if_none_match.split(',').map(str::trim).any(|tag| tag == etag || tag == "*")
+}
+
+/// 把完整响应 (头与正文) 写入 `out` (复用缓冲)
+pub fn respond(request: &Request, out: &mut Vec<u8>) {
+    use std::io::Write as _;
+
+    out.clear();
+    let connection = if request.close { "close" } else { "keep-alive" };
+    let asset = match request.method {
+        "GET" | "HEAD" => find(request.path),
+        _ => {
+            out.extend_from_slice(b"HTTP/1.1 405 Method Not Allowed\r\nAllow: GET, HEAD\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            return;
+        }
+    };
+    let Some(asset) = asset else {
+        let _ = write!(out, "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: {}\r\n\r\n", connection);
+        return;
+    };
+    // 同一路径有多种编码，缓存须按 Accept-Encoding 区分；ETag 对应内容本身，各编码共用
+    if request.if_none_match.is_some_and(|tags| etag_matches(tags, asset.etag)) {
+        STATS.http_not_modified.inc();
+        let _ = write!(
+            out,
+            "HTTP/1.1 304 Not Modified\r\nETag: {}\r\nCache-Control: {}\r\nVary: Accept-Encoding\r\nConnection: {}\r\n\r\n",
+            asset.etag, CACHE_CONTROL, connection
+        );
+        return;
+    }
+    let (body, encoding) = asset.body(request.accept_encoding);
+    let _ = write!(
+        out,
+        "HTTP/1.1 200 OK\r\nContent-Type: {}\r\nContent-Length: {}\r\nETag: {}\r\nCache-Control: {}\r\nVary: Accept-Encoding\r\n",
+        asset.content_type,
+        body.len(),
+        asset.etag,
+        CACHE_CONTROL
+    );
+    if let Some(encoding) = encoding {
+        let _ = write!(out, "Content-Encoding: {}\r\n", encoding);
+    }
+    let _ = write!(out, "Connection: {}\r\n\r\n", connection);
+    if request.method == "GET" {
+        out.extend_from_slice(body);
+    }
+}
+
+/// 处理一个连接上的网页请求，直到连接关闭或出现 WebSocket 升级请求
+///
+/// 遇到升级请求时返回连接 (已读取的字节由 [`Replay`] 重放，供 WebSocket 握手重新读取)
+pub async fn serve(mut stream: TcpStream) -> Option<Replay<TcpStream>> {
+    let mut buf = Vec::with_capacity(1024);
+    let mut out = Vec::new();
+    let mut chunk = [0u8; 2048];
+    loop {
+        // 读到一个完整的请求头 (流水线请求可能已在缓冲中)
+        let deadline = Instant::now() + HEAD_TIMEOUT;
+        let head_len = loop {
+            if let Some(end) = buf.windows(4).position(|w| w == b"\r\n\r\n") {
+                break end;
+            }
+            if buf.len() > MAX_HEAD {
+                let _ = stream.write_all(b"HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n").await;
+                return None;
+            }
+            match timeout_at(deadline, stream.read(&mut chunk)).await {
+                Ok(Ok(n)) if n > 0 => buf.extend_from_slice(&chunk[..n]),
+                _ => return None,
+            }
+        };
+        let Some(request) = parse_head(&buf[..head_len]) else {
+            let _ = stream.write_all(b"HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n").await;
+            return None;
+        };
+        if request.upgrade {
+            return Some(Replay::new(buf, stream));
+        }
+        // 其他方法的请求可能带正文，回复 405 后关闭连接，不再解析后续字节
+        let close = request.close || !matches!(request.method, "GET" | "HEAD");
+        respond(&request, &mut out);
+        STATS.http_requests.inc();
+        STATS.http_sent_bytes.add(out.len() as u64);
+        if stream.write_all(&out).await.is_err() || close {
+            return None;
+        }
+        // GET/HEAD 请求没有正文，下一个请求紧跟在空行之后
+        buf.drain(..head_len + 4);
+    }
+}
+
+/// 先重放已读取的字节，再读取底层流 (写入直接转发)
+pub struct Replay<S> {
+    head: Vec<u8>,
+    pos: usize,
+    inner: S,
+}
+
+impl<S> Replay<S> {
+    pub fn new(head: Vec<u8>, inner: S) -> Self {
+        Self { head, pos: 0, inner }
+    }
+}
+
+impl<S: AsyncRead + Unpin> AsyncRead for Replay<S> {
+    fn poll_read(mut self: Pin<&mut Self>, cx: &mut Context<'_>, buf: &mut ReadBuf<'_>) -> Poll<io::Result<()>> {
+        if self.pos < self.head.len() {
+            let n = buf.remaining().min(self.head.len() - self.pos);
+            buf.put_slice(&self.head[self.pos..self.pos + n]);
+            self.pos += n;
+            if self.pos == self.head.len() {
+                self.head = Vec::new();
+                self.pos = 0;
+            }
+            return Poll::Ready(Ok(()));
+        }
+        Pin::new(&mut self.inner).poll_read(cx, buf)
+    }
+}
+
+impl<S: AsyncWrite + Unpin> AsyncWrite for Replay<S> {
+    fn poll_write(mut self: Pin<&mut Self>, cx: &mut Context<'_>, buf: &[u8]) -> Poll<io::Result<usize>> {
+        Pin::new(&mut self.inner).poll_write(cx, buf)
+    }
+
+    fn poll_flush(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Pin::new(&mut self.inner).poll_flush(cx)
+    }
+
+    fn poll_shutdown(mut self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<io::Result<()>> {
+        Pin::new(&mut self.inner).poll_shutdown(cx)
+    }
+}
@@ -0,0 +1,181 @@
+//! WebSocket 传输格式
+//!
+//! 连接默认收 JSON 文本帧，客户端可发送 `{"format":"binary"}` 或 `{"format":"deflate"}` 切换
+//! (服务端回复 `{"type":"format","format":...}` 确认，旧版服务端不回复，客户端继续按 JSON 解析):
+//! - `binary`: 小端二进制帧 (见 [`encode_binary`])，只含订阅了的数值指标，客户端用 DataView 解码
+//! - `deflate`: JSON 经 raw deflate 压缩后以二进制消息发送。每个连接一个压缩上下文，跨消息保留
+//!   (相邻帧的键名和大部分数值重复，后续帧只需引用窗口中的前文)；每条消息以同步刷新结束，
+//!   解压端用一个持续的解压流逐条取出，消息以 `\n` 分隔
+//!
+//! tungstenite 不支持 permessage-deflate 扩展握手，这里在应用层协商，效果相同
+
+use crate::monitor::SystemMetrics;
+use crate::packed;
+use crate::subscription::{
+    FieldMask, CORE_FREQUENCY_MHZ, CORE_USAGE, CPU_FREQUENCY_MHZ, CPU_TEMP, CPU_USAGE, FAN_SPEEDS, GPU_TEMP,
+    MEMORY_TOTAL, MEMORY_USAGE, MEMORY_USED, POWER_SCORE, SWAP_USAGE,
+};
+use flate2::{Compress, Compression, FlushCompress};
+
+/// 二进制帧版本 (首字节)
+pub const BINARY_VERSION: u8 = 2;
+/// 二进制帧定长头部长度
+pub const BINARY_HEADER_LEN: usize = 16;
+/// 二进制帧可携带的字段 (其余字段只在 JSON 中携带)
+pub const BINARY_FIELDS: FieldMask = CPU_USAGE
+    .with(CPU_FREQUENCY_MHZ)
+    .with(CORE_USAGE)
+    .with(CORE_FREQUENCY_MHZ)
+    .with(MEMORY_USAGE)
+    .with(MEMORY_TOTAL)
+    .with(MEMORY_USED)
+    .with(SWAP_USAGE)
+    .with(CPU_TEMP)
+    .with(GPU_TEMP)
+    .with(FAN_SPEEDS)
+    .with(POWER_SCORE);
+
+/// 连接的传输格式
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Format {
+    Json,
+    Binary,
+    Deflate,
+}
+
+impl Format {
+    pub fn parse(name: &str) -> Option<Format> {
+        match name {
+            "json" => Some(Format::Json),
+            "binary" => Some(Format::Binary),
+            "deflate" => Some(Format::Deflate),
+            _ => None,
+        }
+    }
+
+    pub fn name(self) -> &'static str {
+        match self {
+            Format::Json => "json",
+            Format::Binary => "binary",
+            Format::Deflate => "deflate",
+        }
+    }
+}
+
+/// 按订阅编码二进制帧 (小端)，追加到 `out`
+///
+/// ```text
+///  0  u8   版本 (2)
+///  1  u8   风扇数 F (未订阅 fan_speeds 时为 0)
+///  2  u16  核心数 C (core_usage 与 core_frequency_mhz 都未订阅时为 0)
+///  4  u32  本帧携带的字段 (位号同 subscription::FIELDS，只含 BINARY_FIELDS 中的字段)
+///  8  u32  seq (低 32 位)
+/// 12  u32  sample_ms (低 32 位)
+/// 16  之后按位号顺序依次携带订阅了的字段，未订阅的不占空间:
+///     f32  cpu_usage
+///     u32  cpu_frequency_mhz
+///     u8   core_usage[C]          (%，同 JSON 的紧凑编码)
+///     u8   core_frequency_mhz[C]  (100 MHz 单位)
+///     f32  memory_usage
+///     u32  memory_total (MB)
+///     u32  memory_used (MB)
+///     f32  swap_usage
+///     f32  cpu_temp       (NaN 表示无数据)
+///     f32  gpu_temp       (NaN 表示无数据)
+///     f32  fan_speeds[F]
+///     f32  power_score    (NaN 表示无数据)
+/// ```
+pub fn encode_binary(metrics: &SystemMetrics, mask: FieldMask, out: &mut Vec<u8>) {
+    let mask = mask.only(BINARY_FIELDS);
+    let fans = if mask.contains(FAN_SPEEDS) { metrics.fan_speeds.len().min(u8::MAX as usize) } else { 0 };
+    let cores = if mask.contains(CORE_USAGE) || mask.contains(CORE_FREQUENCY_MHZ) {
+        metrics.core_usage.len().min(u16::MAX as usize)
+    } else {
+        0
+    };
+    out.reserve(BINARY_HEADER_LEN + 9 * 4 + fans * 4 + cores * 2);
+
+    out.push(BINARY_VERSION);
+    out.push(fans as u8);
+    out.extend_from_slice(&(cores as u16).to_le_bytes());
+    out.extend_from_slice(&mask.bits().to_le_bytes());
+    out.extend_from_slice(&(metrics.seq as u32).to_le_bytes());
+    out.extend_from_slice(&(metrics.sample_ms as u32).to_le_bytes());
+
+    let put_f32 = |out: &mut Vec<u8>, value: Option<f32>| out.extend_from_slice(&value.unwrap_or(f32::NAN).to_le_bytes());
+    let put_u32 = |out: &mut Vec<u8>, value: u64| out.extend_from_slice(&(value.min(u32::MAX as u64) as u32).to_le_bytes());
+    if mask.contains(CPU_USAGE) {
+        put_f32(out, Some(metrics.cpu_usage));
+    }
+    if mask.contains(CPU_FREQUENCY_MHZ) {
+        put_u32(out, metrics.cpu_frequency_mhz);
+    }
+    if mask.contains(CORE_USAGE) {
+        out.extend(metrics.core_usage[..cores].iter().map(|v| packed::quantize_percent(*v)));
+    }
+    if mask.contains(CORE_FREQUENCY_MHZ) {
+        // 频率数组可能短于使用率数组 (部分平台取不到每核心频率)，缺失按 0 填充
+        out.extend((0..cores).map(|i| metrics.core_frequency_mhz.get(i).map_or(0, |v| packed::quantize_freq(*v))));
+    }
+    if mask.contains(MEMORY_USAGE) {
+        put_f32(out, Some(metrics.memory_usage));
+    }
+    if mask.contains(MEMORY_TOTAL) {
+        put_u32(out, metrics.memory_total);
+    }
+    if mask.contains(MEMORY_USED) {
+        put_u32(out, metrics.memory_used);
+    }
+    if mask.contains(SWAP_USAGE) {
+        put_f32(out, Some(metrics.swap_usage));
+    }
+    if mask.contains(CPU_TEMP) {
+        put_f32(out, metrics.cpu_temp);
+    }
+    if mask.contains(GPU_TEMP) {
+        put_f32(out, metrics.gpu_temp);
+    }
+    for rpm in &metrics.fan_speeds[..fans] {
+        put_f32(out, Some(*rpm));
+    }
+    if mask.contains(POWER_SCORE) {
+        put_f32(out, metrics.power_score);
+    }
+}
+
+/// 单个连接的 JSON 压缩器 (上下文跨消息保留)
+pub struct Deflater {
+    compress: Compress,
+}
+
+impl Default for Deflater {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Deflater {
+    pub fn new() -> Self {
+        // 每帧只有几百字节，fast 与默认级别压缩率相差很小
+        Self { compress: Compress::new(Compression::fast(), false) }
+    }
+
+    /// 压缩一条消息 (追加 `\n` 分隔符并同步刷新)，结果写入 `out` (清空后复用)
+    pub fn compress(&mut self, json: &str, out: &mut Vec<u8>) {
+        out.clear();
+        out.reserve(json.len() / 2 + 64);
+        for (input, flush) in [(json.as_bytes(), FlushCompress::None), (&b"\n"[..], FlushCompress::Sync)] {
+            let mut input = input;
+            loop {
+                let before = self.compress.total_in();
+                // compress_vec 只写入已预留的空间，空间不足时扩容后继续
+                let _ = self.compress.compress_vec(input, out, flush);
+                input = &input[(self.compress.total_in() - before) as usize..];
+                if input.is_empty() && out.len() < out.capacity() {
+                    break;
+                }
+                out.reserve(out.capacity().max(64));
+            }
+        }
+    }
+}
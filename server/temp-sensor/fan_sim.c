@@ -0,0 +1,248 @@
+/**
+ * 风扇曲线控制器的热模型仿真 (在 Linux/macOS 开发机上编译运行，不需要 SMC)
+ *
+ *   make -C server/temp-sensor sim        批量仿真: 15 分钟负载剖面，打印各阶段结果并检查控制指标
+ *   temp-sensor/fan_sim --helper          实时运行 fanctl 常驻循环 (协议与 temp_sensor --control 相同)，
+ *                                         供服务端 --fan-helper 在没有 SMC 的机器上联调
+ *
+ * 热模型 (一阶): C·dT/dt = P(t) - G(rpm)·(T - T_amb)，G = G_PASSIVE + G_PER_KRPM·rpm/1000；
+ * 风扇实际转速以 FAN_TAU_S 的时间常数跟随下发值；温度读数带 ±SENSOR_NOISE_C 的噪声
+ */
+
+#include "fanctl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// 热模型参数 (量级接近笔记本 SoC: 满载 60W 时最高转速下约 75°C)
+#define T_AMBIENT_C 25.0f
+#define HEAT_CAPACITY_J_PER_K 80.0f
+#define G_PASSIVE_W_PER_K 0.3f
+#define G_PER_KRPM_W_PER_K 0.15f
+#define FAN_TAU_S 1.5f
+#define SENSOR_NOISE_C 0.5f
+#define FAN_MIN_RPM 1200.0f
+#define FAN_MAX_RPM 6000.0f
+
+// 控制周期与仿真步长
+#define PERIOD_MS 500
+#define SUBSTEPS 10
+// 仿真用曲线 (与服务端默认曲线一致)
+#define SIM_CURVE "45:1200,60:2500,75:4500,90:6000 hyst=3 slew=300"
+// 滞回与限速都关闭的对照曲线
+#define NAIVE_CURVE "45:1200,60:2500,75:4500,90:6000 hyst=0 slew=1000000"
+
+typedef struct {
+    float temp_c;
+    float fan_rpm;
+    float command_rpm;  // 0 = 自动 (仿真中按最低转速)
+    uint32_t noise;
+    double t_s;
+} Plant;
+
+// 负载剖面: 空闲 → 持续满载 → 间歇负载 → 空闲 (秒, 瓦)
+static float load_watts(double t_s) {
+    double t = fmod(t_s, 900.0);
+    if (t < 120) return 8.0f;
+    if (t < 420) return 60.0f;
+    if (t < 720) return fmod(t, 40.0) < 20 ? 55.0f : 15.0f;
+    return 8.0f;
+}
+
+static float plant_noise(Plant* p) {
+    p->noise = p->noise * 1664525u + 1013904223u;
+    return ((p->noise >> 8) / 16777216.0f * 2.0f - 1.0f) * SENSOR_NOISE_C;
+}
+
+static void plant_init(Plant* p) {
+    memset(p, 0, sizeof(*p));
+    p->temp_c = 40.0f;
+    p->fan_rpm = FAN_MIN_RPM;
+    p->noise = 12345;
+}
+
+static void plant_advance(Plant* p, float dt_s) {
+    float command = p->command_rpm > 0 ? p->command_rpm : FAN_MIN_RPM;
+    for (int i = 0; i < SUBSTEPS; i++) {
+        float h = dt_s / SUBSTEPS;
+        p->fan_rpm += (command - p->fan_rpm) * (1.0f - expf(-h / FAN_TAU_S));
+        float g = G_PASSIVE_W_PER_K + G_PER_KRPM_W_PER_K * p->fan_rpm / 1000.0f;
+        p->temp_c += (load_watts(p->t_s) - g * (p->temp_c - T_AMBIENT_C)) / HEAT_CAPACITY_J_PER_K * h;
+        p->t_s += h;
+    }
+}
+
+// ========================================
+// 批量仿真
+// ========================================
+
+typedef struct {
+    const char* name;
+    double start_s, end_s;
+    float max_temp, sum_rpm;
+    int samples;
+    int reversals;      // 下发转速变化方向反转的次数 (越少风扇噪声越稳定)
+    float max_slew;     // 最大转速变化率 (RPM/秒)
+} Phase;
+
+typedef struct {
+    float max_temp;
+    int reversals;
+    float max_slew;
+} SimResult;
+
+static SimResult simulate(const char* curve_text, bool verbose) {
+    Phase phases[] = {
+        { "idle", 0, 120, 0, 0, 0, 0, 0 },
+        { "sustained 60W", 120, 420, 0, 0, 0, 0, 0 },
+        { "bursty 15/55W", 420, 720, 0, 0, 0, 0, 0 },
+        { "cool-down", 720, 900, 0, 0, 0, 0, 0 },
+    };
+    const int phase_count = sizeof(phases) / sizeof(phases[0]);
+
+    Plant plant;
+    plant_init(&plant);
+    FanAgent agent;
+    fan_agent_init(&agent, FAN_MIN_RPM, FAN_MAX_RPM);
+    char err[64];
+    char curve_line[128];
+    snprintf(curve_line, sizeof(curve_line), "CURVE %s", curve_text);
+    if (!fan_agent_command(&agent, curve_line, err, sizeof(err)) ||
+        !fan_agent_command(&agent, "MODE custom", err, sizeof(err))) {
+        fprintf(stderr, "command failed: %s\n", err);
+        exit(1);
+    }
+
+    const float dt = PERIOD_MS / 1000.0f;
+    float last_rpm = -1, last_delta = 0;
+    SimResult result = { 0, 0, 0 };
+    while (plant.t_s < 900.0) {
+        float reading = plant.temp_c + plant_noise(&plant);
+        float rpm = fan_agent_tick(&agent, reading, plant.fan_rpm, dt);
+        plant.command_rpm = rpm;
+
+        Phase* ph = &phases[0];
+        for (int i = 0; i < phase_count; i++) {
+            if (plant.t_s >= phases[i].start_s && plant.t_s < phases[i].end_s) ph = &phases[i];
+        }
+        if (plant.temp_c > ph->max_temp) ph->max_temp = plant.temp_c;
+        ph->sum_rpm += rpm;
+        ph->samples++;
+        if (last_rpm >= 0) {
+            float delta = rpm - last_rpm;
+            float slew = fabsf(delta) / dt;
+            if (slew > ph->max_slew) ph->max_slew = slew;
+            if (delta != 0) {
+                if (last_delta != 0 && (delta > 0) != (last_delta > 0)) ph->reversals++;
+                last_delta = delta;
+            }
+        }
+        last_rpm = rpm;
+        plant_advance(&plant, dt);
+    }
+
+    for (int i = 0; i < phase_count; i++) {
+        Phase* ph = &phases[i];
+        if (verbose) {
+            printf("  %-14s max %5.1f C  mean %5.0f RPM  %3d reversals  max slew %6.0f RPM/s\n",
+                   ph->name, ph->max_temp, ph->sum_rpm / ph->samples, ph->reversals, ph->max_slew);
+        }
+        if (ph->max_temp > result.max_temp) result.max_temp = ph->max_temp;
+        if (ph->max_slew > result.max_slew) result.max_slew = ph->max_slew;
+        result.reversals += ph->reversals;
+    }
+    return result;
+}
+
+static int run_batch(void) {
+    FanCurve curve;
+    fan_curve_parse(&curve, SIM_CURVE);
+
+    printf("curve %s\n", SIM_CURVE);
+    SimResult shaped = simulate(SIM_CURVE, true);
+    printf("naive %s\n", NAIVE_CURVE);
+    SimResult naive = simulate(NAIVE_CURVE, true);
+
+    int failures = 0;
+    if (shaped.max_slew > curve.slew_rpm_per_s * 1.001f) {
+        printf("FAIL: slew %.0f RPM/s exceeds limit %.0f\n", shaped.max_slew, curve.slew_rpm_per_s);
+        failures++;
+    }
+    if (shaped.reversals * 4 > naive.reversals) {
+        printf("FAIL: %d reversals with hysteresis vs %d without (expected at least 4x fewer)\n",
+               shaped.reversals, naive.reversals);
+        failures++;
+    }
+    // 限速让升温期间的最高温度略高于无限速的对照，但不应超过 3°C
+    if (shaped.max_temp > naive.max_temp + 3.0f) {
+        printf("FAIL: max temperature %.1f C vs %.1f C without shaping\n", shaped.max_temp, naive.max_temp);
+        failures++;
+    }
+    printf("%s: %d vs %d reversals, max %.1f vs %.1f C\n", failures ? "FAILED" : "ok",
+           shaped.reversals, naive.reversals, shaped.max_temp, naive.max_temp);
+    return failures ? 1 : 0;
+}
+
+// ========================================
+// 常驻模式 (实时)
+// ========================================
+
+static uint64_t wall_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+typedef struct {
+    Plant plant;
+    uint64_t last_ms;
+} SimIo;
+
+static void sim_catch_up(SimIo* s) {
+    uint64_t now = wall_ms();
+    if (now > s->last_ms) plant_advance(&s->plant, (now - s->last_ms) / 1000.0f);
+    s->last_ms = now;
+}
+
+static uint64_t sim_now(void* ctx) {
+    (void)ctx;
+    return wall_ms();
+}
+
+static float sim_read_temp(void* ctx) {
+    SimIo* s = (SimIo*)ctx;
+    sim_catch_up(s);
+    return s->plant.temp_c + plant_noise(&s->plant);
+}
+
+static int sim_read_fans(void* ctx, float* rpm, int max) {
+    SimIo* s = (SimIo*)ctx;
+    if (max < 1) return 0;
+    sim_catch_up(s);
+    rpm[0] = s->plant.fan_rpm;
+    return 1;
+}
+
+static bool sim_apply(void* ctx, FanMode mode, float rpm) {
+    SimIo* s = (SimIo*)ctx;
+    sim_catch_up(s);
+    s->plant.command_rpm = mode == FAN_MODE_AUTO ? 0 : rpm;
+    return true;
+}
+
+static int run_helper(void) {
+    SimIo sim;
+    plant_init(&sim.plant);
+    sim.last_ms = wall_ms();
+    FanIo io = { &sim, sim_now, sim_read_temp, sim_read_fans, sim_apply };
+    FanAgent agent;
+    fan_agent_init(&agent, FAN_MIN_RPM, FAN_MAX_RPM);
+    return fan_agent_run(&agent, &io, PERIOD_MS);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--helper") == 0) return run_helper();
+    return run_batch();
+}
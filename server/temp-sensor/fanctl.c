@@ -0,0 +1,286 @@
+/**
+ * 风扇曲线控制器 (见 fanctl.h)
+ */
+
+#include "fanctl.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+// 曲线未指定时的滞回 (°C) 与限速 (RPM/秒)
+#define DEFAULT_HYSTERESIS_C 2.0f
+#define DEFAULT_SLEW_RPM_PER_S 300.0f
+// 滞回上限 (°C)，防止一次下发的错误配置让风扇长时间降不下来
+#define MAX_HYSTERESIS_C 20.0f
+// 两个周期间隔超过该值 (进程被挂起等) 时按该值计算限速
+#define MAX_STEP_S 5.0f
+// 命令行长度上限
+#define LINE_MAX_LEN 512
+
+static const char* const MODE_NAMES[] = { "auto", "silent", "turbo", "custom" };
+
+const char* fan_mode_name(FanMode mode) {
+    return MODE_NAMES[mode];
+}
+
+bool fan_mode_parse(const char* name, FanMode* mode) {
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(name, MODE_NAMES[i]) == 0) {
+            *mode = (FanMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+bool fan_curve_parse(FanCurve* curve, const char* text) {
+    FanCurve c;
+    memset(&c, 0, sizeof(c));
+    c.hysteresis_c = DEFAULT_HYSTERESIS_C;
+    c.slew_rpm_per_s = DEFAULT_SLEW_RPM_PER_S;
+
+    const char* p = text;
+    while (*p == ' ') p++;
+    // 曲线点: t:rpm,t:rpm,...
+    while (*p && *p != ' ') {
+        if (c.count == FAN_CURVE_MAX_POINTS) return false;
+        char* end;
+        float t = strtof(p, &end);
+        if (end == p || *end != ':') return false;
+        p = end + 1;
+        float rpm = strtof(p, &end);
+        if (end == p || !isfinite(t) || !isfinite(rpm) || rpm < 0) return false;
+        if (c.count > 0 && t <= c.temp_c[c.count - 1]) return false;
+        c.temp_c[c.count] = t;
+        c.rpm[c.count] = rpm;
+        c.count++;
+        p = end;
+        if (*p == ',') p++;
+    }
+    if (c.count == 0) return false;
+
+    // 选项: hyst=H slew=S
+    while (*p) {
+        while (*p == ' ') p++;
+        if (!*p) break;
+        char* end;
+        if (strncmp(p, "hyst=", 5) == 0) {
+            c.hysteresis_c = strtof(p + 5, &end);
+        } else if (strncmp(p, "slew=", 5) == 0) {
+            c.slew_rpm_per_s = strtof(p + 5, &end);
+        } else {
+            return false;
+        }
+        if (end == p + 5 || (*end && *end != ' ')) return false;
+        p = end;
+    }
+    if (!(c.hysteresis_c >= 0 && c.hysteresis_c <= MAX_HYSTERESIS_C)) return false;
+    if (!(c.slew_rpm_per_s > 0 && isfinite(c.slew_rpm_per_s))) return false;
+
+    *curve = c;
+    return true;
+}
+
+float fan_curve_eval(const FanCurve* curve, float temp_c) {
+    if (temp_c <= curve->temp_c[0]) return curve->rpm[0];
+    for (int i = 1; i < curve->count; i++) {
+        if (temp_c < curve->temp_c[i]) {
+            float k = (temp_c - curve->temp_c[i - 1]) / (curve->temp_c[i] - curve->temp_c[i - 1]);
+            return curve->rpm[i - 1] + k * (curve->rpm[i] - curve->rpm[i - 1]);
+        }
+    }
+    return curve->rpm[curve->count - 1];
+}
+
+void fan_controller_init(FanController* c, const FanCurve* curve, float min_rpm, float max_rpm) {
+    memset(c, 0, sizeof(*c));
+    c->curve = *curve;
+    c->min_rpm = min_rpm;
+    c->max_rpm = max_rpm;
+    fan_controller_reset(c, 0);
+}
+
+void fan_controller_reset(FanController* c, float from_rpm) {
+    c->started = false;
+    c->command_rpm = from_rpm > 0 ? clampf(from_rpm, c->min_rpm, c->max_rpm) : -1;
+}
+
+float fan_controller_step(FanController* c, float temp_c, float dt_s) {
+    float hyst = c->curve.hysteresis_c;
+    if (!c->started) {
+        c->started = true;
+        c->tracked_temp = temp_c;
+    } else if (temp_c > c->tracked_temp) {
+        c->tracked_temp = temp_c;
+    } else if (temp_c < c->tracked_temp - hyst) {
+        c->tracked_temp = temp_c + hyst;
+    }
+
+    c->target_rpm = clampf(fan_curve_eval(&c->curve, c->tracked_temp), c->min_rpm, c->max_rpm);
+    if (c->command_rpm < 0) {
+        c->command_rpm = c->target_rpm;
+    } else {
+        float step = c->curve.slew_rpm_per_s * clampf(dt_s, 0, MAX_STEP_S);
+        c->command_rpm += clampf(c->target_rpm - c->command_rpm, -step, step);
+    }
+    return c->command_rpm;
+}
+
+void fan_agent_init(FanAgent* a, float min_rpm, float max_rpm) {
+    memset(a, 0, sizeof(*a));
+    a->mode = FAN_MODE_AUTO;
+    a->ctl.min_rpm = min_rpm;
+    a->ctl.max_rpm = max_rpm;
+}
+
+bool fan_agent_command(FanAgent* a, const char* line, char* err, int err_len) {
+    if (strncmp(line, "CURVE ", 6) == 0) {
+        FanCurve curve;
+        if (!fan_curve_parse(&curve, line + 6)) {
+            snprintf(err, err_len, "invalid curve");
+            return false;
+        }
+        // 换曲线不打断正在进行的调速: 从当前下发的转速继续
+        fan_controller_init(&a->ctl, &curve, a->ctl.min_rpm, a->ctl.max_rpm);
+        fan_controller_reset(&a->ctl, a->output_rpm);
+        a->have_curve = true;
+        return true;
+    }
+    if (strncmp(line, "MODE ", 5) == 0) {
+        FanMode mode;
+        if (!fan_mode_parse(line + 5, &mode)) {
+            snprintf(err, err_len, "unknown mode %s", line + 5);
+            return false;
+        }
+        if (mode == FAN_MODE_CUSTOM && a->mode != FAN_MODE_CUSTOM) {
+            // 从上一模式的转速开始限速 (自动模式下由 fan_agent_tick 取风扇实际转速)
+            fan_controller_reset(&a->ctl, a->output_rpm);
+        }
+        a->mode = mode;
+        return true;
+    }
+    snprintf(err, err_len, "unknown command");
+    return false;
+}
+
+float fan_agent_tick(FanAgent* a, float temp_c, float actual_rpm, float dt_s) {
+    switch (a->mode) {
+    case FAN_MODE_AUTO:
+        a->output_rpm = 0;
+        break;
+    case FAN_MODE_SILENT:
+        a->output_rpm = a->ctl.min_rpm;
+        break;
+    case FAN_MODE_TURBO:
+        a->output_rpm = a->ctl.max_rpm;
+        break;
+    case FAN_MODE_CUSTOM:
+        if (!a->have_curve) {
+            // 没有下发曲线时与单次设置 (-s custom) 相同: 固定在转速范围中点
+            a->output_rpm = (a->ctl.min_rpm + a->ctl.max_rpm) / 2;
+            break;
+        }
+        if (a->ctl.command_rpm < 0 && actual_rpm > 0) fan_controller_reset(&a->ctl, actual_rpm);
+        a->output_rpm = fan_controller_step(&a->ctl, temp_c, dt_s);
+        break;
+    }
+    return a->output_rpm;
+}
+
+int fan_agent_status(const FanAgent* a, float temp_c, const float* fans, int fan_count, char* out, int out_len) {
+    char temp[16] = "null", target[16] = "null", command[16] = "null";
+    if (temp_c > 0 && isfinite(temp_c)) snprintf(temp, sizeof(temp), "%.1f", temp_c);
+    if (a->mode != FAN_MODE_AUTO) {
+        float t = a->mode == FAN_MODE_CUSTOM && a->have_curve ? a->ctl.target_rpm : a->output_rpm;
+        snprintf(target, sizeof(target), "%.0f", t);
+        snprintf(command, sizeof(command), "%.0f", a->output_rpm);
+    }
+    int n = snprintf(out, out_len, "{\"mode\":\"%s\",\"temp\":%s,\"target_rpm\":%s,\"command_rpm\":%s,\"fans\":[",
+                     fan_mode_name(a->mode), temp, target, command);
+    for (int i = 0; i < fan_count && n < out_len; i++) {
+        n += snprintf(out + n, out_len - n, "%s%.0f", i ? "," : "", fans[i]);
+    }
+    if (n < out_len) n += snprintf(out + n, out_len - n, "]}");
+    return n < out_len ? n : out_len - 1;
+}
+
+// 一个控制周期: 读温度 → 计算 → 下发 → 输出状态
+static bool agent_cycle(FanAgent* a, const FanIo* io, float dt_s) {
+    float fans[FAN_MAX_FANS] = { 0 };
+    int fan_count = io->read_fans(io->ctx, fans, FAN_MAX_FANS);
+    float temp = io->read_temp(io->ctx);
+    float rpm = fan_agent_tick(a, temp, fan_count > 0 ? fans[0] : 0, dt_s);
+    bool ok = io->apply(io->ctx, a->mode, rpm);
+
+    char status[256];
+    fan_agent_status(a, temp, fans, fan_count, status, sizeof(status));
+    printf("%s\n", status);
+    fflush(stdout);
+    return ok;
+}
+
+int fan_agent_run(FanAgent* a, const FanIo* io, int period_ms) {
+    char line[LINE_MAX_LEN];
+    int len = 0;
+    bool overlong = false;
+    uint64_t last = io->now_ms(io->ctx);
+    uint64_t next = last;
+
+    for (;;) {
+        uint64_t now = io->now_ms(io->ctx);
+        if (now >= next) {
+            agent_cycle(a, io, (now - last) / 1000.0f);
+            last = now;
+            next += period_ms;
+            if (next <= now) next = now + period_ms;  // 卡顿后不补跑
+            continue;
+        }
+
+        // 等待命令或下一个周期
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(STDIN_FILENO, &fds);
+        struct timeval tv = { (long)((next - now) / 1000), (int)((next - now) % 1000) * 1000 };
+        if (select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0) continue;
+
+        char c;
+        if (read(STDIN_FILENO, &c, 1) != 1) break;  // 服务端退出
+        if (c == '\r') continue;
+        if (c != '\n') {
+            if (len < LINE_MAX_LEN - 1) line[len++] = c;
+            else overlong = true;
+            continue;
+        }
+        line[len] = '\0';
+        len = 0;
+        if (overlong) {
+            overlong = false;
+            printf("ERR line too long\n");
+            fflush(stdout);
+            continue;
+        }
+
+        char err[64] = "";
+        bool ok = fan_agent_command(a, line, err, sizeof(err));
+        if (ok && strncmp(line, "MODE ", 5) == 0) {
+            // 模式切换立即生效，并确认写入是否成功
+            now = io->now_ms(io->ctx);
+            ok = agent_cycle(a, io, (now - last) / 1000.0f);
+            last = now;
+            if (!ok) snprintf(err, sizeof(err), "SMC write failed");
+        }
+        if (ok) printf("OK %s\n", line);
+        else printf("ERR %s\n", err);
+        fflush(stdout);
+    }
+
+    io->apply(io->ctx, FAN_MODE_AUTO, 0);
+    return 0;
+}
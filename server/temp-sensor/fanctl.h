@@ -0,0 +1,91 @@
+/**
+ * 风扇曲线控制器
+ *
+ * temp_sensor --control 常驻模式的控制逻辑: 服务端经 stdin 下发温度→转速曲线和风扇模式，
+ * 控制循环按固定周期读取温度、计算目标转速并写入 SMC，每周期向 stdout 输出一行 JSON 状态。
+ * - 滞回: 温度上升时立即跟随，下降超过 hysteresis_c 才跟随，避免在曲线拐点附近来回调速
+ * - 限速: 每秒转速变化不超过 slew_rpm_per_s，负载突变时风扇平滑加减速
+ *
+ * 协议 (每行一条，回复 "OK <命令>" 或 "ERR <原因>"):
+ *   CURVE 45:1200,60:2500,75:4000,90:6000 hyst=3 slew=400
+ *   MODE auto|silent|turbo|custom
+ * 状态行: {"mode":"custom","temp":71.5,"target_rpm":3100,"command_rpm":2900,"fans":[2890]}
+ *
+ * 读写硬件通过 FanIo 回调完成，不依赖 IOKit，可在 Linux 上对着热模型单独编译测试 (见 fan_sim.c)
+ */
+
+#ifndef FANCTL_H
+#define FANCTL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 曲线最多的点数
+#define FAN_CURVE_MAX_POINTS 16
+// 最多控制的风扇数
+#define FAN_MAX_FANS 2
+
+typedef enum { FAN_MODE_AUTO, FAN_MODE_SILENT, FAN_MODE_TURBO, FAN_MODE_CUSTOM } FanMode;
+
+typedef struct {
+    float temp_c[FAN_CURVE_MAX_POINTS];   // 严格递增
+    float rpm[FAN_CURVE_MAX_POINTS];
+    int count;
+    float hysteresis_c;
+    float slew_rpm_per_s;
+} FanCurve;
+
+typedef struct {
+    FanCurve curve;
+    float min_rpm, max_rpm;
+    bool started;
+    float tracked_temp;   // 经滞回处理后用于查曲线的温度
+    float target_rpm;     // 曲线给出的转速 (已限制在风扇范围内)
+    float command_rpm;    // 限速后实际下发的转速
+} FanController;
+
+// 常驻模式的全部状态: 当前模式 + 自定义曲线控制器
+typedef struct {
+    FanMode mode;
+    bool have_curve;
+    FanController ctl;
+    float output_rpm;     // 上一周期下发的转速 (自动模式为 0)
+} FanAgent;
+
+// 硬件访问回调 (ctx 原样传回)
+typedef struct {
+    void* ctx;
+    uint64_t (*now_ms)(void* ctx);
+    float (*read_temp)(void* ctx);
+    // 读取各风扇实际转速，返回风扇数
+    int (*read_fans)(void* ctx, float* rpm, int max);
+    // 下发: 自动模式时 rpm 无意义 (交还系统控制)；返回 false 表示写入失败
+    bool (*apply)(void* ctx, FanMode mode, float rpm);
+} FanIo;
+
+const char* fan_mode_name(FanMode mode);
+bool fan_mode_parse(const char* name, FanMode* mode);
+
+// 解析 "t:rpm,t:rpm,... [hyst=H] [slew=S]"；失败时返回 false 且不修改 curve
+bool fan_curve_parse(FanCurve* curve, const char* text);
+// 分段线性插值，两端之外取端点值
+float fan_curve_eval(const FanCurve* curve, float temp_c);
+
+void fan_controller_init(FanController* c, const FanCurve* curve, float min_rpm, float max_rpm);
+// 从给定转速开始限速 (切换到自定义模式时传入风扇当前转速，<= 0 表示直接取曲线值)
+void fan_controller_reset(FanController* c, float from_rpm);
+// 推进一个控制周期，返回下发转速
+float fan_controller_step(FanController* c, float temp_c, float dt_s);
+
+void fan_agent_init(FanAgent* a, float min_rpm, float max_rpm);
+// 处理一条命令；失败时把原因写入 err
+bool fan_agent_command(FanAgent* a, const char* line, char* err, int err_len);
+// 推进一个控制周期: 返回下发转速 (自动模式返回 0)；actual_rpm 为风扇当前转速，用于切换模式时平滑衔接
+float fan_agent_tick(FanAgent* a, float temp_c, float actual_rpm, float dt_s);
+// 输出一行状态 JSON (不含换行)，返回长度
+int fan_agent_status(const FanAgent* a, float temp_c, const float* fans, int fan_count, char* out, int out_len);
+
+// 常驻控制循环: 每 period_ms 一个周期，同时处理 stdin 上的命令；stdin 关闭时恢复自动模式并返回
+int fan_agent_run(FanAgent* a, const FanIo* io, int period_ms);
+
+#endif
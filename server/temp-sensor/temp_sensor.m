@@ -11,6 +11,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include "fanctl.h"
 
 // ==========================================
 // SMC 定义
@@ -369,6 +371,41 @@ int SMCWriteFS(uint8_t mode, int debug) {
     return 1;
 }
 
+// 交还系统自动控制
+void restoreAutoMode(int fanCount, int debug) {
+    // 方法1: 重设 FS! 为 0
+    SMCWriteFS(0, debug);
+    
+    // 方法2: 设置各风扇模式为自动 (F0Md = 0)
+    for (int i = 0; i < fanCount; i++) {
+        char key[5];
+        snprintf(key, sizeof(key), "F%dMd", i);
+        SMCWriteByte(key, 0, debug);
+    }
+}
+
+// 进入强制模式 (之后写入的 F%dTg 目标转速才会生效)
+void enterForcedMode(int fanCount, int debug) {
+    // 方法1: 使用 F0Md (Stats 项目的首选方法)
+    // F0Md = 1 表示强制模式
+    int useMd = 0;
+    for (int i = 0; i < fanCount; i++) {
+        char key[5];
+        snprintf(key, sizeof(key), "F%dMd", i);
+        if (SMCReadKey(key, 0) >= 0) {
+            useMd = 1;
+            SMCWriteByte(key, 1, debug);  // 1 = 强制模式
+            if (debug) printf("Set %s = 1 (forced mode)\n", key);
+        }
+    }
+    
+    if (!useMd) {
+        // 方法2: 使用 FS! 位掩码 (老方法)
+        uint8_t fsMask = (fanCount > 1) ? 0x03 : 0x01;
+        SMCWriteFS(fsMask, debug);
+    }
+}
+
 // 设置风扇模式 (参考 Stats 项目)
 int setFanMode(const char *mode, int debug) {
     if (!SMCOpen()) {
@@ -414,38 +451,10 @@ int setFanMode(const char *mode, int debug) {
     }
     
     if (useAuto) {
-        // 方法1: 重设 FS! 为 0
-        SMCWriteFS(0, debug);
-        
-        // 方法2: 设置各风扇模式为自动 (F0Md = 0)
-        for (int i = 0; i < fanCount; i++) {
-            char key[5];
-            snprintf(key, sizeof(key), "F%dMd", i);
-            SMCWriteByte(key, 0, debug);
-        }
-        
+        restoreAutoMode(fanCount, debug);
         printf("Auto mode restored.\n");
     } else {
-        // 设置强制模式
-        
-        // 方法1: 使用 F0Md (Stats 项目的首选方法)
-        // F0Md = 1 表示强制模式
-        int useMd = 0;
-        for (int i = 0; i < fanCount; i++) {
-            char key[5];
-            snprintf(key, sizeof(key), "F%dMd", i);
-            if (SMCReadKey(key, 0) >= 0) {
-                useMd = 1;
-                SMCWriteByte(key, 1, debug);  // 1 = 强制模式
-                if (debug) printf("Set %s = 1 (forced mode)\n", key);
-            }
-        }
-        
-        if (!useMd) {
-            // 方法2: 使用 FS! 位掩码 (老方法)
-            uint8_t fsMask = (fanCount > 1) ? 0x03 : 0x01;
-            SMCWriteFS(fsMask, debug);
-        }
+        enterForcedMode(fanCount, debug);
         
         // 设置各风扇目标转速
         for (int i = 0; i < fanCount; i++) {
@@ -508,7 +517,7 @@ int getHIDData(int page, int usage, int eventType, SensorData *sensors, int maxC
     IOHIDEventSystemClientRef system = IOHIDEventSystemClientCreate(kCFAllocatorDefault);
     IOHIDEventSystemClientSetMatching(system, dict);
     CFArrayRef services = IOHIDEventSystemClientCopyServices(system);
-    if (!services) { CFRelease(dict); return 0; }
+    if (!services) { CFRelease(system); CFRelease(dict); return 0; }
     long count = CFArrayGetCount(services);
     int valid = 0;
     for (int i = 0; i < count && valid < maxCount; i++) {
@@ -530,7 +539,8 @@ int getHIDData(int page, int usage, int eventType, SensorData *sensors, int maxC
             CFRelease(event);
         }
     }
-    CFRelease(services); CFRelease(dict);
+    // 常驻模式每个周期都会调用，客户端必须释放
+    CFRelease(services); CFRelease(system); CFRelease(dict);
     return valid;
 }
 
@@ -545,10 +555,98 @@ double getPeakTemp() {
     return max;
 }
 
+// ==========================================
+// 常驻控制模式 (--control，协议见 fanctl.h)
+// ==========================================
+
+// 控制周期 (毫秒)
+#define CONTROL_PERIOD_MS 500
+
+typedef struct {
+    int fanCount;
+    int forced;     // 已进入强制模式
+    int lastRPM;    // 上次写入的目标转速 (未变化时不写 SMC)
+    int debug;
+} SMCFanIo;
+
+static uint64_t smcNowMs(void *ctx) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static float smcReadTemp(void *ctx) {
+    return (float)getPeakTemp();
+}
+
+static int smcReadFans(void *ctx, float *rpm, int max) {
+    SMCFanIo *io = (SMCFanIo *)ctx;
+    int count = io->fanCount < max ? io->fanCount : max;
+    for (int i = 0; i < count; i++) {
+        char key[5];
+        snprintf(key, sizeof(key), "F%dAc", i);
+        rpm[i] = (float)SMCReadKey(key, 0);
+    }
+    return count;
+}
+
+static bool smcApply(void *ctx, FanMode mode, float rpm) {
+    SMCFanIo *io = (SMCFanIo *)ctx;
+    if (mode == FAN_MODE_AUTO) {
+        if (io->forced) {
+            restoreAutoMode(io->fanCount, io->debug);
+            io->forced = 0;
+            io->lastRPM = 0;
+        }
+        return true;
+    }
+    if (!io->forced) {
+        enterForcedMode(io->fanCount, io->debug);
+        io->forced = 1;
+        io->lastRPM = 0;
+    }
+    int target = (int)lroundf(rpm);
+    if (target == io->lastRPM) return true;
+    int ok = 1;
+    for (int i = 0; i < io->fanCount; i++) {
+        char key[5];
+        snprintf(key, sizeof(key), "F%dTg", i);
+        ok &= SMCWriteFanSpeed(key, target, io->debug);
+    }
+    if (ok) io->lastRPM = target;
+    return ok;
+}
+
+// 打开一次 SMC 连接，直到 stdin 关闭 (服务端退出) 才恢复自动模式并关闭
+int runControl(int debug) {
+    if (!SMCOpen()) {
+        printf("ERR Failed to open SMC. Need sudo?\n");
+        return 1;
+    }
+    
+    SMCFanIo smc = { (int)SMCReadKey("FNum", 0), 0, 0, debug };
+    if (smc.fanCount < 1) smc.fanCount = 1;
+    if (smc.fanCount > FAN_MAX_FANS) smc.fanCount = FAN_MAX_FANS;
+    
+    double minRPM = SMCReadKey("F0Mn", debug);
+    double maxRPM = SMCReadKey("F0Mx", debug);
+    if (minRPM < 500) minRPM = 1200;
+    if (maxRPM < 2000) maxRPM = 6000;
+    
+    FanAgent agent;
+    fan_agent_init(&agent, (float)minRPM, (float)maxRPM);
+    FanIo io = { &smc, smcNowMs, smcReadTemp, smcReadFans, smcApply };
+    fan_agent_run(&agent, &io, CONTROL_PERIOD_MS);
+    
+    SMCClose();
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     int jsonMode = 0;
     int debugMode = 0;
     char *setMode = NULL;
+    int controlMode = 0;
     
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--json") == 0) {
@@ -557,6 +655,8 @@ int main(int argc, char *argv[]) {
             debugMode = 1;
         } else if ((strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--set") == 0) && i + 1 < argc) {
             setMode = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--control") == 0) {
+            controlMode = 1;
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printf("Apple Silicon Hardware Monitor\n");
             printf("Usage: %s [options]\n", argv[0]);
@@ -564,11 +664,17 @@ int main(int argc, char *argv[]) {
             printf("  -j, --json     Output in JSON format\n");
             printf("  -d, --debug    Debug mode (show raw SMC data)\n");
             printf("  -s, --set MODE Set fan mode (turbo/silent/custom/auto)\n");
+            printf("  -c, --control  Stay resident: read CURVE/MODE commands on stdin, run the fan curve\n");
             printf("  -h, --help     Show this help\n");
             return 0;
         }
     }
     
+    // 常驻控制模式 (由服务端启动)
+    if (controlMode) {
+        return runControl(debugMode);
+    }
+
     // 如果指定了 -s，只执行设置模式然后退出
     if (setMode) {
         return setFanMode(setMode, debugMode) ? 0 : 1;
@@ -1,107 +1,369 @@
 /**
  * 赛博朋克仪表盘 - 主逻辑
- * 
+ *
  * 功能：
- * - WebSocket 连接接收实时数据
- * - 更新扁平化 UI 显示
+ * - 接收与解码在 Worker 中进行 (见 worker.js)，主线程只记录历史并标记需要重绘
+ * - 每个动画帧最多更新一次界面，服务端推送频率再高也不会多次改动 DOM
+ * - 最近一段时间的历史存放在预分配的环形缓冲区，画成折线图
+ * - 页面隐藏时断开连接、停止绘制
+ * - 显示服务端告警引擎上报的告警 (见 server/src/alerts.rs)
+ * - 由服务端提供页面时连接同一地址的 WebSocket (见 server/src/web.rs)
  */
 
 // ========================================
 // 配置
 // ========================================
 const CONFIG = {
-    wsUrl: 'ws://localhost:9000',
+    wsUrl: pageWsUrl(),
     reconnectDelay: 3000,
 };
 
+// 页面与 WebSocket 同源 (服务端在同一端口提供网页)；以本地文件打开时连接本机默认端口
+function pageWsUrl() {
+    if (location.protocol !== 'http:' && location.protocol !== 'https:') {
+        return 'ws://localhost:9000';
+    }
+    return (location.protocol === 'https:' ? 'wss://' : 'ws://') + location.host + '/';
+}
+
+// 向服务端订阅的字段/字段组 (与 updateUI 用到的字段一致)
+const SUBSCRIBED_FIELDS = ['cpu_usage', 'memory_usage', 'cpu_temp', 'fan_speeds', 'power_score', 'cores', 'alerts'];
+
+// 告警超过该时长没有收到重发即视为已解除 (服务端每 5 秒重发一次，容忍丢失一次)
+const ALERT_EXPIRE_MS = 12000;
+
+// 历史图表的时间窗口 (毫秒)
+const CHART_WINDOW_MS = 60000;
+// 历史缓冲区容量: 50 Hz 推送时也能存满一个时间窗口
+const HISTORY_SIZE = 3000;
+
+// 请求的传输格式 (?format=json|binary|deflate，默认 binary)；
+// 浏览器不支持 raw deflate 解压时 deflate 退回 JSON (由 worker.js 探测)
+const params = new URLSearchParams(location.search);
+const requestedFormat = params.get('format') || 'binary';
+
+// 中继模式下显示的主机 ID (?host=N 指定，默认取第一个出现的主机)
+const hostParam = params.get('host');
+
 // ========================================
 // 全局状态
 // ========================================
-let metrics = {
-    cpu_usage: 0,
-    memory_usage: 0,
-    memory_total: 0,
-    memory_used: 0,
-    cpu_temp: null,
-    fan_speeds: [],
-    power_score: null,
+// 最近一次收到的指标 (渲染时读取)
+let latest = null;
+// 已请求动画帧、尚未绘制
+let framePending = false;
+
+// 历史环形缓冲区: 接收时间 (performance.now()) 与各曲线的值，无数据记为 NaN
+const history = {
+    time: new Float64Array(HISTORY_SIZE),
+    cpu: new Float32Array(HISTORY_SIZE),
+    mem: new Float32Array(HISTORY_SIZE),
+    temp: new Float32Array(HISTORY_SIZE),
+    head: 0,
+    count: 0,
 };
 
+// 图表曲线: 字段、颜色 (CSS 变量)、图例
+const SERIES = [
+    { key: 'cpu', color: '--cyber-cyan', label: 'CPU %' },
+    { key: 'mem', color: '--cyber-purple', label: '内存 %' },
+    { key: 'temp', color: '--cyber-orange', label: '温度 °C' },
+];
+
+// 告警中的规则: 规则名 -> { value, at: 最近一次收到的时间 (performance.now()) }
+const activeAlerts = new Map();
+
+// 缓存的元素引用与上次写入的文本
+const el = {};
+const shownText = {};
+
+// 每核心热力条单元格 (核心数变化时重建) 与上次显示的值
+let coreCells = [];
+let shownCores = new Uint8Array(0);
+let shownFreq = new Uint8Array(0);
+
+// 图表
+let chart = null;
+
+// 数据源 (Worker，或不能创建 Worker 时在主线程运行的同一份代码)
+let feed = null;
+
 // ========================================
 // 初始化
 // ========================================
 function init() {
-    initWebSocket();
+    for (const id of ['cpu-text', 'mem-text', 'temp-text', 'fan-text', 'power-text', 'alert-text', 'core-strip']) {
+        el[id] = document.getElementById(id);
+    }
+    el.status = document.getElementById('connection-status');
+    el.statusText = el.status.querySelector('.text');
+
+    initChart();
+    initFeed();
+
+    // 隐藏时断开连接 (动画帧本身在隐藏页面中也会暂停)，可见后重连并立即重绘一次
+    document.addEventListener('visibilitychange', () => {
+        feed.postMessage({ type: 'visible', visible: !document.hidden });
+        if (!document.hidden) scheduleFrame();
+    });
 }
 
 // ========================================
-// WebSocket 连接
+// 数据源
 // ========================================
-function initWebSocket() {
-    const statusEl = document.getElementById('connection-status');
-    const textEl = statusEl.querySelector('.text');
-    
-    function connect() {
-        const ws = new WebSocket(CONFIG.wsUrl);
-        
-        ws.onopen = () => {
-            statusEl.classList.add('connected');
-            statusEl.classList.remove('error');
-            textEl.textContent = '已连接';
-        };
-        
-        ws.onmessage = (event) => {
-            try {
-                const data = JSON.parse(event.data);
-                if (data.type === 'connected') return;
-                
-                metrics = { ...metrics, ...data };
-                updateUI();
-            } catch (e) {
-                console.error('解析数据失败:', e);
-            }
-        };
-        
-        ws.onclose = () => {
-            statusEl.classList.remove('connected');
-            textEl.textContent = '连接断开，重连中...';
-            setTimeout(connect, CONFIG.reconnectDelay);
-        };
-        
-        ws.onerror = (error) => {
-            statusEl.classList.add('error');
-            statusEl.classList.remove('connected');
-            textEl.textContent = '连接错误';
-            console.error('WebSocket 错误:', error);
-        };
+function initFeed() {
+    try {
+        const worker = new Worker('worker.js');
+        worker.onmessage = (event) => onFeed(event.data);
+        feed = worker;
+    } catch (e) {
+        // file:// 等环境不允许 Worker，改用页面中已加载的 worker.js 在主线程运行
+        const local = createFeed(onFeed);
+        feed = { postMessage: (msg) => local.handle(msg) };
     }
-    
-    connect();
+    feed.postMessage({
+        type: 'start',
+        url: CONFIG.wsUrl,
+        format: requestedFormat,
+        subscribe: SUBSCRIBED_FIELDS,
+        host: hostParam === null ? null : Number(hostParam),
+        reconnectDelay: CONFIG.reconnectDelay,
+    });
+    if (document.hidden) feed.postMessage({ type: 'visible', visible: false });
+}
+
+function onFeed(msg) {
+    if (msg.type === 'status') {
+        updateStatus(msg.state);
+    } else if (msg.type === 'metrics') {
+        latest = msg.metrics;
+        // 中继补发的静态信息不是新的采样，不计入历史
+        if (!msg.static) recordHistory(latest);
+        scheduleFrame();
+    } else if (msg.type === 'alerts') {
+        const now = performance.now();
+        for (const alert of msg.alerts) {
+            if (alert.on) activeAlerts.set(alert.rule, { value: alert.value, at: now });
+            else activeAlerts.delete(alert.rule);
+        }
+        scheduleFrame();
+    }
+}
+
+function updateStatus(state) {
+    el.status.classList.toggle('connected', state === 'connected');
+    el.status.classList.toggle('error', state === 'error');
+    el.statusText.textContent = {
+        connected: '已连接',
+        closed: document.hidden ? '已暂停' : '连接断开，重连中...',
+        error: '连接错误',
+    }[state];
+}
+
+// ========================================
+// 历史
+// ========================================
+function recordHistory(m) {
+    const i = history.head;
+    history.time[i] = performance.now();
+    history.cpu[i] = m.cpu_usage;
+    history.mem[i] = m.memory_usage;
+    history.temp[i] = m.cpu_temp != null ? m.cpu_temp : NaN;
+    history.head = (i + 1) % HISTORY_SIZE;
+    if (history.count < HISTORY_SIZE) history.count++;
+}
+
+// ========================================
+// 渲染 (每个动画帧最多一次)
+// ========================================
+function scheduleFrame() {
+    if (framePending || document.hidden) return;
+    framePending = true;
+    requestAnimationFrame(renderFrame);
+}
+
+function renderFrame() {
+    framePending = false;
+    if (!latest) return;
+    updateUI();
+    drawChart();
+}
+
+// 文本未变化时不写 DOM
+function setText(id, text) {
+    if (shownText[id] === text) return;
+    shownText[id] = text;
+    el[id].textContent = text;
 }
 
 /**
  * 更新 UI 显示
  */
 function updateUI() {
+    const metrics = latest;
     // 更新文字指示器
-    document.getElementById('cpu-text').textContent = 
-        `CPU: ${metrics.cpu_usage.toFixed(1)}%`;
-    document.getElementById('mem-text').textContent = 
-        `内存: ${metrics.memory_usage.toFixed(1)}%`;
-    document.getElementById('temp-text').textContent = 
-        metrics.cpu_temp != null 
-            ? `温度: ${metrics.cpu_temp.toFixed(0)}°C` 
-            : '温度: N/A';
-            
-    document.getElementById('fan-text').textContent = 
+    setText('cpu-text', `CPU: ${metrics.cpu_usage.toFixed(1)}%`);
+    setText('mem-text', `内存: ${metrics.memory_usage.toFixed(1)}%`);
+    setText('temp-text',
+        metrics.cpu_temp != null
+            ? `温度: ${metrics.cpu_temp.toFixed(0)}°C`
+            : '温度: N/A');
+
+    setText('fan-text',
         (metrics.fan_speeds && Array.isArray(metrics.fan_speeds) && metrics.fan_speeds.length > 0)
             ? `风扇: ${metrics.fan_speeds.map(s => typeof s === 'number' ? s.toFixed(0) : s).join(' / ')} RPM`
-            : '风扇: 0 RPM';
-            
-    document.getElementById('power-text').textContent = 
+            : '风扇: 0 RPM');
+
+    setText('power-text',
         metrics.power_score != null
-            ? `负荷: ${(metrics.power_score / 100000).toFixed(1)} W` 
-            : '负荷: ---';
+            ? `负荷: ${(metrics.power_score / 100000).toFixed(1)} W`
+            : '负荷: ---');
+
+    updateAlerts();
+    updateCoreStrip();
+}
+
+/**
+ * 告警文字: 清除过期的告警，没有告警时隐藏
+ */
+function updateAlerts() {
+    const now = performance.now();
+    for (const [rule, alert] of activeAlerts) {
+        if (now - alert.at > ALERT_EXPIRE_MS) activeAlerts.delete(rule);
+    }
+    const text = [...activeAlerts]
+        .map(([rule, alert]) => `${rule} ${alert.value.toFixed(1)}`)
+        .join(' / ');
+    setText('alert-text', text ? `告警: ${text}` : '');
+    el['alert-text'].hidden = !text;
+}
+
+/**
+ * 使用率热力色: 0% 暗青 -> 50% 黄 -> 100% 红
+ */
+function heatColor(pct) {
+    const hue = 180 - Math.min(pct, 100) * 1.8;
+    const light = 25 + Math.min(pct, 100) * 0.3;
+    return `hsl(${hue}, 100%, ${light}%)`;
+}
+
+/**
+ * 更新每核心热力条 (使用率 %，频率以 100 MHz 为单位)，只改动数值变化的单元格
+ */
+function updateCoreStrip() {
+    const usage = latest.core_usage;
+    const freq = latest.core_frequency_mhz;
+
+    if (coreCells.length !== usage.length) {
+        el['core-strip'].replaceChildren();
+        coreCells = Array.from(usage, () => {
+            const cell = document.createElement('div');
+            cell.className = 'core';
+            el['core-strip'].appendChild(cell);
+            return cell;
+        });
+        // 标记全部单元格需要更新 (使用率最大 100)
+        shownCores = new Uint8Array(usage.length).fill(255);
+        shownFreq = new Uint8Array(usage.length);
+    }
+
+    for (let i = 0; i < usage.length; i++) {
+        const pct = usage[i];
+        const f = freq.length > i ? freq[i] : 0;
+        if (shownCores[i] === pct && shownFreq[i] === f) continue;
+        if (shownCores[i] !== pct) coreCells[i].style.background = heatColor(pct);
+        shownCores[i] = pct;
+        shownFreq[i] = f;
+        coreCells[i].title = freq.length > i
+            ? `CPU${i}: ${pct}% @ ${(f / 10).toFixed(1)} GHz`
+            : `CPU${i}: ${pct}%`;
+    }
+}
+
+// ========================================
+// 历史图表
+// ========================================
+function initChart() {
+    const canvas = document.getElementById('history-chart');
+    const style = getComputedStyle(document.documentElement);
+    chart = {
+        canvas,
+        ctx: canvas.getContext('2d'),
+        colors: SERIES.map((s) => style.getPropertyValue(s.color).trim()),
+        grid: style.getPropertyValue('--cyber-grid').trim(),
+        width: 0,
+        height: 0,
+    };
+    resizeChart();
+    window.addEventListener('resize', () => {
+        resizeChart();
+        scheduleFrame();
+    });
+}
+
+// 按显示尺寸和像素比设置画布分辨率
+function resizeChart() {
+    const ratio = window.devicePixelRatio || 1;
+    const rect = chart.canvas.getBoundingClientRect();
+    chart.width = rect.width;
+    chart.height = rect.height;
+    chart.canvas.width = Math.round(rect.width * ratio);
+    chart.canvas.height = Math.round(rect.height * ratio);
+    chart.ctx.setTransform(ratio, 0, 0, ratio, 0, 0);
+}
+
+/**
+ * 绘制最近 CHART_WINDOW_MS 内的曲线 (纵轴 0-100，最新样本在最右侧)
+ */
+function drawChart() {
+    const { ctx, width, height } = chart;
+    ctx.clearRect(0, 0, width, height);
+
+    ctx.strokeStyle = chart.grid;
+    ctx.lineWidth = 1;
+    ctx.beginPath();
+    for (const level of [25, 50, 75]) {
+        const y = Math.round(height - level / 100 * height) + 0.5;
+        ctx.moveTo(0, y);
+        ctx.lineTo(width, y);
+    }
+    ctx.stroke();
+
+    if (history.count === 0) return;
+    const newest = (history.head + HISTORY_SIZE - 1) % HISTORY_SIZE;
+    const end = history.time[newest];
+    const xScale = width / CHART_WINDOW_MS;
+    const yScale = height / 100;
+
+    ctx.lineWidth = 1.5;
+    SERIES.forEach((series, s) => {
+        const values = history[series.key];
+        ctx.strokeStyle = chart.colors[s];
+        ctx.beginPath();
+        let drawing = false;
+        // 从最旧的样本开始，跳过窗口之外的部分；NaN 处断开
+        for (let n = history.count; n > 0; n--) {
+            const i = (history.head + HISTORY_SIZE - n) % HISTORY_SIZE;
+            const age = end - history.time[i];
+            const v = values[i];
+            if (age > CHART_WINDOW_MS || Number.isNaN(v)) {
+                drawing = false;
+                continue;
+            }
+            const x = width - age * xScale;
+            const y = height - Math.min(Math.max(v, 0), 100) * yScale;
+            if (drawing) ctx.lineTo(x, y);
+            else ctx.moveTo(x, y);
+            drawing = true;
+        }
+        ctx.stroke();
+    });
+
+    ctx.font = '12px monospace';
+    SERIES.forEach((series, s) => {
+        ctx.fillStyle = chart.colors[s];
+        ctx.fillText(series.label, 8 + s * 90, 14);
+    });
 }
 
 // 启动
@@ -0,0 +1,289 @@
+/**
+ * 数据接收 Worker
+ *
+ * 在主线程之外完成 WebSocket 接收、格式协商和解码 (JSON / 二进制 / deflate 压缩 JSON，
+ * 见 server/src/wire.rs)，每条数据解码后把最新指标发给主线程；页面隐藏时断开连接，
+ * 重新可见后再连上。
+ *
+ * 浏览器不允许创建 Worker 时 (例如直接以 file:// 打开页面)，main.js 在主线程调用 createFeed，
+ * 行为相同
+ */
+
+// 二进制帧版本与定长头部长度 (与服务端 wire::encode_binary 一致)
+const BINARY_VERSION = 2;
+const BINARY_HEADER_LEN = 16;
+// 二进制帧的字段: [位号 (同 server/src/subscription.rs 的 FIELDS 下标), 字段名, 类型]，按位号顺序排列；
+// 只有帧头位图中置位的字段占空间
+const BINARY_FIELDS = [
+    [0, 'cpu_usage', 'f32'],
+    [1, 'cpu_frequency_mhz', 'u32'],
+    [2, 'core_usage', 'cores'],
+    [3, 'core_frequency_mhz', 'cores'],
+    [4, 'memory_usage', 'f32'],
+    [5, 'memory_total', 'u32'],
+    [6, 'memory_used', 'u32'],
+    [7, 'swap_usage', 'f32'],
+    [8, 'cpu_temp', 'f32?'],
+    [9, 'gpu_temp', 'f32?'],
+    [10, 'fan_speeds', 'fans'],
+    [11, 'power_score', 'f32?'],
+];
+const BINARY_SIZES = { f32: 4, 'f32?': 4, u32: 4 };
+
+/**
+ * 创建数据源，`post` 接收发往页面的消息:
+ * - { type: 'status', state: 'connected' | 'closed' | 'error' }
+ * - { type: 'metrics', metrics, static }: static 为 true 表示中继补发的主机静态信息，不是一帧新的采样
+ * - { type: 'alerts', alerts }: 告警状态变化 [{ rule, on, value }] (见 server/src/alerts.rs)
+ * 页面发来的消息交给返回对象的 handle():
+ * - { type: 'start', url, format, subscribe, host, reconnectDelay }
+ * - { type: 'visible', visible }
+ */
+function createFeed(post) {
+    // 收到的数据原地写入这个对象 (每核心数组解码为 Uint8Array，核心数不变时复用)
+    const metrics = {
+        cpu_usage: 0,
+        memory_usage: 0,
+        memory_total: 0,
+        memory_used: 0,
+        cpu_temp: null,
+        fan_speeds: [],
+        power_score: null,
+        core_usage: new Uint8Array(0),
+        core_frequency_mhz: new Uint8Array(0),
+    };
+
+    let config = null;
+    let active = false;
+    let ws = null;
+    let retryTimer = null;
+    // 中继模式下显示的主机 ID (null 表示取第一个出现的主机)
+    let relayHost = null;
+
+    function connect() {
+        const socket = new WebSocket(config.url);
+        socket.binaryType = 'arraybuffer';
+        ws = socket;
+        // 服务端确认前按 JSON 解析 (旧版服务端不认识 format，一直发 JSON)
+        let format = 'json';
+        let inflater = null;
+
+        function handleJson(text) {
+            const data = JSON.parse(text);
+            if (data.type === 'connected') return;
+            // 二进制格式不含告警，服务端另发一条文本消息
+            if (data.type === 'alerts') {
+                post({ type: 'alerts', alerts: data.alerts });
+                return;
+            }
+            if (data.type === 'format') {
+                format = data.format;
+                if (inflater) inflater.close();
+                inflater = format === 'deflate' ? createInflater(handleText) : null;
+                return;
+            }
+
+            // 中继模式: 消息带 host 字段，只显示选中的主机
+            if (data.host !== undefined) {
+                if (relayHost === null) relayHost = data.host;
+                if (data.host !== relayHost) return;
+                if (data.static) {
+                    applyJson(metrics, data.static);
+                    post({ type: 'metrics', metrics, static: true });
+                    return;
+                }
+            }
+
+            applyJson(metrics, data);
+            post({ type: 'metrics', metrics });
+            if (data.alerts) post({ type: 'alerts', alerts: data.alerts });
+        }
+
+        function handleText(text) {
+            try {
+                handleJson(text);
+            } catch (e) {
+                console.error('解析数据失败:', e);
+            }
+        }
+
+        socket.onopen = () => {
+            post({ type: 'status', state: 'connected' });
+            // 只订阅页面显示的字段 (服务端默认推送全部字段)，并请求传输格式
+            socket.send(JSON.stringify({ subscribe: config.subscribe, format: config.format }));
+        };
+
+        socket.onmessage = (event) => {
+            if (typeof event.data === 'string') {
+                handleText(event.data);
+            } else if (format === 'binary') {
+                if (applyBinary(metrics, event.data)) post({ type: 'metrics', metrics });
+            } else if (inflater) {
+                inflater.push(event.data);
+            }
+        };
+
+        socket.onclose = () => {
+            if (inflater) inflater.close();
+            inflater = null;
+            if (ws !== socket) return;
+            ws = null;
+            post({ type: 'status', state: 'closed' });
+            if (active) retryTimer = setTimeout(connect, config.reconnectDelay);
+        };
+
+        socket.onerror = (error) => {
+            post({ type: 'status', state: 'error' });
+            console.error('WebSocket 错误:', error);
+        };
+    }
+
+    function disconnect() {
+        clearTimeout(retryTimer);
+        retryTimer = null;
+        if (ws) {
+            const socket = ws;
+            ws = null;
+            socket.close();
+        }
+    }
+
+    return {
+        handle(msg) {
+            if (msg.type === 'start') {
+                config = msg;
+                if (config.format === 'deflate' && !supportsDeflateRaw()) config.format = 'json';
+                relayHost = msg.host;
+                active = true;
+                connect();
+            } else if (msg.type === 'visible' && config && msg.visible !== active) {
+                active = msg.visible;
+                if (active) connect();
+                else disconnect();
+            }
+        },
+    };
+}
+
+/**
+ * 把 JSON 消息的字段写入 metrics (每核心数组解码为字节数组)
+ */
+function applyJson(metrics, data) {
+    for (const key in data) {
+        if (key === 'alerts') {
+            // 告警是事件而不是状态，单独发给页面
+            continue;
+        } else if (key === 'core_usage' || key === 'core_frequency_mhz') {
+            metrics[key] = decodeHex(data[key], metrics[key]);
+        } else {
+            metrics[key] = data[key];
+        }
+    }
+}
+
+/**
+ * 解码二进制帧，原地写入 metrics (只写帧中携带的字段)；版本不符或长度不足时返回 false
+ */
+function applyBinary(metrics, buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength < BINARY_HEADER_LEN || view.getUint8(0) !== BINARY_VERSION) return false;
+    const fans = view.getUint8(1);
+    const cores = view.getUint16(2, true);
+    const mask = view.getUint32(4, true);
+    const sizes = { ...BINARY_SIZES, cores, fans: fans * 4 };
+    let length = BINARY_HEADER_LEN;
+    for (const [bit, , type] of BINARY_FIELDS) {
+        if (mask & (1 << bit)) length += sizes[type];
+    }
+    if (view.byteLength < length) return false;
+
+    metrics.seq = view.getUint32(8, true);
+    metrics.sample_ms = view.getUint32(12, true);
+    let off = BINARY_HEADER_LEN;
+    for (const [bit, name, type] of BINARY_FIELDS) {
+        if (!(mask & (1 << bit))) continue;
+        if (type === 'f32') {
+            metrics[name] = view.getFloat32(off, true);
+        } else if (type === 'f32?') {
+            metrics[name] = orNull(view.getFloat32(off, true));
+        } else if (type === 'u32') {
+            metrics[name] = view.getUint32(off, true);
+        } else if (type === 'cores') {
+            const array = resize(metrics[name], cores);
+            for (let i = 0; i < cores; i++) array[i] = view.getUint8(off + i);
+            metrics[name] = array;
+        } else {
+            metrics.fan_speeds.length = fans;
+            for (let i = 0; i < fans; i++) metrics.fan_speeds[i] = view.getFloat32(off + i * 4, true);
+        }
+        off += sizes[type];
+    }
+    return true;
+}
+
+// 二进制帧用 NaN 表示无数据
+function orNull(value) {
+    return Number.isNaN(value) ? null : value;
+}
+
+// 长度不变时复用原数组
+function resize(array, length) {
+    return array.length === length ? array : new Uint8Array(length);
+}
+
+/**
+ * 是否支持 raw deflate 解压: 有 DecompressionStream 但不认识 'deflate-raw' 的浏览器 (只支持 gzip/deflate)
+ * 构造时抛出异常，这种情况下不请求 deflate 格式
+ */
+function supportsDeflateRaw() {
+    try {
+        new DecompressionStream('deflate-raw');
+        return true;
+    } catch (e) {
+        return false;
+    }
+}
+
+/**
+ * 持续的 raw deflate 解压流: 服务端的压缩上下文跨消息保留，解压端也必须用同一个流。
+ * 每条消息以同步刷新结束并以 \n 分隔，解出的文本按行交给 onMessage
+ */
+function createInflater(onMessage) {
+    const stream = new DecompressionStream('deflate-raw');
+    const writer = stream.writable.getWriter();
+    const reader = stream.readable.pipeThrough(new TextDecoderStream()).getReader();
+    let pending = '';
+    (async () => {
+        for (;;) {
+            const { value, done } = await reader.read();
+            if (done) return;
+            pending += value;
+            let nl;
+            while ((nl = pending.indexOf('\n')) >= 0) {
+                onMessage(pending.slice(0, nl));
+                pending = pending.slice(nl + 1);
+            }
+        }
+    })().catch((e) => console.error('解压失败:', e));
+    return {
+        push: (buffer) => writer.write(new Uint8Array(buffer)).catch(() => {}),
+        close: () => writer.close().catch(() => {}),
+    };
+}
+
+/**
+ * 解码紧凑十六进制数组 (每核心 1 字节)，长度不变时写入 out
+ */
+function decodeHex(hex, out) {
+    out = resize(out, hex.length >> 1);
+    for (let i = 0; i < out.length; i++) {
+        out[i] = parseInt(hex.substr(i * 2, 2), 16);
+    }
+    return out;
+}
+
+// 作为 Worker 运行时接管消息 (以普通脚本加载时只提供 createFeed)
+if (typeof WorkerGlobalScope !== 'undefined' && self instanceof WorkerGlobalScope) {
+    const feed = createFeed((msg) => self.postMessage(msg));
+    self.onmessage = (event) => feed.handle(event.data);
+}